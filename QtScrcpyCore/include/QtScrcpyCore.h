@@ -1,4 +1,5 @@
 #pragma once
+#include <QMap>
 #include <QPointer>
 #include <QMouseEvent>
 
@@ -28,6 +29,12 @@ public:
     }
     virtual void updateFPS(quint32 fps) { Q_UNUSED(fps); }
     virtual void grabCursor(bool grab) {Q_UNUSED(grab);}
+    virtual void textStreamProgress(qint64 sentBytes, qint64 totalBytes, qint64 bytesPerSecond) {
+        Q_UNUSED(sentBytes);
+        Q_UNUSED(totalBytes);
+        Q_UNUSED(bytesPerSecond);
+    }
+    virtual void textStreamFinished(bool complete) { Q_UNUSED(complete); }
 
     virtual void mouseEvent(const QMouseEvent *from, const QSize &frameSize, const QSize &showSize) {
         Q_UNUSED(from);
@@ -62,6 +69,8 @@ public:
     virtual void collapsePanel() {}
     virtual void postBackOrScreenOn(bool down) { Q_UNUSED(down); }
     virtual void postTextInput(QString &text) { Q_UNUSED(text); }
+    virtual void postTextStream(const QString &text) { Q_UNUSED(text); }
+    virtual void cancelTextStream() {}
     virtual void requestDeviceClipboard() {}
     virtual void setDeviceClipboard(bool pause = true) { Q_UNUSED(pause); }
     virtual void clipboardPaste() {}
@@ -83,6 +92,8 @@ public:
 signals:
     void deviceConnected(bool success, const QString& serial, const QString& deviceName, const QSize& size);
     void deviceDisconnected(QString serial);
+    // 断开后线程回收、录像写入等清理全部完成
+    void deviceReleased(QString serial);
 
 public:
     virtual void setUserData(void* data) = 0;
@@ -111,6 +122,9 @@ public:
     virtual void collapsePanel() = 0;
     virtual void postBackOrScreenOn(bool down) = 0;
     virtual void postTextInput(QString &text) = 0;
+    // 不受单条消息长度限制的文本输入，进度通过 DeviceObserver::textStreamProgress 回调
+    virtual void postTextStream(const QString &text) = 0;
+    virtual void cancelTextStream() = 0;
     virtual void requestDeviceClipboard() = 0;
     virtual void setDeviceClipboard(bool pause = true) = 0;
     virtual void clipboardPaste() = 0;
@@ -126,6 +140,12 @@ public:
 
     virtual void updateScript(QString script) = 0;
     virtual bool isCurrentCustomKeymap() = 0;
+
+    // 控制流宏：录制 sendControl 处的序列化消息，回放时直接写入控制通道
+    virtual void startControlRecord() = 0;
+    virtual QByteArray stopControlRecord() = 0;
+    virtual void postControlData(const QByteArray &data) = 0;
+    virtual QSize getFrameSize() = 0;
 };
 
 class IDeviceManage : public QObject {
@@ -137,9 +157,19 @@ public:
     virtual void disconnectAllDevice() = 0;
     virtual QPointer<IDevice> getDevice(const QString& serial) = 0;
 
+    // 批量连接时 adb 阶段（connect/push/reverse/forward/execute）的全局和单主机并发上限
+    virtual void setConnectLimits(int globalLimit, int perHostLimit) = 0;
+    virtual QMap<QString, ConnectStageStats> getConnectStats() = 0;
+    // 远端 server 文件与本地一致时跳过推送，按主机统计命中/未命中
+    virtual QMap<QString, PushCacheStats> getPushCacheStats() = 0;
+    // 设备所属主机（ip:port 取 ip，USB 设备为 local），按主机限流的调用方共用同一分组规则
+    static QString hostOf(const QString& serial);
+
 signals:
     void deviceConnected(bool success, const QString& serial, const QString& deviceName, const QSize& size);
     void deviceDisconnected(QString serial);
+    // 断开后线程回收、录像写入等清理全部完成
+    void deviceReleased(QString serial);
 };
 
 }
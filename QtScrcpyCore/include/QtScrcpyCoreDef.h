@@ -39,6 +39,7 @@ struct DeviceParams {
     bool display = true;              // 是否显示画面（或者仅仅后台录制）
     bool renderExpiredFrames = false; // 是否渲染延迟视频帧
     QString gameScript = "";          // 游戏映射脚本
+    bool autoResume = true;           // 连接中途断开时自动恢复会话（保留解码器和界面）
 
     // TCP直接连接模式（不使用adb）
     bool useDirectTcp = false;        // 是否使用直接TCP连接模式
@@ -47,5 +48,18 @@ struct DeviceParams {
     quint16 tcpAudioPort = 9998;      // TCP音频流端口（可选）
     quint16 tcpControlPort = 9997;    // TCP控制流端口
 };
-    
+
+// 批量连接中每个阶段的耗时统计（wait 为排队等待名额的时间，accept 为 server 启动到连接成功）
+struct ConnectStageStats {
+    quint32 count = 0;
+    qint64 totalMs = 0;
+    qint64 maxMs = 0;
+};
+
+// scrcpy-server 推送缓存命中统计（按主机）
+struct PushCacheStats {
+    quint32 hits = 0;
+    quint32 misses = 0;
+};
+
 }
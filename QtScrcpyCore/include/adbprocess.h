@@ -24,6 +24,9 @@ public:
     virtual ~AdbProcess();
 
     static void setAdbPath(const QString& adbPath);
+    // 开启后 shell/push/forward/reverse/devices/connect 直接走 adb server 协议（tcp:5037），
+    // 不再创建 adb 进程；server 不可达或命令不支持时自动退回 adb 进程。默认开启
+    static void setUseAdbServer(bool enable);
 
     void connectDevice(const QString& serial);
     void execute(const QString &serial, const QStringList &args);
@@ -0,0 +1,96 @@
+#ifndef BULKPUSHER_H
+#define BULKPUSHER_H
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QObject>
+#include <QStringList>
+#include <QVector>
+
+class AdbClient;
+
+namespace qsc {
+
+class AdbProcess;
+
+// 把同一个文件推送到多台设备
+// 源文件只映射一次（QFile::map），所有设备的 sync 流共享同一块内存，
+// 按全局/每主机并发上限调度，单台设备失败时只重推该设备
+class BulkPusher : public QObject
+{
+    Q_OBJECT
+public:
+    struct DeviceResult
+    {
+        QString serial;
+        bool success = false;
+        int attempts = 0;
+        qint64 elapsedMs = 0;
+        QString error;
+    };
+
+    explicit BulkPusher(QObject *parent = nullptr);
+    virtual ~BulkPusher();
+
+    void setConcurrency(int maxStreams, int maxStreamsPerHost);
+    void setMaxAttempts(int maxAttempts);
+
+    // remotePath 是设备上的目录时推送为目录下的同名文件
+    bool start(const QString &localFile, const QString &remotePath, const QStringList &serials);
+    void cancel();
+    bool isRunning();
+    QVector<DeviceResult> results();
+
+signals:
+    // totalBytes = 文件大小 * 设备数，bytesPerSecond 为所有设备合计
+    void pushProgress(qint64 sentBytes, qint64 totalBytes, qint64 bytesPerSecond);
+    void deviceFinished(const QString &serial, bool success, const QString &error);
+    void pushFinished(int succeeded, int failed);
+
+private:
+    struct Target
+    {
+        QString serial;
+        QString host;
+        int attempts = 0;
+        qint64 sent = 0;
+        bool active = false;
+        bool waiting = false; // 失败后等待重试
+        bool done = false;
+        bool success = false;
+        QElapsedTimer clock;
+        QString error;
+        AdbClient *client = nullptr;
+        AdbProcess *process = nullptr;
+    };
+
+    void pump();
+    void startTarget(int index);
+    void startProcessPush(int index);
+    void onTargetResult(int index, bool success, const QString &error);
+    void releaseTarget(Target &target);
+    void reportProgress(bool force);
+    void finish();
+
+private:
+    QFile m_file;
+    const uchar *m_data = nullptr;
+    qint64 m_size = 0;
+    quint32 m_mtime = 0;
+    QString m_remote;
+    QVector<Target> m_targets;
+    QHash<QString, int> m_activePerHost;
+    int m_active = 0;
+    int m_maxStreams = 8;
+    int m_maxStreamsPerHost = 4;
+    int m_maxAttempts = 3;
+    bool m_running = false;
+    qint64 m_written = 0;
+    QElapsedTimer m_clock;
+    QElapsedTimer m_progressClock;
+};
+
+}
+
+#endif // BULKPUSHER_H
@@ -0,0 +1,82 @@
+#ifndef MACROREPLAYER_H
+#define MACROREPLAYER_H
+
+#include <QElapsedTimer>
+#include <QMap>
+#include <QObject>
+#include <QSize>
+#include <QStringList>
+#include <QTimer>
+#include <QVector>
+
+namespace qsc {
+
+// 把 IDevice::stopControlRecord 得到的时间线并行回放到多台设备
+// 所有事件按录制开始的绝对时间调度（不累计误差），每个事件在同一次调度中
+// 写入所有目标设备的控制通道，触摸/滚动坐标按各设备画面尺寸缩放
+class MacroReplayer : public QObject
+{
+    Q_OBJECT
+public:
+    struct ReplayStats
+    {
+        quint32 events = 0;          // 已回放的事件数
+        quint32 sends = 0;           // 写入设备的消息数（events * 设备数）
+        quint32 skippedDevices = 0;  // 回放时已断开的设备次数
+        quint32 rebases = 0;         // 延迟超过 maxDriftUs 后重新对齐时间轴的次数
+        qint64 meanLatenessUs = 0;   // 实际发送时间相对计划时间的平均延迟
+        qint64 maxLatenessUs = 0;    // 最大延迟
+        qint64 durationUs = 0;       // 实际回放耗时
+        qint64 plannedDurationUs = 0; // 录制时长
+    };
+
+    explicit MacroReplayer(QObject *parent = nullptr);
+    virtual ~MacroReplayer();
+
+    bool load(const QByteArray &timeline);
+    quint32 eventCount();
+
+    // 不设置时使用 IDevice::getFrameSize
+    void setTargetFrameSize(const QString &serial, const QSize &size);
+    // 延迟超过该值时整体后移剩余事件，保证事件间隔不被压缩
+    void setMaxDriftUs(qint64 maxDriftUs);
+
+    bool start(const QStringList &serials);
+    void stop();
+    bool isRunning();
+    ReplayStats stats();
+
+signals:
+    void replayProgress(quint32 done, quint32 total);
+    void replayFinished(bool complete);
+
+private:
+    void onTimer();
+    void dispatch(int index);
+    void scheduleNext();
+    void finish(bool complete);
+
+private:
+    struct Event
+    {
+        qint64 timeUs = 0;
+        QByteArray data;
+    };
+
+    QVector<Event> m_events;
+    QStringList m_serials;
+    QMap<QString, QSize> m_targetSizes;
+    QMap<QString, QSize> m_runSizes;
+    QTimer m_timer;
+    QElapsedTimer m_clock;
+    qint64 m_offsetUs = 0;
+    qint64 m_maxDriftUs = 20000;
+    qint64 m_totalLatenessUs = 0;
+    int m_next = 0;
+    bool m_running = false;
+    ReplayStats m_stats;
+};
+
+}
+
+#endif // MACROREPLAYER_H
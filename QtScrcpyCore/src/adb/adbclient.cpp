@@ -0,0 +1,646 @@
+#include <QDateTime>
+#include <QDebug>
+#include <QFileInfo>
+#include <QHostAddress>
+#include <QtEndian>
+
+#include "adbclient.h"
+
+#define ADB_SERVER_DEFAULT_PORT 5037
+#define ADB_STATUS_LENGTH 4
+#define ADB_LENGTH_PREFIX 4
+// sync 协议单个 DATA 包最大 64k
+#define SYNC_DATA_MAX (64 * 1024)
+// socket 待写数据超过该值时等待 bytesWritten 再继续读文件
+#define SYNC_WRITE_WINDOW (256 * 1024)
+// 0100644，普通文件
+#define SYNC_DEFAULT_MODE 33188
+// STAT 应答：4 字节 id + mode/size/mtime 各 4 字节小端
+#define SYNC_STAT_LENGTH 16
+#define SYNC_MODE_TYPE_MASK 0170000
+#define SYNC_MODE_DIRECTORY 0040000
+// shell v2 包头：1 字节类型 + 4 字节小端长度
+#define SHELL_PACKET_HEADER 5
+#define SHELL_ID_STDOUT 1
+#define SHELL_ID_STDERR 2
+#define SHELL_ID_EXIT 3
+// 不支持 shell v2 时追加在命令后，用来取回退出码
+#define SHELL_V1_EXIT_MARKER "__qsc_exit__:"
+
+AdbClient::AdbClient(QObject *parent) : QObject(parent)
+{
+    connect(&m_socket, &QTcpSocket::connected, this, &AdbClient::onConnected);
+    connect(&m_socket, &QTcpSocket::readyRead, this, &AdbClient::onReadyRead);
+    connect(&m_socket, &QTcpSocket::disconnected, this, &AdbClient::onDisconnected);
+    connect(&m_socket, &QTcpSocket::bytesWritten, this, &AdbClient::pumpSyncData);
+#if (QT_VERSION < QT_VERSION_CHECK(5, 15, 0))
+    connect(&m_socket, static_cast<void (QAbstractSocket::*)(QAbstractSocket::SocketError)>(&QAbstractSocket::error), this, &AdbClient::onError);
+#else
+    connect(&m_socket, &QAbstractSocket::errorOccurred, this, &AdbClient::onError);
+#endif
+}
+
+AdbClient::~AdbClient()
+{
+    m_running = false;
+    m_socket.abort();
+}
+
+bool AdbClient::supports(const QStringList &args)
+{
+    if (args.isEmpty()) {
+        return false;
+    }
+    const QString &cmd = args[0];
+    if ("devices" == cmd) {
+        return 1 == args.size();
+    }
+    if ("connect" == cmd) {
+        return 2 == args.size();
+    }
+    if ("forward" == cmd || "reverse" == cmd) {
+        return 3 == args.size() && (("--remove" == args[1]) || !args[1].startsWith("-"));
+    }
+    if ("shell" == cmd) {
+        return 2 <= args.size() && !args[1].startsWith("-");
+    }
+    if ("push" == cmd) {
+        return 3 == args.size() && !args[1].startsWith("-") && QFileInfo(args[1]).isFile();
+    }
+    return false;
+}
+
+quint16 AdbClient::serverPort()
+{
+    bool ok = false;
+    int port = qgetenv("ANDROID_ADB_SERVER_PORT").toInt(&ok);
+    if (ok && 0 < port && port <= 0xFFFF) {
+        return static_cast<quint16>(port);
+    }
+    return ADB_SERVER_DEFAULT_PORT;
+}
+
+bool AdbClient::execute(const QString &serial, const QStringList &args)
+{
+    if (m_running) {
+        kill();
+    }
+    if (!prepare(serial, args)) {
+        return false;
+    }
+    qDebug() << "adb client:" << serial << args.join(" ");
+    startRequest();
+    return true;
+}
+
+bool AdbClient::pushData(const QString &serial, const uchar *data, qint64 size, const QString &remote, const QString &fileName, quint32 mtime)
+{
+    if (m_running) {
+        kill();
+    }
+    if ((!data && 0 < size) || remote.isEmpty()) {
+        return false;
+    }
+
+    m_serial = serial;
+    m_kind = ACK_PUSH;
+    m_step = ACS_NULL;
+    m_hostRequest = serial.isEmpty() ? QByteArray("host:transport-any") : QString("host:transport:%1").arg(serial).toUtf8();
+    m_serviceRequest = "sync:";
+    m_pushRemote = remote;
+    m_pushName = fileName;
+    if (m_pushRemote.endsWith("/") && !m_pushName.isEmpty()) {
+        m_pushRemote += m_pushName;
+    }
+    m_pushMemory = true;
+    m_pushData = data;
+    m_pushSize = size;
+    m_pushMtime = mtime;
+    m_pushDone = false;
+    qDebug() << "adb client: push" << size << "bytes to" << serial << remote;
+    startRequest();
+    return true;
+}
+
+void AdbClient::startRequest()
+{
+    m_standardOutput = "";
+    m_errorOutput = "";
+    m_buffer.clear();
+    m_started = false;
+    m_running = true;
+    m_socket.abort();
+    m_socket.connectToHost(QHostAddress::LocalHost, serverPort());
+}
+
+void AdbClient::readShellPackets()
+{
+    while (m_running && m_buffer.size() >= SHELL_PACKET_HEADER) {
+        const char id = m_buffer.at(0);
+        quint32 len = qFromLittleEndian<quint32>(reinterpret_cast<const uchar *>(m_buffer.constData() + 1));
+        if (static_cast<quint32>(m_buffer.size()) < SHELL_PACKET_HEADER + len) {
+            return;
+        }
+        QByteArray payload = m_buffer.mid(SHELL_PACKET_HEADER, static_cast<int>(len));
+        m_buffer.remove(0, SHELL_PACKET_HEADER + static_cast<int>(len));
+        switch (id) {
+        case SHELL_ID_STDOUT:
+            appendStdOut(payload);
+            break;
+        case SHELL_ID_STDERR: {
+            QString err = QString::fromUtf8(payload).trimmed();
+            m_errorOutput += err;
+            emit standardError(err);
+            break;
+        }
+        case SHELL_ID_EXIT: {
+            int exitCode = payload.isEmpty() ? -1 : static_cast<uchar>(payload.at(0));
+            finish(0 == exitCode, 0 == exitCode ? QString() : QString("exit code %1").arg(exitCode));
+            return;
+        }
+        default:
+            break;
+        }
+    }
+}
+
+void AdbClient::finishShellV1()
+{
+    // 最后一行是追加的退出码标记，去掉后再交给调用方
+    int pos = m_shellV1Output.lastIndexOf(SHELL_V1_EXIT_MARKER);
+    if (pos < 0) {
+        if (!m_shellV1Output.isEmpty()) {
+            appendStdOut(m_shellV1Output);
+        }
+        finish(false, "shell closed without exit status");
+        return;
+    }
+    bool ok = false;
+    int exitCode = m_shellV1Output.mid(pos + static_cast<int>(sizeof(SHELL_V1_EXIT_MARKER) - 1)).trimmed().toInt(&ok);
+    if (0 < pos) {
+        appendStdOut(m_shellV1Output.left(pos));
+    }
+    if (!ok) {
+        exitCode = -1;
+    }
+    finish(0 == exitCode, 0 == exitCode ? QString() : QString("exit code %1").arg(exitCode));
+}
+
+bool AdbClient::isRuning()
+{
+    return m_running;
+}
+
+void AdbClient::kill()
+{
+    if (!m_running) {
+        return;
+    }
+    m_running = false;
+    m_step = ACS_DONE;
+    m_pushFile.close();
+    m_socket.abort();
+}
+
+QString AdbClient::getStdOut()
+{
+    return m_standardOutput;
+}
+
+QString AdbClient::getErrorOut()
+{
+    return m_errorOutput;
+}
+
+bool AdbClient::prepare(const QString &serial, const QStringList &args)
+{
+    if (!supports(args)) {
+        return false;
+    }
+
+    m_serial = serial;
+    m_hostRequest.clear();
+    m_serviceRequest.clear();
+    m_pushRemote.clear();
+    m_pushName.clear();
+    m_pushMemory = false;
+    m_pushData = nullptr;
+    m_pushSize = 0;
+    m_pushDone = false;
+    m_step = ACS_NULL;
+
+    const QString &cmd = args[0];
+    if ("devices" == cmd) {
+        m_kind = ACK_HOST_QUERY;
+        m_hostRequest = "host:devices";
+    } else if ("connect" == cmd) {
+        m_kind = ACK_HOST_QUERY;
+        m_hostRequest = QString("host:connect:%1").arg(args[1]).toUtf8();
+    } else if ("forward" == cmd) {
+        m_kind = ACK_HOST_COMMAND;
+        QString prefix = serial.isEmpty() ? QString("host:") : QString("host-serial:%1:").arg(serial);
+        if ("--remove" == args[1]) {
+            m_hostRequest = QString("%1killforward:%2").arg(prefix, args[2]).toUtf8();
+        } else {
+            m_hostRequest = QString("%1forward:%2;%3").arg(prefix, args[1], args[2]).toUtf8();
+        }
+    } else if ("reverse" == cmd) {
+        m_kind = ACK_LOCAL_COMMAND;
+        if ("--remove" == args[1]) {
+            m_serviceRequest = QString("reverse:killforward:%1").arg(args[2]).toUtf8();
+        } else {
+            m_serviceRequest = QString("reverse:forward:%1;%2").arg(args[1], args[2]).toUtf8();
+        }
+    } else if ("shell" == cmd) {
+        m_kind = ACK_SHELL;
+        m_shellCommand = args.mid(1).join(" ");
+        m_shellV2 = true;
+        m_shellV1Output.clear();
+        m_serviceRequest = QString("shell,v2,raw:%1").arg(m_shellCommand).toUtf8();
+    } else if ("push" == cmd) {
+        m_kind = ACK_PUSH;
+        m_serviceRequest = "sync:";
+        m_pushFile.setFileName(args[1]);
+        m_pushRemote = args[2];
+        m_pushName = QFileInfo(args[1]).fileName();
+        if (m_pushRemote.endsWith("/")) {
+            m_pushRemote += m_pushName;
+        }
+    } else {
+        return false;
+    }
+
+    if (m_hostRequest.isEmpty()) {
+        m_hostRequest = serial.isEmpty() ? QByteArray("host:transport-any") : QString("host:transport:%1").arg(serial).toUtf8();
+    }
+    return true;
+}
+
+void AdbClient::onConnected()
+{
+    if (!m_running) {
+        return;
+    }
+    // 退回 shell v1 重连时不再重复通知启动
+    if (!m_started) {
+        m_started = true;
+        emit adbClientResult(qsc::AdbProcess::AER_SUCCESS_START);
+        if (!m_running) {
+            return;
+        }
+    }
+
+    m_step = (ACK_HOST_QUERY == m_kind || ACK_HOST_COMMAND == m_kind) ? ACS_SERVICE : ACS_TRANSPORT;
+    sendRequest(m_hostRequest);
+}
+
+void AdbClient::onReadyRead()
+{
+    m_buffer.append(m_socket.readAll());
+
+    while (m_running) {
+        bool okay = false;
+        QString failMessage;
+        switch (m_step) {
+        case ACS_TRANSPORT:
+            if (!readStatus(okay, failMessage)) {
+                return;
+            }
+            if (!okay) {
+                finish(false, failMessage);
+                return;
+            }
+            m_step = ACS_SERVICE;
+            sendRequest(m_serviceRequest);
+            break;
+        case ACS_SERVICE:
+            if (!readStatus(okay, failMessage)) {
+                return;
+            }
+            if (!okay && ACK_SHELL == m_kind && m_shellV2) {
+                // Android 7 以下不支持 shell v2，改用 shell: 并在输出末尾带回退出码
+                qInfo() << "adb client: shell v2 unsupported on" << m_serial << failMessage;
+                m_shellV2 = false;
+                m_serviceRequest = QString("shell:%1; echo %2$?").arg(m_shellCommand, SHELL_V1_EXIT_MARKER).toUtf8();
+                m_step = ACS_NULL;
+                m_buffer.clear();
+                // abort 会同步发出 disconnected，期间不能当作命令结束
+                m_running = false;
+                m_socket.abort();
+                m_running = true;
+                m_socket.connectToHost(QHostAddress::LocalHost, serverPort());
+                return;
+            }
+            if (!okay) {
+                finish(false, failMessage);
+                return;
+            }
+            if (ACK_SHELL == m_kind) {
+                m_step = ACS_STREAM;
+            } else if (ACK_PUSH == m_kind) {
+                // SEND 只认完整文件路径，先 STAT 确认目标是不是目录
+                m_step = ACS_STAT;
+                startSyncStat();
+            } else {
+                // host 命令第一个 OKAY 表示已连接到目标，第二个才是执行结果
+                m_step = ACS_REPLY;
+            }
+            break;
+        case ACS_REPLY:
+            if (ACK_HOST_QUERY == m_kind) {
+                QByteArray payload;
+                if (!readLengthPrefixed(payload)) {
+                    return;
+                }
+                appendStdOut(payload);
+                if (m_hostRequest.startsWith("host:connect:")) {
+                    QString reply = QString::fromUtf8(payload).trimmed();
+                    bool connected = !reply.startsWith("failed") && !reply.startsWith("cannot") && !reply.startsWith("unable");
+                    finish(connected, connected ? QString() : reply);
+                } else {
+                    finish(true);
+                }
+                return;
+            }
+            if (!readStatus(okay, failMessage)) {
+                return;
+            }
+            finish(okay, failMessage);
+            return;
+        case ACS_STREAM:
+            if (m_shellV2) {
+                readShellPackets();
+            } else if (!m_buffer.isEmpty()) {
+                // 完整的行立即输出，退出码标记所在行留到连接关闭时解析
+                m_shellV1Output.append(m_buffer);
+                m_buffer.clear();
+                int end = m_shellV1Output.lastIndexOf('\n') + 1;
+                int marker = m_shellV1Output.indexOf(SHELL_V1_EXIT_MARKER);
+                if (0 <= marker && marker < end) {
+                    end = marker;
+                }
+                if (0 < end) {
+                    appendStdOut(m_shellV1Output.left(end));
+                    m_shellV1Output.remove(0, end);
+                }
+            }
+            return;
+        case ACS_STAT:
+            if (!readSyncStat()) {
+                return;
+            }
+            m_step = ACS_SYNC;
+            if (!startSyncSend()) {
+                return;
+            }
+            break;
+        case ACS_SYNC: {
+            if (m_buffer.size() < 8) {
+                return;
+            }
+            QByteArray id = m_buffer.left(4);
+            quint32 len = qFromLittleEndian<quint32>(reinterpret_cast<const uchar *>(m_buffer.constData() + 4));
+            if ("OKAY" == id) {
+                m_buffer.remove(0, 8);
+                writeSyncRequest("QUIT", 0);
+                m_socket.flush();
+                finish(true);
+                return;
+            }
+            if ("FAIL" == id) {
+                if (static_cast<quint32>(m_buffer.size()) < 8 + len) {
+                    return;
+                }
+                QString message = QString::fromUtf8(m_buffer.mid(8, static_cast<int>(len)));
+                m_buffer.clear();
+                finish(false, message);
+                return;
+            }
+            finish(false, QString("unexpected sync response: %1").arg(QString::fromLatin1(id)));
+            return;
+        }
+        default:
+            return;
+        }
+    }
+}
+
+void AdbClient::onDisconnected()
+{
+    if (!m_running) {
+        return;
+    }
+    if (ACS_STREAM == m_step) {
+        if (m_shellV2) {
+            readShellPackets();
+            // 没收到 exit 包就断开，按失败处理
+            finish(false, "shell closed without exit status");
+            return;
+        }
+        m_shellV1Output.append(m_buffer);
+        m_buffer.clear();
+        finishShellV1();
+        return;
+    }
+    // 部分 adb 版本只回一个 OKAY 就关闭连接
+    if (ACS_REPLY == m_step && ACK_HOST_QUERY != m_kind && m_buffer.isEmpty()) {
+        finish(true);
+        return;
+    }
+    finish(false, "adb server closed connection");
+}
+
+void AdbClient::onError(QAbstractSocket::SocketError error)
+{
+    if (!m_running) {
+        return;
+    }
+    if (!m_started) {
+        // adb server 没有运行，交给 adb 进程处理（会自动启动 server）
+        qInfo() << "adb server not reachable on port" << serverPort() << m_socket.errorString();
+        m_running = false;
+        m_step = ACS_DONE;
+        emit serverUnavailable();
+        return;
+    }
+    if (QAbstractSocket::RemoteHostClosedError == error) {
+        // 由 onDisconnected 处理
+        return;
+    }
+    finish(false, m_socket.errorString());
+}
+
+void AdbClient::sendRequest(const QByteArray &request)
+{
+    QByteArray out = QString("%1").arg(request.size(), ADB_LENGTH_PREFIX, 16, QChar('0')).toLatin1();
+    out.append(request);
+    m_socket.write(out);
+}
+
+bool AdbClient::readStatus(bool &okay, QString &failMessage)
+{
+    if (m_buffer.size() < ADB_STATUS_LENGTH) {
+        return false;
+    }
+    QByteArray status = m_buffer.left(ADB_STATUS_LENGTH);
+    if ("OKAY" == status) {
+        m_buffer.remove(0, ADB_STATUS_LENGTH);
+        okay = true;
+        return true;
+    }
+    if ("FAIL" == status) {
+        if (m_buffer.size() < ADB_STATUS_LENGTH + ADB_LENGTH_PREFIX) {
+            return false;
+        }
+        int len = m_buffer.mid(ADB_STATUS_LENGTH, ADB_LENGTH_PREFIX).toInt(nullptr, 16);
+        if (m_buffer.size() < ADB_STATUS_LENGTH + ADB_LENGTH_PREFIX + len) {
+            return false;
+        }
+        failMessage = QString::fromUtf8(m_buffer.mid(ADB_STATUS_LENGTH + ADB_LENGTH_PREFIX, len));
+        m_buffer.remove(0, ADB_STATUS_LENGTH + ADB_LENGTH_PREFIX + len);
+        okay = false;
+        return true;
+    }
+    failMessage = QString("unexpected adb response: %1").arg(QString::fromLatin1(status));
+    m_buffer.clear();
+    okay = false;
+    return true;
+}
+
+bool AdbClient::readLengthPrefixed(QByteArray &payload)
+{
+    if (m_buffer.size() < ADB_LENGTH_PREFIX) {
+        return false;
+    }
+    int len = m_buffer.left(ADB_LENGTH_PREFIX).toInt(nullptr, 16);
+    if (m_buffer.size() < ADB_LENGTH_PREFIX + len) {
+        return false;
+    }
+    payload = m_buffer.mid(ADB_LENGTH_PREFIX, len);
+    m_buffer.remove(0, ADB_LENGTH_PREFIX + len);
+    return true;
+}
+
+void AdbClient::startSyncStat()
+{
+    QByteArray path = m_pushRemote.toUtf8();
+    writeSyncRequest("STAT", static_cast<quint32>(path.size()), path);
+}
+
+bool AdbClient::readSyncStat()
+{
+    if (m_buffer.size() < SYNC_STAT_LENGTH) {
+        return false;
+    }
+    QByteArray id = m_buffer.left(4);
+    if ("STAT" != id) {
+        finish(false, QString("unexpected sync response: %1").arg(QString::fromLatin1(id)));
+        return false;
+    }
+    // 目标不存在时 mode 为 0，按文件路径推送
+    quint32 mode = qFromLittleEndian<quint32>(reinterpret_cast<const uchar *>(m_buffer.constData() + 4));
+    m_buffer.remove(0, SYNC_STAT_LENGTH);
+    if (SYNC_MODE_DIRECTORY == (mode & SYNC_MODE_TYPE_MASK)) {
+        if (m_pushName.isEmpty()) {
+            finish(false, QString("%1 is a directory").arg(m_pushRemote));
+            return false;
+        }
+        m_pushRemote = QString("%1/%2").arg(m_pushRemote, m_pushName);
+    }
+    return true;
+}
+
+bool AdbClient::startSyncSend()
+{
+    m_pushOffset = 0;
+    if (!m_pushMemory && !m_pushFile.open(QIODevice::ReadOnly)) {
+        finish(false, QString("cannot open %1: %2").arg(m_pushFile.fileName(), m_pushFile.errorString()));
+        return false;
+    }
+    QByteArray spec = QString("%1,%2").arg(m_pushRemote).arg(SYNC_DEFAULT_MODE).toUtf8();
+    writeSyncRequest("SEND", static_cast<quint32>(spec.size()), spec);
+    m_pushDone = false;
+    pumpSyncData();
+    return m_running;
+}
+
+void AdbClient::pumpSyncData()
+{
+    if (!m_running || ACS_SYNC != m_step || m_pushDone) {
+        return;
+    }
+    if (m_pushMemory) {
+        pumpSyncMemory();
+        return;
+    }
+    if (!m_pushFile.isOpen()) {
+        return;
+    }
+    while (m_socket.bytesToWrite() < SYNC_WRITE_WINDOW) {
+        QByteArray chunk = m_pushFile.read(SYNC_DATA_MAX);
+        if (chunk.isEmpty()) {
+            if (!m_pushFile.atEnd()) {
+                finish(false, QString("read %1 failed: %2").arg(m_pushFile.fileName(), m_pushFile.errorString()));
+                return;
+            }
+            quint32 mtime = static_cast<quint32>(QFileInfo(m_pushFile).lastModified().toMSecsSinceEpoch() / 1000);
+            writeSyncRequest("DONE", mtime);
+            m_pushDone = true;
+            m_pushFile.close();
+            return;
+        }
+        writeSyncRequest("DATA", static_cast<quint32>(chunk.size()), chunk);
+    }
+}
+
+void AdbClient::pumpSyncMemory()
+{
+    while (m_socket.bytesToWrite() < SYNC_WRITE_WINDOW) {
+        if (m_pushOffset >= m_pushSize) {
+            writeSyncRequest("DONE", m_pushMtime);
+            m_pushDone = true;
+            return;
+        }
+        int len = static_cast<int>(qMin<qint64>(SYNC_DATA_MAX, m_pushSize - m_pushOffset));
+        // fromRawData 不拷贝，写入 socket 时才复制到发送缓冲
+        writeSyncRequest("DATA", static_cast<quint32>(len),
+                         QByteArray::fromRawData(reinterpret_cast<const char *>(m_pushData + m_pushOffset), len));
+        m_pushOffset += len;
+        emit pushProgress(m_pushOffset, m_pushSize);
+    }
+}
+
+void AdbClient::writeSyncRequest(const char *id, quint32 arg, const QByteArray &payload)
+{
+    QByteArray out(id, 4);
+    uchar le[4];
+    qToLittleEndian<quint32>(arg, le);
+    out.append(reinterpret_cast<const char *>(le), 4);
+    out.append(payload);
+    m_socket.write(out);
+}
+
+void AdbClient::appendStdOut(const QByteArray &data)
+{
+    QString tmp = QString::fromUtf8(data).trimmed();
+    m_standardOutput += tmp;
+    emit standardOutput(tmp);
+}
+
+void AdbClient::finish(bool success, const QString &errorMessage)
+{
+    if (!m_running) {
+        return;
+    }
+    m_running = false;
+    m_step = ACS_DONE;
+    m_pushFile.close();
+    if (!errorMessage.isEmpty()) {
+        m_errorOutput += errorMessage;
+        emit standardError(errorMessage);
+    }
+    m_socket.abort();
+    qDebug() << "adb client return" << (success ? "success" : "failed");
+    // 接收方可能在信号中立即发起下一条命令，之后不能再访问状态
+    emit adbClientResult(success ? qsc::AdbProcess::AER_SUCCESS_EXEC : qsc::AdbProcess::AER_ERROR_EXEC);
+}
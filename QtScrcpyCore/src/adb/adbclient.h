@@ -0,0 +1,117 @@
+#pragma once
+
+#include <QFile>
+#include <QTcpSocket>
+#include "adbprocess.h"
+
+// adb host 协议客户端，直接连接本机 adb server（默认 tcp:5037）
+// 避免每次操作都创建 adb 进程，支持的命令：
+//   devices / connect          -> host:devices, host:connect:
+//   forward [--remove]         -> host-serial:<serial>:forward / killforward
+//   reverse [--remove]         -> host:transport + reverse:forward / reverse:killforward
+//   shell ...                  -> host:transport + shell,v2,raw:（不支持 v2 的设备退回 shell: 并追加退出码标记）
+//   push local remote          -> host:transport + sync: (STAT/SEND/DATA/DONE)，remote 是目录时推送到目录下同名文件
+// 结果信号与 AdbProcessImpl 一致：连接成功发 AER_SUCCESS_START，结束发 AER_SUCCESS_EXEC/AER_ERROR_EXEC
+// adb server 不可达时发 serverUnavailable，由调用方退回到 adb 进程（adb 进程会拉起 server）
+class AdbClient : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit AdbClient(QObject *parent = nullptr);
+    virtual ~AdbClient();
+
+    static bool supports(const QStringList &args);
+    // 可通过 ANDROID_ADB_SERVER_PORT 指向本地替身 server
+    static quint16 serverPort();
+
+    bool execute(const QString &serial, const QStringList &args);
+    // 从内存推送（例如多台设备共享同一块 QFile::map 映射），data 在结束前必须保持有效
+    // remote 是目录时推送为 remote/fileName
+    bool pushData(const QString &serial, const uchar *data, qint64 size, const QString &remote, const QString &fileName, quint32 mtime);
+    bool isRuning();
+    void kill();
+    QString getStdOut();
+    QString getErrorOut();
+
+signals:
+    void adbClientResult(qsc::AdbProcess::ADB_EXEC_RESULT processResult);
+    void standardOutput(const QString &out);
+    void standardError(const QString &err);
+    void serverUnavailable();
+    // 已写入 socket 的推送字节数
+    void pushProgress(qint64 sentBytes, qint64 totalBytes);
+
+private:
+    enum CommandKind
+    {
+        ACK_NULL,
+        ACK_HOST_QUERY,   // 应答 OKAY + 长度 + 内容
+        ACK_HOST_COMMAND, // 应答一到两个状态
+        ACK_LOCAL_COMMAND,
+        ACK_SHELL,
+        ACK_PUSH,
+    };
+
+    enum CommandStep
+    {
+        ACS_NULL,
+        ACS_TRANSPORT,
+        ACS_SERVICE,
+        ACS_REPLY,
+        ACS_STREAM,
+        ACS_STAT, // 等待目标路径的 STAT 应答
+        ACS_SYNC,
+        ACS_DONE,
+    };
+
+    bool prepare(const QString &serial, const QStringList &args);
+    void startRequest();
+    void onConnected();
+    void onReadyRead();
+    void onDisconnected();
+    void onError(QAbstractSocket::SocketError error);
+
+    void sendRequest(const QByteArray &request);
+    // 读取 OKAY / FAIL，数据不足时返回 false
+    bool readStatus(bool &okay, QString &failMessage);
+    bool readLengthPrefixed(QByteArray &payload);
+    // shell v2 按包解析 stdout/stderr/exit，收到 exit 包后结束
+    void readShellPackets();
+    void finishShellV1();
+
+    void startSyncStat();
+    bool readSyncStat();
+    bool startSyncSend();
+    void pumpSyncData();
+    void pumpSyncMemory();
+    void writeSyncRequest(const char *id, quint32 arg, const QByteArray &payload = QByteArray());
+
+    void appendStdOut(const QByteArray &data);
+    void finish(bool success, const QString &errorMessage = QString());
+
+private:
+    QTcpSocket m_socket;
+    QByteArray m_buffer;
+    CommandKind m_kind = ACK_NULL;
+    CommandStep m_step = ACS_NULL;
+    QString m_serial;
+    QByteArray m_hostRequest;
+    QByteArray m_serviceRequest;
+    QString m_shellCommand;
+    bool m_shellV2 = false;
+    QByteArray m_shellV1Output;
+    QFile m_pushFile;
+    QString m_pushRemote;
+    QString m_pushName;
+    bool m_pushMemory = false;
+    const uchar *m_pushData = nullptr;
+    qint64 m_pushSize = 0;
+    qint64 m_pushOffset = 0;
+    quint32 m_pushMtime = 0;
+    bool m_pushDone = false;
+    bool m_started = false;
+    bool m_running = false;
+    QString m_standardOutput = "";
+    QString m_errorOutput = "";
+};
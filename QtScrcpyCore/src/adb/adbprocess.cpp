@@ -21,7 +21,7 @@ AdbProcess::AdbProcess(QObject *parent)
 AdbProcess::~AdbProcess()
 {
     if (m_adbImpl->isRuning()) {
-        m_adbImpl->kill();
+        m_adbImpl->stop();
     }
     delete m_adbImpl;
 }
@@ -31,6 +31,11 @@ void AdbProcess::setAdbPath(const QString &adbPath)
     g_adbPath = adbPath;
 }
 
+void AdbProcess::setUseAdbServer(bool enable)
+{
+    AdbProcessImpl::setUseAdbServer(enable);
+}
+
 void AdbProcess::connectDevice(const QString &serial)
 {
     m_adbImpl->connectDevice(serial);
@@ -53,12 +58,12 @@ void AdbProcess::setShowTouchesEnabled(const QString &serial, bool enabled)
 
 void AdbProcess::kill()
 {
-    m_adbImpl->kill();
+    m_adbImpl->stop();
 }
 
 QStringList AdbProcess::arguments()
 {
-    return m_adbImpl->arguments();
+    return m_adbImpl->adbArguments();
 }
 
 QStringList AdbProcess::getDevicesSerialFromStdOut()
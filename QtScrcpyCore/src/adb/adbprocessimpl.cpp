@@ -9,9 +9,12 @@
 #include <QRegularExpression>
 #endif
 
+#include "adbclient.h"
 #include "adbprocessimpl.h"
 
 QString AdbProcessImpl::s_adbPath = "";
+// -1 未初始化，读取环境变量 QTSCRCPY_ADB_SERVER
+int AdbProcessImpl::s_useAdbServer = -1;
 extern QString g_adbPath;
 
 AdbProcessImpl::AdbProcessImpl(QObject *parent) : QProcess(parent)
@@ -22,6 +25,7 @@ AdbProcessImpl::AdbProcessImpl(QObject *parent) : QProcess(parent)
 AdbProcessImpl::~AdbProcessImpl()
 {
     if (isRuning()) {
+        stop();
         close();
     }
 }
@@ -31,8 +35,7 @@ void AdbProcessImpl::connectDevice(const QString &serial)
     QStringList adbArgs;
     adbArgs << "connect";
     adbArgs << serial;
-    qDebug() << getAdbPath() << adbArgs.join(" ");
-    start(getAdbPath(), adbArgs);
+    execute("", adbArgs);
 }
 
 const QString &AdbProcessImpl::getAdbPath()
@@ -64,6 +67,20 @@ const QString &AdbProcessImpl::getAdbPath()
     return s_adbPath;
 }
 
+void AdbProcessImpl::setUseAdbServer(bool enable)
+{
+    s_useAdbServer = enable ? 1 : 0;
+}
+
+bool AdbProcessImpl::useAdbServer()
+{
+    if (s_useAdbServer < 0) {
+        // 默认开启，QTSCRCPY_ADB_SERVER=0 时全部走 adb 进程
+        s_useAdbServer = ("0" == qgetenv("QTSCRCPY_ADB_SERVER")) ? 0 : 1;
+    }
+    return 1 == s_useAdbServer;
+}
+
 void AdbProcessImpl::initSignals()
 {
     // aboutToQuit not exit event loop, so deletelater is ok
@@ -113,12 +130,51 @@ void AdbProcessImpl::execute(const QString &serial, const QStringList &args)
         adbArgs << "-s" << serial;
     }
     adbArgs << args;
+
+    // 协议客户端能处理的命令不再创建 adb 进程
+    if (useAdbServer() && AdbClient::supports(args)) {
+        if (!m_adbClient) {
+            m_adbClient = new AdbClient(this);
+            connect(m_adbClient, &AdbClient::adbClientResult, this, &AdbProcessImpl::adbProcessImplResult);
+            connect(m_adbClient, &AdbClient::standardOutput, this, [this](const QString &out) {
+                m_standardOutput += out;
+                qInfo() << QString("AdbProcessImpl::out:%1").arg(out).toStdString().data();
+            });
+            connect(m_adbClient, &AdbClient::standardError, this, [this](const QString &err) {
+                m_errorOutput += err;
+                qWarning() << QString("AdbProcessImpl::error:%1").arg(err).toStdString().data();
+            });
+            connect(m_adbClient, &AdbClient::serverUnavailable, this, [this]() {
+                QStringList fallbackArgs;
+                if (!m_clientSerial.isEmpty()) {
+                    fallbackArgs << "-s" << m_clientSerial;
+                }
+                fallbackArgs << m_clientArgs;
+                m_clientArgs.clear();
+                startProcess(fallbackArgs);
+            });
+        }
+        m_clientSerial = serial;
+        m_clientArgs = args;
+        if (m_adbClient->execute(serial, args)) {
+            return;
+        }
+        m_clientArgs.clear();
+    }
+    startProcess(adbArgs);
+}
+
+void AdbProcessImpl::startProcess(const QStringList &adbArgs)
+{
     qDebug() << getAdbPath() << adbArgs.join(" ");
     start(getAdbPath(), adbArgs);
 }
 
 bool AdbProcessImpl::isRuning()
 {
+    if (m_adbClient && m_adbClient->isRuning()) {
+        return true;
+    }
     if (QProcess::NotRunning == state()) {
         return false;
     } else {
@@ -126,6 +182,29 @@ bool AdbProcessImpl::isRuning()
     }
 }
 
+void AdbProcessImpl::stop()
+{
+    if (m_adbClient) {
+        m_adbClient->kill();
+    }
+    m_clientArgs.clear();
+    if (QProcess::NotRunning != state()) {
+        kill();
+    }
+}
+
+QStringList AdbProcessImpl::adbArguments()
+{
+    if (!m_clientArgs.isEmpty()) {
+        QStringList adbArgs;
+        if (!m_clientSerial.isEmpty()) {
+            adbArgs << "-s" << m_clientSerial;
+        }
+        return adbArgs << m_clientArgs;
+    }
+    return arguments();
+}
+
 void AdbProcessImpl::setShowTouchesEnabled(const QString &serial, bool enabled)
 {
     QStringList adbArgs;
@@ -3,6 +3,7 @@
 #include <QProcess>
 #include "adbprocess.h"
 
+class AdbClient;
 class AdbProcessImpl : public QProcess
 {
     Q_OBJECT
@@ -21,6 +22,9 @@ public:
     void install(const QString &serial, const QString &local);
     void removePath(const QString &serial, const QString &path);
     bool isRuning();
+    // 同时停止 adb 进程和协议客户端
+    void stop();
+    QStringList adbArguments();
     void setShowTouchesEnabled(const QString &serial, bool enabled);
     QStringList getDevicesSerialFromStdOut();
     QString getDeviceIPFromStdOut();
@@ -29,15 +33,22 @@ public:
     QString getErrorOut();
 
     static const QString &getAdbPath();
+    static void setUseAdbServer(bool enable);
+    static bool useAdbServer();
 
 signals:
     void adbProcessImplResult(qsc::AdbProcess::ADB_EXEC_RESULT processResult);
 
 private:
     void initSignals();
+    void startProcess(const QStringList &adbArgs);
 
 private:
     QString m_standardOutput = "";
     QString m_errorOutput = "";
+    AdbClient *m_adbClient = nullptr;
+    QString m_clientSerial;
+    QStringList m_clientArgs;
     static QString s_adbPath;
+    static int s_useAdbServer;
 };
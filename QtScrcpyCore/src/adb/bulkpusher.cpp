@@ -0,0 +1,304 @@
+#include <QDateTime>
+#include <QDebug>
+#include <QFileInfo>
+#include <QTimer>
+
+#include "adbclient.h"
+#include "adbprocess.h"
+#include "adbprocessimpl.h"
+#include "bulkpusher.h"
+#include "connectscheduler.h"
+
+// 进度信号最小间隔
+#define BULK_PUSH_PROGRESS_INTERVAL_MS 200
+
+namespace qsc {
+
+BulkPusher::BulkPusher(QObject *parent) : QObject(parent) {}
+
+BulkPusher::~BulkPusher()
+{
+    cancel();
+}
+
+void BulkPusher::setConcurrency(int maxStreams, int maxStreamsPerHost)
+{
+    m_maxStreams = qMax(1, maxStreams);
+    m_maxStreamsPerHost = qMax(1, maxStreamsPerHost);
+}
+
+void BulkPusher::setMaxAttempts(int maxAttempts)
+{
+    m_maxAttempts = qMax(1, maxAttempts);
+}
+
+bool BulkPusher::start(const QString &localFile, const QString &remotePath, const QStringList &serials)
+{
+    if (m_running || serials.isEmpty() || remotePath.isEmpty()) {
+        return false;
+    }
+    QFileInfo info(localFile);
+    if (!info.isFile()) {
+        qWarning() << "bulk push: file not found" << localFile;
+        return false;
+    }
+
+    m_file.setFileName(localFile);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        qWarning() << "bulk push: cannot open" << localFile << m_file.errorString();
+        return false;
+    }
+    m_size = m_file.size();
+    m_mtime = static_cast<quint32>(info.lastModified().toMSecsSinceEpoch() / 1000);
+    // 映射失败（例如 32 位进程中的超大文件）时退回每台设备各自的 adb push
+    m_data = 0 < m_size ? m_file.map(0, m_size) : nullptr;
+    if (0 < m_size && !m_data) {
+        qWarning() << "bulk push: map failed, fall back to adb push per device" << m_file.errorString();
+    }
+    if (!AdbProcessImpl::useAdbServer()) {
+        m_file.unmap(const_cast<uchar *>(m_data));
+        m_data = nullptr;
+    }
+
+    m_remote = remotePath;
+
+    m_targets.clear();
+    m_targets.reserve(serials.size());
+    for (const auto &serial : serials) {
+        Target target;
+        target.serial = serial;
+        target.host = ConnectScheduler::hostOf(serial);
+        m_targets.append(target);
+    }
+    m_activePerHost.clear();
+    m_active = 0;
+    m_written = 0;
+    m_running = true;
+    m_clock.start();
+    m_progressClock.start();
+    qInfo("bulk push %s (%lld bytes) to %d devices", m_remote.toUtf8().data(), m_size, m_targets.size());
+    pump();
+    return true;
+}
+
+void BulkPusher::cancel()
+{
+    if (!m_running) {
+        return;
+    }
+    m_running = false;
+    for (auto &target : m_targets) {
+        if (target.active) {
+            target.error = "canceled";
+        }
+        releaseTarget(target);
+    }
+    if (m_data) {
+        m_file.unmap(const_cast<uchar *>(m_data));
+        m_data = nullptr;
+    }
+    m_file.close();
+}
+
+bool BulkPusher::isRunning()
+{
+    return m_running;
+}
+
+QVector<BulkPusher::DeviceResult> BulkPusher::results()
+{
+    QVector<DeviceResult> out;
+    out.reserve(m_targets.size());
+    for (const auto &target : m_targets) {
+        DeviceResult result;
+        result.serial = target.serial;
+        result.success = target.success;
+        result.attempts = target.attempts;
+        result.elapsedMs = target.clock.isValid() ? target.clock.elapsed() : 0;
+        result.error = target.error;
+        out.append(result);
+    }
+    return out;
+}
+
+void BulkPusher::pump()
+{
+    if (!m_running) {
+        return;
+    }
+    for (int i = 0; i < m_targets.size() && m_active < m_maxStreams; i++) {
+        // startTarget 可能同步发出信号，接收方在其中取消推送后不能再启动新的目标
+        if (!m_running) {
+            return;
+        }
+        const Target &target = m_targets[i];
+        if (target.done || target.active || target.waiting) {
+            continue;
+        }
+        if (m_activePerHost.value(target.host) >= m_maxStreamsPerHost) {
+            continue;
+        }
+        startTarget(i);
+    }
+
+    for (const auto &target : m_targets) {
+        if (!target.done) {
+            return;
+        }
+    }
+    finish();
+}
+
+void BulkPusher::startTarget(int index)
+{
+    Target &target = m_targets[index];
+    target.active = true;
+    target.attempts++;
+    target.sent = 0;
+    if (1 == target.attempts) {
+        target.clock.start();
+    }
+    m_active++;
+    m_activePerHost[target.host]++;
+
+    if (!m_data && 0 < m_size) {
+        startProcessPush(index);
+        return;
+    }
+
+    target.client = new AdbClient(this);
+    connect(target.client, &AdbClient::pushProgress, this, [this, index](qint64 sentBytes, qint64) {
+        Target &target = m_targets[index];
+        m_written += sentBytes - target.sent;
+        target.sent = sentBytes;
+        reportProgress(false);
+    });
+    connect(target.client, &AdbClient::adbClientResult, this, [this, index](qsc::AdbProcess::ADB_EXEC_RESULT result) {
+        if (AdbProcess::AER_SUCCESS_START == result) {
+            return;
+        }
+        AdbClient *client = m_targets[index].client;
+        onTargetResult(index, AdbProcess::AER_SUCCESS_EXEC == result, client ? client->getErrorOut() : QString());
+    });
+    connect(target.client, &AdbClient::serverUnavailable, this, [this, index]() {
+        // adb server 未运行，交给 adb 进程（会拉起 server）
+        Target &target = m_targets[index];
+        target.client->deleteLater();
+        target.client = nullptr;
+        startProcessPush(index);
+    });
+    target.client->pushData(target.serial, m_data, m_size, m_remote, QFileInfo(m_file).fileName(), m_mtime);
+}
+
+void BulkPusher::startProcessPush(int index)
+{
+    Target &target = m_targets[index];
+    target.process = new AdbProcess(this);
+    connect(target.process, &AdbProcess::adbProcessResult, this, [this, index](AdbProcess::ADB_EXEC_RESULT result) {
+        if (AdbProcess::AER_SUCCESS_START == result) {
+            return;
+        }
+        AdbProcess *process = m_targets[index].process;
+        if (AdbProcess::AER_SUCCESS_EXEC == result) {
+            m_written += m_size;
+        }
+        onTargetResult(index, AdbProcess::AER_SUCCESS_EXEC == result, process ? process->getErrorOut() : QString());
+    });
+    target.process->push(target.serial, m_file.fileName(), m_remote);
+}
+
+void BulkPusher::onTargetResult(int index, bool success, const QString &error)
+{
+    if (!m_running) {
+        return;
+    }
+    Target &target = m_targets[index];
+    releaseTarget(target);
+
+    if (success) {
+        target.done = true;
+        target.success = true;
+        target.sent = m_size;
+        target.error.clear();
+        qInfo("bulk push %s finished in %lldms (attempt %d)", target.serial.toUtf8().data(), target.clock.elapsed(), target.attempts);
+        emit deviceFinished(target.serial, true, QString());
+    } else if (target.attempts < m_maxAttempts) {
+        // 只重推这台设备，其他设备不受影响；sync 协议不支持断点续传，从头开始
+        target.error = error;
+        target.waiting = true;
+        int delayMs = ConnectScheduler::backoffMs(static_cast<quint32>(target.attempts - 1), 500, 5000);
+        qWarning("bulk push %s failed (%s), retry in %dms", target.serial.toUtf8().data(), error.toUtf8().data(), delayMs);
+        QTimer::singleShot(delayMs, this, [this, index]() {
+            if (!m_running) {
+                return;
+            }
+            m_targets[index].waiting = false;
+            pump();
+        });
+    } else {
+        target.done = true;
+        target.success = false;
+        target.error = error;
+        qWarning("bulk push %s failed after %d attempts: %s", target.serial.toUtf8().data(), target.attempts, error.toUtf8().data());
+        emit deviceFinished(target.serial, false, error);
+    }
+    reportProgress(true);
+    pump();
+}
+
+void BulkPusher::releaseTarget(Target &target)
+{
+    if (target.active) {
+        target.active = false;
+        m_active--;
+        if (0 >= --m_activePerHost[target.host]) {
+            m_activePerHost.remove(target.host);
+        }
+    }
+    if (target.client) {
+        target.client->disconnect(this);
+        target.client->kill();
+        target.client->deleteLater();
+        target.client = nullptr;
+    }
+    if (target.process) {
+        target.process->disconnect(this);
+        target.process->kill();
+        target.process->deleteLater();
+        target.process = nullptr;
+    }
+}
+
+void BulkPusher::reportProgress(bool force)
+{
+    if (!force && m_progressClock.elapsed() < BULK_PUSH_PROGRESS_INTERVAL_MS) {
+        return;
+    }
+    m_progressClock.restart();
+    qint64 sent = 0;
+    for (const auto &target : m_targets) {
+        sent += target.sent;
+    }
+    qint64 elapsed = qMax<qint64>(1, m_clock.elapsed());
+    emit pushProgress(sent, m_size * m_targets.size(), m_written * 1000 / elapsed);
+}
+
+void BulkPusher::finish()
+{
+    int succeeded = 0;
+    for (const auto &target : m_targets) {
+        if (target.success) {
+            succeeded++;
+        }
+    }
+    int failed = m_targets.size() - succeeded;
+    qint64 elapsed = qMax<qint64>(1, m_clock.elapsed());
+    qInfo("bulk push finished: %d ok, %d failed, %lld bytes written in %lldms (%lld KB/s)",
+          succeeded, failed, m_written, elapsed, m_written * 1000 / elapsed / 1024);
+    reportProgress(true);
+    // 先清理状态，接收方可以在信号里发起下一次推送
+    cancel();
+    emit pushFinished(succeeded, failed);
+}
+
+}
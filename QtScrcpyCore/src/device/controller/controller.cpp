@@ -2,11 +2,32 @@
 #include <QClipboard>
 
 #include "controller.h"
+#include "controlmacro.h"
 #include "controlmsg.h"
 #include "inputconvertgame.h"
 #include "receiver.h"
 #include "videosocket.h"
 
+// 控制通道积压超过该值时暂停发送文本块
+#define TEXT_STREAM_HIGH_WATER (16 * 1024)
+// 每次调度最多发送的文本块数，避免长时间占用事件循环
+#define TEXT_STREAM_BURST 8
+// 积压时的重试间隔
+#define TEXT_STREAM_RETRY_MS 5
+#define TEXT_STREAM_PROGRESS_INTERVAL_MS 100
+
+// 从 pos 开始最多取 maxLen 字节，且不截断多字节字符
+static int utf8ChunkLength(const QByteArray &data, int pos, int maxLen)
+{
+    int len = qMin(maxLen, data.size() - pos);
+    if (pos + len < data.size()) {
+        while (len > 0 && 0x80 == (static_cast<uchar>(data.at(pos + len)) & 0xC0)) {
+            len--;
+        }
+    }
+    return len;
+}
+
 Controller::Controller(std::function<qint64(const QByteArray&)> sendData, QString gameScript, QObject *parent)
     : QObject(parent)
     , m_sendData(sendData)
@@ -14,6 +35,9 @@ Controller::Controller(std::function<qint64(const QByteArray&)> sendData, QStrin
     m_receiver = new Receiver(this);
     Q_ASSERT(m_receiver);
 
+    m_textStreamTimer.setSingleShot(true);
+    connect(&m_textStreamTimer, &QTimer::timeout, this, &Controller::pumpTextStream);
+
     updateScript(gameScript);
 }
 
@@ -176,12 +200,16 @@ void Controller::setDeviceClipboard(bool pause)
 void Controller::clipboardPaste()
 {
     QClipboard *board = QApplication::clipboard();
-    QString text = board->text();
-    postTextInput(text);
+    postTextStream(board->text());
 }
 
 void Controller::postTextInput(QString &text)
 {
+    // 超长文本或已有文本流时走分块发送，保证不截断且顺序不乱
+    if (isTextStreaming() || CONTROL_MSG_INJECT_TEXT_MAX_LENGTH < text.toUtf8().length()) {
+        postTextStream(text);
+        return;
+    }
     ControlMsg *controlMsg = new ControlMsg(ControlMsg::CMT_INJECT_TEXT);
     if (!controlMsg) {
         return;
@@ -190,6 +218,134 @@ void Controller::postTextInput(QString &text)
     postControlMsg(controlMsg);
 }
 
+void Controller::setSendPending(std::function<qint64()> pendingBytes)
+{
+    m_sendPending = pendingBytes;
+}
+
+void Controller::postTextStream(const QString &text)
+{
+    if (text.isEmpty()) {
+        return;
+    }
+    if (!isTextStreaming()) {
+        m_textStream.clear();
+        m_textStreamPos = 0;
+        m_textStreamSent = 0;
+        m_textStreamLastProgressMs = 0;
+        m_textStreamClock.start();
+    } else if (m_textStreamPos > 0) {
+        // 丢弃已发送部分，新文本追加到队尾
+        m_textStream.remove(0, m_textStreamPos);
+        m_textStreamPos = 0;
+    }
+    m_textStream.append(text.toUtf8());
+    if (!m_textStreamTimer.isActive()) {
+        m_textStreamTimer.start(0);
+    }
+}
+
+void Controller::cancelTextStream()
+{
+    if (!isTextStreaming()) {
+        return;
+    }
+    finishTextStream(false);
+}
+
+bool Controller::isTextStreaming()
+{
+    return m_textStreamPos < m_textStream.size();
+}
+
+void Controller::pumpTextStream()
+{
+    if (!isTextStreaming()) {
+        return;
+    }
+
+    int burst = 0;
+    while (isTextStreaming() && burst < TEXT_STREAM_BURST) {
+        if (m_sendPending && m_sendPending() > TEXT_STREAM_HIGH_WATER) {
+            break;
+        }
+        int len = utf8ChunkLength(m_textStream, m_textStreamPos, CONTROL_MSG_INJECT_TEXT_MAX_LENGTH);
+        QString chunk = QString::fromUtf8(m_textStream.constData() + m_textStreamPos, len);
+        ControlMsg controlMsg(ControlMsg::CMT_INJECT_TEXT);
+        controlMsg.setInjectTextMsgData(chunk);
+        if (!sendControl(controlMsg.serializeData())) {
+            qWarning("text stream: send failed at %lld bytes", m_textStreamSent);
+            finishTextStream(false);
+            return;
+        }
+        m_textStreamPos += len;
+        m_textStreamSent += len;
+        burst++;
+    }
+
+    if (!isTextStreaming()) {
+        finishTextStream(true);
+        return;
+    }
+
+    qint64 elapsedMs = m_textStreamClock.elapsed();
+    if (elapsedMs - m_textStreamLastProgressMs >= TEXT_STREAM_PROGRESS_INTERVAL_MS) {
+        m_textStreamLastProgressMs = elapsedMs;
+        qint64 total = m_textStreamSent + (m_textStream.size() - m_textStreamPos);
+        emit textStreamProgress(m_textStreamSent, total, m_textStreamSent * 1000 / qMax<qint64>(1, elapsedMs));
+    }
+    // 本轮发满说明通道空闲，立即继续；否则等待积压写出
+    m_textStreamTimer.start(TEXT_STREAM_BURST == burst ? 0 : TEXT_STREAM_RETRY_MS);
+}
+
+void Controller::finishTextStream(bool complete)
+{
+    m_textStreamTimer.stop();
+    qint64 elapsedMs = m_textStreamClock.elapsed();
+    qint64 total = m_textStreamSent + (m_textStream.size() - m_textStreamPos);
+    qint64 bytesPerSecond = m_textStreamSent * 1000 / qMax<qint64>(1, elapsedMs);
+    m_textStream.clear();
+    m_textStreamPos = 0;
+
+    qInfo("text stream %s: %lld/%lld bytes in %lldms, %lld B/s",
+          complete ? "finished" : "aborted", m_textStreamSent, total, elapsedMs, bytesPerSecond);
+    emit textStreamProgress(m_textStreamSent, total, bytesPerSecond);
+    emit textStreamFinished(complete);
+}
+
+void Controller::postControlData(const QByteArray &data)
+{
+    sendControl(data);
+}
+
+void Controller::startMacroRecord()
+{
+    m_macroTimeline = ControlMacro::header();
+    m_macroLastUs = 0;
+    m_macroClock.start();
+    m_macroRecording = true;
+}
+
+QByteArray Controller::stopMacroRecord()
+{
+    if (!m_macroRecording) {
+        return QByteArray();
+    }
+    m_macroRecording = false;
+    QByteArray timeline = m_macroTimeline;
+    m_macroTimeline.clear();
+    // 只有文件头说明没有录到任何事件
+    if (timeline.size() <= ControlMacro::header().size()) {
+        return QByteArray();
+    }
+    return timeline;
+}
+
+bool Controller::isMacroRecording()
+{
+    return m_macroRecording;
+}
+
 void Controller::setDisplayPower(bool on)
 {
     ControlMsg *controlMsg = new ControlMsg(ControlMsg::CMT_SET_DISPLAY_POWER);
@@ -238,6 +394,11 @@ bool Controller::sendControl(const QByteArray &buffer)
     if (buffer.isEmpty()) {
         return false;
     }
+    if (m_macroRecording) {
+        qint64 nowUs = m_macroClock.nsecsElapsed() / 1000;
+        ControlMacro::appendEvent(m_macroTimeline, nowUs - m_macroLastUs, buffer);
+        m_macroLastUs = nowUs;
+    }
     qint32 len = 0;
     if (m_sendData) {
         len = static_cast<qint32>(m_sendData(buffer));
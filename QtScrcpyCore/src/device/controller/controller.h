@@ -2,8 +2,10 @@
 #ifndef CONTROLLER_H
 #define CONTROLLER_H
 
+#include <QElapsedTimer>
 #include <QObject>
 #include <QPointer>
+#include <QTimer>
 
 #include "inputconvertbase.h"
 
@@ -52,8 +54,25 @@ public:
     void clipboardPaste();
     void postTextInput(QString &text);
 
+    // 长文本按UTF-8边界切块后分批发送，控制通道积压超过水位时暂停
+    // pendingBytes 返回控制通道中尚未写出的字节数，用于流控
+    void setSendPending(std::function<qint64()> pendingBytes);
+    void postTextStream(const QString &text);
+    void cancelTextStream();
+    bool isTextStreaming();
+
+    // 直接发送已序列化的控制消息（宏回放）
+    void postControlData(const QByteArray &data);
+
+    // 在 sendControl 处录制控制流，stop 时返回二进制时间线
+    void startMacroRecord();
+    QByteArray stopMacroRecord();
+    bool isMacroRecording();
+
 signals:
     void grabCursor(bool grab);
+    void textStreamProgress(qint64 sentBytes, qint64 totalBytes, qint64 bytesPerSecond);
+    void textStreamFinished(bool complete);
 
 protected:
     bool event(QEvent *event);
@@ -61,11 +80,26 @@ protected:
 private:
     bool sendControl(const QByteArray &buffer);
     void postKeyCodeClick(AndroidKeycode keycode);
+    void pumpTextStream();
+    void finishTextStream(bool complete);
 
 private:
     QPointer<Receiver> m_receiver;
     QPointer<InputConvertBase> m_inputConvert;
     std::function<qint64(const QByteArray&)> m_sendData = Q_NULLPTR;
+    std::function<qint64()> m_sendPending = Q_NULLPTR;
+
+    QByteArray m_textStream;
+    int m_textStreamPos = 0;
+    qint64 m_textStreamSent = 0;
+    qint64 m_textStreamLastProgressMs = 0;
+    QElapsedTimer m_textStreamClock;
+    QTimer m_textStreamTimer;
+
+    bool m_macroRecording = false;
+    QElapsedTimer m_macroClock;
+    qint64 m_macroLastUs = 0;
+    QByteArray m_macroTimeline;
 };
 
 #endif // CONTROLLER_H
@@ -36,6 +36,8 @@ void ControlMsg::setInjectTextMsgData(QString &text)
     // write length (2 byte) + string (non nul-terminated)
     if (CONTROL_MSG_INJECT_TEXT_MAX_LENGTH < text.length()) {
         // injecting a text takes time, so limit the text length
+        // longer text should go through Controller::postTextStream
+        qWarning("inject text truncated from %d to %d", text.length(), CONTROL_MSG_INJECT_TEXT_MAX_LENGTH);
         text = text.left(CONTROL_MSG_INJECT_TEXT_MAX_LENGTH);
     }
     QByteArray tmp = text.toUtf8();
@@ -0,0 +1,156 @@
+#include <QDebug>
+
+#include "controlmacro.h"
+#include "controlmsg.h"
+
+#define MACRO_MAGIC "QSCM"
+#define MACRO_MAGIC_LENGTH 4
+#define MACRO_VERSION 1
+#define MACRO_HEADER_LENGTH (MACRO_MAGIC_LENGTH + 1)
+
+// 坐标在序列化消息中的偏移，参考 ControlMsg::serializeData
+// touch: type(1) action(1) id(8) x(4) y(4) w(2) h(2) ...
+// scroll: type(1) x(4) y(4) w(2) h(2) ...
+#define TOUCH_POSITION_OFFSET 10
+#define SCROLL_POSITION_OFFSET 1
+#define POSITION_LENGTH 12
+
+static quint32 read32be(const uchar *buf)
+{
+    return static_cast<quint32>((buf[0] << 24) | (buf[1] << 16) | (buf[2] << 8) | buf[3]);
+}
+
+static quint16 read16be(const uchar *buf)
+{
+    return static_cast<quint16>((buf[0] << 8) | buf[1]);
+}
+
+static void write32be(uchar *buf, quint32 value)
+{
+    buf[0] = value >> 24;
+    buf[1] = value >> 16;
+    buf[2] = value >> 8;
+    buf[3] = value;
+}
+
+static void write16be(uchar *buf, quint16 value)
+{
+    buf[0] = value >> 8;
+    buf[1] = value;
+}
+
+QByteArray ControlMacro::header()
+{
+    QByteArray out(MACRO_MAGIC, MACRO_MAGIC_LENGTH);
+    out.append(static_cast<char>(MACRO_VERSION));
+    return out;
+}
+
+void ControlMacro::appendEvent(QByteArray &timeline, qint64 deltaUs, const QByteArray &data)
+{
+    if (timeline.isEmpty()) {
+        timeline = header();
+    }
+    writeVarint(timeline, static_cast<quint64>(qMax<qint64>(0, deltaUs)));
+    writeVarint(timeline, static_cast<quint64>(data.size()));
+    timeline.append(data);
+}
+
+bool ControlMacro::parse(const QByteArray &timeline, QVector<Event> &events)
+{
+    events.clear();
+    if (timeline.size() < MACRO_HEADER_LENGTH || !timeline.startsWith(MACRO_MAGIC)) {
+        qWarning("control macro: bad header");
+        return false;
+    }
+    if (MACRO_VERSION != static_cast<quint8>(timeline.at(MACRO_MAGIC_LENGTH))) {
+        qWarning("control macro: unsupported version %d", static_cast<quint8>(timeline.at(MACRO_MAGIC_LENGTH)));
+        return false;
+    }
+
+    int pos = MACRO_HEADER_LENGTH;
+    qint64 timeUs = 0;
+    while (pos < timeline.size()) {
+        quint64 deltaUs = 0;
+        quint64 len = 0;
+        if (!readVarint(timeline, pos, deltaUs) || !readVarint(timeline, pos, len)) {
+            qWarning("control macro: truncated event header at %d", pos);
+            return false;
+        }
+        if (len > CONTROL_MSG_MAX_SIZE || pos + static_cast<qint64>(len) > timeline.size()) {
+            qWarning("control macro: bad event length %llu at %d", len, pos);
+            return false;
+        }
+        timeUs += static_cast<qint64>(deltaUs);
+        Event event;
+        event.timeUs = timeUs;
+        event.data = timeline.mid(pos, static_cast<int>(len));
+        events.append(event);
+        pos += static_cast<int>(len);
+    }
+    return true;
+}
+
+QByteArray ControlMacro::scale(const QByteArray &data, const QSize &targetSize)
+{
+    if (data.isEmpty() || !targetSize.isValid() || targetSize.isEmpty()) {
+        return data;
+    }
+
+    int offset = -1;
+    switch (static_cast<quint8>(data.at(0))) {
+    case ControlMsg::CMT_INJECT_TOUCH:
+        offset = TOUCH_POSITION_OFFSET;
+        break;
+    case ControlMsg::CMT_INJECT_SCROLL:
+        offset = SCROLL_POSITION_OFFSET;
+        break;
+    default:
+        return data;
+    }
+    if (data.size() < offset + POSITION_LENGTH) {
+        return data;
+    }
+
+    const uchar *src = reinterpret_cast<const uchar *>(data.constData()) + offset;
+    qint32 x = static_cast<qint32>(read32be(src));
+    qint32 y = static_cast<qint32>(read32be(src + 4));
+    quint16 w = read16be(src + 8);
+    quint16 h = read16be(src + 10);
+    if (0 == w || 0 == h || (w == targetSize.width() && h == targetSize.height())) {
+        return data;
+    }
+
+    QByteArray out = data;
+    uchar *dst = reinterpret_cast<uchar *>(out.data()) + offset;
+    write32be(dst, static_cast<quint32>(static_cast<qint64>(x) * targetSize.width() / w));
+    write32be(dst + 4, static_cast<quint32>(static_cast<qint64>(y) * targetSize.height() / h));
+    write16be(dst + 8, static_cast<quint16>(targetSize.width()));
+    write16be(dst + 10, static_cast<quint16>(targetSize.height()));
+    return out;
+}
+
+void ControlMacro::writeVarint(QByteArray &out, quint64 value)
+{
+    while (value >= 0x80) {
+        out.append(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.append(static_cast<char>(value));
+}
+
+bool ControlMacro::readVarint(const QByteArray &in, int &pos, quint64 &value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (pos >= in.size()) {
+            return false;
+        }
+        quint8 byte = static_cast<quint8>(in.at(pos++));
+        value |= static_cast<quint64>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,39 @@
+#ifndef CONTROLMACRO_H
+#define CONTROLMACRO_H
+
+#include <QByteArray>
+#include <QSize>
+#include <QVector>
+
+// 控制流宏的二进制时间线
+// 录制点在 Controller::sendControl，保存的是已经序列化好的控制消息
+//
+// 格式：
+// [Q S C M][ver] 文件头，5字节
+// 之后是连续的事件记录：
+// [delta us][len][payload]
+//  varint    varint  len字节
+// delta us 为距上一个事件的单调时间差（微秒），第一个事件相对录制开始
+class ControlMacro
+{
+public:
+    struct Event
+    {
+        qint64 timeUs = 0;  // 相对录制开始的时间（微秒）
+        QByteArray data;    // 序列化后的控制消息
+    };
+
+    static QByteArray header();
+    static void appendEvent(QByteArray &timeline, qint64 deltaUs, const QByteArray &data);
+    static bool parse(const QByteArray &timeline, QVector<Event> &events);
+
+    // 把触摸/滚动消息中的坐标从录制时的画面尺寸缩放到目标画面尺寸
+    // 其它类型的消息原样返回
+    static QByteArray scale(const QByteArray &data, const QSize &targetSize);
+
+private:
+    static void writeVarint(QByteArray &out, quint64 value);
+    static bool readVarint(const QByteArray &in, int &pos, quint64 &value);
+};
+
+#endif // CONTROLMACRO_H
@@ -0,0 +1,178 @@
+#include <QDebug>
+
+#include "QtScrcpyCore.h"
+#include "controlmacro.h"
+#include "macroreplayer.h"
+
+// 距离下一个事件不足1ms时直接发送，Qt定时器精度为毫秒
+#define REPLAY_DUE_SLACK_US 1000
+
+namespace qsc {
+
+MacroReplayer::MacroReplayer(QObject *parent) : QObject(parent)
+{
+    m_timer.setSingleShot(true);
+    m_timer.setTimerType(Qt::PreciseTimer);
+    connect(&m_timer, &QTimer::timeout, this, &MacroReplayer::onTimer);
+}
+
+MacroReplayer::~MacroReplayer()
+{
+    m_timer.stop();
+}
+
+bool MacroReplayer::load(const QByteArray &timeline)
+{
+    if (m_running) {
+        qWarning("macro replayer: cannot load while running");
+        return false;
+    }
+
+    QVector<ControlMacro::Event> events;
+    if (!ControlMacro::parse(timeline, events)) {
+        return false;
+    }
+    m_events.clear();
+    m_events.reserve(events.size());
+    for (const auto &item : events) {
+        Event event;
+        event.timeUs = item.timeUs;
+        event.data = item.data;
+        m_events.append(event);
+    }
+    return true;
+}
+
+quint32 MacroReplayer::eventCount()
+{
+    return static_cast<quint32>(m_events.size());
+}
+
+void MacroReplayer::setTargetFrameSize(const QString &serial, const QSize &size)
+{
+    m_targetSizes[serial] = size;
+}
+
+void MacroReplayer::setMaxDriftUs(qint64 maxDriftUs)
+{
+    m_maxDriftUs = qMax<qint64>(REPLAY_DUE_SLACK_US, maxDriftUs);
+}
+
+bool MacroReplayer::start(const QStringList &serials)
+{
+    if (m_running || m_events.isEmpty() || serials.isEmpty()) {
+        return false;
+    }
+
+    m_serials = serials;
+    m_runSizes.clear();
+    for (const auto &serial : m_serials) {
+        if (m_targetSizes.contains(serial)) {
+            m_runSizes[serial] = m_targetSizes.value(serial);
+            continue;
+        }
+        auto device = IDeviceManage::getInstance().getDevice(serial);
+        if (device) {
+            m_runSizes[serial] = device->getFrameSize();
+        }
+    }
+
+    m_stats = ReplayStats();
+    m_stats.plannedDurationUs = m_events.last().timeUs;
+    m_totalLatenessUs = 0;
+    m_offsetUs = 0;
+    m_next = 0;
+    m_running = true;
+    m_clock.start();
+    onTimer();
+    return true;
+}
+
+void MacroReplayer::stop()
+{
+    if (!m_running) {
+        return;
+    }
+    finish(false);
+}
+
+bool MacroReplayer::isRunning()
+{
+    return m_running;
+}
+
+MacroReplayer::ReplayStats MacroReplayer::stats()
+{
+    return m_stats;
+}
+
+void MacroReplayer::onTimer()
+{
+    if (!m_running) {
+        return;
+    }
+
+    while (m_next < m_events.size()) {
+        qint64 nowUs = m_clock.nsecsElapsed() / 1000;
+        qint64 dueUs = m_events[m_next].timeUs + m_offsetUs;
+        if (dueUs - nowUs > REPLAY_DUE_SLACK_US) {
+            break;
+        }
+
+        qint64 latenessUs = qMax<qint64>(0, nowUs - dueUs);
+        if (latenessUs > m_maxDriftUs) {
+            // 整体后移，后续事件保持录制时的相对间隔
+            m_offsetUs += latenessUs;
+            m_stats.rebases++;
+        }
+        m_totalLatenessUs += latenessUs;
+        m_stats.maxLatenessUs = qMax(m_stats.maxLatenessUs, latenessUs);
+
+        dispatch(m_next);
+        m_next++;
+        m_stats.events++;
+        m_stats.meanLatenessUs = m_totalLatenessUs / m_stats.events;
+    }
+
+    emit replayProgress(static_cast<quint32>(m_next), static_cast<quint32>(m_events.size()));
+
+    if (m_next >= m_events.size()) {
+        finish(true);
+        return;
+    }
+    scheduleNext();
+}
+
+void MacroReplayer::dispatch(int index)
+{
+    const QByteArray &data = m_events[index].data;
+    for (const auto &serial : m_serials) {
+        auto device = IDeviceManage::getInstance().getDevice(serial);
+        if (!device) {
+            m_stats.skippedDevices++;
+            continue;
+        }
+        device->postControlData(ControlMacro::scale(data, m_runSizes.value(serial)));
+        m_stats.sends++;
+    }
+}
+
+void MacroReplayer::scheduleNext()
+{
+    qint64 nowUs = m_clock.nsecsElapsed() / 1000;
+    qint64 waitUs = m_events[m_next].timeUs + m_offsetUs - nowUs;
+    m_timer.start(static_cast<int>(qMax<qint64>(0, waitUs / 1000)));
+}
+
+void MacroReplayer::finish(bool complete)
+{
+    m_timer.stop();
+    m_running = false;
+    m_stats.durationUs = m_clock.nsecsElapsed() / 1000;
+    qInfo("macro replay %s: %u events to %d devices, mean lateness %lldus, max %lldus, rebases %u",
+          complete ? "finished" : "stopped", m_stats.events, m_serials.size(),
+          m_stats.meanLatenessUs, m_stats.maxLatenessUs, m_stats.rebases);
+    emit replayFinished(complete);
+}
+
+}
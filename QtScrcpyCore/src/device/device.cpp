@@ -2,6 +2,7 @@
 #include <QMessageBox>
 #include <QTimer>
 
+#include "connectscheduler.h"
 #include "controller.h"
 #include "devicemsg.h"
 #include "decoder.h"
@@ -10,6 +11,11 @@
 #include "recorder.h"
 #include "server.h"
 #include "demuxer.h"
+#include "sessionreaper.h"
+
+// 会话断开后最多连续恢复的次数，会话稳定运行超过 DEVICE_RESUME_STABLE_MS 后清零
+#define DEVICE_MAX_RESUME_COUNT 3
+#define DEVICE_RESUME_STABLE_MS 10000
 
 namespace qsc {
 
@@ -23,6 +29,14 @@ Device::Device(DeviceParams params, QObject *parent) : IDevice(parent), m_params
 
     if (params.display) {
         m_decoder = new Decoder([this](int width, int height, uint8_t* dataY, uint8_t* dataU, uint8_t* dataV, int linesizeY, int linesizeU, int linesizeV) {
+            // 后台回收期间 demuxer 可能还在推帧，不再交给观察者
+            if (m_closing) {
+                return;
+            }
+            // 旋转后帧尺寸会变，宏录制按当前帧尺寸换算坐标
+            if (width != m_frameSize.width() || height != m_frameSize.height()) {
+                m_frameSize = QSize(width, height);
+            }
             for (const auto& item : m_deviceObservers) {
                 item->onFrame(width, height, dataY, dataU, dataV, linesizeY, linesizeU, linesizeV);
             }
@@ -64,6 +78,12 @@ Device::Device(DeviceParams params, QObject *parent) : IDevice(parent), m_params
             
             return written;
         }, params.gameScript, this);
+        m_controller->setSendPending([this]() -> qint64 {
+            if (!m_server || !m_server->getControlSocket()) {
+                return 0;
+            }
+            return m_server->getControlSocket()->bytesToWrite();
+        });
     }
 
     m_stream = new Demuxer(this);
@@ -160,7 +180,7 @@ void Device::showTouch(bool show)
 
 bool Device::isReversePort(quint16 port)
 {
-    if (m_server && m_server->isReverse() && port == m_server->getParams().localPort) {
+    if (m_server && m_server->isReverse() && 0 != port && port == m_server->reversePort()) {
         return true;
     }
 
@@ -183,6 +203,16 @@ void Device::initSignals()
                 item->grabCursor(grab);
             }
         });
+        connect(m_controller, &Controller::textStreamProgress, this, [this](qint64 sentBytes, qint64 totalBytes, qint64 bytesPerSecond){
+            for (const auto& item : m_deviceObservers) {
+                item->textStreamProgress(sentBytes, totalBytes, bytesPerSecond);
+            }
+        });
+        connect(m_controller, &Controller::textStreamFinished, this, [this](bool complete){
+            for (const auto& item : m_deviceObservers) {
+                item->textStreamFinished(complete);
+            }
+        });
     }
     if (m_fileHandler) {
         connect(m_fileHandler, &FileHandler::fileHandlerResult, this, [this](FileHandler::FILE_HANDLER_RESULT processResult, bool isApk) {
@@ -210,7 +240,12 @@ void Device::initSignals()
 
     if (m_server) {
         connect(m_server, &Server::serverStarted, this, [this](bool success, const QString &deviceName, const QSize &size) {
+            if (RS_NONE != m_resumeState) {
+                onSessionResumed(success, size);
+                return;
+            }
             m_serverStartSuccess = success;
+            m_frameSize = success ? size : QSize();
             emit deviceConnected(success, m_params.serial, deviceName, size);
             if (success) {
                 double diff = m_startTimeCount.elapsed() / 1000.0;
@@ -233,64 +268,18 @@ void Device::initSignals()
                     m_decoder->open();
                 }
 
-                // init stream
-                m_stream->installVideoSocket(m_server->removeVideoSocket());
-                m_stream->setFrameSize(size);
-                m_stream->startDecode();
-
-                // recv device msg
-                connect(m_server->getControlSocket(), &QTcpSocket::readyRead, this, [this](){
-                    if (!m_controller) {
-                        return;
-                    }
-
-                    auto controlSocket = m_server->getControlSocket();
-                    while (controlSocket->bytesAvailable()) {
-                        QByteArray byteArray = controlSocket->peek(controlSocket->bytesAvailable());
-                        DeviceMsg deviceMsg;
-                        qint32 consume = deviceMsg.deserialize(byteArray);
-                        if (0 >= consume) {
-                            break;
-                        }
-                        controlSocket->read(consume);
-                        m_controller->recvDeviceMsg(&deviceMsg);
-                    }
-                });
-
-                // 显示界面时才自动息屏（m_params.display）
-                if (m_params.closeScreen && m_params.display && m_controller) {
-                    m_controller->setDisplayPower(false);
-                }
+                startStream(size);
             } else {
                 m_server->stop();
             }
         });
         connect(m_server, &Server::serverStoped, this, [this]() {
-            disconnectDevice();
             qDebug() << "server process stop";
+            onSessionLost();
         });
     }
 
-    if (m_stream) {
-        connect(m_stream, &Demuxer::onStreamStop, this, [this]() {
-            disconnectDevice();
-            qDebug() << "stream thread stop";
-        });
-        connect(m_stream, &Demuxer::getFrame, this, [this](AVPacket *packet) {
-            if (m_decoder && !m_decoder->push(packet)) {
-                qCritical("Could not send packet to decoder");
-            }
-
-            if (m_recorder && !m_recorder->push(packet)) {
-                qCritical("Could not send packet to recorder");
-            }
-        }, Qt::DirectConnection);
-        connect(m_stream, &Demuxer::getConfigFrame, this, [this](AVPacket *packet) {
-            if (m_recorder && !m_recorder->push(packet)) {
-                qCritical("Could not send config packet to recorder");
-            }
-        }, Qt::DirectConnection);
-    }
+    initStreamSignals();
 
     if (m_decoder) {
         connect(m_decoder, &Decoder::updateFPS, this, [this](quint32 fps) {
@@ -301,6 +290,142 @@ void Device::initSignals()
     }
 }
 
+void Device::initStreamSignals()
+{
+    if (!m_stream) {
+        return;
+    }
+    connect(m_stream, &Demuxer::onStreamStop, this, [this]() {
+        qDebug() << "stream thread stop";
+        onSessionLost();
+    });
+    connect(m_stream, &Demuxer::getFrame, this, [this](AVPacket *packet) {
+        if (m_decoder && !m_decoder->push(packet)) {
+            qCritical("Could not send packet to decoder");
+        }
+
+        if (m_recorder && !m_recorder->push(packet)) {
+            qCritical("Could not send packet to recorder");
+        }
+    }, Qt::DirectConnection);
+    connect(m_stream, &Demuxer::getConfigFrame, this, [this](AVPacket *packet) {
+        if (m_recorder && !m_recorder->push(packet)) {
+            qCritical("Could not send config packet to recorder");
+        }
+    }, Qt::DirectConnection);
+}
+
+void Device::startStream(const QSize &size)
+{
+    // 旧的 demuxer 线程可能还阻塞在失效的 socket 上（半开连接），主线程不等待它：
+    // 断开信号后由它的 finished 信号自行释放，新会话使用新的 demuxer
+    if (m_stream && m_stream->isRunning()) {
+        Demuxer *retired = m_stream;
+        retired->disconnect(this);
+        retired->setParent(Q_NULLPTR);
+        connect(retired, &QThread::finished, retired, &QObject::deleteLater);
+        // 检查和连接之间线程可能已经结束，finished 不会再发出；deleteLater 重复调用是安全的
+        if (retired->isFinished()) {
+            retired->deleteLater();
+        }
+        m_stream = new Demuxer(this);
+        initStreamSignals();
+    }
+
+    // init stream
+    m_stream->installVideoSocket(m_server->removeVideoSocket());
+    m_stream->setFrameSize(size);
+    m_stream->startDecode();
+    m_sessionClock.start();
+
+    // recv device msg
+    connect(m_server->getControlSocket(), &QTcpSocket::readyRead, this, [this](){
+        if (!m_controller) {
+            return;
+        }
+
+        auto controlSocket = m_server->getControlSocket();
+        while (controlSocket->bytesAvailable()) {
+            QByteArray byteArray = controlSocket->peek(controlSocket->bytesAvailable());
+            DeviceMsg deviceMsg;
+            qint32 consume = deviceMsg.deserialize(byteArray);
+            if (0 >= consume) {
+                break;
+            }
+            controlSocket->read(consume);
+            m_controller->recvDeviceMsg(&deviceMsg);
+        }
+    });
+
+    // 显示界面时才自动息屏（m_params.display）
+    if (m_params.closeScreen && m_params.display && m_controller) {
+        m_controller->setDisplayPower(false);
+    }
+}
+
+void Device::onSessionLost()
+{
+    // 主动断开、尚未连接成功或者正在恢复中
+    if (RS_NONE != m_resumeState) {
+        return;
+    }
+    if (m_closing || !m_server || !m_serverStartSuccess || !m_params.autoResume) {
+        disconnectDevice();
+        return;
+    }
+
+    if (m_sessionClock.isValid() && m_sessionClock.elapsed() > DEVICE_RESUME_STABLE_MS) {
+        m_resumeAttempts = 0;
+    }
+    if (DEVICE_MAX_RESUME_COUNT <= m_resumeAttempts) {
+        qWarning("device %s dropped %u times in a row, give up resume", m_params.serial.toUtf8().data(), m_resumeAttempts);
+        disconnectDeviceAsync();
+        return;
+    }
+
+    // 解码器、录制、控制器和观察者保持不变，只重建 server 会话
+    // 带抖动的退避，避免网络抖动后大量设备同时重连
+    int delayMs = ConnectScheduler::backoffMs(m_resumeAttempts, 100, 2000);
+    m_resumeAttempts++;
+    m_resumeState = RS_RESUME;
+    m_resumeClock.start();
+    qInfo("device %s session lost, resume in %dms (attempt %u)", m_params.serial.toUtf8().data(), delayMs, m_resumeAttempts);
+    QTimer::singleShot(delayMs, this, [this]() {
+        if (m_closing || !m_server) {
+            return;
+        }
+        if (!m_server->resume()) {
+            onSessionResumed(false, QSize());
+        }
+    });
+}
+
+void Device::onSessionResumed(bool success, const QSize &size)
+{
+    if (success) {
+        qint64 elapsed = m_resumeClock.elapsed();
+        ConnectScheduler::instance().recordStage(RS_RESUME == m_resumeState ? "resume" : "restart", elapsed);
+        qInfo("device %s %s in %lldms", m_params.serial.toUtf8().data(),
+              RS_RESUME == m_resumeState ? "resumed" : "restarted", elapsed);
+        m_resumeState = RS_NONE;
+        m_frameSize = size;
+        startStream(size);
+        return;
+    }
+
+    if (RS_RESUME == m_resumeState && m_server) {
+        // 快速恢复失败（例如 adb 传输已断开），退回到完整的 connect/push/tunnel 流程
+        qWarning("device %s resume failed, restart server", m_params.serial.toUtf8().data());
+        m_resumeState = RS_RESTART;
+        m_server->start(m_server->getParams());
+        return;
+    }
+
+    qWarning("device %s restart failed", m_params.serial.toUtf8().data());
+    m_resumeState = RS_NONE;
+    disconnectDeviceAsync();
+}
+
 bool Device::connectDevice()
 {
     if (!m_server) {
@@ -359,6 +484,8 @@ void Device::disconnectDevice()
     if (!m_server) {
         return;
     }
+    m_closing = true;
+    m_resumeState = RS_NONE;
     m_server->stop();
     m_server = Q_NULLPTR;
 
@@ -385,6 +512,78 @@ void Device::disconnectDevice()
     m_serverStartSuccess = false;
 }
 
+void Device::disconnectDeviceAsync()
+{
+    if (!m_server) {
+        return;
+    }
+    // 标记为关闭中：停止 server（sockets 关闭后 demuxer 会读到结束），不再恢复、不再推帧给观察者
+    m_closing = true;
+    // 必须在发出 deviceDisconnected 之前标记，接收方据此决定是否释放设备
+    m_releasesItself = true;
+    m_resumeState = RS_NONE;
+    m_server->stop();
+    m_server = Q_NULLPTR;
+
+    if (m_serverStartSuccess) {
+        emit deviceDisconnected(m_params.serial);
+    }
+    m_serverStartSuccess = false;
+
+    // 阻塞的部分（join 线程、写录像 trailer）放到后台，完成后在主线程释放设备
+    // demuxer/recorder 脱离 parent 由回收任务负责释放，设备提前销毁（例如程序退出）也不会删掉运行中的线程
+    Demuxer *stream = m_stream;
+    Recorder *recorder = m_recorder;
+    if (stream) {
+        stream->setParent(Q_NULLPTR);
+    }
+    if (recorder) {
+        recorder->setParent(Q_NULLPTR);
+    }
+    QPointer<Device> self = this;
+    QElapsedTimer clock;
+    clock.start();
+    SessionReaper::instance().reap([stream, recorder]() {
+        if (stream) {
+            stream->stopDecode();
+        }
+        if (recorder) {
+            if (recorder->isRunning()) {
+                recorder->stopRecorder();
+                recorder->wait();
+            }
+            recorder->close();
+        }
+    }, [self, stream, recorder, clock]() {
+        if (stream) {
+            stream->deleteLater();
+        }
+        if (recorder) {
+            recorder->deleteLater();
+        }
+        if (!self) {
+            return;
+        }
+        // decoder 只被 demuxer 线程使用，线程结束后才能关闭
+        if (self->m_decoder) {
+            self->m_decoder->close();
+        }
+        qInfo("device %s released in %lldms", self->m_params.serial.toUtf8().data(), clock.elapsed());
+        emit self->deviceReleased(self->m_params.serial);
+        self->deleteLater();
+    });
+}
+
+bool Device::isClosing()
+{
+    return m_closing;
+}
+
+bool Device::releasesItself()
+{
+    return m_releasesItself;
+}
+
 void Device::postGoBack()
 {
     if (!m_controller) {
@@ -553,6 +752,30 @@ void Device::postTextInput(QString &text)
     }
 }
 
+void Device::postTextStream(const QString &text)
+{
+    if (!m_controller) {
+        return;
+    }
+    m_controller->postTextStream(text);
+
+    for (const auto& item : m_deviceObservers) {
+        item->postTextStream(text);
+    }
+}
+
+void Device::cancelTextStream()
+{
+    if (!m_controller) {
+        return;
+    }
+    m_controller->cancelTextStream();
+
+    for (const auto& item : m_deviceObservers) {
+        item->cancelTextStream();
+    }
+}
+
 void Device::requestDeviceClipboard()
 {
     if (!m_controller) {
@@ -657,6 +880,35 @@ bool Device::isCurrentCustomKeymap()
     return m_controller->isCurrentCustomKeymap();
 }
 
+void Device::startControlRecord()
+{
+    if (!m_controller) {
+        return;
+    }
+    m_controller->startMacroRecord();
+}
+
+QByteArray Device::stopControlRecord()
+{
+    if (!m_controller) {
+        return QByteArray();
+    }
+    return m_controller->stopMacroRecord();
+}
+
+void Device::postControlData(const QByteArray &data)
+{
+    if (!m_controller) {
+        return;
+    }
+    m_controller->postControlData(data);
+}
+
+QSize Device::getFrameSize()
+{
+    return m_frameSize;
+}
+
 bool Device::saveFrame(int width, int height, uint8_t* dataRGB32)
 {
     if (!dataRGB32) {
@@ -1,6 +1,7 @@
 ﻿#ifndef DEVICE_H
 #define DEVICE_H
 
+#include <atomic>
 #include <set>
 #include <QElapsedTimer>
 #include <QPointer>
@@ -38,6 +39,12 @@ public:
 
     bool connectDevice() override;
     void disconnectDevice() override;
+    // 异步断开：立即停止 server 并发出 deviceDisconnected，线程回收在后台进行，
+    // 完成后发出 deviceReleased 并释放自身
+    void disconnectDeviceAsync();
+    bool isClosing();
+    // 已交给后台回收，回收完成后自行 deleteLater，调用方不能再释放
+    bool releasesItself();
 
     // key map
     void mouseEvent(const QMouseEvent *from, const QSize &frameSize, const QSize &showSize) override;
@@ -58,6 +65,8 @@ public:
     void collapsePanel() override;
     void postBackOrScreenOn(bool down) override;
     void postTextInput(QString &text) override;
+    void postTextStream(const QString &text) override;
+    void cancelTextStream() override;
     void requestDeviceClipboard() override;
     void setDeviceClipboard(bool pause = true) override;
     void clipboardPaste() override;
@@ -74,8 +83,18 @@ public:
     void updateScript(QString script) override;
     bool isCurrentCustomKeymap() override;
 
+    void startControlRecord() override;
+    QByteArray stopControlRecord() override;
+    void postControlData(const QByteArray &data) override;
+    QSize getFrameSize() override;
+
 private:
     void initSignals();
+    void initStreamSignals();
+    void startStream(const QSize &size);
+    // 会话中途断开：尝试快速恢复，失败后完整重启，仍失败才断开设备
+    void onSessionLost();
+    void onSessionResumed(bool success, const QSize &size);
     bool saveFrame(int width, int height, uint8_t* dataRGB32);
 
 private:
@@ -89,9 +108,25 @@ private:
     QPointer<Recorder> m_recorder;
 
     QElapsedTimer m_startTimeCount;
+    QSize m_frameSize;
     DeviceParams m_params;
     std::set<DeviceObserver*> m_deviceObservers;
     void* m_userData = nullptr;
+
+    // session resume
+    enum ResumeState
+    {
+        RS_NONE,
+        RS_RESUME,  // 只重建隧道/server 进程/sockets
+        RS_RESTART, // 完整重启
+    };
+    ResumeState m_resumeState = RS_NONE;
+    quint32 m_resumeAttempts = 0;
+    // GUI 线程写，解码帧回调里读
+    std::atomic<bool> m_closing{false};
+    bool m_releasesItself = false;
+    QElapsedTimer m_resumeClock;
+    QElapsedTimer m_sessionClock;
 };
 
 }
@@ -0,0 +1,155 @@
+#include <QDebug>
+#include <QRandomGenerator>
+
+#include "connectscheduler.h"
+
+#define CONNECT_STAGE_WAIT "wait"
+
+ConnectScheduler &ConnectScheduler::instance()
+{
+    static ConnectScheduler scheduler;
+    return scheduler;
+}
+
+ConnectScheduler::ConnectScheduler(QObject *parent) : QObject(parent) {}
+
+void ConnectScheduler::setLimits(int globalLimit, int perHostLimit)
+{
+    m_globalLimit = qMax(1, globalLimit);
+    m_perHostLimit = qMax(1, perHostLimit);
+    qInfo("connect scheduler limits: global %d, per host %d", m_globalLimit, m_perHostLimit);
+    pump();
+}
+
+void ConnectScheduler::acquire(QObject *owner, const QString &serial, const QString &stage, std::function<void()> run)
+{
+    if (!owner || !run) {
+        return;
+    }
+    // 同一个 owner 同一时间只占一个名额
+    release(owner);
+
+    if (m_active.isEmpty() && m_pending.isEmpty()) {
+        m_burstClock.start();
+        m_burstStages = 0;
+    }
+
+    // 已在排队的申请就地替换，保留排队位置和等待时间，避免拿到名额后重复执行
+    for (auto &queued : m_pending) {
+        if (queued.owner == owner) {
+            queued.host = hostOf(serial);
+            queued.stage = stage;
+            queued.run = run;
+            pump();
+            return;
+        }
+    }
+
+    Pending pending;
+    pending.owner = owner;
+    pending.host = hostOf(serial);
+    pending.stage = stage;
+    pending.run = run;
+    pending.waitClock.start();
+    m_pending.append(pending);
+    pump();
+}
+
+void ConnectScheduler::release(QObject *owner)
+{
+    auto it = m_active.find(owner);
+    if (it == m_active.end()) {
+        return;
+    }
+    recordStage(it->stage, it->clock.elapsed());
+    m_burstStages++;
+    int &hostActive = m_hostActive[it->host];
+    if (--hostActive <= 0) {
+        m_hostActive.remove(it->host);
+    }
+    m_active.erase(it);
+    pump();
+
+    if (m_active.isEmpty() && m_pending.isEmpty() && m_burstClock.isValid()) {
+        qInfo("connect burst idle: %u stages in %lldms", m_burstStages, m_burstClock.elapsed());
+        for (auto stat = m_stats.constBegin(); stat != m_stats.constEnd(); ++stat) {
+            qInfo("  stage %-8s count %u avg %lldms max %lldms", stat.key().toUtf8().data(), stat->count,
+                  stat->count ? stat->totalMs / stat->count : 0, stat->maxMs);
+        }
+        m_burstClock.invalidate();
+    }
+}
+
+void ConnectScheduler::cancel(QObject *owner)
+{
+    for (int i = m_pending.size() - 1; i >= 0; --i) {
+        if (m_pending[i].owner == owner) {
+            m_pending.removeAt(i);
+        }
+    }
+    release(owner);
+}
+
+void ConnectScheduler::recordStage(const QString &stage, qint64 ms)
+{
+    qsc::ConnectStageStats &stat = m_stats[stage];
+    stat.count++;
+    stat.totalMs += ms;
+    stat.maxMs = qMax(stat.maxMs, ms);
+}
+
+QMap<QString, qsc::ConnectStageStats> ConnectScheduler::stats()
+{
+    return m_stats;
+}
+
+QString ConnectScheduler::hostOf(const QString &serial)
+{
+    // ip:port 形式取 ip，usb 设备共用本机 adb
+    int pos = serial.lastIndexOf(':');
+    if (pos > 0) {
+        return serial.left(pos);
+    }
+    return "local";
+}
+
+int ConnectScheduler::backoffMs(quint32 attempt, int baseMs, int maxMs)
+{
+    qint64 delay = baseMs;
+    for (quint32 i = 0; i < attempt && delay < maxMs; ++i) {
+        delay *= 2;
+    }
+    delay = qMin<qint64>(delay, maxMs);
+    int half = static_cast<int>(delay / 2);
+    return half + static_cast<int>(QRandomGenerator::global()->bounded(half + 1));
+}
+
+void ConnectScheduler::pump()
+{
+    // 先选出可以执行的申请，再统一执行，避免 run 中重入修改队列
+    QList<Pending> granted;
+    int index = 0;
+    while (index < m_pending.size() && m_active.size() < m_globalLimit) {
+        const Pending &pending = m_pending[index];
+        if (m_hostActive.value(pending.host) >= m_perHostLimit) {
+            index++;
+            continue;
+        }
+        Active active;
+        active.host = pending.host;
+        active.stage = pending.stage;
+        active.clock.start();
+        m_active[pending.owner] = active;
+        m_hostActive[pending.host]++;
+        recordStage(CONNECT_STAGE_WAIT, pending.waitClock.elapsed());
+        granted.append(m_pending.takeAt(index));
+    }
+
+    for (const auto &pending : granted) {
+        // 前面的 run 可能已经让后面的 owner 取消
+        if (!m_active.contains(pending.owner)) {
+            continue;
+        }
+        pending.run();
+    }
+}
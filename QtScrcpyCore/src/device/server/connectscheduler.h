@@ -0,0 +1,69 @@
+#ifndef CONNECTSCHEDULER_H
+#define CONNECTSCHEDULER_H
+
+#include <functional>
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QMap>
+#include <QObject>
+
+#include "QtScrcpyCoreDef.h"
+
+// 批量连接调度器
+// 每个 Server 的 adb 阶段（connect/push/reverse/forward/execute）执行前先申请名额，
+// 阶段结束后归还。全局和单主机（serial 中的 ip）分别限制并发数，
+// 不同设备的不同阶段可以同时进行，形成流水线，避免几百台设备同时打到同一个 adb/主机上
+class ConnectScheduler : public QObject
+{
+    Q_OBJECT
+public:
+    static ConnectScheduler &instance();
+
+    void setLimits(int globalLimit, int perHostLimit);
+
+    // 拿到名额时调用 run（名额充足时同步调用）
+    void acquire(QObject *owner, const QString &serial, const QString &stage, std::function<void()> run);
+    // 阶段结束，归还名额并记录耗时
+    void release(QObject *owner);
+    // owner 停止或析构时调用，同时移除排队中的申请
+    void cancel(QObject *owner);
+
+    void recordStage(const QString &stage, qint64 ms);
+    QMap<QString, qsc::ConnectStageStats> stats();
+
+    static QString hostOf(const QString &serial);
+    // 指数退避 + 抖动：[d/2, d]，d = min(maxMs, baseMs * 2^attempt)
+    static int backoffMs(quint32 attempt, int baseMs, int maxMs);
+
+private:
+    explicit ConnectScheduler(QObject *parent = nullptr);
+    void pump();
+
+private:
+    struct Pending
+    {
+        QObject *owner = nullptr;
+        QString host;
+        QString stage;
+        std::function<void()> run;
+        QElapsedTimer waitClock;
+    };
+    struct Active
+    {
+        QString host;
+        QString stage;
+        QElapsedTimer clock;
+    };
+
+    QList<Pending> m_pending;
+    QMap<QObject *, Active> m_active;
+    QMap<QString, int> m_hostActive;
+    QMap<QString, qsc::ConnectStageStats> m_stats;
+    QElapsedTimer m_burstClock;
+    quint32 m_burstStages = 0;
+    int m_globalLimit = 16;
+    int m_perHostLimit = 4;
+};
+
+#endif // CONNECTSCHEDULER_H
@@ -0,0 +1,65 @@
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+
+#include "connectscheduler.h"
+#include "pushcache.h"
+
+QMap<QString, PushCache::LocalEntry> PushCache::s_localEntries;
+QMap<QString, qsc::PushCacheStats> PushCache::s_stats;
+
+QString PushCache::localMd5(const QString &localPath)
+{
+    QFileInfo info(localPath);
+    if (!info.isFile()) {
+        return QString();
+    }
+
+    LocalEntry &entry = s_localEntries[info.absoluteFilePath()];
+    if (entry.size == info.size() && entry.modified == info.lastModified() && !entry.md5.isEmpty()) {
+        return entry.md5;
+    }
+
+    QFile file(localPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "push cache: open failed" << localPath << file.errorString();
+        return QString();
+    }
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    if (!hash.addData(&file)) {
+        return QString();
+    }
+    entry.size = info.size();
+    entry.modified = info.lastModified();
+    entry.md5 = QString::fromLatin1(hash.result().toHex());
+    return entry.md5;
+}
+
+bool PushCache::remoteMatches(const QString &md5sumOutput, const QString &localMd5)
+{
+    if (localMd5.isEmpty()) {
+        return false;
+    }
+    QString remote = md5sumOutput.trimmed().section(' ', 0, 0).toLower();
+    return remote == localMd5;
+}
+
+void PushCache::recordHit(const QString &serial)
+{
+    qsc::PushCacheStats &stat = s_stats[ConnectScheduler::hostOf(serial)];
+    stat.hits++;
+    qInfo("push cache hit: %s (host hits %u, misses %u)", serial.toUtf8().data(), stat.hits, stat.misses);
+}
+
+void PushCache::recordMiss(const QString &serial)
+{
+    qsc::PushCacheStats &stat = s_stats[ConnectScheduler::hostOf(serial)];
+    stat.misses++;
+    qInfo("push cache miss: %s (host hits %u, misses %u)", serial.toUtf8().data(), stat.hits, stat.misses);
+}
+
+QMap<QString, qsc::PushCacheStats> PushCache::stats()
+{
+    return s_stats;
+}
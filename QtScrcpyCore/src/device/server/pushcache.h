@@ -0,0 +1,36 @@
+#ifndef PUSHCACHE_H
+#define PUSHCACHE_H
+
+#include <QDateTime>
+#include <QMap>
+#include <QString>
+
+#include "QtScrcpyCoreDef.h"
+
+// scrcpy-server 推送缓存
+// 推送前先在设备上 md5sum 远端文件，与本地文件一致时跳过推送
+// 本地 md5 按路径缓存（大小和修改时间不变时不重新计算），命中/未命中按主机统计
+class PushCache
+{
+public:
+    // 本地文件的 md5（十六进制小写），读取失败返回空
+    static QString localMd5(const QString &localPath);
+    // md5sum 输出形如 "<md5>  <path>"
+    static bool remoteMatches(const QString &md5sumOutput, const QString &localMd5);
+
+    static void recordHit(const QString &serial);
+    static void recordMiss(const QString &serial);
+    static QMap<QString, qsc::PushCacheStats> stats();
+
+private:
+    struct LocalEntry
+    {
+        qint64 size = -1;
+        QDateTime modified;
+        QString md5;
+    };
+    static QMap<QString, LocalEntry> s_localEntries;
+    static QMap<QString, qsc::PushCacheStats> s_stats;
+};
+
+#endif // PUSHCACHE_H
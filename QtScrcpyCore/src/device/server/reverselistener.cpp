@@ -0,0 +1,83 @@
+#include <QDebug>
+#include <QHostAddress>
+
+#include "reverselistener.h"
+#include "server.h"
+#include "tcpserver.h"
+
+// 空闲监听最多保留的数量，多余的关闭
+#define REVERSE_LISTENER_MAX_IDLE 8
+
+ReverseListener &ReverseListener::instance()
+{
+    static ReverseListener listener;
+    return listener;
+}
+
+ReverseListener::ReverseListener(QObject *parent) : QObject(parent) {}
+
+quint16 ReverseListener::lease(Server *server)
+{
+    TcpServer *listener = Q_NULLPTR;
+    if (!m_idle.isEmpty()) {
+        listener = m_idle.takeLast();
+    } else {
+        listener = new TcpServer(this);
+        listener->setMaxPendingConnections(2);
+        if (!listener->listen(QHostAddress::LocalHost, 0)) {
+            qCritical() << "reverse listener: listen failed" << listener->errorString();
+            delete listener;
+            return 0;
+        }
+        connect(listener, &QTcpServer::newConnection, this, [this, listener]() { onNewConnection(listener); });
+        m_listeners.insert(listener->serverPort(), listener);
+    }
+
+    quint16 port = listener->serverPort();
+    listener->reset();
+    m_leases.insert(port, server);
+    qDebug("reverse listener: lease port %d, %d listeners, %d idle", port, m_listeners.size(), m_idle.size());
+    return port;
+}
+
+void ReverseListener::release(quint16 port)
+{
+    if (!m_leases.remove(port)) {
+        return;
+    }
+    TcpServer *listener = m_listeners.value(port);
+    if (!listener) {
+        return;
+    }
+    // 丢弃借用期间未被取走的连接
+    while (listener->hasPendingConnections()) {
+        QTcpSocket *socket = listener->nextPendingConnection();
+        socket->abort();
+        socket->deleteLater();
+    }
+    if (m_idle.size() >= REVERSE_LISTENER_MAX_IDLE) {
+        m_listeners.remove(port);
+        listener->close();
+        listener->deleteLater();
+        return;
+    }
+    listener->reset();
+    m_idle.append(listener);
+}
+
+void ReverseListener::onNewConnection(TcpServer *listener)
+{
+    quint16 port = listener->serverPort();
+    while (listener->hasPendingConnections()) {
+        QTcpSocket *socket = listener->nextPendingConnection();
+        QPointer<Server> server = m_leases.value(port);
+        if (!server) {
+            // 没有借用者（已超时或停止），直接关闭
+            qWarning("reverse listener: unexpected connection on port %d", port);
+            socket->abort();
+            socket->deleteLater();
+            continue;
+        }
+        server->onReverseConnection(socket);
+    }
+}
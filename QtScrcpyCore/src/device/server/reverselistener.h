@@ -0,0 +1,38 @@
+#ifndef REVERSELISTENER_H
+#define REVERSELISTENER_H
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QPointer>
+
+class Server;
+class TcpServer;
+class QTcpSocket;
+
+// adb reverse 共享监听池
+// 监听端口由系统分配，只在 server 建立连接的窗口期（reverse -> 两个连接 accept）借给一个 Server，
+// 连接按端口路由给借用者，借用结束后监听保持打开，给下一台设备复用。
+// scrcpy 反向连接不携带 scid，所以同一时刻一个端口只能借给一个会话，
+// 监听数量等于同时处于 accept 阶段的设备数（受 ConnectScheduler 限制），而不是设备总数
+class ReverseListener : public QObject
+{
+    Q_OBJECT
+public:
+    static ReverseListener &instance();
+
+    // 失败返回 0
+    quint16 lease(Server *server);
+    void release(quint16 port);
+
+private:
+    explicit ReverseListener(QObject *parent = nullptr);
+    void onNewConnection(TcpServer *listener);
+
+private:
+    QList<TcpServer *> m_idle;
+    QHash<quint16, TcpServer *> m_listeners;
+    QHash<quint16, QPointer<Server>> m_leases;
+};
+
+#endif // REVERSELISTENER_H
@@ -6,12 +6,18 @@
 #include <QTimer>
 #include <QTimerEvent>
 
+#include "connectscheduler.h"
+#include "pushcache.h"
+#include "reverselistener.h"
 #include "server.h"
 
 #define DEVICE_NAME_FIELD_LENGTH 64
 #define SOCKET_NAME_PREFIX "scrcpy"
 #define MAX_CONNECT_COUNT 30
 #define MAX_RESTART_COUNT 1
+// 连接 server socket 的重试间隔，指数退避并加抖动，避免大量设备同时重试
+#define CONNECT_RETRY_BASE_MS 50
+#define CONNECT_RETRY_MAX_MS 500
 
 static quint32 bufferRead32be(quint8 *buf)
 {
@@ -23,34 +29,54 @@ Server::Server(QObject *parent) : QObject(parent)
     connect(&m_workProcess, &qsc::AdbProcess::adbProcessResult, this, &Server::onWorkProcessResult);
     connect(&m_serverProcess, &qsc::AdbProcess::adbProcessResult, this, &Server::onWorkProcessResult);
 
-    connect(&m_serverSocket, &QTcpServer::newConnection, this, [this]() {
-        QTcpSocket *tmp = m_serverSocket.nextPendingConnection();
-        if (dynamic_cast<VideoSocket *>(tmp)) {
-            m_videoSocket = dynamic_cast<VideoSocket *>(tmp);
-            if (!m_videoSocket->isValid() || !readInfo(m_videoSocket, m_deviceName, m_deviceSize)) {
-                stop();
-                emit serverStarted(false);
-            }
+}
+
+Server::~Server()
+{
+    ConnectScheduler::instance().cancel(this);
+    releaseReverseListener();
+}
+
+void Server::onReverseConnection(QTcpSocket *socket)
+{
+    socket->setParent(this);
+    if (dynamic_cast<VideoSocket *>(socket)) {
+        m_videoSocket = dynamic_cast<VideoSocket *>(socket);
+        if (!m_videoSocket->isValid() || !readInfo(m_videoSocket, m_deviceName, m_deviceSize)) {
+            stop();
+            emit serverStarted(false);
+        }
+    } else {
+        m_controlSocket = socket;
+        if (m_controlSocket && m_controlSocket->isValid()) {
+            // we don't need the server socket anymore
+            // just m_videoSocket is ok
+            releaseReverseListener();
+            // we don't need the adb tunnel anymore
+            disableTunnelReverse();
+            m_tunnelEnabled = false;
+            recordConnectTiming();
+            emit serverStarted(true, m_deviceName, m_deviceSize);
         } else {
-            m_controlSocket = tmp;
-            if (m_controlSocket && m_controlSocket->isValid()) {
-                // we don't need the server socket anymore
-                // just m_videoSocket is ok
-                m_serverSocket.close();
-                // we don't need the adb tunnel anymore
-                disableTunnelReverse();
-                m_tunnelEnabled = false;
-                emit serverStarted(true, m_deviceName, m_deviceSize);
-            } else {
-                stop();
-                emit serverStarted(false);
-            }
-            stopAcceptTimeoutTimer();
+            stop();
+            emit serverStarted(false);
         }
-    });
+        stopAcceptTimeoutTimer();
+    }
 }
 
-Server::~Server() {}
+quint16 Server::reversePort()
+{
+    return m_reversePort;
+}
+
+void Server::releaseReverseListener()
+{
+    if (m_reversePort) {
+        ReverseListener::instance().release(m_reversePort);
+        m_reversePort = 0;
+    }
+}
 
 bool Server::pushServer()
 {
@@ -61,12 +87,44 @@ bool Server::pushServer()
     return true;
 }
 
+bool Server::checkServer()
+{
+    if (m_workProcess.isRuning()) {
+        m_workProcess.kill();
+    }
+    // 一次 shell 往返拿到远端文件的 md5，文件不存在时输出不是 md5，按未命中处理
+    QStringList args;
+    args << "shell" << "md5sum" << m_params.serverRemotePath;
+    m_workProcess.execute(m_params.serial, args);
+    return true;
+}
+
+void Server::startTunnelStep()
+{
+    if (m_params.useReverse) {
+        m_serverStartStep = SSS_ENABLE_TUNNEL_REVERSE;
+    } else {
+        m_tunnelForward = true;
+        m_serverStartStep = SSS_ENABLE_TUNNEL_FORWARD;
+    }
+    startServerByStep();
+}
+
 bool Server::enableTunnelReverse()
 {
     if (m_workProcess.isRuning()) {
         m_workProcess.kill();
     }
-    m_workProcess.reverse(m_params.serial, QString(SOCKET_NAME_PREFIX "_%1").arg(m_params.scid, 8, 16, QChar('0')), m_params.localPort);
+    // 先借到共享监听端口，再把设备端的 localabstract 反向映射到该端口
+    releaseReverseListener();
+    m_reversePort = ReverseListener::instance().lease(this);
+    if (0 == m_reversePort) {
+        qWarning("no reverse listener available, use adb forward");
+        m_tunnelForward = true;
+        m_serverStartStep = SSS_ENABLE_TUNNEL_FORWARD;
+        return enableTunnelForward();
+    }
+    m_workProcess.reverse(m_params.serial, QString(SOCKET_NAME_PREFIX "_%1").arg(m_params.scid, 8, 16, QChar('0')), m_reversePort);
     return true;
 }
 
@@ -230,6 +288,7 @@ bool Server::start(Server::ServerParams params)
     }
     
     m_params = params;
+    m_connectClock.start();
     // 如果使用直接TCP连接模式，跳过adb步骤，直接进入TCP连接
     if (params.useDirectTcp) {
         m_serverStartStep = SSS_DIRECT_TCP_CONNECT;
@@ -318,24 +377,10 @@ void Server::stop()
     cleanupAsyncSockets();
     m_asyncState = ACS_IDLE;
 
-    // 清理已连接的sockets
-    if (m_videoSocket) {
-        m_videoSocket->disconnect();
-        if (m_videoSocket->state() != QAbstractSocket::UnconnectedState) {
-            m_videoSocket->abort();
-        }
-        m_videoSocket->deleteLater();
-        m_videoSocket = nullptr;
-    }
-    if (m_controlSocket) {
-        m_controlSocket->disconnect();
-        if (m_controlSocket->state() != QAbstractSocket::UnconnectedState) {
-            m_controlSocket->abort();
-        }
-        m_controlSocket->deleteLater();
-        m_controlSocket = nullptr;
-    }
+    closeSockets();
     
+    ConnectScheduler::instance().cancel(this);
+
     // ignore failure
     m_serverProcess.kill();
     if (m_tunnelEnabled) {
@@ -347,14 +392,119 @@ void Server::stop()
         m_tunnelForward = false;
         m_tunnelEnabled = false;
     }
-    m_serverSocket.close();
+    releaseReverseListener();
     
     // 重置连接计数和状态，以便下次重连
     m_connectCount = 0;
     m_serverStartStep = SSS_NULL;
 }
 
+bool Server::resume()
+{
+    // 只有已经运行过的会话才能恢复，启动中的会话由自身的重试逻辑处理
+    if (SSS_RUNNING != m_serverStartStep && SSS_NULL != m_serverStartStep) {
+        return false;
+    }
+    if (m_params.serial.isEmpty()) {
+        return false;
+    }
+
+    // 先清除步骤，kill 旧的 server 进程时不会再发 serverStoped
+    m_serverStartStep = SSS_NULL;
+    stopAcceptTimeoutTimer();
+    stopConnectTimeoutTimer();
+    stopAsyncTimers();
+    cleanupAsyncSockets();
+    m_asyncState = ACS_IDLE;
+    closeSockets();
+    ConnectScheduler::instance().cancel(this);
+
+    m_connectClock.start();
+    m_connectCount = 0;
+    m_restartCount = 0;
+
+    if (m_params.useDirectTcp) {
+        // 设备端 server 仍在监听，只需重新建立 socket
+        m_serverStartStep = SSS_DIRECT_TCP_CONNECT;
+        return startServerByStep();
+    }
+
+    // scrcpy server 在 socket 断开后会退出，需要重新拉起；
+    // server 文件已推送并校验过，跳过 connect/check/push，从建立隧道开始
+    m_serverProcess.kill();
+    releaseReverseListener();
+    m_tunnelForward = false;
+    m_tunnelEnabled = false;
+    startTunnelStep();
+    return true;
+}
+
+void Server::closeSockets()
+{
+    if (m_videoSocket) {
+        m_videoSocket->disconnect();
+        if (m_videoSocket->state() != QAbstractSocket::UnconnectedState) {
+            m_videoSocket->abort();
+        }
+        m_videoSocket->deleteLater();
+        m_videoSocket = nullptr;
+    }
+    if (m_controlSocket) {
+        m_controlSocket->disconnect();
+        if (m_controlSocket->state() != QAbstractSocket::UnconnectedState) {
+            m_controlSocket->abort();
+        }
+        m_controlSocket->deleteLater();
+        m_controlSocket = nullptr;
+    }
+}
+
 bool Server::startServerByStep()
+{
+    // adb 阶段需要先从调度器拿到名额，直连模式不经过 adb
+    if (SSS_NULL == m_serverStartStep || SSS_DIRECT_TCP_CONNECT == m_serverStartStep) {
+        return runServerStep();
+    }
+    ConnectScheduler::instance().acquire(this, m_params.serial, stepName(m_serverStartStep), [this]() {
+        runServerStep();
+    });
+    return true;
+}
+
+const char *Server::stepName(SERVER_START_STEP step)
+{
+    switch (step) {
+    case SSS_CONNECT:
+        return "connect";
+    case SSS_CHECK_SERVER:
+        return "check";
+    case SSS_PUSH:
+        return "push";
+    case SSS_ENABLE_TUNNEL_REVERSE:
+        return "reverse";
+    case SSS_ENABLE_TUNNEL_FORWARD:
+        return "forward";
+    case SSS_EXECUTE_SERVER:
+        return "execute";
+    default:
+        return "other";
+    }
+}
+
+void Server::recordConnectTiming()
+{
+    if (m_acceptClock.isValid()) {
+        ConnectScheduler::instance().recordStage("accept", m_acceptClock.elapsed());
+        m_acceptClock.invalidate();
+    }
+    if (m_connectClock.isValid()) {
+        ConnectScheduler::instance().recordStage("total", m_connectClock.elapsed());
+        qInfo("server %s started in %lldms", m_params.serial.toUtf8().data(), m_connectClock.elapsed());
+        m_connectClock.invalidate();
+    }
+}
+
+bool Server::runServerStep()
 {
     bool stepSuccess = false;
     // push, enable tunnel et start the server
@@ -363,6 +513,9 @@ bool Server::startServerByStep()
         case SSS_CONNECT:
             stepSuccess = connectDevice();
             break;
+        case SSS_CHECK_SERVER:
+            stepSuccess = checkServer();
+            break;
         case SSS_PUSH:
             stepSuccess = pushServer();
             break;
@@ -386,6 +539,7 @@ bool Server::startServerByStep()
     }
 
     if (!stepSuccess) {
+        ConnectScheduler::instance().release(this);
         emit serverStarted(false);
     }
     return stepSuccess;
@@ -486,7 +640,16 @@ void Server::stopAcceptTimeoutTimer()
 void Server::startConnectTimeoutTimer()
 {
     stopConnectTimeoutTimer();
-    m_connectTimeoutTimer = startTimer(300);
+    scheduleConnectRetry();
+}
+
+void Server::scheduleConnectRetry()
+{
+    if (m_connectTimeoutTimer) {
+        killTimer(m_connectTimeoutTimer);
+        m_connectTimeoutTimer = 0;
+    }
+    m_connectTimeoutTimer = startTimer(ConnectScheduler::backoffMs(m_connectCount, CONNECT_RETRY_BASE_MS, CONNECT_RETRY_MAX_MS));
 }
 
 void Server::stopConnectTimeoutTimer()
@@ -502,8 +665,13 @@ void Server::onConnectTimer()
 {
     // device server need time to start
     // 这里连接太早时间不够导致安卓监听socket还没有建立，readInfo会失败，所以采取定时重试策略
-    // 每隔100ms尝试一次，最多尝试MAX_CONNECT_COUNT次
+    // 重试间隔按次数指数增长（带抖动），最多尝试MAX_CONNECT_COUNT次
     // 使用异步连接，避免阻塞UI线程
+    // 单次定时，失败后由 handleConnectFailure 安排下一次
+    if (m_connectTimeoutTimer) {
+        killTimer(m_connectTimeoutTimer);
+        m_connectTimeoutTimer = 0;
+    }
     if (m_asyncState != ACS_IDLE) {
         // 如果上一次异步连接还在进行中，跳过这次重试
         return;
@@ -866,6 +1034,7 @@ void Server::handleConnectSuccess()
     m_restartCount = 0;
 
     m_asyncState = ACS_COMPLETE;
+    recordConnectTiming();
     emit serverStarted(true, m_pendingDeviceName, m_pendingDeviceSize);
 
     // 清理临时指针（对象已经转移）
@@ -899,6 +1068,7 @@ void Server::handleConnectFailure()
     } else {
         // 未达到最大重试次数，重置状态以便重试
         m_asyncState = ACS_IDLE;
+        scheduleConnectRetry();
     }
 }
 
@@ -1024,6 +1194,7 @@ bool Server::connectDirectTcp()
     m_serverStartStep = SSS_RUNNING;
     m_tunnelEnabled = false;  // 直接TCP模式不使用adb隧道
     m_tunnelForward = false;  // 不使用forward模式
+    m_acceptClock.start();
     
     // 启动异步连接
     startConnectTimeoutTimer();
@@ -1033,12 +1204,22 @@ bool Server::connectDirectTcp()
 
 void Server::onWorkProcessResult(qsc::AdbProcess::ADB_EXEC_RESULT processResult)
 {
+    // 阶段结束（进程退出或 server 进程启动），归还调度名额
+    if (sender() == &m_workProcess && qsc::AdbProcess::AER_SUCCESS_START != processResult) {
+        ConnectScheduler::instance().release(this);
+    }
+    if (sender() == &m_serverProcess && SSS_EXECUTE_SERVER == m_serverStartStep) {
+        ConnectScheduler::instance().release(this);
+    }
+
     if (sender() == &m_workProcess) {
         if (SSS_NULL != m_serverStartStep) {
             switch (m_serverStartStep) {
             case SSS_CONNECT:
                 if (qsc::AdbProcess::AER_SUCCESS_EXEC == processResult) {
-                    m_serverStartStep = SSS_PUSH;
+                    // 本地 md5 可用时先检查远端文件，一致则跳过推送
+                    m_serverMd5 = PushCache::localMd5(m_params.serverLocalPath);
+                    m_serverStartStep = m_serverMd5.isEmpty() ? SSS_PUSH : SSS_CHECK_SERVER;
                     startServerByStep();
                 } else if (qsc::AdbProcess::AER_SUCCESS_START != processResult) {
                     qCritical("adb connect failed");
@@ -1046,15 +1227,23 @@ void Server::onWorkProcessResult(qsc::AdbProcess::ADB_EXEC_RESULT processResult)
                     emit serverStarted(false);
                 }
                 break;
+            case SSS_CHECK_SERVER:
+                if (qsc::AdbProcess::AER_SUCCESS_START == processResult) {
+                    break;
+                }
+                if (qsc::AdbProcess::AER_SUCCESS_EXEC == processResult
+                    && PushCache::remoteMatches(m_workProcess.getStdOut(), m_serverMd5)) {
+                    PushCache::recordHit(m_params.serial);
+                    startTunnelStep();
+                } else {
+                    PushCache::recordMiss(m_params.serial);
+                    m_serverStartStep = SSS_PUSH;
+                    startServerByStep();
+                }
+                break;
             case SSS_PUSH:
                 if (qsc::AdbProcess::AER_SUCCESS_EXEC == processResult) {
-                    if (m_params.useReverse) {
-                        m_serverStartStep = SSS_ENABLE_TUNNEL_REVERSE;
-                    } else {
-                        m_tunnelForward = true;
-                        m_serverStartStep = SSS_ENABLE_TUNNEL_FORWARD;
-                    }
-                    startServerByStep();
+                    startTunnelStep();
                 } else if (qsc::AdbProcess::AER_SUCCESS_START != processResult) {
                     qCritical("adb push failed");
                     m_serverStartStep = SSS_NULL;
@@ -1068,21 +1257,14 @@ void Server::onWorkProcessResult(qsc::AdbProcess::ADB_EXEC_RESULT processResult)
                     // client listens and the server connects to the client. That way, the
                     // client can listen before starting the server app, so there is no need to
                     // try to connect until the server socket is listening on the device.
-                    m_serverSocket.setMaxPendingConnections(2);
-                    if (!m_serverSocket.listen(QHostAddress::LocalHost, m_params.localPort)) {
-                        qCritical() << QString("Could not listen on port %1").arg(m_params.localPort).toStdString().c_str();
-                        m_serverStartStep = SSS_NULL;
-                        disableTunnelReverse();
-                        emit serverStarted(false);
-                        break;
-                    }
-
+                    // 共享监听在 lease 时已经处于监听状态
                     m_serverStartStep = SSS_EXECUTE_SERVER;
                     startServerByStep();
                 } else if (qsc::AdbProcess::AER_SUCCESS_START != processResult) {
                     // 有一些设备reverse会报错more than o'ne device，adb的bug
                     // https://github.com/Genymobile/scrcpy/issues/5
                     qCritical("adb reverse failed");
+                    releaseReverseListener();
                     m_tunnelForward = true;
                     m_serverStartStep = SSS_ENABLE_TUNNEL_FORWARD;
                     startServerByStep();
@@ -1108,10 +1290,11 @@ void Server::onWorkProcessResult(qsc::AdbProcess::ADB_EXEC_RESULT processResult)
             if (qsc::AdbProcess::AER_SUCCESS_START == processResult) {
                 m_serverStartStep = SSS_RUNNING;
                 m_tunnelEnabled = true;
+                m_acceptClock.start();
                 connectTo();
             } else if (qsc::AdbProcess::AER_ERROR_START == processResult) {
                 if (!m_tunnelForward) {
-                    m_serverSocket.close();
+                    releaseReverseListener();
                     disableTunnelReverse();
                 } else {
                     disableTunnelForward();
@@ -6,10 +6,10 @@
 #include <QSize>
 #include <QTimer>
 #include <QAbstractSocket>
+#include <QElapsedTimer>
 #include <QTcpSocket>
 
 #include "adbprocess.h"
-#include "tcpserver.h"
 #include "videosocket.h"
 
 class Server : public QObject
@@ -20,6 +20,7 @@ class Server : public QObject
     {
         SSS_NULL,
         SSS_CONNECT,
+        SSS_CHECK_SERVER,  // 检查远端 server 文件是否与本地一致
         SSS_PUSH,
         SSS_ENABLE_TUNNEL_REVERSE,
         SSS_ENABLE_TUNNEL_FORWARD,
@@ -72,10 +73,17 @@ public:
 
     bool start(Server::ServerParams params);
     void stop();
+    // 会话中途断开后快速恢复：保留已推送的 server 文件，只重建隧道、server 进程和 sockets
+    // 直连模式只重建 sockets。结果同样通过 serverStarted 通知
+    bool resume();
     bool isReverse();
     Server::ServerParams getParams();
     VideoSocket *removeVideoSocket();
     QTcpSocket *getControlSocket();
+    // reverse 模式下借用的共享监听端口，未借用时为 0
+    quint16 reversePort();
+    // 由 ReverseListener 按端口路由过来的连接，第一个是 video socket，第二个是 control socket
+    void onReverseConnection(QTcpSocket *socket);
 
 signals:
     void serverStarted(bool success, const QString &deviceName = "", const QSize &size = QSize());
@@ -89,14 +97,22 @@ protected:
 
 private:
     bool connectDevice();
+    void closeSockets();
+    bool checkServer();
     bool pushServer();
+    void startTunnelStep();
     bool enableTunnelReverse();
+    void releaseReverseListener();
     bool disableTunnelReverse();
     bool enableTunnelForward();
     bool disableTunnelForward();
     bool execute();
     bool connectTo();
     bool startServerByStep();
+    bool runServerStep();
+    static const char *stepName(SERVER_START_STEP step);
+    void recordConnectTiming();
+    void scheduleConnectRetry();
     bool readInfo(VideoSocket *videoSocket, QString &deviceName, QSize &size);
     bool readInfoAsync(VideoSocket *videoSocket);
     void startAcceptTimeoutTimer();
@@ -130,7 +146,7 @@ private:
 private:
     qsc::AdbProcess m_workProcess;
     qsc::AdbProcess m_serverProcess;
-    TcpServer m_serverSocket; // only used if !tunnel_forward
+    quint16 m_reversePort = 0; // only used if !tunnel_forward
     QPointer<VideoSocket> m_videoSocket = Q_NULLPTR;
     QPointer<QTcpSocket> m_controlSocket = Q_NULLPTR;
     // 异步连接临时sockets
@@ -152,6 +168,9 @@ private:
     ServerParams m_params;
 
     SERVER_START_STEP m_serverStartStep = SSS_NULL;
+    QElapsedTimer m_connectClock;
+    QElapsedTimer m_acceptClock;
+    QString m_serverMd5;
 };
 
 #endif // SERVER_H
@@ -10,6 +10,9 @@ public:
     explicit TcpServer(QObject *parent = nullptr);
     virtual ~TcpServer();
 
+    // 重新开始一次会话：下一个连接是 video socket
+    void reset();
+
 protected:
     virtual void incomingConnection(qintptr handle);
 
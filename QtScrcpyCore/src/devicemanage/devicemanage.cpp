@@ -5,6 +5,8 @@
 #include <QMutexLocker>
 
 #include "devicemanage.h"
+#include "connectscheduler.h"
+#include "pushcache.h"
 #include "device.h"
 #include "demuxer.h"
 
@@ -17,8 +19,17 @@ IDeviceManage& IDeviceManage::getInstance() {
     return dm;
 }
 
+QString IDeviceManage::hostOf(const QString &serial) {
+    return ConnectScheduler::hostOf(serial);
+}
+
 DeviceManage::DeviceManage() {
     Demuxer::init();
+    // 端口空闲表，按升序分配，保证低位端口优先被复用
+    m_freePorts.reserve(DM_MAX_DEVICES_NUM);
+    for (int i = DM_MAX_DEVICES_NUM - 1; i >= 0; i--) {
+        m_freePorts.append(static_cast<quint16>(m_localPortStart + i));
+    }
 }
 
 DeviceManage::~DeviceManage() {
@@ -53,9 +64,7 @@ bool DeviceManage::connectDevice(qsc::DeviceParams params)
             // 设备存在但为 nullptr（可能是之前的连接失败留下的），清理它
             qInfo() << "Cleaning up stale device entry:" << params.serial;
             m_devices.remove(params.serial);
-            if (m_allocatedPorts.contains(params.serial)) {
-                m_allocatedPorts.remove(params.serial);
-            }
+            releasePort(params.serial);
         }
     }
     if (DM_MAX_DEVICES_NUM < m_devices.size()) {
@@ -84,11 +93,12 @@ bool DeviceManage::connectDevice(qsc::DeviceParams params)
     IDevice *device = new Device(params);
     connect(device, &Device::deviceConnected, this, &DeviceManage::onDeviceConnected);
     connect(device, &Device::deviceDisconnected, this, &DeviceManage::onDeviceDisconnected);
+    connect(device, &Device::deviceReleased, this, &DeviceManage::deviceReleased);
     if (!device->connectDevice()) {
         // 连接失败，需要清理
         locker.relock();  // 重新加锁
         m_devices.remove(params.serial);  // 从 m_devices 中移除
-        m_allocatedPorts.remove(params.serial);  // 释放端口
+        releasePort(params.serial);  // 释放端口
         locker.unlock();
         delete device;
         return false;
@@ -108,7 +118,7 @@ bool DeviceManage::disconnectDevice(const QString &serial)
     if (!serial.isEmpty() && m_devices.contains(serial)) {
         auto it = m_devices.find(serial);
         if (it->data()) {
-            delete it->data();
+            releaseDevice(it->data());
             ret = true;
         }
     }
@@ -117,15 +127,52 @@ bool DeviceManage::disconnectDevice(const QString &serial)
 
 void DeviceManage::disconnectAllDevice()
 {
-    QMapIterator<QString, QPointer<IDevice>> i(m_devices);
-    while (i.hasNext()) {
-        i.next();
-        if (i.value()) {
-            delete i.value();
+    // 先复制一份，releaseDevice 过程中 deviceDisconnected 会修改 m_devices
+    QList<QPointer<IDevice>> devices = m_devices.values();
+    for (auto &device : devices) {
+        if (device) {
+            releaseDevice(device);
         }
     }
 }
 
+void DeviceManage::releaseDevice(IDevice *device)
+{
+    // 立即返回，线程回收在后台并行进行，完成后由设备发出 deviceReleased
+    Device *dev = qobject_cast<Device *>(device);
+    if (!dev) {
+        delete device;
+        return;
+    }
+    if (dev->releasesItself()) {
+        return;
+    }
+    QString serial = dev->getSerial();
+    dev->disconnectDeviceAsync();
+    // 从未连接成功的设备不会发 deviceDisconnected，这里直接移除
+    if (m_devices.contains(serial)) {
+        removeDevice(serial);
+    } else if (!dev->releasesItself()) {
+        // server 已经停止（包括已同步断开的设备），没有需要回收的线程
+        dev->deleteLater();
+    }
+}
+
+void DeviceManage::setConnectLimits(int globalLimit, int perHostLimit)
+{
+    ConnectScheduler::instance().setLimits(globalLimit, perHostLimit);
+}
+
+QMap<QString, ConnectStageStats> DeviceManage::getConnectStats()
+{
+    return ConnectScheduler::instance().stats();
+}
+
+QMap<QString, PushCacheStats> DeviceManage::getPushCacheStats()
+{
+    return PushCache::stats();
+}
+
 void DeviceManage::onDeviceConnected(bool success, const QString &serial, const QString &deviceName, const QSize &size)
 {
     emit deviceConnected(success, serial, deviceName, size);
@@ -142,52 +189,38 @@ void DeviceManage::onDeviceDisconnected(QString serial)
 
 quint16 DeviceManage::getFreePort()
 {
-    quint16 port = m_localPortStart;
-    while (port < m_localPortStart + DM_MAX_DEVICES_NUM) {
-        bool used = false;
-        
-        // 首先检查已分配的端口（包括未启动的设备）
-        for (auto it = m_allocatedPorts.constBegin(); it != m_allocatedPorts.constEnd(); ++it) {
-            if (it.value() == port) {
-                used = true;
-                break;
-            }
-        }
-        
-        // 如果没有在已分配列表中，再检查已启动设备的实际端口
-        if (!used) {
-            QMapIterator<QString, QPointer<IDevice>> i(m_devices);
-            while (i.hasNext()) {
-                i.next();
-                auto device = i.value();
-                if (device) {
-                    // 检查所有模式的端口使用情况（reverse 和 forward 都需要独立端口）
-                    quint16 devicePort = device->getLocalPort();
-                    if (devicePort == port && devicePort != 0) {
-                        used = true;
-                        break;
-                    }
-                }
-            }
-        }
-        
-        if (!used) {
-            return port;
-        }
-        port++;
+    // 调用方持有 m_portMutex
+    if (m_freePorts.isEmpty()) {
+        return 0;
+    }
+    quint16 port = m_freePorts.last();
+    m_freePorts.removeLast();
+    return port;
+}
+
+void DeviceManage::releasePort(const QString &serial)
+{
+    // 调用方持有 m_portMutex
+    auto it = m_allocatedPorts.find(serial);
+    if (it == m_allocatedPorts.end()) {
+        return;
     }
-    return 0;
+    m_freePorts.append(it.value());
+    m_allocatedPorts.erase(it);
 }
 
 void DeviceManage::removeDevice(const QString &serial)
 {
     QMutexLocker locker(&m_portMutex);
     if (!serial.isEmpty() && m_devices.contains(serial)) {
-        if (m_devices[serial]) {
-            m_devices[serial]->deleteLater();
+        // 先移出 map，重复移除时不会再次释放
+        QPointer<IDevice> device = m_devices.take(serial);
+        releasePort(serial);  // 释放端口
+        // 交给后台回收的设备完成后自行释放，其余（包括已同步断开的）在这里释放
+        Device *dev = qobject_cast<Device *>(device.data());
+        if (device && !(dev && dev->releasesItself())) {
+            device->deleteLater();
         }
-        m_devices.remove(serial);
-        m_allocatedPorts.remove(serial);  // 释放端口
     }
 }
 
@@ -1,8 +1,10 @@
 #ifndef DEVICEMANAGE_H
 #define DEVICEMANAGE_H
 
+#include <QHash>
 #include <QMap>
 #include <QMutex>
+#include <QVector>
 
 #include "../../include/QtScrcpyCore.h"
 
@@ -20,6 +22,9 @@ public:
     bool connectDevice(qsc::DeviceParams params) override;
     bool disconnectDevice(const QString &serial) override;
     void disconnectAllDevice() override;
+    void setConnectLimits(int globalLimit, int perHostLimit) override;
+    QMap<QString, ConnectStageStats> getConnectStats() override;
+    QMap<QString, PushCacheStats> getPushCacheStats() override;
 
 protected slots:
     void onDeviceConnected(bool success, const QString& serial, const QString& deviceName, const QSize& size);
@@ -27,11 +32,14 @@ protected slots:
 
 private:
     quint16 getFreePort();
+    void releaseDevice(IDevice *device);
+    void releasePort(const QString& serial);
     void removeDevice(const QString& serial);
 
 private:
     QMap<QString, QPointer<IDevice>> m_devices;
-    QMap<QString, quint16> m_allocatedPorts;  // 记录已分配的端口（serial -> port），包括未启动的设备
+    QHash<QString, quint16> m_allocatedPorts;  // 记录已分配的端口（serial -> port），包括未启动的设备
+    QVector<quint16> m_freePorts;             // 未分配的端口，栈顶为最小端口
     quint16 m_localPortStart = 27183;
     QString m_script;
     QMutex m_portMutex;  // 保护端口分配和设备添加的并发访问
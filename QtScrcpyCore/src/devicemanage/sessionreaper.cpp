@@ -0,0 +1,60 @@
+#include <QDebug>
+#include <QRunnable>
+
+#include "sessionreaper.h"
+
+// 回收任务大部分时间在等待线程退出，不占 CPU，可以比核数多
+#define REAPER_MAX_THREADS 16
+
+namespace {
+
+class ReapTask : public QRunnable
+{
+public:
+    ReapTask(std::function<void()> work, std::function<void()> done) : m_work(work), m_done(done) {}
+
+    void run() override
+    {
+        if (m_work) {
+            m_work();
+        }
+        m_done();
+    }
+
+private:
+    std::function<void()> m_work;
+    std::function<void()> m_done;
+};
+
+}
+
+SessionReaper &SessionReaper::instance()
+{
+    static SessionReaper reaper;
+    return reaper;
+}
+
+SessionReaper::SessionReaper(QObject *parent) : QObject(parent)
+{
+    m_pool.setMaxThreadCount(REAPER_MAX_THREADS);
+    m_pool.setExpiryTimeout(5000);
+}
+
+void SessionReaper::reap(std::function<void()> work, std::function<void()> finish)
+{
+    m_pending++;
+    m_pool.start(new ReapTask(work, [this, finish]() {
+        // 回到主线程
+        QMetaObject::invokeMethod(this, [this, finish]() {
+            m_pending--;
+            if (finish) {
+                finish();
+            }
+        }, Qt::QueuedConnection);
+    }));
+}
+
+int SessionReaper::pending()
+{
+    return m_pending;
+}
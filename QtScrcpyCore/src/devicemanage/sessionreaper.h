@@ -0,0 +1,31 @@
+#ifndef SESSIONREAPER_H
+#define SESSIONREAPER_H
+
+#include <functional>
+
+#include <QObject>
+#include <QThreadPool>
+
+// 设备会话的后台回收
+// 断开设备时 join demuxer/recorder 线程、写录像 trailer 都会阻塞，
+// 这些工作放到线程池里并行执行，完成后回到主线程执行 finish（释放 QObject、通知完成），
+// 批量断开时 UI 线程不再逐个等待
+class SessionReaper : public QObject
+{
+    Q_OBJECT
+public:
+    static SessionReaper &instance();
+
+    // work 在线程池中执行，完成后 finish 回到主线程执行
+    void reap(std::function<void()> work, std::function<void()> finish);
+    int pending();
+
+private:
+    explicit SessionReaper(QObject *parent = nullptr);
+
+private:
+    QThreadPool m_pool;
+    int m_pending = 0;
+};
+
+#endif // SESSIONREAPER_H
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStandardPaths>
+#include <QString>
+#include <QStringList>
+#include <QVariantList>
+#include <QVariantMap>
+
+/**
+ * @brief 基准测试用的 get_db 数据
+ *
+ * 字段与接口一致；镜像、系统版本、状态、DNS 只有少数几种取值，与真实主机相近。
+ * revision 不为 0 时每 100 台设备有 1 台状态不同，用来模拟增量同步
+ */
+namespace benchdata {
+
+inline QString hostIp(int host)
+{
+    return QString("10.0.%1.%2").arg(host / 200).arg(host % 200 + 10);
+}
+
+inline QString hostId(int host)
+{
+    return QString("host-%1").arg(host);
+}
+
+inline QString dbId(int host, int index)
+{
+    return QString("db-%1-%2").arg(host).arg(index);
+}
+
+inline QString shortId(int host, int index)
+{
+    return QString("S%1%2").arg(host, 3, 10, QChar('0')).arg(index, 5, 10, QChar('0'));
+}
+
+inline QString deviceName(int host, int index)
+{
+    return QString("VM%1%2").arg(host, 3, 10, QChar('0')).arg(index, 5, 10, QChar('0'));
+}
+
+inline QJsonObject makeDevice(int host, int index, int revision = 0)
+{
+    static const QStringList images = {"vcloud_android13_edge_20250601", "vcloud_android12_edge_20250415",
+                                       "vcloud_android10_edge_20241120"};
+    static const QStringList aospVersions = {"13", "12", "10"};
+    bool changed = revision != 0 && index % 100 == revision % 100;
+
+    QJsonObject device;
+    device["id"] = QString("pad-%1").arg(index);
+    device["name"] = deviceName(host, index);
+    device["user_name"] = QString("cloud-phone-%1").arg(index);
+    device["short_id"] = shortId(host, index);
+    device["db_id"] = dbId(host, index);
+    device["image"] = images[index % images.size()];
+    device["state"] = changed ? "stopped" : "running";
+    device["adb"] = 5000 + index % 1000;
+    device["data"] = QString("/data/vmos/pads/%1").arg(index);
+    device["dns"] = "8.8.8.8";
+    device["dpi"] = "320";
+    device["fps"] = "60";
+    device["height"] = "1920";
+    device["width"] = "1080";
+    device["ip"] = QString("172.17.%1.%2").arg(index / 250).arg(index % 250 + 2);
+    device["memory"] = 4096;
+    device["created"] = "2025-06-01 12:00:00";
+    device["aosp_version"] = aospVersions[index % aospVersions.size()];
+    device["host_ip"] = hostIp(host);
+    device["macvlan_ip"] = QString("192.168.%1.%2").arg(index / 250).arg(index % 250 + 2);
+    device["tcp_port"] = 20000 + index * 3;
+    device["tcp_audio_port"] = 20001 + index * 3;
+    device["tcp_control_port"] = 20002 + index * 3;
+    return device;
+}
+
+inline QJsonArray makeDeviceArray(int host, int count, int revision = 0)
+{
+    QJsonArray list;
+    for (int i = 0; i < count; ++i) {
+        list.append(makeDevice(host, i, revision));
+    }
+    return list;
+}
+
+// 完整的 get_db 响应文本
+inline QString makeResponse(int host, int count, int revision = 0)
+{
+    QJsonObject data;
+    data["host_ip"] = hostIp(host);
+    data["list"] = makeDeviceArray(host, count, revision);
+    QJsonObject res;
+    res["code"] = 200;
+    res["msg"] = "success";
+    res["data"] = data;
+    return QString::fromUtf8(QJsonDocument(res).toJson(QJsonDocument::Compact));
+}
+
+inline QVariantMap makeHost(int host)
+{
+    QVariantMap data;
+    data["id"] = hostId(host);
+    data["ip"] = hostIp(host);
+    return data;
+}
+
+// TreeModel 在构造时读取、修改后写回配置文件，基准使用测试目录并从空配置开始
+inline void resetModelConfig()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    QFile::remove(QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + "/treemodel.json");
+}
+
+}
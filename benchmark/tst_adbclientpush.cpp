@@ -0,0 +1,231 @@
+#include <QtTest>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTemporaryDir>
+#include <QtEndian>
+#include "adbclient.h"
+
+static const QString SERIAL = "10.0.0.10:5555";
+// 0040000，目录
+static const quint32 MODE_DIRECTORY = 040000;
+
+/**
+ * @brief 本地替身 adb server，只实现 host:transport、sync: 以及 STAT/SEND/DATA/DONE/QUIT
+ *
+ * directories 里的路径按目录应答 STAT，其他路径按不存在应答（mode 为 0）。
+ * 每次 SEND 完成后记录目标路径和收到的内容
+ */
+class FakeAdbServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FakeAdbServer(QObject *parent = nullptr) : QObject(parent)
+    {
+        connect(&m_server, &QTcpServer::newConnection, this, &FakeAdbServer::onNewConnection);
+    }
+
+    bool listen()
+    {
+        return m_server.listen(QHostAddress::LocalHost, 0);
+    }
+
+    quint16 port() const
+    {
+        return m_server.serverPort();
+    }
+
+    QStringList directories;
+    QStringList statPaths;
+    QStringList sentPaths;
+    QList<QByteArray> sentData;
+
+private:
+    void onNewConnection()
+    {
+        while (QTcpSocket *socket = m_server.nextPendingConnection()) {
+            // 每个连接的状态挂在 socket 上：是否已进入 sync 模式、未解析的数据、正在接收的文件
+            connect(socket, &QTcpSocket::readyRead, this, [this, socket]() { onReadyRead(socket); });
+            connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+        }
+    }
+
+    void onReadyRead(QTcpSocket *socket)
+    {
+        QByteArray buffer = socket->property("buffer").toByteArray() + socket->readAll();
+        while (true) {
+            if (!socket->property("sync").toBool()) {
+                if (buffer.size() < 4) {
+                    break;
+                }
+                int len = buffer.left(4).toInt(nullptr, 16);
+                if (buffer.size() < 4 + len) {
+                    break;
+                }
+                QByteArray request = buffer.mid(4, len);
+                buffer.remove(0, 4 + len);
+                if (request.startsWith("host:transport")) {
+                    socket->write("OKAY");
+                } else if ("sync:" == request) {
+                    socket->write("OKAY");
+                    socket->setProperty("sync", true);
+                } else {
+                    QByteArray message = "unsupported";
+                    socket->write("FAIL" + QString("%1").arg(message.size(), 4, 16, QChar('0')).toLatin1() + message);
+                }
+                continue;
+            }
+
+            if (buffer.size() < 8) {
+                break;
+            }
+            QByteArray id = buffer.left(4);
+            quint32 arg = qFromLittleEndian<quint32>(reinterpret_cast<const uchar *>(buffer.constData() + 4));
+            // DONE 的参数是 mtime，QUIT 没有内容
+            quint32 len = ("DONE" == id || "QUIT" == id) ? 0 : arg;
+            if (static_cast<quint32>(buffer.size()) < 8 + len) {
+                break;
+            }
+            QByteArray payload = buffer.mid(8, static_cast<int>(len));
+            buffer.remove(0, 8 + static_cast<int>(len));
+
+            if ("STAT" == id) {
+                QString path = QString::fromUtf8(payload);
+                statPaths.append(path);
+                writeSync(socket, "STAT", directories.contains(path) ? MODE_DIRECTORY : 0);
+                socket->write(QByteArray(8, '\0'));
+            } else if ("SEND" == id) {
+                QString spec = QString::fromUtf8(payload);
+                socket->setProperty("path", spec.left(spec.lastIndexOf(',')));
+                socket->setProperty("data", QByteArray());
+            } else if ("DATA" == id) {
+                socket->setProperty("data", socket->property("data").toByteArray() + payload);
+            } else if ("DONE" == id) {
+                sentPaths.append(socket->property("path").toString());
+                sentData.append(socket->property("data").toByteArray());
+                writeSync(socket, "OKAY", 0);
+            } else if ("QUIT" == id) {
+                socket->disconnectFromHost();
+                buffer.clear();
+                break;
+            }
+        }
+        socket->setProperty("buffer", buffer);
+    }
+
+    static void writeSync(QTcpSocket *socket, const char *id, quint32 arg)
+    {
+        uchar le[4];
+        qToLittleEndian<quint32>(arg, le);
+        socket->write(QByteArray(id, 4) + QByteArray(reinterpret_cast<const char *>(le), 4));
+    }
+
+    QTcpServer m_server;
+};
+
+/**
+ * @brief AdbClient 通过 sync 协议推送文件
+ *
+ * 目标是目录时推送为目录下的同名文件，是文件路径（或不存在）时原样使用
+ */
+class tst_AdbClientPush : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void init();
+    void pushToDirectory();
+    void pushToDirectoryWithSlash();
+    void pushToFilePath();
+    void pushDataToDirectory();
+
+private:
+    static bool waitFinished(AdbClient &client);
+
+    FakeAdbServer *m_server = nullptr;
+    QTemporaryDir m_dir;
+    QString m_localFile;
+    QByteArray m_content;
+};
+
+void tst_AdbClientPush::initTestCase()
+{
+    m_server = new FakeAdbServer(this);
+    QVERIFY(m_server->listen());
+    qputenv("ANDROID_ADB_SERVER_PORT", QByteArray::number(m_server->port()));
+    QCOMPARE(AdbClient::serverPort(), m_server->port());
+
+    // 超过一个 DATA 包，覆盖分包
+    m_content.reserve(200 * 1024);
+    for (int i = 0; i < 200 * 1024; ++i) {
+        m_content.append(static_cast<char>(i % 251));
+    }
+    QVERIFY(m_dir.isValid());
+    m_localFile = m_dir.filePath("payload.bin");
+    QFile file(m_localFile);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    QCOMPARE(file.write(m_content), qint64(m_content.size()));
+    file.close();
+}
+
+void tst_AdbClientPush::init()
+{
+    m_server->directories = QStringList() << "/sdcard/Download";
+    m_server->statPaths.clear();
+    m_server->sentPaths.clear();
+    m_server->sentData.clear();
+}
+
+bool tst_AdbClientPush::waitFinished(AdbClient &client)
+{
+    bool success = false;
+    QObject::connect(&client, &AdbClient::adbClientResult, [&success](qsc::AdbProcess::ADB_EXEC_RESULT result) {
+        if (qsc::AdbProcess::AER_SUCCESS_EXEC == result) {
+            success = true;
+        }
+    });
+    return QTest::qWaitFor([&client]() { return !client.isRuning(); }, 5000) && success;
+}
+
+void tst_AdbClientPush::pushToDirectory()
+{
+    AdbClient client;
+    QVERIFY(client.execute(SERIAL, QStringList() << "push" << m_localFile << "/sdcard/Download"));
+    QVERIFY2(waitFinished(client), qPrintable(client.getErrorOut()));
+    QCOMPARE(m_server->statPaths, QStringList() << "/sdcard/Download");
+    QCOMPARE(m_server->sentPaths, QStringList() << "/sdcard/Download/payload.bin");
+    QCOMPARE(m_server->sentData.value(0), m_content);
+}
+
+void tst_AdbClientPush::pushToDirectoryWithSlash()
+{
+    AdbClient client;
+    QVERIFY(client.execute(SERIAL, QStringList() << "push" << m_localFile << "/sdcard/Download/"));
+    QVERIFY2(waitFinished(client), qPrintable(client.getErrorOut()));
+    QCOMPARE(m_server->sentPaths, QStringList() << "/sdcard/Download/payload.bin");
+    QCOMPARE(m_server->sentData.value(0), m_content);
+}
+
+void tst_AdbClientPush::pushToFilePath()
+{
+    AdbClient client;
+    QVERIFY(client.execute(SERIAL, QStringList() << "push" << m_localFile << "/sdcard/Download/renamed.bin"));
+    QVERIFY2(waitFinished(client), qPrintable(client.getErrorOut()));
+    QCOMPARE(m_server->sentPaths, QStringList() << "/sdcard/Download/renamed.bin");
+    QCOMPARE(m_server->sentData.value(0), m_content);
+}
+
+void tst_AdbClientPush::pushDataToDirectory()
+{
+    AdbClient client;
+    QVERIFY(client.pushData(SERIAL, reinterpret_cast<const uchar *>(m_content.constData()), m_content.size(),
+                            "/sdcard/Download", "shared.bin", 0));
+    QVERIFY2(waitFinished(client), qPrintable(client.getErrorOut()));
+    QCOMPARE(m_server->sentPaths, QStringList() << "/sdcard/Download/shared.bin");
+    QCOMPARE(m_server->sentData.value(0), m_content);
+}
+
+QTEST_GUILESS_MAIN(tst_AdbClientPush)
+
+#include "tst_adbclientpush.moc"
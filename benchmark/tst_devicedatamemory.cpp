@@ -0,0 +1,199 @@
+#include <QtTest>
+#include "benchdata.h"
+#include "treemodel.h"
+#include "helper/StringPool.h"
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#include <psapi.h>
+#elif defined(Q_OS_MACOS)
+#include <malloc/malloc.h>
+#elif defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+static const int HOST_COUNT = 100;
+static const int DEVICES_PER_HOST = 200;
+
+// 改为紧凑布局之前的 DeviceData，字段和顺序保持原样，用来对比
+struct LegacyDeviceData {
+    int groupId;
+    QString hostId;
+    int adb;
+    QString data;
+    QString dbId;
+    QString dns;
+    QString dpi;
+    QString fps;
+    QString height;
+    QString id;
+    QString image;
+    QString ip;
+    int memory;
+    QString name;
+    QString displayName;
+    QString shortId;
+    QString state;
+    QString created;
+    QString width;
+    QString aospVersion;
+    QString hostIp;
+    bool checked;
+    bool selected;
+    bool refresh;
+    int tcpVideoPort;
+    int tcpAudioPort;
+    int tcpControlPort;
+    QString macvlanIp;
+};
+
+// 原来的 parseDevice：数值字段按字符串保存，字符串不去重
+static void parseLegacyDevice(const QJsonObject &padObject, LegacyDeviceData &device)
+{
+    device.id = padObject["id"].toString();
+    device.name = padObject["name"].toString();
+    device.displayName = padObject["user_name"].toString();
+    device.shortId = padObject["short_id"].toString();
+    device.dbId = padObject["db_id"].toString();
+    device.image = padObject["image"].toString();
+    device.state = padObject["state"].toString();
+    device.adb = padObject["adb"].toInt();
+    device.data = padObject["data"].toString();
+    device.dns = padObject["dns"].toString();
+    device.dpi = padObject["dpi"].toString();
+    device.fps = padObject["fps"].toString();
+    device.height = padObject["height"].toString();
+    device.ip = padObject["ip"].toString();
+    device.memory = padObject["memory"].toInt();
+    device.created = padObject["created"].toString();
+    device.width = padObject["width"].toString();
+    device.aospVersion = padObject["aosp_version"].toString();
+    device.hostIp = padObject["host_ip"].toString();
+    device.macvlanIp = padObject["macvlan_ip"].toString();
+    device.tcpVideoPort = padObject["tcp_port"].toInt();
+    device.tcpAudioPort = padObject["tcp_audio_port"].toInt();
+    device.tcpControlPort = padObject["tcp_control_port"].toInt();
+    device.checked = false;
+    device.selected = false;
+    device.refresh = false;
+}
+
+// 当前进程堆上已分配的字节数，不支持的平台返回 -1
+static qint64 heapBytes()
+{
+#if defined(Q_OS_WIN)
+    // 进程私有提交内存，包含堆里已释放未归还的部分，只能看量级
+    PROCESS_MEMORY_COUNTERS_EX counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), reinterpret_cast<PROCESS_MEMORY_COUNTERS *>(&counters), sizeof(counters))) {
+        return -1;
+    }
+    return static_cast<qint64>(counters.PrivateUsage);
+#elif defined(Q_OS_MACOS)
+    malloc_statistics_t stats;
+    malloc_zone_statistics(nullptr, &stats);
+    return static_cast<qint64>(stats.size_in_use);
+#elif defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    struct mallinfo2 info = mallinfo2();
+    return static_cast<qint64>(info.uordblks + info.hblkhd);
+#elif defined(__GLIBC__)
+    struct mallinfo info = mallinfo();
+    return static_cast<qint64>(info.uordblks) + static_cast<qint64>(info.hblkhd);
+#else
+    return -1;
+#endif
+}
+
+/**
+ * @brief 20k 台设备（100 台主机 × 200 台）的内存占用
+ *
+ * 对比改动前后 DeviceData 列表本身的堆占用，以及装满 20k 台设备的 TreeModel 的总占用。
+ * 输入 JSON 在测量前释放，只统计解析结果
+ */
+class tst_DeviceDataMemory : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void deviceList();
+    void model();
+};
+
+template <typename T, typename Parse>
+static QList<T> parseHost(int host, Parse parse)
+{
+    QList<T> devices;
+    devices.reserve(DEVICES_PER_HOST);
+    const QJsonArray list = benchdata::makeDeviceArray(host, DEVICES_PER_HOST);
+    for (const QJsonValue &value : list) {
+        T device;
+        parse(value.toObject(), device);
+        devices.append(device);
+    }
+    return devices;
+}
+
+void tst_DeviceDataMemory::initTestCase()
+{
+    if (heapBytes() < 0) {
+        QSKIP("heap statistics are not available on this platform");
+    }
+    // 先填好字符串池，池里只有少数几个字符串，不计入每台设备的占用
+    parseHost<DeviceData>(0, &TreeModel::parseDevice);
+}
+
+void tst_DeviceDataMemory::deviceList()
+{
+    const int total = HOST_COUNT * DEVICES_PER_HOST;
+
+    qint64 before = heapBytes();
+    QList<QList<LegacyDeviceData>> legacy;
+    for (int host = 0; host < HOST_COUNT; ++host) {
+        legacy.append(parseHost<LegacyDeviceData>(host, &parseLegacyDevice));
+    }
+    qint64 legacyBytes = heapBytes() - before;
+    legacy.clear();
+
+    before = heapBytes();
+    QList<QList<DeviceData>> compact;
+    for (int host = 0; host < HOST_COUNT; ++host) {
+        compact.append(parseHost<DeviceData>(host, &TreeModel::parseDevice));
+    }
+    qint64 compactBytes = heapBytes() - before;
+
+    qInfo("sizeof: legacy %d B, compact %d B", int(sizeof(LegacyDeviceData)), int(sizeof(DeviceData)));
+    qInfo("%d devices: legacy %lld B (%lld B/device), compact %lld B (%lld B/device), interned strings %d",
+          total, legacyBytes, legacyBytes / total, compactBytes, compactBytes / total, StringPool::size());
+    QVERIFY(compactBytes < legacyBytes);
+}
+
+void tst_DeviceDataMemory::model()
+{
+    const int total = HOST_COUNT * DEVICES_PER_HOST;
+    benchdata::resetModelConfig();
+
+    qint64 before = heapBytes();
+    TreeModel *model = new TreeModel(this);
+    {
+        // 差异在作用域内释放，模型里的字符串不再与它共享
+        model->beginTransaction();
+        for (int host = 0; host < HOST_COUNT; ++host) {
+            DeviceListDelta delta;
+            delta.hostIp = benchdata::hostIp(host);
+            delta.full = true;
+            delta.changed = parseHost<DeviceData>(host, &TreeModel::parseDevice);
+            model->addHost(benchdata::makeHost(host));
+            model->applyDeviceDelta(delta);
+        }
+        model->commitTransaction();
+    }
+    qint64 modelBytes = heapBytes() - before;
+
+    qInfo("model with %d devices: %lld B (%lld B/device)", total, modelBytes, modelBytes / total);
+    QCOMPARE(model->getRunningDeviceCount(benchdata::hostIp(HOST_COUNT - 1)), DEVICES_PER_HOST);
+    delete model;
+}
+
+QTEST_GUILESS_MAIN(tst_DeviceDataMemory)
+
+#include "tst_devicedatamemory.moc"
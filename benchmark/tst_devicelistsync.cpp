@@ -0,0 +1,150 @@
+#include <QtTest>
+#include "benchdata.h"
+#include "treemodel.h"
+#include "helper/DeviceListSync.h"
+
+static const int HOST = 0;
+static const int DEVICE_COUNT = 10000;
+
+/**
+ * @brief 单台主机 10k 设备的 get_db 同步
+ *
+ * parse* 是工作线程上的耗时，apply* 是主线程上的耗时。
+ * legacyVariantList 是原来的路径：JSON 转 QVariantList（QML 里 JSON.parse 的结果）后交给
+ * updateDeviceList，转换和比对全部在主线程
+ */
+class tst_DeviceListSync : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void parseFull();
+    void parseUnchanged();
+    void parseIncremental();
+    void applyInitial();
+    void applyFullUnchanged();
+    void applyIncremental();
+    void legacyVariantList();
+
+private:
+    static DeviceListSync::ParseResult parseAll(const QString &response);
+    TreeModel *createModel();
+
+    QString m_response;
+    QString m_changedResponse;
+};
+
+void tst_DeviceListSync::initTestCase()
+{
+    m_response = benchdata::makeResponse(HOST, DEVICE_COUNT);
+    m_changedResponse = benchdata::makeResponse(HOST, DEVICE_COUNT, 1);
+    qInfo() << "response bytes:" << m_response.toUtf8().size();
+}
+
+DeviceListSync::ParseResult tst_DeviceListSync::parseAll(const QString &response)
+{
+    return DeviceListSync::parse(benchdata::hostIp(HOST), response, 0, QHash<QString, size_t>(), true);
+}
+
+TreeModel *tst_DeviceListSync::createModel()
+{
+    benchdata::resetModelConfig();
+    TreeModel *model = new TreeModel(this);
+    model->addHost(benchdata::makeHost(HOST));
+    return model;
+}
+
+void tst_DeviceListSync::parseFull()
+{
+    DeviceListSync::ParseResult parsed;
+    QBENCHMARK {
+        parsed = parseAll(m_response);
+    }
+    QVERIFY(parsed.ok);
+    QCOMPARE(int(parsed.delta.changed.size()), DEVICE_COUNT);
+}
+
+void tst_DeviceListSync::parseUnchanged()
+{
+    DeviceListSync::ParseResult last = parseAll(m_response);
+    DeviceListSync::ParseResult parsed;
+    QBENCHMARK {
+        parsed = DeviceListSync::parse(benchdata::hostIp(HOST), m_response, last.payloadHash, last.recordHashes, false);
+    }
+    QVERIFY(parsed.skipped);
+}
+
+void tst_DeviceListSync::parseIncremental()
+{
+    DeviceListSync::ParseResult last = parseAll(m_response);
+    DeviceListSync::ParseResult parsed;
+    QBENCHMARK {
+        parsed = DeviceListSync::parse(benchdata::hostIp(HOST), m_changedResponse, last.payloadHash, last.recordHashes, false);
+    }
+    QVERIFY(!parsed.skipped);
+    QCOMPARE(int(parsed.delta.changed.size()), DEVICE_COUNT / 100);
+    QVERIFY(parsed.delta.removed.isEmpty());
+}
+
+void tst_DeviceListSync::applyInitial()
+{
+    // 空主机第一次同步，每轮都要新模型，只测一次
+    DeviceListSync::ParseResult parsed = parseAll(m_response);
+    TreeModel *model = createModel();
+    QBENCHMARK_ONCE {
+        model->applyDeviceDelta(parsed.delta);
+    }
+    QCOMPARE(model->getRunningDeviceCount(benchdata::hostIp(HOST)), DEVICE_COUNT);
+    delete model;
+}
+
+void tst_DeviceListSync::applyFullUnchanged()
+{
+    // 定期全量同步，服务端数据没有变化
+    DeviceListSync::ParseResult parsed = parseAll(m_response);
+    TreeModel *model = createModel();
+    model->applyDeviceDelta(parsed.delta);
+    QBENCHMARK {
+        model->applyDeviceDelta(parsed.delta);
+    }
+    QCOMPARE(model->getRunningDeviceCount(benchdata::hostIp(HOST)), DEVICE_COUNT);
+    delete model;
+}
+
+void tst_DeviceListSync::applyIncremental()
+{
+    // 1% 设备状态变化，每轮来回各应用一次，两次都有实际改动
+    DeviceListSync::ParseResult base = parseAll(m_response);
+    DeviceListSync::ParseResult changed = parseAll(m_changedResponse);
+    DeviceListSync::ParseResult forward = DeviceListSync::parse(benchdata::hostIp(HOST), m_changedResponse,
+                                                                base.payloadHash, base.recordHashes, false);
+    DeviceListSync::ParseResult backward = DeviceListSync::parse(benchdata::hostIp(HOST), m_response,
+                                                                 changed.payloadHash, changed.recordHashes, false);
+    TreeModel *model = createModel();
+    model->applyDeviceDelta(base.delta);
+    QBENCHMARK {
+        model->applyDeviceDelta(forward.delta);
+        model->applyDeviceDelta(backward.delta);
+    }
+    QCOMPARE(model->getRunningDeviceCount(benchdata::hostIp(HOST)), DEVICE_COUNT);
+    delete model;
+}
+
+void tst_DeviceListSync::legacyVariantList()
+{
+    TreeModel *model = createModel();
+    model->applyDeviceDelta(parseAll(m_response).delta);
+    QByteArray payload = m_response.toUtf8();
+    QBENCHMARK {
+        QJsonObject res = QJsonDocument::fromJson(payload).object();
+        QVariantList list = res.value("data").toObject().value("list").toArray().toVariantList();
+        model->updateDeviceList(benchdata::hostIp(HOST), list);
+    }
+    QCOMPARE(model->getRunningDeviceCount(benchdata::hostIp(HOST)), DEVICE_COUNT);
+    delete model;
+}
+
+QTEST_GUILESS_MAIN(tst_DeviceListSync)
+
+#include "tst_devicelistsync.moc"
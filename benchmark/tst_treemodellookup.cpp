@@ -0,0 +1,169 @@
+#include <QtTest>
+#include <utility>
+#include "benchdata.h"
+#include "treemodel.h"
+
+static const int HOST_COUNT = 50;
+static const int DEVICES_PER_HOST = 200;
+
+/**
+ * @brief 50 台主机 × 200 台设备的模型查找与刷新
+ *
+ * 查找/修改用例每轮按 dbId、shortId 或名称访问全部 10k 台设备各一次。修改类调用放在
+ * 一个事务里，配置文件只在提交时写一次
+ */
+class tst_TreeModelLookup : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void populate();
+    void lookupCheckedByDbId();
+    void updateByDbId();
+    void modifyByShortId();
+    void modifyByName();
+    void refreshAllHosts();
+
+private:
+    static DeviceListDelta makeDelta(int host);
+    void fillModel(TreeModel *model);
+
+    TreeModel *m_model = nullptr;
+    QList<DeviceListDelta> m_deltas;
+    // 查找用的 key 预先生成，不计入查找耗时
+    QStringList m_dbIds;
+    QStringList m_shortIds;
+    QStringList m_names;
+    bool m_flag = false;
+};
+
+DeviceListDelta tst_TreeModelLookup::makeDelta(int host)
+{
+    DeviceListDelta delta;
+    delta.hostIp = benchdata::hostIp(host);
+    delta.full = true;
+    const QJsonArray list = benchdata::makeDeviceArray(host, DEVICES_PER_HOST);
+    delta.changed.reserve(list.size());
+    for (const QJsonValue &value : list) {
+        DeviceData device;
+        TreeModel::parseDevice(value.toObject(), device);
+        delta.changed.append(device);
+    }
+    return delta;
+}
+
+void tst_TreeModelLookup::fillModel(TreeModel *model)
+{
+    model->beginTransaction();
+    for (int host = 0; host < HOST_COUNT; ++host) {
+        model->addHost(benchdata::makeHost(host));
+        model->applyDeviceDelta(m_deltas[host]);
+    }
+    model->commitTransaction();
+}
+
+void tst_TreeModelLookup::initTestCase()
+{
+    for (int host = 0; host < HOST_COUNT; ++host) {
+        m_deltas.append(makeDelta(host));
+        for (int i = 0; i < DEVICES_PER_HOST; ++i) {
+            m_dbIds.append(benchdata::dbId(host, i));
+            m_shortIds.append(benchdata::shortId(host, i));
+            m_names.append(benchdata::deviceName(host, i));
+        }
+    }
+    benchdata::resetModelConfig();
+    m_model = new TreeModel(this);
+    fillModel(m_model);
+    for (int host = 0; host < HOST_COUNT; ++host) {
+        QCOMPARE(m_model->getRunningDeviceCount(benchdata::hostIp(host)), DEVICES_PER_HOST);
+    }
+}
+
+void tst_TreeModelLookup::cleanupTestCase()
+{
+    delete m_model;
+    m_model = nullptr;
+}
+
+void tst_TreeModelLookup::populate()
+{
+    // 空模型一次加入全部主机和设备，每轮都要新模型，只测一次
+    benchdata::resetModelConfig();
+    TreeModel model;
+    QBENCHMARK_ONCE {
+        fillModel(&model);
+    }
+    QCOMPARE(model.getRunningDeviceCount(benchdata::hostIp(HOST_COUNT - 1)), DEVICES_PER_HOST);
+}
+
+void tst_TreeModelLookup::lookupCheckedByDbId()
+{
+    int checked = 0;
+    QBENCHMARK {
+        checked = 0;
+        for (const QString &dbId : std::as_const(m_dbIds)) {
+            checked += m_model->isDeviceChecked(dbId) ? 1 : 0;
+        }
+    }
+    QCOMPARE(checked, 0);
+}
+
+void tst_TreeModelLookup::updateByDbId()
+{
+    QBENCHMARK {
+        // 每轮翻转一次，保证每次调用都有实际修改
+        QVariantMap data;
+        data["refresh"] = (m_flag = !m_flag);
+        m_model->beginTransaction();
+        for (const QString &dbId : std::as_const(m_dbIds)) {
+            m_model->updateDevice(dbId, data);
+        }
+        m_model->commitTransaction();
+    }
+}
+
+void tst_TreeModelLookup::modifyByShortId()
+{
+    QBENCHMARK {
+        QVariantMap data;
+        data["refresh"] = (m_flag = !m_flag);
+        m_model->beginTransaction();
+        for (const QString &shortId : std::as_const(m_shortIds)) {
+            m_model->modifyDeviceEx(shortId, data);
+        }
+        m_model->commitTransaction();
+    }
+}
+
+void tst_TreeModelLookup::modifyByName()
+{
+    QBENCHMARK {
+        QVariantMap data;
+        data["refresh"] = (m_flag = !m_flag);
+        m_model->beginTransaction();
+        for (const QString &name : std::as_const(m_names)) {
+            m_model->modifyDevice(name, data);
+        }
+        m_model->commitTransaction();
+    }
+}
+
+void tst_TreeModelLookup::refreshAllHosts()
+{
+    // 每台主机一次全量刷新，服务端数据没有变化
+    QBENCHMARK {
+        m_model->beginTransaction();
+        for (int host = 0; host < HOST_COUNT; ++host) {
+            m_model->applyDeviceDelta(m_deltas[host]);
+        }
+        m_model->commitTransaction();
+    }
+    QCOMPARE(m_model->getRunningDeviceCount(benchdata::hostIp(0)), DEVICES_PER_HOST);
+}
+
+QTEST_GUILESS_MAIN(tst_TreeModelLookup)
+
+#include "tst_treemodellookup.moc"
@@ -1689,6 +1689,7 @@ FluPopup {
         if (!guardStorageOrWarn()) return
         console.log("[创建云机] 准备上传镜像:", path, "size=", fileCopyManager.getFileSize(path))
         Network.postForm(`http://${ip}:18182/v1` + "/import_image")
+        .setStreamChunks(true)
         .setRetry(1)
         .addFile("file", path)
         .setUserData(ip)
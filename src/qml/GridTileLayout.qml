@@ -37,6 +37,7 @@ Item {
         const bool_control = tcpControlPort > 0
         
         Network.postJson(url)
+        .setPriority(NetworkParams.PriorityInteractive)
         .bind(root)
         .setTimeout(5000)
         .add("db_id", dbId)
@@ -159,60 +160,6 @@ Item {
         return null;
     }
 
-    function updateScreenshotImage() {
-        if (!gridView.contentItem || !model) {
-            console.log("GridView contentItem or model not ready for screenshot update.");
-            return;
-        }
-
-        var visibleCount = 0;
-        var totalCount = gridView.contentItem.children.length;
-        
-        // 只遍历一次，同时进行可见性检查和截图更新
-        for (var i = 0; i < totalCount; i++) {
-            var delegateItem = gridView.contentItem.children[i];
-            var modelIndex = gridView.indexAt(delegateItem.x, delegateItem.y);
-
-            // 快速跳过无效项
-            if (modelIndex === -1 || !delegateItem.visible) {
-                continue;
-            }
-
-            // 将delegateItem的坐标映射到gridView的坐标系
-            var topLeftInView = delegateItem.mapToItem(gridView, 0, 0);
-
-            // 检查item是否在可视区域内
-            if (topLeftInView.x + delegateItem.width > 0 && topLeftInView.x < gridView.width &&
-                    topLeftInView.y + delegateItem.height > 0 && topLeftInView.y < gridView.height) {
-                
-                visibleCount++;
-                
-                if (delegateItem.img1 && delegateItem.modelData) {
-                    var modelData = delegateItem.modelData;
-                    // console.log("Updating screenshot for item", i, "dbId:", delegateItem.dbId, "modelData.name:", modelData?.name, "modelData.hostIp:", modelData?.hostIp);
-                    if(modelData.state !== "running"){
-                        continue
-                    }
-
-                    // 添加时间戳参数避免缓存，确保每个设备获取独立的截图
-                    var timestamp = new Date().getTime();
-                    var dbId = modelData?.dbId || modelData?.db_id || modelData?.name;
-                    var screenshotUrl = `http://${modelData?.hostIp}:18182/container_api/v1/screenshots/${dbId}?t=${timestamp}`;
-                    // console.log("===========url: ", dbId, screenshotUrl);
-                    
-                    // 只有当URL真正改变时才更新，避免重复请求
-                    if (delegateItem.img1.imageUrl !== screenshotUrl) {
-                        delegateItem.img1.imageUrl = screenshotUrl;
-                    }
-                } else {
-                    // console.log("Item", i, "not ready for screenshot update:", "img1:", !!delegateItem.img1, "modelData:", !!delegateItem.modelData);
-                }
-            }
-        }
-        
-        // console.log("Updated screenshots for", visibleCount, "visible items out of", totalCount, "total children");
-    }
-
     function selectItemsInRect(x, y, width, height, container) {
         if (!gridView.contentItem) return;
         // var currentModel = model;
@@ -350,7 +297,10 @@ Item {
                             Layout.preferredWidth: root.viewDirection == 0 ? root.itemWidth  : root.itemHeight
                             Layout.preferredHeight: root.viewDirection == 0 ? root.itemHeight : root.itemWidth
                             rotation: root.viewDirection == 0 ? 0 : 270
-                            imageUrl: `http://${model?.hostIp}:18182/container_api/v1/screenshots/${model?.dbId || model?.db_id || model?.name}?t=${new Date().getTime()}`
+                            // 刷新由 ThumbnailService 按可见性调度，地址不再带时间戳；未运行的设备没有截图，地址置空即退订
+                            imageUrl: model?.state === "running" ? `http://${model?.hostIp}:18182/container_api/v1/screenshots/${model?.dbId || model?.db_id || model?.name}` : 
+                            // 与点击连接时的序列号一致，会话存在时缩略图取自视频流
+                            serial: AppConfig.useDirectTcp ? (model?.dbId || model?.db_id || model?.name || "") : `${model?.hostIp}:${model?.adb || 0}`
 
                             Image{
                                 anchors.fill: parent
@@ -77,8 +77,7 @@ FluWindow {
 
         // 扫描主机
         scanner.startDiscovery(1000)
-        phoneListTimer.start()
-        deviceListTimer.start()
+        deviceListSync.start()
         
         // 初始化CBS文件
         initCbsFile()
@@ -386,11 +385,7 @@ FluWindow {
     }
 
     function updateDeviceList(){
-        const hostList = treeModel.hostList()
-        hostList.forEach(
-                    item=>{
-                        reqDeviceListWithoutLoading(item.ip)
-                    })
+        deviceListSync.syncNow()
     }
 
     function validateName(name){
@@ -3090,6 +3085,7 @@ FluWindow {
     // 检查更新
     function reqCheckVersion(channel, versionCode){
         Network.get(AppConfig.apiHost + "/pcVersion/pcCheckForceUpdateInfo?channelName=" + channel + "&versionCode=" + versionCode)
+        .setPriority(NetworkParams.PriorityBackground)
         .bind(root)
         .setUserData(ip)
         .go(checkVersion)
@@ -3149,6 +3145,7 @@ FluWindow {
     // 重启主机
     function reqRebootForArm(ip){
         Network.get(`http://${ip}:18182/v1` + "/reboot_for_arm")
+        .setPriority(NetworkParams.PriorityInteractive)
         .bind(root)
         .setUserData(ip)
         .go(rebootForArm)
@@ -3181,6 +3178,7 @@ FluWindow {
     // 重置主机
     function reqReset(ip){
         Network.get(`http://${ip}:18182/v1` + "/reset")
+        .setPriority(NetworkParams.PriorityInteractive)
         .bind(root)
         .setUserData(ip)
         .setTimeout(300000)
@@ -3265,38 +3263,24 @@ FluWindow {
     // 获取云机列表
     function reqDeviceList(ip){
         Network.postJson(`http://${ip}:18182/container_api/v1` + "/get_db")
+        .setPriority(NetworkParams.PriorityBackground)
         .bind(root)
         .setTimeout(2000)
         .setUserData(ip)
         .go(deviceList)
     }
 
-    NetworkCallable {
-        id: deviceListWithoutLoading
-        onError:
-            (status, errorString, result, userData) => {
-                console.debug(status + ";" + errorString + ";" + result)
-                treeModel.modifyHost(userData, {state:"offline"})
-            }
-        onSuccess:
-            (result, userData) => {
-                var res = JSON.parse(result)
-                if(res.code === 200){
-                    treeModel.modifyHost(res.data.host_ip, {state:"online"})
-                    treeModel.updateDeviceList(res.data.host_ip, res.data.list ?? [])
-                }else{
-                    showError(res.msg)
-                }
-            }
+    Connections {
+        target: deviceListSync
+
+        function onSyncError(hostIp, message){
+            showError(message)
+        }
     }
 
-    // 获取云机列表
+    // 获取云机列表：由 deviceListSync 全量同步该主机，轮询也由它按变化频率调度
     function reqDeviceListWithoutLoading(ip){
-        Network.postJson(`http://${ip}:18182/container_api/v1` + "/get_db")
-        .bind(root)
-        .setTimeout(2000)
-        .setUserData(ip)
-        .go(deviceListWithoutLoading)
+        deviceListSync.syncHost(ip)
     }
 
     NetworkCallable {
@@ -3326,6 +3310,7 @@ FluWindow {
     // 删除云机
     function reqDeleteDevice(ip, padNames){
         Network.postJson(`http://${ip}:18182/container_api/v1` + "/delete")
+        .setPriority(NetworkParams.PriorityInteractive)
         .addList("db_ids", padNames)
         .bind(root)
         .setTimeout(300000)
@@ -3360,6 +3345,7 @@ FluWindow {
     // 重启云机
     function reqRebootDevice(ip, padNames){
         Network.postJson(`http://${ip}:18182/container_api/v1` + "/reboot")
+        .setPriority(NetworkParams.PriorityInteractive)
         .addList("db_ids", padNames)
         .bind(root)
         .setUserData(ip)
@@ -3393,6 +3379,7 @@ FluWindow {
     // 重置云机
     function reqResetDevice(ip, padNames){
         Network.postJson(`http://${ip}:18182/container_api/v1` + "/reset")
+        .setPriority(NetworkParams.PriorityInteractive)
         .addList("db_ids", padNames)
         .bind(root)
         .setUserData(ip)
@@ -3426,6 +3413,7 @@ FluWindow {
     // 启动云机
     function reqRunDevice(ip, padNames){
         Network.postJson(`http://${ip}:18182/container_api/v1` + "/run")
+        .setPriority(NetworkParams.PriorityInteractive)
         .addList("db_ids", padNames)
         .bind(root)
         .setUserData(ip)
@@ -3459,6 +3447,7 @@ FluWindow {
     // 停止云机
     function reqStopDevice(ip, padNames){
         Network.postJson(`http://${ip}:18182/container_api/v1` + "/stop")
+        .setPriority(NetworkParams.PriorityInteractive)
         .addList("db_ids", padNames)
         .bind(root)
         .setUserData(ip)
@@ -3486,6 +3475,7 @@ FluWindow {
     // 获取截图
     function reqScreenshots(ip, dbId){
         Network.get(`http://${ip}:18182/container_api/v1` + "/screenshots/" + dbId)
+        .setPriority(NetworkParams.PriorityBackground)
         .bind(root)
         .setUserData(ip)
         .go(screenshots)
@@ -3538,6 +3528,7 @@ FluWindow {
     // ADB启动
     function reqDeviceAdb(ip, dbId){
         Network.get(`http://${ip}:18182/container_api/v1` + "/adb_start/" + dbId)
+        .setPriority(NetworkParams.PriorityInteractive)
         .bind(root)
         .setUserData(ip)
         .go(deviceAdb)
@@ -3603,6 +3594,7 @@ FluWindow {
     // 检查主机状态
     function reqCheckHost(ip){
         Network.get(`http://${ip}:18182/v1` + "/heartbeat")
+        .setPriority(NetworkParams.PriorityBackground)
         .bind(root)
         .setUserData(ip)
         .go(checkHost)
@@ -3707,24 +3699,6 @@ FluWindow {
         .go(oneKeyNewDevice)
     }
 
-    Timer{
-        id: phoneListTimer
-        repeat: true
-        interval: 2000
-        onTriggered: {
-            explorer.updateScreenshotImage()
-        }
-    }
-
-    Timer{
-        id: deviceListTimer
-        repeat: true
-        interval: 5000
-        onTriggered: {
-            updateDeviceList()
-        }
-    }
-
     Timer{
         id: scannerTimer
         repeat: false
@@ -1022,6 +1022,7 @@ FluPopup {
     // 上传镜像
     function reqUploadImage(ip, path){
         Network.postForm(`http://${ip}:18182/v1` + "/import_image")
+        .setStreamChunks(true)
         .setRetry(1)
         .addFile("file", path)
         .bind(root)
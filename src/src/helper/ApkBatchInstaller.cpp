@@ -0,0 +1,281 @@
+#include "ApkBatchInstaller.h"
+#include "ApkManifestReader.h"
+#include "adbprocess.h"
+#include "QtScrcpyCore.h"
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QDebug>
+
+// 版本查询只是一次 dumpsys，开销小，并发可以比安装高
+#define MAX_QUERY_CONCURRENCY 32
+
+ApkBatchInstaller::ApkBatchInstaller(QObject *parent)
+    : QObject(parent)
+{
+}
+
+ApkBatchInstaller::~ApkBatchInstaller()
+{
+    cancel();
+}
+
+void ApkBatchInstaller::setConcurrency(int maxInstalls, int maxInstallsPerHost)
+{
+    m_maxInstalls = qMax(1, maxInstalls);
+    m_maxInstallsPerHost = qMax(1, maxInstallsPerHost);
+}
+
+void ApkBatchInstaller::setForceInstall(bool force)
+{
+    m_force = force;
+}
+
+bool ApkBatchInstaller::start(const QString& apkFile, const QStringList& serials)
+{
+    if (m_running || serials.isEmpty()) {
+        return false;
+    }
+    QFileInfo fileInfo(apkFile);
+    if (!fileInfo.isFile()) {
+        qWarning() << "ApkBatchInstaller: APK file does not exist:" << apkFile;
+        return false;
+    }
+
+    m_apkFile = fileInfo.absoluteFilePath();
+    m_packageName.clear();
+    m_versionCode = -1;
+    if (!m_force && !readApkInfo(m_apkFile, m_packageName, m_versionCode)) {
+        qWarning() << "ApkBatchInstaller: cannot read package info, install on all devices";
+    }
+
+    m_targets.clear();
+    m_targets.reserve(serials.size());
+    for (const QString& serial : serials) {
+        Target target;
+        target.serial = serial;
+        target.host = qsc::IDeviceManage::hostOf(serial);
+        m_targets.append(target);
+    }
+    m_installsPerHost.clear();
+    m_queries = 0;
+    m_installs = 0;
+    m_done = 0;
+    m_running = true;
+    m_clock.start();
+    qInfo() << "ApkBatchInstaller: install" << m_apkFile << "package:" << m_packageName
+            << "versionCode:" << m_versionCode << "devices:" << m_targets.size();
+    pump();
+    return true;
+}
+
+void ApkBatchInstaller::cancel()
+{
+    if (!m_running) {
+        return;
+    }
+    m_running = false;
+    for (Target& target : m_targets) {
+        releaseAdb(target);
+    }
+}
+
+bool ApkBatchInstaller::isRunning() const
+{
+    return m_running;
+}
+
+QString ApkBatchInstaller::packageName() const
+{
+    return m_packageName;
+}
+
+qint64 ApkBatchInstaller::versionCode() const
+{
+    return m_versionCode;
+}
+
+QString ApkBatchInstaller::statusName(DeviceStatus status)
+{
+    switch (status) {
+    case DS_INSTALLED:
+        return "installed";
+    case DS_SKIPPED:
+        return "skipped";
+    case DS_FAILED:
+        return "failed";
+    default:
+        return "pending";
+    }
+}
+
+void ApkBatchInstaller::pump()
+{
+    if (!m_running) {
+        return;
+    }
+    // 没有拿到包名/版本时无法比较，直接进入安装队列
+    bool canQuery = !m_force && !m_packageName.isEmpty() && 0 <= m_versionCode;
+    for (int i = 0; i < m_targets.size(); i++) {
+        Target& target = m_targets[i];
+        if (DS_PENDING == target.status) {
+            if (!canQuery) {
+                target.status = DS_QUEUED;
+            } else if (m_queries < MAX_QUERY_CONCURRENCY) {
+                startQuery(i);
+            }
+        }
+        if (DS_QUEUED == target.status && m_installs < m_maxInstalls
+            && m_installsPerHost.value(target.host) < m_maxInstallsPerHost) {
+            startInstall(i);
+        }
+    }
+
+    if (m_done >= m_targets.size()) {
+        int installed = 0;
+        int skipped = 0;
+        int failed = 0;
+        for (const Target& target : m_targets) {
+            if (DS_INSTALLED == target.status) {
+                installed++;
+            } else if (DS_SKIPPED == target.status) {
+                skipped++;
+            } else {
+                failed++;
+            }
+        }
+        m_running = false;
+        qInfo() << "ApkBatchInstaller: finished in" << m_clock.elapsed() << "ms, installed:" << installed
+                << "skipped:" << skipped << "failed:" << failed;
+        emit finished(installed, skipped, failed);
+    }
+}
+
+void ApkBatchInstaller::startQuery(int index)
+{
+    Target& target = m_targets[index];
+    target.status = DS_QUERYING;
+    target.clock.start();
+    m_queries++;
+    target.adb = new qsc::AdbProcess(this);
+    connect(target.adb, &qsc::AdbProcess::adbProcessResult, this, [this, index](qsc::AdbProcess::ADB_EXEC_RESULT result) {
+        if (qsc::AdbProcess::AER_SUCCESS_START == result) {
+            return;
+        }
+        onQueryResult(index, qsc::AdbProcess::AER_SUCCESS_EXEC == result);
+    });
+    target.adb->execute(target.serial, QStringList() << "shell" << "dumpsys" << "package" << m_packageName);
+}
+
+void ApkBatchInstaller::onQueryResult(int index, bool success)
+{
+    Target& target = m_targets[index];
+    m_queries--;
+    QString output = target.adb ? target.adb->getStdOut() : QString();
+    QString error = target.adb ? target.adb->getErrorOut() : QString();
+    releaseAdb(target);
+    if (!m_running) {
+        return;
+    }
+
+    // 查询失败只说明版本未知，照常安装，安装本身失败时再记为失败
+    if (!success) {
+        qWarning() << "ApkBatchInstaller:" << target.serial << "version query failed, install anyway:" << error.trimmed();
+        target.status = DS_QUEUED;
+    } else {
+        target.installedVersion = parseInstalledVersion(output);
+        if (target.installedVersion >= m_versionCode) {
+            finishTarget(index, DS_SKIPPED, QString("versionCode %1 already installed").arg(target.installedVersion));
+        } else {
+            target.status = DS_QUEUED;
+        }
+    }
+    pump();
+}
+
+void ApkBatchInstaller::startInstall(int index)
+{
+    Target& target = m_targets[index];
+    target.status = DS_INSTALLING;
+    if (!target.clock.isValid()) {
+        target.clock.start();
+    }
+    m_installs++;
+    m_installsPerHost[target.host]++;
+    target.adb = new qsc::AdbProcess(this);
+    connect(target.adb, &qsc::AdbProcess::adbProcessResult, this, [this, index](qsc::AdbProcess::ADB_EXEC_RESULT result) {
+        if (qsc::AdbProcess::AER_SUCCESS_START == result) {
+            return;
+        }
+        onInstallResult(index, qsc::AdbProcess::AER_SUCCESS_EXEC == result);
+    });
+    target.adb->install(target.serial, m_apkFile);
+}
+
+void ApkBatchInstaller::onInstallResult(int index, bool success)
+{
+    Target& target = m_targets[index];
+    m_installs--;
+    if (0 >= --m_installsPerHost[target.host]) {
+        m_installsPerHost.remove(target.host);
+    }
+    QString output = target.adb ? target.adb->getStdOut() : QString();
+    QString error = target.adb ? target.adb->getErrorOut() : QString();
+    releaseAdb(target);
+    if (!m_running) {
+        return;
+    }
+
+    // 旧版本 adb 安装失败时退出码也是 0，以输出中的 Failure 为准
+    if (success && !output.contains("Failure")) {
+        finishTarget(index, DS_INSTALLED, QString());
+    } else {
+        QString message = output.contains("Failure") ? output.trimmed() : error.trimmed();
+        finishTarget(index, DS_FAILED, message);
+    }
+    pump();
+}
+
+void ApkBatchInstaller::finishTarget(int index, DeviceStatus status, const QString& message)
+{
+    Target& target = m_targets[index];
+    target.status = status;
+    m_done++;
+    qInfo() << "ApkBatchInstaller:" << target.serial << statusName(status)
+            << "in" << target.clock.elapsed() << "ms" << message;
+    emit deviceFinished(target.serial, statusName(status), message);
+    emit progress(m_done, m_targets.size());
+}
+
+void ApkBatchInstaller::releaseAdb(Target& target)
+{
+    if (!target.adb) {
+        return;
+    }
+    target.adb->disconnect(this);
+    target.adb->kill();
+    target.adb->deleteLater();
+    target.adb = nullptr;
+}
+
+qint64 ApkBatchInstaller::parseInstalledVersion(const QString& dumpsys)
+{
+    // dumpsys package 中每个用户/每份代码都有一行 versionCode=123 minSdk=... targetSdk=...
+    qint64 version = -1;
+    QRegularExpression regex(R"(versionCode=(\d+))");
+    QRegularExpressionMatchIterator it = regex.globalMatch(dumpsys);
+    while (it.hasNext()) {
+        version = qMax(version, it.next().captured(1).toLongLong());
+    }
+    return version;
+}
+
+bool ApkBatchInstaller::readApkInfo(const QString& apkFile, QString& packageName, qint64& versionCode)
+{
+    ApkManifest manifest;
+    if (!ApkManifestReader::read(apkFile, manifest) || manifest.versionCode < 0) {
+        return false;
+    }
+    packageName = manifest.packageName;
+    versionCode = manifest.versionCode;
+    return true;
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+namespace qsc {
+class AdbProcess;
+}
+
+/**
+ * @brief 批量安装APK
+ *
+ * 只解析一次APK的包名和versionCode，并行查询所有设备上已安装的版本，
+ * 跳过已经是最新版本的设备，其余设备按全局/每主机并发上限安装
+ */
+class ApkBatchInstaller : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum DeviceStatus
+    {
+        DS_PENDING,    // 等待查询版本
+        DS_QUERYING,   // 正在查询已安装版本
+        DS_QUEUED,     // 需要安装，等待名额
+        DS_INSTALLING, // 正在安装
+        DS_INSTALLED,  // 安装成功
+        DS_SKIPPED,    // 已是最新版本，跳过
+        DS_FAILED,     // 失败
+    };
+
+    explicit ApkBatchInstaller(QObject *parent = nullptr);
+    ~ApkBatchInstaller() override;
+
+    /**
+     * @brief 设置安装并发
+     * @param maxInstalls 同时安装的设备数
+     * @param maxInstallsPerHost 同一主机（同一 IP 或本机 USB）同时安装的设备数
+     */
+    void setConcurrency(int maxInstalls, int maxInstallsPerHost);
+
+    /**
+     * @brief 为 true 时不比较版本，所有设备都安装
+     */
+    void setForceInstall(bool force);
+
+    /**
+     * @brief 开始批量安装
+     * @param apkFile APK文件路径
+     * @param serials ADB设备地址列表（序列号或 ip:port）
+     * @return 参数无效或已在运行时返回 false
+     */
+    bool start(const QString& apkFile, const QStringList& serials);
+    void cancel();
+    bool isRunning() const;
+
+    QString packageName() const;
+    qint64 versionCode() const;
+
+    static QString statusName(DeviceStatus status);
+
+signals:
+    void progress(int done, int total);
+    void deviceFinished(const QString& serial, const QString& status, const QString& message);
+    void finished(int installed, int skipped, int failed);
+
+private:
+    struct Target
+    {
+        QString serial;
+        QString host;
+        DeviceStatus status = DS_PENDING;
+        qint64 installedVersion = -1;
+        qsc::AdbProcess* adb = nullptr;
+        QElapsedTimer clock;
+    };
+
+    static bool readApkInfo(const QString& apkFile, QString& packageName, qint64& versionCode);
+    static qint64 parseInstalledVersion(const QString& dumpsys);
+
+    void pump();
+    void startQuery(int index);
+    void startInstall(int index);
+    void onQueryResult(int index, bool success);
+    void onInstallResult(int index, bool success);
+    void finishTarget(int index, DeviceStatus status, const QString& message);
+    void releaseAdb(Target& target);
+
+private:
+    QString m_apkFile;
+    QString m_packageName;
+    qint64 m_versionCode = -1;
+    QVector<Target> m_targets;
+    QHash<QString, int> m_installsPerHost;
+    int m_queries = 0;
+    int m_installs = 0;
+    int m_done = 0;
+    int m_maxInstalls = 8;
+    int m_maxInstallsPerHost = 2;
+    bool m_force = false;
+    bool m_running = false;
+    QElapsedTimer m_clock;
+};
@@ -0,0 +1,316 @@
+#include "ApkManifestReader.h"
+#include <QFile>
+#include <QVector>
+#include <QtEndian>
+#include <QDebug>
+#include <archive.h>
+#include <archive_entry.h>
+
+// AndroidManifest.xml 一般只有几十 KB，超过这个大小认为文件异常
+#define MAX_MANIFEST_SIZE (16 * 1024 * 1024)
+#define STRING_POOL_UTF8_FLAG (1 << 8)
+#define NO_INDEX 0xffffffff
+
+namespace {
+
+// 与 androidfw/ResourceTypes.h 中的定义一致
+enum ChunkType
+{
+    RES_STRING_POOL_TYPE = 0x0001,
+    RES_XML_TYPE = 0x0003,
+    RES_XML_START_ELEMENT_TYPE = 0x0102,
+    RES_XML_RESOURCE_MAP_TYPE = 0x0180,
+};
+
+enum ValueType
+{
+    TYPE_STRING = 0x03,
+    TYPE_FIRST_INT = 0x10,
+    TYPE_LAST_INT = 0x1f,
+};
+
+// android.R.attr 的资源 id，属性名被混淆后只能按 id 匹配
+enum AttrId
+{
+    ATTR_MIN_SDK_VERSION = 0x0101020c,
+    ATTR_VERSION_CODE = 0x0101021b,
+    ATTR_VERSION_NAME = 0x0101021c,
+    ATTR_TARGET_SDK_VERSION = 0x01010270,
+    ATTR_VERSION_CODE_MAJOR = 0x01010576,
+};
+
+inline quint16 readU16(const uchar *p)
+{
+    return qFromLittleEndian<quint16>(p);
+}
+
+inline quint32 readU32(const uchar *p)
+{
+    return qFromLittleEndian<quint32>(p);
+}
+
+struct StringPool
+{
+    const uchar *chunk = nullptr;
+    quint32 chunkSize = 0;
+    quint32 headerSize = 0;
+    quint32 count = 0;
+    quint32 stringsStart = 0;
+    bool utf8 = false;
+
+    QString at(quint32 index) const
+    {
+        if (!chunk || index >= count) {
+            return QString();
+        }
+        // 偏移来自文件内容，用 64 位计算防止溢出
+        quint64 entry = headerSize + static_cast<quint64>(index) * 4;
+        if (entry + 4 > chunkSize) {
+            return QString();
+        }
+        quint64 start = static_cast<quint64>(stringsStart) + readU32(chunk + entry);
+        if (start >= chunkSize) {
+            return QString();
+        }
+        quint32 pos = static_cast<quint32>(start);
+
+        if (utf8) {
+            // 先是 utf16 长度，再是 utf8 字节数，各占 1 或 2 字节（最高位为 1 表示 2 字节）
+            pos += (chunk[pos] & 0x80) ? 2 : 1;
+            if (pos + 2 > chunkSize) {
+                return QString();
+            }
+            quint32 len = chunk[pos];
+            if (len & 0x80) {
+                len = ((len & 0x7f) << 8) | chunk[pos + 1];
+                pos += 2;
+            } else {
+                pos += 1;
+            }
+            if (len > chunkSize - pos) {
+                return QString();
+            }
+            return QString::fromUtf8(reinterpret_cast<const char *>(chunk + pos), static_cast<int>(len));
+        }
+
+        // utf16 长度占 1 或 2 个 u16
+        if (pos + 2 > chunkSize) {
+            return QString();
+        }
+        quint32 len = readU16(chunk + pos);
+        pos += 2;
+        if (len & 0x8000) {
+            if (pos + 2 > chunkSize) {
+                return QString();
+            }
+            len = ((len & 0x7fff) << 16) | readU16(chunk + pos);
+            pos += 2;
+        }
+        if (len > (chunkSize - pos) / 2) {
+            return QString();
+        }
+        QString str(static_cast<int>(len), Qt::Uninitialized);
+        for (quint32 i = 0; i < len; ++i) {
+            str[static_cast<int>(i)] = QChar(readU16(chunk + pos + i * 2));
+        }
+        return str;
+    }
+};
+
+struct Attribute
+{
+    QString name;
+    quint32 resId = 0;
+    quint32 rawValue = NO_INDEX;
+    quint8 dataType = 0;
+    quint32 data = 0;
+
+    bool is(const char *attrName, quint32 attrId) const
+    {
+        return (resId && resId == attrId) || name == QLatin1String(attrName);
+    }
+
+    QString toString(const StringPool &pool) const
+    {
+        if (rawValue != NO_INDEX) {
+            return pool.at(rawValue);
+        }
+        if (dataType == TYPE_STRING) {
+            return pool.at(data);
+        }
+        if (dataType >= TYPE_FIRST_INT && dataType <= TYPE_LAST_INT) {
+            return QString::number(data);
+        }
+        return QString();
+    }
+
+    qint64 toInt(const StringPool &pool) const
+    {
+        if (dataType >= TYPE_FIRST_INT && dataType <= TYPE_LAST_INT) {
+            return data;
+        }
+        // 个别打包工具把数字写成字符串
+        bool ok = false;
+        qint64 value = toString(pool).toLongLong(&ok);
+        return ok ? value : -1;
+    }
+};
+
+}
+
+bool ApkManifestReader::read(const QString& apkFile, ApkManifest& manifest)
+{
+    struct archive *a = archive_read_new();
+    // seekable 模式直接读中央目录定位条目，不需要顺序扫描整个 APK
+    archive_read_support_format_zip_seekable(a);
+#ifdef Q_OS_WIN
+    int r = archive_read_open_filename_w(a, reinterpret_cast<const wchar_t *>(apkFile.utf16()), 64 * 1024);
+#else
+    int r = archive_read_open_filename(a, QFile::encodeName(apkFile).constData(), 64 * 1024);
+#endif
+    if (r != ARCHIVE_OK) {
+        qDebug() << "ApkManifestReader: Failed to open APK:" << apkFile << archive_error_string(a);
+        archive_read_free(a);
+        return false;
+    }
+
+    QByteArray axml;
+    struct archive_entry *entry;
+    while (archive_read_next_header(a, &entry) == ARCHIVE_OK) {
+        if (qstrcmp(archive_entry_pathname(entry), "AndroidManifest.xml") != 0) {
+            continue;
+        }
+        la_int64_t size = archive_entry_size(entry);
+        if (size <= 0 || size > MAX_MANIFEST_SIZE) {
+            break;
+        }
+        axml.resize(static_cast<int>(size));
+        int filled = 0;
+        while (filled < axml.size()) {
+            la_ssize_t len = archive_read_data(a, axml.data() + filled, axml.size() - filled);
+            if (len <= 0) {
+                break;
+            }
+            filled += static_cast<int>(len);
+        }
+        if (filled != axml.size()) {
+            axml.clear();
+        }
+        break;
+    }
+    archive_read_free(a);
+
+    if (axml.isEmpty()) {
+        qDebug() << "ApkManifestReader: AndroidManifest.xml not found in" << apkFile;
+        return false;
+    }
+    return parse(axml, manifest);
+}
+
+bool ApkManifestReader::parse(const QByteArray& axml, ApkManifest& manifest)
+{
+    manifest = ApkManifest();
+
+    const uchar *data = reinterpret_cast<const uchar *>(axml.constData());
+    const quint32 size = static_cast<quint32>(axml.size());
+    if (size < 8 || readU16(data) != RES_XML_TYPE) {
+        return false;
+    }
+
+    StringPool pool;
+    QVector<quint32> resourceIds;
+    qint64 versionCode = -1;
+    qint64 versionCodeMajor = 0;
+
+    quint32 offset = readU16(data + 2);
+    while (offset + 8 <= size) {
+        const uchar *chunk = data + offset;
+        quint16 type = readU16(chunk);
+        quint16 headerSize = readU16(chunk + 2);
+        quint32 chunkSize = readU32(chunk + 4);
+        if (chunkSize < 8 || chunkSize > size - offset || headerSize > chunkSize) {
+            qDebug() << "ApkManifestReader: Malformed chunk at" << offset;
+            return false;
+        }
+
+        if (type == RES_STRING_POOL_TYPE && !pool.chunk && headerSize >= 28) {
+            pool.chunk = chunk;
+            pool.chunkSize = chunkSize;
+            pool.headerSize = headerSize;
+            pool.count = readU32(chunk + 8);
+            pool.utf8 = (readU32(chunk + 16) & STRING_POOL_UTF8_FLAG) != 0;
+            pool.stringsStart = readU32(chunk + 20);
+        } else if (type == RES_XML_RESOURCE_MAP_TYPE) {
+            for (quint32 pos = headerSize; pos + 4 <= chunkSize; pos += 4) {
+                resourceIds.append(readU32(chunk + pos));
+            }
+        } else if (type == RES_XML_START_ELEMENT_TYPE && headerSize + 20 <= chunkSize) {
+            // ResXMLTree_attrExt: ns, name, attributeStart, attributeSize, attributeCount, ...
+            const uchar *ext = chunk + headerSize;
+            QString element = pool.at(readU32(ext + 4));
+            bool isManifest = element == QLatin1String("manifest");
+            bool isUsesSdk = element == QLatin1String("uses-sdk");
+            if (isManifest || isUsesSdk) {
+                quint32 attrStart = readU16(ext + 8);
+                quint32 attrSize = readU16(ext + 10);
+                quint32 attrCount = readU16(ext + 12);
+                if (attrSize < 20) {
+                    return false;
+                }
+                for (quint32 i = 0; i < attrCount; ++i) {
+                    quint32 pos = headerSize + attrStart + i * attrSize;
+                    if (pos + 20 > chunkSize) {
+                        break;
+                    }
+                    const uchar *raw = chunk + pos;
+                    Attribute attr;
+                    quint32 nameIndex = readU32(raw + 4);
+                    attr.name = pool.at(nameIndex);
+                    attr.resId = nameIndex < static_cast<quint32>(resourceIds.size()) ? resourceIds[nameIndex] : 0;
+                    attr.rawValue = readU32(raw + 8);
+                    attr.dataType = raw[15];
+                    attr.data = readU32(raw + 16);
+
+                    if (isManifest) {
+                        if (attr.name == QLatin1String("package")) {
+                            manifest.packageName = attr.toString(pool);
+                        } else if (attr.name == QLatin1String("split")) {
+                            manifest.split = attr.toString(pool);
+                        } else if (attr.is("versionCode", ATTR_VERSION_CODE)) {
+                            versionCode = attr.toInt(pool);
+                        } else if (attr.is("versionCodeMajor", ATTR_VERSION_CODE_MAJOR)) {
+                            versionCodeMajor = qMax<qint64>(0, attr.toInt(pool));
+                        } else if (attr.is("versionName", ATTR_VERSION_NAME)) {
+                            manifest.versionName = attr.toString(pool);
+                        }
+                    } else {
+                        if (attr.is("minSdkVersion", ATTR_MIN_SDK_VERSION)) {
+                            manifest.minSdk = static_cast<int>(attr.toInt(pool));
+                        } else if (attr.is("targetSdkVersion", ATTR_TARGET_SDK_VERSION)) {
+                            manifest.targetSdk = static_cast<int>(attr.toInt(pool));
+                        }
+                    }
+                }
+                // uses-sdk 在 manifest 之后，读到就可以结束
+                if (isUsesSdk) {
+                    break;
+                }
+            }
+        }
+        offset += chunkSize;
+    }
+
+    if (versionCode >= 0) {
+        manifest.versionCode = (versionCodeMajor << 32) | (versionCode & 0xffffffff);
+    }
+    return !manifest.packageName.isEmpty();
+}
+
+QString ApkManifestReader::packageName(const QString& apkFile)
+{
+    ApkManifest manifest;
+    if (!read(apkFile, manifest)) {
+        return QString();
+    }
+    return manifest.packageName;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+
+/**
+ * @brief APK 清单信息
+ */
+struct ApkManifest
+{
+    QString packageName;
+    QString versionName;
+    qint64 versionCode = -1;  // 已合并 versionCodeMajor（高 32 位）
+    QString split;            // split APK 的名字，base APK 为空
+    int minSdk = -1;          // 引用资源或代号（如 "Q"）时无法解析，保持 -1
+    int targetSdk = -1;
+};
+
+/**
+ * @brief 进程内读取 APK 的 AndroidManifest.xml
+ *
+ * 通过 zip 中央目录直接定位 AndroidManifest.xml，解析二进制 AXML 的字符串池和
+ * manifest/uses-sdk 元素，不再启动 aapt 进程
+ */
+class ApkManifestReader
+{
+public:
+    /**
+     * @brief 读取 APK 文件中的清单信息
+     * @param apkFile APK 文件路径
+     * @param manifest 输出：清单信息
+     * @return 成功且包名不为空时返回 true
+     */
+    static bool read(const QString& apkFile, ApkManifest& manifest);
+
+    /**
+     * @brief 解析二进制 AXML 数据
+     * @param axml AndroidManifest.xml 的原始内容
+     * @param manifest 输出：清单信息
+     * @return 成功且包名不为空时返回 true
+     */
+    static bool parse(const QByteArray& axml, ApkManifest& manifest);
+
+    /**
+     * @brief 只读取包名，失败返回空字符串
+     */
+    static QString packageName(const QString& apkFile);
+};
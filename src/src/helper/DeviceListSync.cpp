@@ -0,0 +1,338 @@
+#include "DeviceListSync.h"
+#include "Network.h"
+#include "../treemodel.h"
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QElapsedTimer>
+#include <QDebug>
+
+// 检查哪些主机到期的节拍
+#define TICK_INTERVAL 500
+#define REQUEST_TIMEOUT 2000
+// 连续失败这么多次才把主机标为离线，偶发超时不让整台主机的设备闪成离线
+#define OFFLINE_FAILURES 3
+
+DeviceListSync::DeviceListSync(TreeModel *model, QObject *parent)
+    : QObject(parent)
+    , m_model(model)
+{
+    _minInterval = 2000;
+    _maxInterval = 15000;
+    _fullSyncRounds = 30;
+    m_clock.start();
+    // 每个主机同一时间只有一个请求在途，单线程足够，也不和界面抢核心
+    m_parsePool.setMaxThreadCount(1);
+    m_timer.setInterval(TICK_INTERVAL);
+    connect(&m_timer, &QTimer::timeout, this, &DeviceListSync::onTick);
+}
+
+void DeviceListSync::start()
+{
+    if (!m_timer.isActive()) {
+        m_timer.start();
+    }
+    onTick();
+}
+
+void DeviceListSync::stop()
+{
+    m_timer.stop();
+}
+
+void DeviceListSync::syncNow()
+{
+    for (auto it = m_hosts.begin(); it != m_hosts.end(); ++it) {
+        it.value().nextDue = 0;
+    }
+    onTick();
+}
+
+void DeviceListSync::syncHost(const QString &hostIp)
+{
+    if (hostIp.isEmpty()) {
+        return;
+    }
+    HostState &state = m_hosts[hostIp];
+    state.force = true;
+    state.nextDue = 0;
+    if (!state.inFlight) {
+        request(hostIp);
+    }
+}
+
+void DeviceListSync::onTick()
+{
+    if (!m_model) {
+        return;
+    }
+
+    // 主机列表以 TreeModel 为准，已删除的主机不再轮询
+    QSet<QString> hostIps;
+    for (const QVariant &host : m_model->hostList()) {
+        QString ip = host.toMap().value("ip").toString();
+        if (!ip.isEmpty()) {
+            hostIps.insert(ip);
+        }
+    }
+    for (auto it = m_hosts.begin(); it != m_hosts.end();) {
+        if (!hostIps.contains(it.key()) && !it.value().inFlight) {
+            it = m_hosts.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    bool anyInFlight = false;
+    qint64 now = m_clock.elapsed();
+    for (const QString &ip : hostIps) {
+        HostState &state = m_hosts[ip];
+        if (!state.inFlight && now >= state.nextDue) {
+            request(ip);
+        }
+        anyInFlight = anyInFlight || state.inFlight;
+    }
+
+    // 一轮的所有请求都回来后结算统计
+    if (!anyInFlight && m_cycle.requests > 0) {
+        m_lastCycle = m_cycle;
+        m_cycle = CycleStats();
+    }
+}
+
+void DeviceListSync::request(const QString &hostIp)
+{
+    HostState &state = m_hosts[hostIp];
+    state.inFlight = true;
+    if (_fullSyncRounds > 0 && ++state.rounds % _fullSyncRounds == 0) {
+        state.force = true;
+    }
+    m_cycle.requests++;
+    m_total.requests++;
+
+    NetworkCallable *callable = new NetworkCallable(this);
+    connect(callable, &NetworkCallable::success, this, [this, hostIp](QString result, QVariant) {
+        onResponse(hostIp, result);
+    });
+    connect(callable, &NetworkCallable::error, this, [this, hostIp](int status, QString errorString, QString, QVariant) {
+        qDebug() << "DeviceListSync: get_db failed for" << hostIp << status << errorString;
+        onFailed(hostIp, status);
+    });
+    connect(callable, &NetworkCallable::finish, callable, &QObject::deleteLater);
+
+    // 直接交给 Network::handle：callable 在 C++ 创建，没有 JS 引擎，不能走 go() 的 QML 拦截器
+    NetworkParams *params = Network::getInstance()->postJson(QString("http://%1:18182/container_api/v1/get_db").arg(hostIp))
+        ->setPriority(NetworkParams::PriorityBackground)
+        ->setReadOnly(true)
+        ->bind(this)
+        ->setTimeout(REQUEST_TIMEOUT)
+        ->setUserData(hostIp);
+    Network::getInstance()->handle(params, callable);
+}
+
+void DeviceListSync::onResponse(const QString &hostIp, const QString &result)
+{
+    auto it = m_hosts.find(hostIp);
+    if (it == m_hosts.end()) {
+        return;
+    }
+    // inFlight 保持到解析结果应用完，避免同一主机的两次结果乱序
+    const HostState &state = it.value();
+    bool full = state.force || state.payloadHash == 0;
+    size_t lastPayloadHash = state.payloadHash;
+    QHash<QString, size_t> lastRecordHashes = state.recordHashes;
+    m_parsePool.start([this, hostIp, result, lastPayloadHash, lastRecordHashes, full] {
+        ParseResult parsed = parse(hostIp, result, lastPayloadHash, lastRecordHashes, full);
+        QMetaObject::invokeMethod(this, [this, hostIp, parsed] {
+            onParsed(hostIp, parsed);
+        }, Qt::QueuedConnection);
+    });
+}
+
+DeviceListSync::ParseResult DeviceListSync::parse(const QString &hostIp, const QString &result, size_t lastPayloadHash,
+                                                  const QHash<QString, size_t> &lastRecordHashes, bool full)
+{
+    QElapsedTimer timer;
+    timer.start();
+    ParseResult parsed;
+    parsed.delta.full = full;
+    QByteArray payload = result.toUtf8();
+    parsed.bytes = payload.size();
+
+    parsed.payloadHash = qHash(payload);
+    if (!full && lastPayloadHash != 0 && parsed.payloadHash == lastPayloadHash) {
+        // 与上次完全相同，不解析也不碰模型
+        parsed.skipped = true;
+        parsed.ok = true;
+        return parsed;
+    }
+
+    QJsonObject res = QJsonDocument::fromJson(payload).object();
+    if (res.value("code").toInt() != 200) {
+        parsed.message = res.value("msg").toString();
+        return parsed;
+    }
+    parsed.ok = true;
+
+    QJsonObject data = res.value("data").toObject();
+    DeviceListDelta &delta = parsed.delta;
+    delta.hostIp = data.value("host_ip").toString();
+    if (delta.hostIp.isEmpty()) {
+        delta.hostIp = hostIp;
+    }
+
+    QJsonArray list = data.value("list").toArray();
+    parsed.recordHashes.reserve(list.size());
+    if (full) {
+        delta.changed.reserve(list.size());
+    }
+    for (const QJsonValue &value : list) {
+        QJsonObject record = value.toObject();
+        QString dbId = record.value("db_id").toString();
+        bool changed = full;
+        if (!dbId.isEmpty()) {
+            size_t recordHash = qHash(QJsonDocument(record).toJson(QJsonDocument::Compact));
+            parsed.recordHashes.insert(dbId, recordHash);
+            changed = changed || lastRecordHashes.value(dbId) != recordHash;
+        }
+        if (changed) {
+            DeviceData device;
+            TreeModel::parseDevice(record, device);
+            delta.changed.append(device);
+        }
+    }
+    if (!full) {
+        for (auto it = lastRecordHashes.constBegin(); it != lastRecordHashes.constEnd(); ++it) {
+            if (!parsed.recordHashes.contains(it.key())) {
+                delta.removed.append(it.key());
+            }
+        }
+    }
+    parsed.parseMs = timer.elapsed();
+    return parsed;
+}
+
+void DeviceListSync::onParsed(const QString &hostIp, const ParseResult &parsed)
+{
+    auto it = m_hosts.find(hostIp);
+    if (it == m_hosts.end()) {
+        return;
+    }
+    HostState &state = it.value();
+    state.inFlight = false;
+    m_cycle.bytes += parsed.bytes;
+    m_total.bytes += parsed.bytes;
+    m_cycle.parseMs += parsed.parseMs;
+    m_total.parseMs += parsed.parseMs;
+
+    // 主机有应答，不论内容如何都清零失败计数
+    state.failures = 0;
+    if (parsed.skipped) {
+        m_cycle.skipped++;
+        m_total.skipped++;
+        setOnline(hostIp, state, true);
+        reschedule(state, false);
+        if (state.force) {
+            state.nextDue = 0;
+        }
+        return;
+    }
+    if (!parsed.ok) {
+        emit syncError(hostIp, parsed.message);
+        reschedule(state, false);
+        return;
+    }
+    setOnline(hostIp, state, true);
+
+    const DeviceListDelta &delta = parsed.delta;
+    QElapsedTimer timer;
+    timer.start();
+    if (m_model) {
+        m_model->applyDeviceDelta(delta);
+    }
+    qint64 applyMs = timer.elapsed();
+
+    int changedCount = delta.changed.size();
+    int removedCount = delta.removed.size();
+    state.payloadHash = parsed.payloadHash;
+    state.recordHashes = parsed.recordHashes;
+    // 解析期间又被要求强制同步的，下一拍立即再同步一次
+    if (delta.full) {
+        state.force = false;
+    }
+    m_cycle.rowsChanged += changedCount;
+    m_cycle.rowsRemoved += removedCount;
+    m_cycle.applyMs += applyMs;
+    m_total.rowsChanged += changedCount;
+    m_total.rowsRemoved += removedCount;
+    m_total.applyMs += applyMs;
+    reschedule(state, changedCount > 0 || removedCount > 0);
+    if (state.force) {
+        state.nextDue = 0;
+    }
+    emit hostSynced(delta.hostIp, changedCount, removedCount);
+}
+
+void DeviceListSync::onFailed(const QString &hostIp, int status)
+{
+    auto it = m_hosts.find(hostIp);
+    if (it == m_hosts.end()) {
+        return;
+    }
+    HostState &state = it.value();
+    state.inFlight = false;
+    // status -1 是 Network 在该主机排队过多时丢弃的后台请求，没有发出去，不说明主机离线
+    if (status != -1 && ++state.failures >= OFFLINE_FAILURES) {
+        setOnline(hostIp, state, false);
+    }
+    reschedule(state, false);
+}
+
+void DeviceListSync::setOnline(const QString &hostIp, HostState &state, bool online)
+{
+    if (state.online == static_cast<int>(online) || !m_model) {
+        return;
+    }
+    state.online = online;
+    QVariantMap data;
+    data["state"] = online ? "online" : "offline";
+    m_model->modifyHost(hostIp, data);
+    // modifyHost 会改写该主机所有设备的状态，之前的哈希不再对应表格内容，下一轮必须全量同步
+    state.payloadHash = 0;
+    state.recordHashes.clear();
+    state.force = true;
+}
+
+void DeviceListSync::reschedule(HostState &state, bool changed)
+{
+    // 有变化说明主机正忙（创建、启动中），保持最快频率；安静时逐步放宽
+    if (changed || state.interval <= 0) {
+        state.interval = _minInterval;
+    } else {
+        state.interval = qMin(_maxInterval, state.interval * 3 / 2);
+    }
+    state.nextDue = m_clock.elapsed() + state.interval;
+}
+
+QVariantMap DeviceListSync::stats() const
+{
+    auto toMap = [](const CycleStats &stats) {
+        QVariantMap map;
+        map.insert("requests", stats.requests);
+        map.insert("skipped", stats.skipped);
+        map.insert("bytes", stats.bytes);
+        map.insert("rowsChanged", stats.rowsChanged);
+        map.insert("rowsRemoved", stats.rowsRemoved);
+        map.insert("parseMs", stats.parseMs);
+        map.insert("applyMs", stats.applyMs);
+        return map;
+    };
+    QVariantMap result = toMap(m_total);
+    result.insert("lastCycle", toMap(m_lastCycle));
+    QVariantMap intervals;
+    for (auto it = m_hosts.constBegin(); it != m_hosts.constEnd(); ++it) {
+        intervals.insert(it.key(), it.value().interval);
+    }
+    result.insert("intervals", intervals);
+    return result;
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QPointer>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QThreadPool>
+#include <QVariantMap>
+#include "../stdafx.h"
+#include "../structs.h"
+
+class TreeModel;
+
+/**
+ * @brief 设备列表增量同步
+ *
+ * 代替 QML 里每 5 秒全量拉取 get_db 再整表比对的做法：
+ * 1. 每个主机记住上次响应的哈希，响应没变直接跳过
+ * 2. 响应有变化时按 db_id 比较每条记录的哈希，只把变化的记录和删除的 dbId 交给 TreeModel
+ * 3. 主机有变化时按 minInterval 轮询，连续无变化则逐步放宽到 maxInterval
+ *
+ * 哈希、JSON 解析和 DeviceData 转换都在工作线程完成，主线程只做一次 TreeModel::applyDeviceDelta
+ */
+class DeviceListSync : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY_AUTO(int, minInterval)
+    Q_PROPERTY_AUTO(int, maxInterval)
+    // 每隔多少轮忽略哈希做一次全量比对，纠正本地临时修改
+    Q_PROPERTY_AUTO(int, fullSyncRounds)
+
+public:
+    explicit DeviceListSync(TreeModel *model, QObject *parent = nullptr);
+
+    Q_INVOKABLE void start();
+    Q_INVOKABLE void stop();
+
+    // 所有主机立即同步一轮（仍按哈希跳过未变化的响应）
+    Q_INVOKABLE void syncNow();
+
+    // 立即全量同步一个主机，用于增删改设备后的刷新
+    Q_INVOKABLE void syncHost(const QString &hostIp);
+
+    // 累计与最近一轮的统计：requests/skipped/bytes/rowsChanged/rowsRemoved/parseMs/applyMs/lastCycle
+    Q_INVOKABLE QVariantMap stats() const;
+
+signals:
+    void hostSynced(const QString &hostIp, int changed, int removed);
+    void syncError(const QString &hostIp, const QString &message);
+
+private:
+    // 基准测试直接调用 parse
+    friend class tst_DeviceListSync;
+
+    struct HostState {
+        size_t payloadHash = 0;
+        QHash<QString, size_t> recordHashes;  // db_id -> 记录哈希
+        int interval = 0;
+        int rounds = 0;
+        qint64 nextDue = 0;
+        bool inFlight = false;
+        bool force = false;
+        int online = -1;  // -1 未知
+        int failures = 0; // 连续请求失败次数
+    };
+
+    // 工作线程的解析结果
+    struct ParseResult {
+        size_t payloadHash = 0;
+        bool skipped = false;   // 响应与上次相同
+        bool ok = false;        // code == 200
+        QString message;
+        DeviceListDelta delta;
+        QHash<QString, size_t> recordHashes;
+        qint64 bytes = 0;
+        qint64 parseMs = 0;
+    };
+
+    struct CycleStats {
+        quint64 requests = 0;
+        quint64 skipped = 0;
+        quint64 bytes = 0;
+        quint64 rowsChanged = 0;
+        quint64 rowsRemoved = 0;
+        quint64 parseMs = 0;    // 工作线程解析耗时
+        quint64 applyMs = 0;    // 主线程应用耗时
+    };
+
+    void onTick();
+
+    void request(const QString &hostIp);
+
+    void onResponse(const QString &hostIp, const QString &result);
+
+    static ParseResult parse(const QString &hostIp, const QString &result, size_t lastPayloadHash,
+                             const QHash<QString, size_t> &lastRecordHashes, bool full);
+
+    void onParsed(const QString &hostIp, const ParseResult &result);
+
+    void onFailed(const QString &hostIp, int status);
+
+    void setOnline(const QString &hostIp, HostState &state, bool online);
+
+    void reschedule(HostState &state, bool changed);
+
+private:
+    QPointer<TreeModel> m_model;
+    QTimer m_timer;
+    QElapsedTimer m_clock;
+    QHash<QString, HostState> m_hosts;
+    CycleStats m_total;
+    CycleStats m_cycle;      // 当前一轮
+    CycleStats m_lastCycle;  // 上一轮
+    // 放在最后，析构时先等待解析任务结束
+    QThreadPool m_parsePool;
+};
@@ -1,11 +1,38 @@
 
 #include "DeviceScanner.h"
+#include "SettingsHelper.h"
 #include <QNetworkAddressEntry>
 #include <QDateTime>
+#include <algorithm>
+#include <climits>
+#ifdef Q_OS_LINUX
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <errno.h>
+#include <string.h>
+#endif
+
+#define SCAN_PORT 7678
+#define SCAN_PROBE_DATA "lgcloud"
+// 发送节拍，每个节拍按令牌发送一批
+#define SCAN_TICK_MS 10
+// 令牌桶容量，限制单个节拍的突发量
+#define SCAN_BURST 128
+// 一次 sendmmsg 的最大条数
+#define SCAN_BATCH 64
+// 未响应主机最多补发轮数。全网段扫描只补发以前有响应的已知主机，
+// 其余地址大多没有设备，整段重扫一个 /16 要十几秒
+#define SCAN_MAX_RETRIES 2
+// 子网太大时只扫描本机所在的 /16
+#define SCAN_MIN_PREFIX 16
+// 缓存的已知主机数量上限
+#define SCAN_KNOWN_HOSTS_MAX 256
+#define SCAN_KNOWN_HOSTS_KEY "scannerKnownHosts"
 
 DeviceScanner::DeviceScanner(QObject *parent)
     : QObject(parent),
       m_udpSocket(new QUdpSocket(this)),
+      m_sendTimer(new QTimer(this)),
       m_scanTimer(new QTimer(this)),
       m_scanning(false)
 {
@@ -13,7 +40,13 @@ DeviceScanner::DeviceScanner(QObject *parent)
     connect(m_udpSocket, &QUdpSocket::readyRead, this, &DeviceScanner::onReadyRead);
     
     // 连接定时器的timeout信号，当扫描超时时触发
+    m_scanTimer->setSingleShot(true);
     connect(m_scanTimer, &QTimer::timeout, this, &DeviceScanner::onScanTimeout);
+
+    // 按令牌桶节奏发送探测包
+    m_sendTimer->setTimerType(Qt::PreciseTimer);
+    m_sendTimer->setInterval(SCAN_TICK_MS);
+    connect(m_sendTimer, &QTimer::timeout, this, &DeviceScanner::onSendTick);
 }
 
 bool DeviceScanner::scanning() const
@@ -37,6 +70,7 @@ void DeviceScanner::startDiscovery(int timeout)
     // 1. 清理上一次的扫描结果
     m_discoveredDevices.clear();
     m_foundDeviceIds.clear();
+    m_pendingIps.clear();
     emit discoveredDevicesChanged();
 
     // 2. 更新状态并绑定端口
@@ -44,15 +78,9 @@ void DeviceScanner::startDiscovery(int timeout)
     emit scanningChanged();
     m_udpSocket->bind(QHostAddress::AnyIPv4); // 绑定到任意IPv4地址以接收响应
 
-    // 3. 遍历所有网段并发送探测包
-    QList<QHostAddress> targets = getTargetHosts();
-    QByteArray probeData = "lgcloud";
-    for (const QHostAddress &host : targets) {
-        m_udpSocket->writeDatagram(probeData, host, 7678);
-    }
-
-    // 4. 启动超时定时器
-    m_scanTimer->start(timeout);
+    // 3. 按速率分批探测所有网段
+    m_explicitTargets = false;
+    beginScan(getTargetRanges(), timeout);
 }
 
 void DeviceScanner::startDiscoveryWithIps(const QString& ipList, int timeout)
@@ -80,12 +108,13 @@ void DeviceScanner::startDiscoveryWithIps(const QString& ipList, int timeout)
         stopDiscovery();
         return;
     }
-    QByteArray probeData = "lgcloud";
+    QVector<HostRange> ranges;
     for (const QString &ipString : ips) {
         QString trimmedIp = ipString.trimmed();
         QHostAddress host(trimmedIp);
         if (!host.isNull() && host.protocol() == QAbstractSocket::IPv4Protocol) {
-            m_udpSocket->writeDatagram(probeData, host, 7678);
+            quint32 ip = host.toIPv4Address();
+            ranges.append({ ip, ip });
             m_pendingIps.insert(trimmedIp);
         } else {
             qWarning() << "DeviceScanner: Invalid IP address in list:" << ipString;
@@ -98,8 +127,9 @@ void DeviceScanner::startDiscoveryWithIps(const QString& ipList, int timeout)
         return;
     }
 
-    // 4. 启动超时定时器
-    m_scanTimer->start(timeout);
+    // 4. 按速率发送探测包并启动超时定时器
+    m_explicitTargets = true;
+    beginScan(ranges, timeout);
 }
 
 void DeviceScanner::stopDiscovery()
@@ -109,7 +139,34 @@ void DeviceScanner::stopDiscovery()
     }
 
     m_scanTimer->stop();
+    m_sendTimer->stop();
     m_pendingIps.clear();
+
+    // 有响应的主机写入缓存，下次扫描优先探测
+    if (!m_foundHosts.isEmpty()) {
+        QStringList known;
+        for (quint32 host : qAsConst(m_foundHosts)) {
+            known.append(QHostAddress(host).toString());
+        }
+        const QStringList previous = SettingsHelper::getInstance()->get(SCAN_KNOWN_HOSTS_KEY).toStringList();
+        for (const QString &ip : previous) {
+            if (known.size() >= SCAN_KNOWN_HOSTS_MAX) {
+                break;
+            }
+            if (!known.contains(ip)) {
+                known.append(ip);
+            }
+        }
+        SettingsHelper::getInstance()->save(SCAN_KNOWN_HOSTS_KEY, known);
+    }
+
+    m_ranges.clear();
+    m_backlog.clear();
+    m_knownHosts.clear();
+    m_knownSet.clear();
+    m_answered.clear();
+    m_sentAt.clear();
+    m_foundHosts.clear();
     m_udpSocket->close(); // close()会解绑端口，下次启动需要重新bind
     m_scanning = false;
     emit scanningChanged();
@@ -135,6 +192,16 @@ void DeviceScanner::onReadyRead()
         m_udpSocket->readDatagram(datagram.data(), datagram.size(), &senderIp, &senderPort);
         m_pendingIps.remove(senderIp.toString());
 
+        // 记录已响应的主机，补发时跳过，并用首个响应估算 RTT
+        quint32 senderAddr = senderIp.toIPv4Address();
+        if (!m_answered.contains(senderAddr)) {
+            m_answered.insert(senderAddr);
+            auto sent = m_sentAt.constFind(senderAddr);
+            if (sent != m_sentAt.constEnd()) {
+                m_maxRtt = qMax(m_maxRtt, m_clock.elapsed() - sent.value());
+            }
+        }
+
         QString response = QString::fromUtf8(datagram).trimmed();
         qDebug() << "host" << response;
         if (response.startsWith("CBS:")) {
@@ -148,6 +215,7 @@ void DeviceScanner::onReadyRead()
                 }
 
                 m_foundDeviceIds.insert(deviceId);
+                m_foundHosts.insert(senderAddr);
 
                 QVariantMap device;
                 device["ip"] = senderIp.toString();
@@ -163,14 +231,20 @@ void DeviceScanner::onReadyRead()
         }
     }
 
-    if (m_scanning && m_pendingIps.isEmpty()) {
+    // 指定 IP 扫描时全部响应即可结束；全网段扫描持续接收到超时，边扫边输出结果
+    if (m_scanning && m_explicitTargets && m_pendingIps.isEmpty()) {
         stopDiscovery();
     }
 }
 
-QList<QHostAddress> DeviceScanner::getTargetHosts()
+void DeviceScanner::setProbeRate(int probesPerSecond)
+{
+    m_probeRate = qMax(1, probesPerSecond);
+}
+
+QVector<DeviceScanner::HostRange> DeviceScanner::getTargetRanges()
 {
-    QList<QHostAddress> hosts;
+    QVector<HostRange> ranges;
     // 遍历所有网络接口
     for (const QNetworkInterface &iface : QNetworkInterface::allInterfaces()) {
         // 只处理活动的、非回环的接口
@@ -183,17 +257,239 @@ QList<QHostAddress> DeviceScanner::getTargetHosts()
             // 只处理IPv4
             if (entry.ip().protocol() == QAbstractSocket::IPv4Protocol) {
                 quint32 ip = entry.ip().toIPv4Address();
-                quint32 netmask = entry.netmask().toIPv4Address();
+                int prefix = qMax(entry.prefixLength(), SCAN_MIN_PREFIX);
+                quint32 netmask = prefix >= 32 ? 0xffffffff : ~(0xffffffffu >> prefix);
                 quint32 networkAddr = ip & netmask;
                 quint32 broadcastAddr = networkAddr | (~netmask);
 
                 // 从网络地址+1到广播地址-1，都是有效的主机地址
-                for (quint32 i = networkAddr + 1; i < broadcastAddr; ++i) {
-                    hosts.append(QHostAddress(i));
+                if (broadcastAddr - networkAddr >= 2) {
+                    ranges.append({ networkAddr + 1, broadcastAddr - 1 });
                 }
             }
         }
     }
-    return hosts;
+    return ranges;
 }
 
+void DeviceScanner::beginScan(const QVector<HostRange> &ranges, int timeout)
+{
+    // 合并重叠的地址段（多个网卡在同一网段、IP 列表中有重复）
+    m_ranges = ranges;
+    std::sort(m_ranges.begin(), m_ranges.end(), [](const HostRange &a, const HostRange &b) {
+        return a.first < b.first;
+    });
+    int merged = 0;
+    for (int i = 1; i < m_ranges.size(); ++i) {
+        if (m_ranges[i].first <= m_ranges[merged].last + 1ull) {
+            m_ranges[merged].last = qMax(m_ranges[merged].last, m_ranges[i].last);
+        } else {
+            m_ranges[++merged] = m_ranges[i];
+        }
+    }
+    m_ranges.resize(m_ranges.isEmpty() ? 0 : merged + 1);
+
+    qint64 total = 0;
+    for (const HostRange &range : qAsConst(m_ranges)) {
+        total += static_cast<qint64>(range.last) - range.first + 1;
+    }
+    m_total = static_cast<int>(total);
+    if (m_total == 0) {
+        stopDiscovery();
+        return;
+    }
+
+    // 缓存中落在本次网段内的已知主机先探测
+    m_knownHosts.clear();
+    m_knownSet.clear();
+    const QStringList known = SettingsHelper::getInstance()->get(SCAN_KNOWN_HOSTS_KEY).toStringList();
+    for (const QString &ip : known) {
+        quint32 host = QHostAddress(ip).toIPv4Address();
+        auto range = std::upper_bound(m_ranges.cbegin(), m_ranges.cend(), host, [](quint32 value, const HostRange &r) {
+            return value < r.first;
+        });
+        if (range != m_ranges.cbegin() && host <= (range - 1)->last && !m_knownSet.contains(host)) {
+            m_knownHosts.append(host);
+            m_knownSet.insert(host);
+        }
+    }
+
+    m_backlog.clear();
+    m_answered.clear();
+    m_sentAt.clear();
+    m_foundHosts.clear();
+    m_pass = 0;
+    m_knownCursor = 0;
+    m_rangeIndex = 0;
+    m_rangeOffset = 0;
+    m_probed = 0;
+    m_maxRtt = 0;
+    m_nextPassAt = 0;
+    m_tokens = SCAN_BURST;
+    m_clock.start();
+    m_lastRefill = 0;
+
+    // 总耗时上限：按速率发完一轮的时间 + 等待响应的 timeout，补发只在这个时间内进行
+    m_deadline = total * 1000 / m_probeRate + timeout;
+    qInfo("DeviceScanner: probing %d hosts (%d known) at %d/s, deadline %lldms", m_total, m_knownHosts.size(),
+          m_probeRate, m_deadline);
+
+    m_sendTimer->start();
+    m_scanTimer->start(static_cast<int>(qMin<qint64>(m_deadline, INT_MAX)));
+    onSendTick();
+}
+
+bool DeviceScanner::nextHost(quint32 &host)
+{
+    if (!m_backlog.isEmpty()) {
+        host = m_backlog.takeLast();
+        return true;
+    }
+    while (m_knownCursor < m_knownHosts.size()) {
+        quint32 candidate = m_knownHosts[m_knownCursor++];
+        if (!m_answered.contains(candidate)) {
+            host = candidate;
+            return true;
+        }
+    }
+    if (m_pass > 0 && !m_explicitTargets) {
+        return false;
+    }
+    while (m_rangeIndex < m_ranges.size()) {
+        const HostRange &range = m_ranges[m_rangeIndex];
+        if (m_rangeOffset > range.last - range.first) {
+            m_rangeIndex++;
+            m_rangeOffset = 0;
+            continue;
+        }
+        quint32 candidate = range.first + m_rangeOffset++;
+        if (m_answered.contains(candidate) || m_knownSet.contains(candidate)) {
+            continue;
+        }
+        host = candidate;
+        return true;
+    }
+    return false;
+}
+
+void DeviceScanner::onSendTick()
+{
+    qint64 now = m_clock.elapsed();
+    m_tokens = qMin<double>(SCAN_BURST, m_tokens + (now - m_lastRefill) * m_probeRate / 1000.0);
+    m_lastRefill = now;
+    if (now < m_nextPassAt) {
+        return;
+    }
+
+    quint32 batch[SCAN_BATCH];
+    int probedBefore = m_probed;
+    while (m_tokens >= 1) {
+        int count = 0;
+        int limit = qMin(SCAN_BATCH, static_cast<int>(m_tokens));
+        while (count < limit && nextHost(batch[count])) {
+            count++;
+        }
+        if (count == 0) {
+            finishSending();
+            break;
+        }
+
+        int sent = sendProbes(batch, count);
+        for (int i = 0; i < sent; ++i) {
+            m_sentAt.insert(batch[i], now);
+        }
+        // 没发出去的留到下个节拍
+        for (int i = count - 1; i >= sent; --i) {
+            m_backlog.append(batch[i]);
+        }
+        m_tokens -= sent;
+        if (m_pass == 0) {
+            m_probed += sent;
+        }
+        if (sent < count) {
+            break;
+        }
+    }
+
+    if (m_probed != probedBefore) {
+        emit scanProgress(m_probed, m_total);
+    }
+}
+
+void DeviceScanner::finishSending()
+{
+    // 补发等待按观测到的 RTT 调整
+    qint64 retryDelay = m_maxRtt > 0 ? qBound<qint64>(100, m_maxRtt * 3, 1000) : 300;
+    qint64 now = m_clock.elapsed();
+    bool unanswered = false;
+    if (m_explicitTargets) {
+        unanswered = !m_pendingIps.isEmpty();
+    } else {
+        for (quint32 host : qAsConst(m_knownHosts)) {
+            if (!m_answered.contains(host)) {
+                unanswered = true;
+                break;
+            }
+        }
+    }
+    if (m_pass < SCAN_MAX_RETRIES && unanswered && now + retryDelay * 2 < m_deadline) {
+        m_pass++;
+        m_knownCursor = 0;
+        m_rangeIndex = 0;
+        m_rangeOffset = 0;
+        m_nextPassAt = now + retryDelay;
+        qDebug() << "DeviceScanner: retry pass" << m_pass << "after" << retryDelay << "ms,"
+                 << m_answered.size() << "of" << m_total << "answered";
+        return;
+    }
+    // 不再发送，等 m_scanTimer 到期或全部响应后结束
+    m_sendTimer->stop();
+}
+
+int DeviceScanner::sendProbes(const quint32 *hosts, int count)
+{
+    static const QByteArray probeData = SCAN_PROBE_DATA;
+#ifdef Q_OS_LINUX
+    // 一次系统调用发送一批，避免每个地址一次 writeDatagram
+    qintptr fd = m_udpSocket->socketDescriptor();
+    if (fd >= 0) {
+        struct mmsghdr msgs[SCAN_BATCH];
+        struct sockaddr_in addrs[SCAN_BATCH];
+        struct iovec iov;
+        iov.iov_base = const_cast<char *>(probeData.constData());
+        iov.iov_len = static_cast<size_t>(probeData.size());
+        memset(msgs, 0, sizeof(struct mmsghdr) * count);
+        memset(addrs, 0, sizeof(struct sockaddr_in) * count);
+        for (int i = 0; i < count; ++i) {
+            addrs[i].sin_family = AF_INET;
+            addrs[i].sin_port = htons(SCAN_PORT);
+            addrs[i].sin_addr.s_addr = htonl(hosts[i]);
+            msgs[i].msg_hdr.msg_name = &addrs[i];
+            msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+            msgs[i].msg_hdr.msg_iov = &iov;
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+        int sent = ::sendmmsg(static_cast<int>(fd), msgs, static_cast<unsigned int>(count), MSG_DONTWAIT);
+        if (sent >= 0) {
+            return sent;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS) {
+            return 0;
+        }
+        // 单个地址不可达（如 EHOSTUNREACH）时跳过它，不卡住整批
+        if (errno == EHOSTUNREACH || errno == ENETUNREACH || errno == EACCES) {
+            return 1;
+        }
+    }
+#endif
+    int sent = 0;
+    for (; sent < count; ++sent) {
+        if (m_udpSocket->writeDatagram(probeData, QHostAddress(hosts[sent]), SCAN_PORT) < 0) {
+            // 发送缓冲区满，剩下的下个节拍再发；其他错误跳过该地址
+            if (m_udpSocket->error() == QAbstractSocket::TemporaryError) {
+                break;
+            }
+        }
+    }
+    return sent;
+}
@@ -8,6 +8,9 @@
 #include <QTimer>
 #include <QNetworkInterface>
 #include <QSet>
+#include <QHash>
+#include <QVector>
+#include <QElapsedTimer>
 
 class DeviceScanner : public QObject
 {
@@ -24,6 +27,8 @@ public:
     Q_INVOKABLE void startDiscovery(int timeout = 3000);
     Q_INVOKABLE void startDiscoveryWithIps(const QString& ipList, int timeout = 3000);
     Q_INVOKABLE void stopDiscovery();
+    // 探测包发送速率（包/秒），默认 4000
+    Q_INVOKABLE void setProbeRate(int probesPerSecond);
 
 signals:
     void scanningChanged();
@@ -32,20 +37,59 @@ signals:
     void discoveryStarted();
     void discoveryFinished();
     void discoveryFailed(const QStringList &failedIps);
+    void scanProgress(int probed, int total);
 
 private slots:
     void onReadyRead();
     void onScanTimeout();
+    void onSendTick();
 
 private:
-    QList<QHostAddress> getTargetHosts();
+    struct HostRange
+    {
+        quint32 first;
+        quint32 last;
+    };
+
+    QVector<HostRange> getTargetRanges();
+    void beginScan(const QVector<HostRange> &ranges, int timeout);
+    bool nextHost(quint32 &host);
+    int sendProbes(const quint32 *hosts, int count);
+    void finishSending();
+    void rememberHost(quint32 host);
 
     QUdpSocket *m_udpSocket;
+    QTimer *m_sendTimer;
     QTimer *m_scanTimer;
     bool m_scanning;
     QVariantList m_discoveredDevices;
     QSet<QString> m_foundDeviceIds; // 用于设备去重
     QSet<QString> m_pendingIps;     // 用于追踪待响应的IP
+    bool m_explicitTargets = false; // 是否为指定 IP 扫描
+
+    // 发送状态：目标按地址段保存，不展开成地址列表
+    QVector<HostRange> m_ranges;
+    QVector<quint32> m_backlog;         // 发送缓冲区满时没发出去的地址
+    QVector<quint32> m_knownHosts;      // 以前扫描有响应的主机，每轮优先探测
+    QSet<quint32> m_knownSet;
+    QSet<quint32> m_answered;
+    QHash<quint32, qint64> m_sentAt;    // 探测发送时间，用于估算 RTT
+    int m_pass = 0;
+    int m_knownCursor = 0;
+    int m_rangeIndex = 0;
+    quint32 m_rangeOffset = 0;
+    int m_total = 0;
+    int m_probed = 0;
+    qint64 m_maxRtt = 0;
+    qint64 m_nextPassAt = 0;
+    qint64 m_deadline = 0;
+    QSet<quint32> m_foundHosts;         // 本次扫描新发现的主机，结束时写入缓存
+
+    // 令牌桶
+    int m_probeRate = 4000;
+    double m_tokens = 0;
+    qint64 m_lastRefill = 0;
+    QElapsedTimer m_clock;
 };
 
 #endif // DEVICESCANNER_H
@@ -12,13 +12,16 @@
 #include <QJSEngine>
 #include <QJsonArray>
 #include <QStandardPaths>
-#include <QThreadPool>
 #include <QDir>
 #include <QCryptographicHash>
-#include <QEventLoop>
 #include <QGuiApplication>
 #include <utility>
 
+// 按 Content-Length 预留响应缓冲的上限，更大的响应按需增长
+#define MAX_RESPONSE_RESERVE (256 * 1024 * 1024)
+// 内存响应缓存上限（按 QString 字节数计）
+#define MEMORY_CACHE_BYTES (16 * 1024 * 1024)
+
 NetworkCallable::NetworkCallable(QObject *parent) : QObject{parent} {
 }
 
@@ -133,6 +136,21 @@ NetworkParams *NetworkParams::setCacheMode(int val) {
     return this;
 }
 
+NetworkParams *NetworkParams::setPriority(int val) {
+    _priority = qBound<int>(PriorityInteractive, val, PriorityBackground);
+    return this;
+}
+
+NetworkParams *NetworkParams::setStreamChunks(bool val) {
+    _streamChunks = val;
+    return this;
+}
+
+NetworkParams *NetworkParams::setReadOnly(bool val) {
+    _readOnly = val;
+    return this;
+}
+
 NetworkParams *NetworkParams::toDownload(QString destPath, bool append) {
     _downloadParam = new FluDownloadParam(std::move(destPath), append, this);
     return this;
@@ -178,9 +196,13 @@ QString NetworkParams::buildCacheKey() const {
 }
 
 void NetworkParams::go(NetworkCallable *callable) {
-    QJSValueList data;
-    data << qjsEngine(callable)->newQObject(this);
-    Network::getInstance()->_interceptor.call(data);
+    // 拦截器是 QML 里设置的，C++ 创建的 callable 没有 JS 引擎，跳过
+    QJSEngine *engine = qjsEngine(callable);
+    if (engine && Network::getInstance()->_interceptor.isCallable()) {
+        QJSValueList data;
+        data << engine->newQObject(this);
+        Network::getInstance()->_interceptor.call(data);
+    }
     if (_downloadParam) {
         Network::getInstance()->handleDownload(this, callable);
     } else {
@@ -194,107 +216,400 @@ QString NetworkParams::url(){
 
 void Network::handle(NetworkParams *params, NetworkCallable *c) {
     QPointer<NetworkCallable> callable(c);
-    QThreadPool::globalInstance()->start([=]() {
+    if (!callable.isNull()) {
+        callable->start();
+    }
+    QString cacheKey = params->buildCacheKey();
+    if (params->_cacheMode == NetworkType::CacheMode::FirstCacheThenRequest &&
+        cacheExists(cacheKey)) {
         if (!callable.isNull()) {
-            callable->start();
+            callable->cache(readCache(cacheKey), params->userData());
         }
-        QString cacheKey = params->buildCacheKey();
-        if (params->_cacheMode == NetworkType::CacheMode::FirstCacheThenRequest &&
-            cacheExists(cacheKey)) {
-            if (!callable.isNull()) {
-                callable->cache(readCache(cacheKey), params->userData());
-            }
+    }
+    if (params->_cacheMode == NetworkType::CacheMode::IfNoneCacheRequest &&
+        cacheExists(cacheKey)) {
+        if (!callable.isNull()) {
+            callable->cache(readCache(cacheKey), params->userData());
+            callable->finish();
         }
-        if (params->_cacheMode == NetworkType::CacheMode::IfNoneCacheRequest &&
-            cacheExists(cacheKey)) {
+        params->deleteLater();
+        return;
+    }
+
+    QUrl url(params->_url);
+    QString host = url.authority();
+    bool isGet = params->_method == NetworkParams::METHOD_GET && !params->_streamChunks;
+    bool isWrite = params->_method != NetworkParams::METHOD_GET &&
+                   params->_method != NetworkParams::METHOD_HEAD && !params->_readOnly;
+    if (isWrite) {
+        // 修改类请求之后该 host 的内存缓存和在途 GET 都不再可信，请求完成时还会再标记一次
+        markHostWritten(host);
+    }
+
+    int ttlMs = isGet ? endpointTtl(url) : 0;
+    if (ttlMs > 0) {
+        MemoryEntry *entry = _memoryCache.object(cacheKey);
+        if (entry && entry->storedAt >= 0 && _clock.elapsed() - entry->storedAt < ttlMs) {
+            _cacheHits++;
             if (!callable.isNull()) {
-                callable->cache(readCache(cacheKey), params->userData());
+                callable->success(entry->response, params->userData());
                 callable->finish();
-                params->deleteLater();
             }
+            params->deleteLater();
             return;
         }
-        QNetworkAccessManager manager;
-        manager.setTransferTimeout(params->getTimeout());
-        QEventLoop loop;
-        connect(&manager, &QNetworkAccessManager::finished, &manager,
-                [&loop](QNetworkReply *reply) { loop.quit(); });
-        for (int i = 0; i <= params->getRetry() - 1; ++i) {
-            QUrl url(params->_url);
-            addQueryParam(&url, params->_queryMap);
-            QNetworkRequest request(url);
-            addHeaders(&request, params->_headerMap);
-            QNetworkReply *reply;
-            sendRequest(&manager, request, params, reply, i == 0, callable);
-            if (!QPointer<QCoreApplication>(QGuiApplication::instance())) {
-                reply->deleteLater();
-                reply = nullptr;
-                return;
-            }
-            auto abortCallable = [reply, &i, params] {
-                if (reply) {
-                    i = params->getRetry();
-                    reply->abort();
-                }
-            };
-            QMetaObject::Connection conn_destroyed = {};
-            QMetaObject::Connection conn_quit = {};
-            if (params->_target) {
-                conn_destroyed =
-                    connect(params->_target, &QObject::destroyed, &manager, abortCallable);
-            }
-            conn_quit = connect(QGuiApplication::instance(), &QGuiApplication::aboutToQuit,
-                                &manager, abortCallable);
-            loop.exec();
-            if (conn_destroyed) {
-                disconnect(conn_destroyed);
+        _cacheMisses++;
+    }
+
+    if (isGet) {
+        TaskPtr inflight = _inflightGets.value(cacheKey);
+        if (inflight && inflight->writeGen == _hostWriteGen.value(host)) {
+            // 与在途请求完全相同，等它的结果即可
+            _coalesced++;
+            inflight->followers.append({params, callable});
+            return;
+        }
+    }
+
+    auto task = TaskPtr::create();
+    task->params = params;
+    task->callable = callable;
+    task->cacheKey = cacheKey;
+    task->host = host;
+    task->priority = params->_priority;
+    task->ttlMs = ttlMs;
+    task->writeGen = _hostWriteGen.value(host);
+    // 绑定的对象销毁后不再发起/重试请求
+    if (params->_target) {
+        connect(params->_target, &QObject::destroyed, params, [task] { task->cancelled = true; });
+    }
+    if (isGet) {
+        task->coalesced = true;
+        _inflightGets.insert(cacheKey, task);
+    }
+    enqueue(task);
+}
+
+void Network::enqueue(const TaskPtr &task, bool front) {
+    QQueue<TaskPtr> &queue = _hostQueues[task->host].queues[task->priority];
+    if (front) {
+        queue.prepend(task);
+    } else {
+        task->queued.start();
+        queue.enqueue(task);
+        // 后台请求积压说明 host 已经忙不过来，丢弃最早的一个（轮询类请求下一轮还会再发）
+        if (task->priority == NetworkParams::PriorityBackground &&
+            queue.size() > qMax(1, _maxBackgroundQueue)) {
+            shed(queue.dequeue());
+        }
+    }
+    pump(task->host);
+}
+
+Network::TaskPtr Network::takeNext(HostQueue &hostQueue, int active) {
+    int limit = qMax(1, _maxConnectionsPerHost);
+    // 交互请求可以多占两个名额，由 manager 按 request priority 优先发送；
+    // 后台请求留出一个名额，保证交互请求到来时不用等后台请求结束
+    const int limits[NetworkParams::PriorityCount] = {limit + 2, limit, qMax(1, limit - 1)};
+    for (int priority = 0; priority < NetworkParams::PriorityCount; ++priority) {
+        QQueue<TaskPtr> &queue = hostQueue.queues[priority];
+        if (!queue.isEmpty() && active < limits[priority]) {
+            return queue.dequeue();
+        }
+    }
+    return TaskPtr();
+}
+
+void Network::pump(const QString &host) {
+    // 回调里可能重入 enqueue/pump，每轮重新查找，不跨回调持有迭代器
+    for (;;) {
+        auto it = _hostQueues.find(host);
+        if (it == _hostQueues.end()) {
+            return;
+        }
+        // 每个 host 同时在途的请求有上限，其余按优先级排队
+        TaskPtr task = takeNext(*it, _hostActive.value(host));
+        if (!task) {
+            bool empty = true;
+            for (const QQueue<TaskPtr> &queue : it->queues) {
+                empty = empty && queue.isEmpty();
             }
-            if (conn_quit) {
-                disconnect(conn_quit);
+            if (empty) {
+                _hostQueues.erase(it);
             }
-            QString response;
-            if (params->_method == NetworkParams::METHOD_HEAD) {
-                response = headerList2String(reply->rawHeaderPairs());
-            } else {
-                if (params->_type == NetworkParams::TYPE_JSON) {
-                    response = QString::fromUtf8(reply->property("accumulatedBody").toByteArray());
-                } else {
-                    if (reply->isOpen()) {
-                        response = QString::fromUtf8(reply->readAll());
-                    }
-                }
+            return;
+        }
+        if (!task->wanted() || _quitting) {
+            complete(task);
+            continue;
+        }
+        if (task->attempt == 0) {
+            QueueStats &stats = _queueStats[task->priority];
+            qint64 waitMs = task->queued.elapsed();
+            stats.count++;
+            stats.totalWaitMs += waitMs;
+            stats.maxWaitMs = qMax(stats.maxWaitMs, waitMs);
+        }
+        dispatch(task);
+    }
+}
+
+void Network::shed(const TaskPtr &task) {
+    _queueStats[task->priority].shed++;
+    notifyError(task, -1, "request shed: host busy", "");
+    complete(task);
+}
+
+QVariantMap Network::queueStats() const {
+    static const char *names[NetworkParams::PriorityCount] = {"interactive", "normal", "background"};
+    QVariantMap result;
+    for (int priority = 0; priority < NetworkParams::PriorityCount; ++priority) {
+        const QueueStats &stats = _queueStats[priority];
+        QVariantMap item;
+        item.insert("count", stats.count);
+        item.insert("avgWaitMs", stats.count ? stats.totalWaitMs / qint64(stats.count) : 0);
+        item.insert("maxWaitMs", stats.maxWaitMs);
+        item.insert("shed", stats.shed);
+        result.insert(names[priority], item);
+    }
+    return result;
+}
+
+void Network::dispatch(const TaskPtr &task) {
+    NetworkParams *params = task->params;
+    if (params->_downloadParam) {
+        dispatchDownload(task);
+        return;
+    }
+    QUrl url(params->_url);
+    addQueryParam(&url, params->_queryMap);
+    QNetworkRequest request(url);
+    addHeaders(&request, params->_headerMap);
+    request.setTransferTimeout(params->getTimeout());
+    static const QNetworkRequest::Priority requestPriority[NetworkParams::PriorityCount] = {
+        QNetworkRequest::HighPriority, QNetworkRequest::NormalPriority, QNetworkRequest::LowPriority};
+    request.setPriority(requestPriority[task->priority]);
+    task->request = request;
+
+    QNetworkReply *reply;
+    sendRequest(_manager, request, params, reply, task->attempt == 0, task->callable);
+    _hostActive[task->host]++;
+    task->body.clear();
+    if (params->_method != NetworkParams::METHOD_HEAD) {
+        connect(reply, &QNetworkReply::readyRead, this, [this, task, reply] { onReadyRead(task, reply); });
+    }
+    if (params->_target) {
+        connect(params->_target, &QObject::destroyed, reply, [task, reply] {
+            if (task->followers.isEmpty()) {
+                reply->abort();
             }
-            int httpStatus = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
-            if (httpStatus == 200) {
-                if (!callable.isNull()) {
-                    if (params->_cacheMode != NetworkType::CacheMode::NoCache) {
-                        saveResponse(cacheKey, response);
-                    }
-                    callable->success(response, params->userData());
-                }
-                printRequestEndLog(request, params, reply, response);
-                break;
+        });
+    }
+    connect(reply, &QNetworkReply::finished, this, [this, task, reply] { onReplyFinished(task, reply); });
+}
+
+void Network::onReadyRead(const TaskPtr &task, QNetworkReply *reply) {
+    QByteArray chunk = reply->readAll();
+    if (chunk.isEmpty()) {
+        return;
+    }
+    if (task->body.isEmpty()) {
+        // 首块数据到达时按 Content-Length 一次预留，之后追加不再扩容拷贝
+        qint64 length = reply->header(QNetworkRequest::ContentLengthHeader).toLongLong();
+        if (length > chunk.size() && length <= MAX_RESPONSE_RESERVE) {
+            task->body.reserve(static_cast<int>(length));
+        }
+    }
+    task->body.append(chunk);
+    if (task->params->_streamChunks && !task->callable.isNull()) {
+        // chunk 是 readAll 返回的独立缓冲，隐式共享交给接收方，不再拷贝
+        Q_EMIT task->callable->chunkData(chunk, task->params->userData());
+        Q_EMIT task->callable->chunck(QString::fromUtf8(chunk), task->params->userData());
+    }
+}
+
+void Network::onReplyFinished(const TaskPtr &task, QNetworkReply *reply) {
+    NetworkParams *params = task->params;
+    if (--_hostActive[task->host] <= 0) {
+        _hostActive.remove(task->host);
+    }
+    // 请求发出后该 host 有过其他修改时，响应可能是修改前的数据，不写入缓存
+    bool fresh = task->writeGen == _hostWriteGen.value(task->host);
+    if (params->_method != NetworkParams::METHOD_GET && params->_method != NetworkParams::METHOD_HEAD &&
+        !params->_readOnly) {
+        // 修改在途期间读到的 GET 结果可能是旧数据，写入生效后再标记一次
+        markHostWritten(task->host);
+    }
+
+    QString response;
+    if (params->_method == NetworkParams::METHOD_HEAD) {
+        response = headerList2String(reply->rawHeaderPairs());
+    } else {
+        if (reply->isOpen() && reply->bytesAvailable() > 0) {
+            task->body.append(reply->readAll());
+        }
+        response = QString::fromUtf8(task->body);
+        // 响应已转成 QString，释放缓冲
+        task->body = QByteArray();
+    }
+    int httpStatus = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (httpStatus == 200) {
+        if (fresh && params->_cacheMode != NetworkType::CacheMode::NoCache) {
+            saveResponse(task->cacheKey, response);
+        }
+        if (fresh && (params->_cacheMode != NetworkType::CacheMode::NoCache || task->ttlMs > 0)) {
+            insertMemoryCache(task->cacheKey, new MemoryEntry{response, task->host, _clock.elapsed()});
+        }
+        notifySuccess(task, response);
+        printRequestEndLog(task->request, params, reply, response);
+        reply->deleteLater();
+        complete(task);
+        return;
+    }
+
+    bool aborted = reply->error() == QNetworkReply::OperationCanceledError;
+    if (!aborted && task->wanted() && !_quitting && task->attempt < params->getRetry() - 1) {
+        // 重试放回队首，复用同一个 host 的连接
+        task->attempt++;
+        reply->deleteLater();
+        enqueue(task, true);
+        return;
+    }
+
+    if (params->_cacheMode == NetworkType::CacheMode::RequestFailedReadCache &&
+        cacheExists(task->cacheKey) && !task->callable.isNull()) {
+        task->callable->cache(readCache(task->cacheKey), params->userData());
+    }
+    notifyError(task, httpStatus, reply->errorString(), response);
+    printRequestEndLog(task->request, params, reply, response);
+    reply->deleteLater();
+    complete(task);
+}
+
+void Network::notifySuccess(const TaskPtr &task, const QString &response) {
+    // 先摘掉在途记录，回调里再发同样的请求时走新的一轮
+    if (task->coalesced && _inflightGets.value(task->cacheKey) == task) {
+        _inflightGets.remove(task->cacheKey);
+    }
+    if (!task->callable.isNull()) {
+        task->callable->success(response, task->params->userData());
+    }
+    for (const Follower &follower : qAsConst(task->followers)) {
+        if (!follower.callable.isNull()) {
+            follower.callable->success(response, follower.params->userData());
+        }
+    }
+}
+
+void Network::notifyError(const TaskPtr &task, int status, const QString &errorString,
+                          const QString &response) {
+    if (task->coalesced && _inflightGets.value(task->cacheKey) == task) {
+        _inflightGets.remove(task->cacheKey);
+    }
+    if (!task->callable.isNull()) {
+        task->callable->error(status, errorString, response, task->params->userData());
+    }
+    for (const Follower &follower : qAsConst(task->followers)) {
+        if (!follower.callable.isNull()) {
+            follower.callable->error(status, errorString, response, follower.params->userData());
+        }
+    }
+}
+
+void Network::complete(const TaskPtr &task) {
+    if (task->coalesced && _inflightGets.value(task->cacheKey) == task) {
+        _inflightGets.remove(task->cacheKey);
+    }
+    task->params->deleteLater();
+    if (!task->callable.isNull()) {
+        task->callable->finish();
+    }
+    const QList<Follower> followers = task->followers;
+    task->followers.clear();
+    for (const Follower &follower : followers) {
+        follower.params->deleteLater();
+        if (!follower.callable.isNull()) {
+            follower.callable->finish();
+        }
+    }
+    pump(task->host);
+}
+
+int Network::endpointTtl(const QUrl &url) const {
+    const QString path = url.path();
+    for (const auto &item : _endpointTtls) {
+        if (path.startsWith(item.first)) {
+            return item.second;
+        }
+    }
+    return 0;
+}
+
+void Network::setEndpointTtl(const QString &pathPrefix, int ttlMs) {
+    for (int i = 0; i < _endpointTtls.size(); ++i) {
+        if (_endpointTtls[i].first == pathPrefix) {
+            _endpointTtls.removeAt(i);
+            break;
+        }
+    }
+    if (ttlMs > 0) {
+        // 长前缀优先匹配
+        int pos = 0;
+        while (pos < _endpointTtls.size() && _endpointTtls[pos].first.size() >= pathPrefix.size()) {
+            pos++;
+        }
+        _endpointTtls.insert(pos, qMakePair(pathPrefix, ttlMs));
+    }
+}
+
+void Network::invalidateHost(const QString &host) {
+    const QSet<QString> keys = _hostCacheKeys.take(host);
+    for (const QString &key : keys) {
+        _memoryCache.remove(key);
+    }
+}
+
+void Network::markHostWritten(const QString &host) {
+    _hostWriteGen[host]++;
+    invalidateHost(host);
+    // 在途 GET 照常完成并回调已合并的请求，之后相同的 GET 重新发出
+    for (auto it = _inflightGets.begin(); it != _inflightGets.end();) {
+        if (it.value()->host == host) {
+            it = _inflightGets.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void Network::insertMemoryCache(const QString &key, MemoryEntry *entry) {
+    const QString host = entry->host;
+    int cost = qMax(1, entry->response.size() * 2);
+    if (!_memoryCache.insert(key, entry, cost) || host.isEmpty()) {
+        return;
+    }
+    QSet<QString> &keys = _hostCacheKeys[host];
+    keys.insert(key);
+    if (keys.size() > qMax(64, _memoryCache.count() * 2)) {
+        // 被 LRU 淘汰的 key 不会通知这里，记录过多时按缓存现状收缩（contains 不改变 LRU 顺序）
+        for (auto it = keys.begin(); it != keys.end();) {
+            if (_memoryCache.contains(*it)) {
+                ++it;
             } else {
-                if (i == params->getRetry() - 1) {
-                    if (!callable.isNull()) {
-                        if (params->_cacheMode == NetworkType::CacheMode::RequestFailedReadCache &&
-                            cacheExists(cacheKey)) {
-                            if (!callable.isNull()) {
-                                callable->cache(readCache(cacheKey), params->userData());
-                            }
-                        }
-                        callable->error(httpStatus, reply->errorString(), response, params->userData());
-                    }
-                    printRequestEndLog(request, params, reply, response);
-                }
+                it = keys.erase(it);
             }
-            reply->deleteLater();
         }
-        params->deleteLater();
-        if (!callable.isNull()) {
-            callable->finish();
-        }
-    });
+    }
+}
+
+QVariantMap Network::cacheStats() const {
+    QVariantMap result;
+    result.insert("hits", _cacheHits);
+    result.insert("misses", _cacheMisses);
+    result.insert("coalesced", _coalesced);
+    result.insert("entries", _memoryCache.count());
+    result.insert("bytes", _memoryCache.totalCost());
+    return result;
 }
 
 // void Network::handleDownload(NetworkParams *params, NetworkCallable *c) {
@@ -426,158 +741,169 @@ void Network::handle(NetworkParams *params, NetworkCallable *c) {
 
 void Network::handleDownload(NetworkParams *params, NetworkCallable *c) {
     QPointer<NetworkCallable> callable(c);
-    QThreadPool::globalInstance()->start([=]() {
-        if (!callable.isNull()) {
-            callable->start();
-        }
-
-        QString cacheKey = params->buildCacheKey();
-        QUrl url(params->_url);
-        QNetworkAccessManager manager;
-        manager.setTransferTimeout(params->getTimeout());
-        addQueryParam(&url, params->_queryMap);
-        QNetworkRequest request(url);
-        addHeaders(&request, params->_headerMap);
-
-        QString cachePath = getCacheFilePath(cacheKey);
-        QString destPath = params->_downloadParam->_destPath;
-
-        auto *destFile = new QFile(destPath);
-        auto *cacheFile = new QFile(cachePath);
-
-        bool isOpen;
-        qint64 seek = 0;
-        qint64 totalExpectedContentLength = 0;
-
-        if (cacheFile->exists() && destFile->exists() && params->_downloadParam->_append) {
-            QJsonObject cacheInfo = QJsonDocument::fromJson(readCache(cacheKey).toUtf8()).object();
-            qint64 cachedFileSize = qRound(cacheInfo.value("fileSize").toDouble());
-            totalExpectedContentLength = qRound(cacheInfo.value("contentLength").toDouble());
-            qint64 actualDestFileSize = destFile->size();
-
-            if (cachedFileSize == totalExpectedContentLength && actualDestFileSize == totalExpectedContentLength && totalExpectedContentLength > 0) {
-                if (!callable.isNull()) {
-                    callable->downloadProgress(cachedFileSize, totalExpectedContentLength);
-                    callable->success(destPath, params->userData());
-                    callable->finish();
-                }
-                destFile->deleteLater();
-                cacheFile->deleteLater();
-                params->deleteLater();
-                return;
-            }
+    if (!callable.isNull()) {
+        callable->start();
+    }
 
-            if (cachedFileSize == actualDestFileSize) {
-                request.setRawHeader("Range", QString("bytes=%1-").arg(cachedFileSize).toUtf8());
-                seek = cachedFileSize;
-                isOpen = destFile->open(QIODevice::WriteOnly | QIODevice::Append);
-            } else {
-                qWarning() << "Cached file size mismatch with actual file size. Restarting download.";
-                isOpen = destFile->open(QIODevice::WriteOnly | QIODevice::Truncate);
-                seek = 0;
-            }
-        } else {
-            isOpen = destFile->open(QIODevice::WriteOnly | QIODevice::Truncate);
-            seek = 0;
-        }
+    // 下载与普通请求一样按 host 排队，占用同一份并发名额，轮到时由 dispatchDownload 发出
+    auto task = TaskPtr::create();
+    task->params = params;
+    task->callable = callable;
+    task->cacheKey = params->buildCacheKey();
+    task->host = QUrl(params->_url).authority();
+    task->priority = params->_priority;
+    if (params->_target) {
+        connect(params->_target, &QObject::destroyed, params, [task] { task->cancelled = true; });
+    }
+    enqueue(task);
+}
 
-        if (!isOpen) {
+void Network::dispatchDownload(const TaskPtr &task) {
+    NetworkParams *params = task->params;
+    QPointer<NetworkCallable> callable = task->callable;
+    QString cacheKey = task->cacheKey;
+    QUrl url(params->_url);
+    addQueryParam(&url, params->_queryMap);
+    QNetworkRequest request(url);
+    addHeaders(&request, params->_headerMap);
+    request.setTransferTimeout(params->getTimeout());
+    static const QNetworkRequest::Priority requestPriority[NetworkParams::PriorityCount] = {
+        QNetworkRequest::HighPriority, QNetworkRequest::NormalPriority, QNetworkRequest::LowPriority};
+    request.setPriority(requestPriority[task->priority]);
+
+    QString cachePath = getCacheFilePath(cacheKey);
+    QString destPath = params->_downloadParam->_destPath;
+
+    auto *destFile = new QFile(destPath);
+    auto *cacheFile = new QFile(cachePath);
+
+    bool isOpen;
+    qint64 seek = 0;
+    // readyRead 和 finished 回调共用，请求异步执行，不能引用栈上的变量
+    auto totalLength = QSharedPointer<qint64>::create(0);
+    qint64 &totalExpectedContentLength = *totalLength;
+
+    // 下载进度文件在 readyRead 中不断重写，内存里的副本不可信，始终读磁盘
+    _memoryCache.remove(cacheKey);
+    if (cacheFile->exists() && destFile->exists() && params->_downloadParam->_append) {
+        QJsonObject cacheInfo = QJsonDocument::fromJson(readCacheFile(cacheKey).toUtf8()).object();
+        qint64 cachedFileSize = qRound(cacheInfo.value("fileSize").toDouble());
+        totalExpectedContentLength = qRound(cacheInfo.value("contentLength").toDouble());
+        qint64 actualDestFileSize = destFile->size();
+
+        if (cachedFileSize == totalExpectedContentLength && actualDestFileSize == totalExpectedContentLength && totalExpectedContentLength > 0) {
             if (!callable.isNull()) {
-                callable->error(-1, "device not open", "", params->userData());
-                callable->finish();
+                callable->downloadProgress(cachedFileSize, totalExpectedContentLength);
+                callable->success(destPath, params->userData());
             }
             destFile->deleteLater();
             cacheFile->deleteLater();
-            params->deleteLater();
+            complete(task);
             return;
         }
 
-        if (!cacheFile->open(QIODevice::WriteOnly | QIODevice::Truncate)) {
-            qWarning() << "Could not open cache file for writing:" << cachePath << cacheFile->errorString();
+        if (cachedFileSize == actualDestFileSize) {
+            request.setRawHeader("Range", QString("bytes=%1-").arg(cachedFileSize).toUtf8());
+            seek = cachedFileSize;
+            isOpen = destFile->open(QIODevice::WriteOnly | QIODevice::Append);
+        } else {
+            qWarning() << "Cached file size mismatch with actual file size. Restarting download.";
+            isOpen = destFile->open(QIODevice::WriteOnly | QIODevice::Truncate);
+            seek = 0;
         }
+    } else {
+        isOpen = destFile->open(QIODevice::WriteOnly | QIODevice::Truncate);
+        seek = 0;
+    }
 
-        QEventLoop loop;
-        QNetworkReply *reply = manager.get(request);
-        destFile->setParent(reply);
-        cacheFile->setParent(reply);
+    if (!isOpen) {
+        if (!callable.isNull()) {
+            callable->error(-1, "device not open", "", params->userData());
+        }
+        destFile->deleteLater();
+        cacheFile->deleteLater();
+        complete(task);
+        return;
+    }
 
-        QObject::connect(reply, &QNetworkReply::finished, &loop, &QEventLoop::quit);
+    if (!cacheFile->open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Could not open cache file for writing:" << cachePath << cacheFile->errorString();
+    }
 
-        QMetaObject::Connection conn_target_destroyed;
-        if (params->_target) {
-            conn_target_destroyed = QObject::connect(params->_target, &QObject::destroyed, reply, [reply]() {
-                if (reply && reply->isRunning()) {
-                    reply->abort();
-                    qDebug() << "Download aborted due to target destruction.";
-                }
-            });
-        }
-        QMetaObject::Connection conn_app_quit = QObject::connect(QGuiApplication::instance(), &QGuiApplication::aboutToQuit, reply, [reply]() {
+    QNetworkReply *reply = _manager->get(request);
+    _hostActive[task->host]++;
+    destFile->setParent(reply);
+    cacheFile->setParent(reply);
+
+    QMetaObject::Connection conn_target_destroyed;
+    if (params->_target) {
+        conn_target_destroyed = QObject::connect(params->_target, &QObject::destroyed, reply, [reply]() {
             if (reply && reply->isRunning()) {
                 reply->abort();
-                qDebug() << "Download aborted due to application quitting.";
+                qDebug() << "Download aborted due to target destruction.";
             }
         });
+    }
 
-        QObject::connect(reply, &QNetworkReply::readyRead, reply,
-                         [reply, seek, destFile, cacheFile, callable, params, &totalExpectedContentLength] {
-                             if (!reply || reply->error() != QNetworkReply::NoError) {
-                                 return;
-                             }
-
-                             destFile->write(reply->readAll());
-                             destFile->flush();
+    QObject::connect(reply, &QNetworkReply::readyRead, reply,
+                     [reply, seek, destFile, cacheFile, callable, params, totalLength] {
+                         qint64 &totalExpectedContentLength = *totalLength;
+                         if (!reply || reply->error() != QNetworkReply::NoError) {
+                             return;
+                         }
 
-                             qint64 currentDownloadedSize = destFile->size();
+                         destFile->write(reply->readAll());
+                         destFile->flush();
 
-                             if (totalExpectedContentLength == 0) {
-                                 QByteArray rangeHeader = reply->rawHeader("Content-Range");
-                                 if (!rangeHeader.isEmpty()) {
-                                     int slashIndex = rangeHeader.lastIndexOf('/');
-                                     if (slashIndex != -1) {
-                                         totalExpectedContentLength = rangeHeader.mid(slashIndex + 1).toLongLong();
-                                     }
-                                 } else {
-                                     totalExpectedContentLength = reply->header(QNetworkRequest::ContentLengthHeader).toLongLong() + seek;
-                                 }
+                         qint64 currentDownloadedSize = destFile->size();
 
-                                 if (totalExpectedContentLength < currentDownloadedSize) {
-                                     totalExpectedContentLength = currentDownloadedSize;
+                         if (totalExpectedContentLength == 0) {
+                             QByteArray rangeHeader = reply->rawHeader("Content-Range");
+                             if (!rangeHeader.isEmpty()) {
+                                 int slashIndex = rangeHeader.lastIndexOf('/');
+                                 if (slashIndex != -1) {
+                                     totalExpectedContentLength = rangeHeader.mid(slashIndex + 1).toLongLong();
                                  }
+                             } else {
+                                 totalExpectedContentLength = reply->header(QNetworkRequest::ContentLengthHeader).toLongLong() + seek;
                              }
 
-                             if (cacheFile->isOpen()) {
-                                 QMap<QString, QVariant> downInfo;
-                                 downInfo.insert("contentLength", totalExpectedContentLength);
-                                 downInfo.insert("fileSize", currentDownloadedSize);
-                                 QString eTag = reply->header(QNetworkRequest::ETagHeader).toString();
-                                 downInfo.insert("eTag", eTag);
-
-                                 cacheFile->resize(0);
-                                 cacheFile->write(QJsonDocument::fromVariant(QVariant(downInfo)).toJson().toBase64());
-                                 cacheFile->flush();
-                             }
-
-                             if (!callable.isNull()) {
-                                 callable->downloadProgress(currentDownloadedSize, totalExpectedContentLength);
+                             if (totalExpectedContentLength < currentDownloadedSize) {
+                                 totalExpectedContentLength = currentDownloadedSize;
                              }
-                         });
-
-        // --- 在 reply->finished 信号中断开其他连接 ---
-        QObject::connect(reply, &QNetworkReply::finished, reply, [conn_target_destroyed, conn_app_quit]() mutable {
-            // 在 Qt 5.x 中，直接比较 QMetaObject::Connection 对象与 0 (或布尔值)
-            // 默认构造的 QMetaObject::Connection 值为 0，表示无效连接
-            if (conn_target_destroyed) { // 替换 conn_target_destroyed.isValid()
-                QObject::disconnect(conn_target_destroyed);
-            }
-            if (conn_app_quit) { // 替换 conn_app_quit.isValid()
-                QObject::disconnect(conn_app_quit);
-            }
-        });
-
-
-        loop.exec();
+                         }
+
+                         if (cacheFile->isOpen()) {
+                             QMap<QString, QVariant> downInfo;
+                             downInfo.insert("contentLength", totalExpectedContentLength);
+                             downInfo.insert("fileSize", currentDownloadedSize);
+                             QString eTag = reply->header(QNetworkRequest::ETagHeader).toString();
+                             downInfo.insert("eTag", eTag);
+
+                             cacheFile->resize(0);
+                             cacheFile->write(QJsonDocument::fromVariant(QVariant(downInfo)).toJson().toBase64());
+                             cacheFile->flush();
+                         }
+
+                         if (!callable.isNull()) {
+                             callable->downloadProgress(currentDownloadedSize, totalExpectedContentLength);
+                         }
+                     });
+
+    // --- 在 reply->finished 信号中断开其他连接 ---
+    QObject::connect(reply, &QNetworkReply::finished, this,
+                     [this, task, reply, request, destFile, destPath, callable, params, totalLength,
+                      conn_target_destroyed]() mutable {
+        // 在 Qt 5.x 中，直接比较 QMetaObject::Connection 对象与 0 (或布尔值)
+        // 默认构造的 QMetaObject::Connection 值为 0，表示无效连接
+        if (conn_target_destroyed) { // 替换 conn_target_destroyed.isValid()
+            QObject::disconnect(conn_target_destroyed);
+        }
+        if (--_hostActive[task->host] <= 0) {
+            _hostActive.remove(task->host);
+        }
 
+        qint64 totalExpectedContentLength = *totalLength;
         int httpStatus = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
         QNetworkReply::NetworkError error = reply->error();
 
@@ -599,19 +925,30 @@ void Network::handleDownload(NetworkParams *params, NetworkCallable *c) {
             printRequestEndLog(request, params, reply, destPath);
         }
 
-        if (!callable.isNull()) {
-            callable->finish();
-        }
+        reply->deleteLater();
+        // 释放参数、通知 finish，并让该 host 排队的请求继续
+        complete(task);
     });
 }
 
 QString Network::readCache(const QString &key) {
-    auto filePath = getCacheFilePath(key);
-    QString result;
-    QFile file(filePath);
-    if (!file.exists()) {
-        return result;
+    if (MemoryEntry *entry = _memoryCache.object(key)) {
+        _cacheHits++;
+        return entry->response;
+    }
+    _cacheMisses++;
+    if (!QFile::exists(getCacheFilePath(key))) {
+        return QString();
     }
+    QString result = readCacheFile(key);
+    // 从磁盘读回的内容时效未知，只做磁盘缓存的替身，不参与 TTL 命中
+    insertMemoryCache(key, new MemoryEntry{result, QString(), -1});
+    return result;
+}
+
+QString Network::readCacheFile(const QString &key) {
+    QString result;
+    QFile file(getCacheFilePath(key));
     if (file.open(QIODevice::ReadOnly)) {
         QTextStream stream(&file);
         result = QString(QByteArray::fromBase64(stream.readAll().toUtf8()));
@@ -620,7 +957,7 @@ QString Network::readCache(const QString &key) {
 }
 
 bool Network::cacheExists(const QString &key) {
-    return QFile(getCacheFilePath(key)).exists();
+    return _memoryCache.contains(key) || QFile(getCacheFilePath(key)).exists();
 }
 
 QString Network::getCacheFilePath(const QString &key) {
@@ -686,14 +1023,6 @@ void Network::sendRequest(QNetworkAccessManager *manager, QNetworkRequest reques
                             Q_EMIT callable->uploadProgress(bytesSent, bytesTotal);
                         }
                     });
-            reply->setProperty("accumulatedBody", QByteArray());
-            connect(reply, &QNetworkReply::readyRead, reply, [reply, callable, params]() {
-                if (!callable.isNull()) {
-                    QByteArray chunk = reply->readAll();
-                    reply->setProperty("accumulatedBody", reply->property("accumulatedBody").toByteArray() + chunk);
-                    Q_EMIT callable->chunck(chunk, params->userData());
-                }
-            });
         } else {
             request.setHeader(QNetworkRequest::ContentTypeHeader,
                               QString("application/x-www-form-urlencoded"));
@@ -719,14 +1048,6 @@ void Network::sendRequest(QNetworkAccessManager *manager, QNetworkRequest reques
         }
         QByteArray data = QJsonDocument(json).toJson(QJsonDocument::Compact);
         reply = manager->sendCustomRequest(request, verb, data);
-        reply->setProperty("accumulatedBody", QByteArray());
-        connect(reply, &QNetworkReply::readyRead, reply, [reply, callable, params]() {
-            if (!callable.isNull()) {
-                QByteArray chunk = reply->readAll();
-                reply->setProperty("accumulatedBody", reply->property("accumulatedBody").toByteArray() + chunk);
-                Q_EMIT callable->chunck(chunk, params->userData());
-            }
-        });
         break;
     }
     case NetworkParams::TYPE_JSONARRAY: {
@@ -839,9 +1160,30 @@ Network::Network(QObject *parent) : QObject{parent} {
     _timeout = 10000;
     _retry = 3;
     _openLog = false;
+    _maxConnectionsPerHost = 6;
+    _maxBackgroundQueue = 8;
+    _clock.start();
+    _memoryCache.setMaxCost(MEMORY_CACHE_BYTES);
+    // 多个视图几乎同时拉取的只读接口，短时间内直接复用结果
+    setEndpointTtl("/v1/get_img_list", 3000);
+    setEndpointTtl("/v1/systeminfo", 2000);
+    setEndpointTtl("/container_api/v1/get_android_detail/", 1000);
     _cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
                     .append(QDir::separator())
                     .append("network");
+    _manager = new QNetworkAccessManager(this);
+    // 退出时中止所有在途请求，排队中的请求不再发出
+    if (QCoreApplication::instance()) {
+        connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, [this] {
+            _quitting = true;
+            const QList<QNetworkReply *> replies = _manager->findChildren<QNetworkReply *>();
+            for (QNetworkReply *reply : replies) {
+                if (reply->isRunning()) {
+                    reply->abort();
+                }
+            }
+        });
+    }
 }
 
 NetworkParams *Network::get(const QString &url) {
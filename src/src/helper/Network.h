@@ -7,6 +7,12 @@
 #include <QJSValue>
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
+#include <QPointer>
+#include <QQueue>
+#include <QCache>
+#include <QSet>
+#include <QElapsedTimer>
+#include <QSharedPointer>
 #include "../stdafx.h"
 #include "../singleton.h"
 
@@ -48,6 +54,9 @@ public:
     Q_SIGNAL void downloadProgress(qint64 recv, qint64 total);
 
     Q_SIGNAL void chunck(QString data, QVariant userData);
+
+    // 与 chunck 同时发出，直接交出收到的数据块，不做 QString 转换
+    Q_SIGNAL void chunkData(QByteArray data, QVariant userData);
 };
 
 /**
@@ -74,6 +83,9 @@ class NetworkParams : public QObject {
 public:
     enum Method { METHOD_GET, METHOD_HEAD, METHOD_POST, METHOD_PUT, METHOD_PATCH, METHOD_DELETE };
     enum Type { TYPE_NONE, TYPE_FORM, TYPE_JSON, TYPE_JSONARRAY, TYPE_BODY };
+    // 同一 host 上交互请求总是先发，后台请求（轮询截图、列表刷新、心跳）负载高时丢弃
+    enum Priority { PriorityInteractive, PriorityNormal, PriorityBackground, PriorityCount };
+    Q_ENUM(Priority)
 
     explicit NetworkParams(QObject *parent = nullptr);
 
@@ -99,6 +111,14 @@ public:
 
     Q_INVOKABLE NetworkParams *setCacheMode(int val);
 
+    Q_INVOKABLE NetworkParams *setPriority(int val);
+
+    // 开启后每收到一块数据就发出 chunck/chunkData，默认只在结束时回调完整响应
+    Q_INVOKABLE NetworkParams *setStreamChunks(bool val);
+
+    // 用 POST 等方法发出但不修改服务端数据的请求（例如轮询查询），完成后不清除该 host 的内存缓存
+    Q_INVOKABLE NetworkParams *setReadOnly(bool val);
+
     Q_INVOKABLE NetworkParams *toDownload(QString destPath, bool append = false);
 
     Q_INVOKABLE NetworkParams *bind(QObject *target);
@@ -139,6 +159,9 @@ public:
     QVariant _openLog;
     QVariant _userData;
     int _cacheMode = NetworkType::CacheMode::NoCache;
+    int _priority = PriorityNormal;
+    bool _streamChunks = false;
+    bool _readOnly = false;
 };
 
 /**
@@ -150,6 +173,9 @@ class Network : public QObject {
     Q_PROPERTY_AUTO(int, retry)
     Q_PROPERTY_AUTO(QString, cacheDir)
     Q_PROPERTY_AUTO(bool, openLog)
+    Q_PROPERTY_AUTO(int, maxConnectionsPerHost)
+    // 每个 host 排队中的后台请求上限，超过后丢弃最早的
+    Q_PROPERTY_AUTO(int, maxBackgroundQueue)
     QML_NAMED_ELEMENT(Network)
     QML_SINGLETON
 
@@ -201,11 +227,99 @@ public:
 
     Q_INVOKABLE void setInterceptor(QJSValue interceptor);
 
+    // 各优先级的排队统计：count/avgWaitMs/maxWaitMs/shed
+    Q_INVOKABLE QVariantMap queueStats() const;
+
+    // GET 内存缓存按路径前缀设置有效期，0 表示该前缀不走内存缓存
+    Q_INVOKABLE void setEndpointTtl(const QString &pathPrefix, int ttlMs);
+
+    // 内存缓存/合并统计：hits/misses/coalesced/entries/bytes
+    Q_INVOKABLE QVariantMap cacheStats() const;
+
     void handle(NetworkParams *params, NetworkCallable *result);
 
     void handleDownload(NetworkParams *params, NetworkCallable *result);
 
 private:
+    // 合并到同一个在途 GET 上的请求，只等结果，不单独发请求
+    struct Follower {
+        NetworkParams *params = nullptr;
+        QPointer<NetworkCallable> callable;
+    };
+
+    // 一次请求（含重试）的状态，请求在主线程异步执行，不占用线程池
+    struct Task {
+        NetworkParams *params = nullptr;
+        QPointer<NetworkCallable> callable;
+        QString cacheKey;
+        QString host;
+        QNetworkRequest request;
+        QByteArray body;
+        QElapsedTimer queued;
+        int priority = NetworkParams::PriorityNormal;
+        int attempt = 0;
+        int ttlMs = 0;
+        quint64 writeGen = 0;  // 创建时该 host 的写入代数
+        bool coalesced = false;
+        bool cancelled = false;
+        QList<Follower> followers;
+
+        // 发起者取消后，只要还有合并进来的请求就继续执行
+        bool wanted() const {
+            return !cancelled || !followers.isEmpty();
+        }
+    };
+    using TaskPtr = QSharedPointer<Task>;
+
+    struct HostQueue {
+        QQueue<TaskPtr> queues[NetworkParams::PriorityCount];
+    };
+
+    struct QueueStats {
+        quint64 count = 0;
+        qint64 totalWaitMs = 0;
+        qint64 maxWaitMs = 0;
+        quint64 shed = 0;
+    };
+
+    struct MemoryEntry {
+        QString response;
+        QString host;
+        qint64 storedAt = 0;  // -1 表示从磁盘读回，时效未知
+    };
+
+    TaskPtr takeNext(HostQueue &hostQueue, int active);
+
+    int endpointTtl(const QUrl &url) const;
+
+    void invalidateHost(const QString &host);
+
+    // 该 host 发出或完成了一次修改：写入代数加一，清掉内存缓存，在途 GET 不再接受合并
+    void markHostWritten(const QString &host);
+
+    void insertMemoryCache(const QString &key, MemoryEntry *entry);
+
+    void notifySuccess(const TaskPtr &task, const QString &response);
+
+    void notifyError(const TaskPtr &task, int status, const QString &errorString,
+                     const QString &response);
+
+    void shed(const TaskPtr &task);
+
+    void enqueue(const TaskPtr &task, bool front = false);
+
+    void pump(const QString &host);
+
+    void dispatch(const TaskPtr &task);
+
+    void dispatchDownload(const TaskPtr &task);
+
+    void onReadyRead(const TaskPtr &task, QNetworkReply *reply);
+
+    void onReplyFinished(const TaskPtr &task, QNetworkReply *reply);
+
+    void complete(const TaskPtr &task);
+
     static void sendRequest(QNetworkAccessManager *manager, QNetworkRequest request,
                             NetworkParams *params, QNetworkReply *&reply, bool isFirst,
                             const QPointer<NetworkCallable> &callable);
@@ -218,6 +332,9 @@ private:
 
     QString readCache(const QString &key);
 
+    // 只读磁盘缓存文件，不经过内存缓存也不计入命中统计
+    QString readCacheFile(const QString &key);
+
     bool cacheExists(const QString &key);
 
     QString getCacheFilePath(const QString &key);
@@ -233,4 +350,25 @@ private:
 
 public:
     QJSValue _interceptor;
+
+private:
+    // 所有请求共用一个 manager，按 host 复用 keep-alive 连接
+    QNetworkAccessManager *_manager = nullptr;
+    QHash<QString, HostQueue> _hostQueues;
+    QHash<QString, int> _hostActive;
+    QueueStats _queueStats[NetworkParams::PriorityCount];
+    // 相同的 GET 在途时只发一次
+    QHash<QString, TaskPtr> _inflightGets;
+    // 每个 host 的写入代数，GET 只在代数不变时合并和写入缓存
+    QHash<QString, quint64> _hostWriteGen;
+    // 磁盘缓存前面的内存 LRU，成本按响应字节数计算
+    QCache<QString, MemoryEntry> _memoryCache;
+    // 每个 host 写入内存缓存的 key，清除时不必逐个访问缓存项（访问会改变 LRU 顺序）
+    QHash<QString, QSet<QString>> _hostCacheKeys;
+    QList<QPair<QString, int>> _endpointTtls;
+    QElapsedTimer _clock;
+    quint64 _cacheHits = 0;
+    quint64 _cacheMisses = 0;
+    quint64 _coalesced = 0;
+    bool _quitting = false;
 };
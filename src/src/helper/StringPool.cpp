@@ -0,0 +1,25 @@
+#include "StringPool.h"
+#include <QMutexLocker>
+
+QMutex StringPool::s_mutex;
+QSet<QString> StringPool::s_strings;
+
+QString StringPool::intern(const QString &value)
+{
+    if (value.isEmpty()) {
+        return QString();
+    }
+    QMutexLocker locker(&s_mutex);
+    auto it = s_strings.constFind(value);
+    if (it != s_strings.constEnd()) {
+        return *it;
+    }
+    s_strings.insert(value);
+    return value;
+}
+
+int StringPool::size()
+{
+    QMutexLocker locker(&s_mutex);
+    return s_strings.size();
+}
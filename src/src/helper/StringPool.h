@@ -0,0 +1,25 @@
+#pragma once
+
+#include <QString>
+#include <QSet>
+#include <QMutex>
+
+/**
+ * @brief 低基数字符串去重
+ *
+ * 镜像名、系统版本、状态、DNS、主机IP 在上万台设备里只有少数几种取值。解析时经过
+ * intern()，相同的值共享同一份 QString 数据，不再每台设备各自分配一份。
+ * 设备列表在工作线程解析，所以加锁
+ */
+class StringPool
+{
+public:
+    static QString intern(const QString &value);
+
+    // 池中不同字符串的个数
+    static int size();
+
+private:
+    static QMutex s_mutex;
+    static QSet<QString> s_strings;
+};
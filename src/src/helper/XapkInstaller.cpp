@@ -1,4 +1,5 @@
 #include "XapkInstaller.h"
+#include "ApkManifestReader.h"
 #include "../../QtScrcpyCore/src/adb/adbprocessimpl.h"
 #include <QFileInfo>
 #include <QDir>
@@ -8,10 +9,19 @@
 #include <QRegularExpression>
 #include <QCoreApplication>
 #include <QTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QDebug>
 #include <archive.h>
 #include <archive_entry.h>
 
+// 流式安装每次从 zip 读取的块大小
+#define XAPK_STREAM_BLOCK (256 * 1024)
+// 写往 adb 进程、尚未被消费的数据上限，超过后等待管道排空
+#define XAPK_STREAM_WINDOW (1024 * 1024)
+// manifest.json 最大读取长度
+#define XAPK_MANIFEST_MAX (1024 * 1024)
+
 XapkInstaller::XapkInstaller(QObject *parent)
     : QObject(parent)
     , m_workerThread(nullptr)
@@ -51,7 +61,7 @@ void XapkInstaller::installXapk(const QString& xapkFile, QPointer<qsc::IDevice>
         return;
     }
 
-    emit progress("开始解压 XAPK 文件...");
+    emit progress("开始读取 XAPK 文件...");
 
     // 创建临时目录用于解压 XAPK
     QString tempDir = QStandardPaths::writableLocation(QStandardPaths::TempLocation);
@@ -106,6 +116,24 @@ void XapkInstaller::doInstallInBackground(const QString& xapkFile, const QString
                                           const QString& adbPath, const QString& adbDeviceAddress,
                                           QPointer<qsc::IDevice> device)
 {
+    // 优先直接从 zip 流式安装，不落地临时文件；设备或文件不支持时再走解压流程
+    QString streamPackageName;
+    QString streamMessage;
+    StreamResult streamResult = streamInstall(xapkFile, adbPath, adbDeviceAddress, streamPackageName, streamMessage);
+    if (streamResult != SR_UNSUPPORTED) {
+        // OBB 已在流式安装中写入设备，这里不再推送
+        QMetaObject::invokeMethod(this, "onBackgroundInstallCompleted",
+                                Qt::QueuedConnection,
+                                Q_ARG(bool, streamResult == SR_SUCCESS),
+                                Q_ARG(QString, streamMessage),
+                                Q_ARG(QString, extractDir),
+                                Q_ARG(QStringList, QStringList()),
+                                Q_ARG(QString, streamPackageName),
+                                Q_ARG(QPointer<qsc::IDevice>, device));
+        return;
+    }
+    qDebug() << "XapkInstaller background thread: Streaming install unavailable, fallback to extract:" << streamMessage;
+
     // 第一步：解压 XAPK 文件
     qDebug() << "XapkInstaller background thread: Extracting XAPK file";
     if (!extractZip(xapkFile, extractDir)) {
@@ -322,6 +350,327 @@ void XapkInstaller::onBackgroundInstallCompleted(bool success, const QString& me
     emit finished(success, message);
 }
 
+XapkInstaller::StreamResult XapkInstaller::streamInstall(const QString& xapkFile, const QString& adbPath,
+                                                         const QString& adbDeviceAddress,
+                                                         QString& packageName, QString& message)
+{
+    struct StreamEntry
+    {
+        QString path;
+        qint64 size = 0;
+    };
+    QList<StreamEntry> apkEntries;
+    QList<StreamEntry> obbEntries;
+    qint64 totalApkSize = 0;
+
+    // 第一遍：只读中央目录，收集 APK/OBB 条目和大小，顺带读取 manifest.json 中的包名
+    struct archive *a = openZip(xapkFile);
+    if (!a) {
+        message = "无法打开 XAPK 文件";
+        return SR_UNSUPPORTED;
+    }
+
+    struct archive_entry *entry;
+    int r;
+    while ((r = archive_read_next_header(a, &entry)) == ARCHIVE_OK) {
+        if (archive_entry_filetype(entry) != AE_IFREG) {
+            continue;
+        }
+        StreamEntry item;
+        item.path = QString::fromUtf8(archive_entry_pathname(entry));
+        item.size = archive_entry_size_is_set(entry) ? archive_entry_size(entry) : -1;
+        QString lowerPath = item.path.toLower();
+
+        if (lowerPath.endsWith(".apk") && !item.path.contains('/')) {
+            if (item.size < 0) {
+                archive_read_free(a);
+                message = QString("APK 条目大小未知: %1").arg(item.path);
+                return SR_UNSUPPORTED;
+            }
+            apkEntries.append(item);
+            totalApkSize += item.size;
+        } else if (lowerPath.endsWith(".obb")) {
+            obbEntries.append(item);
+        } else if (lowerPath == "manifest.json" && item.size > 0 && item.size <= XAPK_MANIFEST_MAX) {
+            QByteArray manifest(static_cast<int>(item.size), Qt::Uninitialized);
+            if (archive_read_data(a, manifest.data(), manifest.size()) == manifest.size()) {
+                packageName = QJsonDocument::fromJson(manifest).object().value("package_name").toString();
+            }
+        }
+    }
+    archive_read_free(a);
+
+    if (r != ARCHIVE_EOF) {
+        message = "读取 XAPK 目录失败";
+        return SR_UNSUPPORTED;
+    }
+    if (apkEntries.isEmpty()) {
+        message = "未找到 APK 文件";
+        return SR_UNSUPPORTED;
+    }
+
+    // 没有 manifest.json 时从 OBB 文件名（main.<versionCode>.<package>.obb）推断包名
+    if (packageName.isEmpty()) {
+        QRegularExpression obbRegex(R"((?:main|patch)\.\d+\.(.+)\.obb$)", QRegularExpression::CaseInsensitiveOption);
+        for (const StreamEntry& obb : obbEntries) {
+            QRegularExpressionMatch match = obbRegex.match(QFileInfo(obb.path).fileName());
+            if (match.hasMatch()) {
+                packageName = match.captured(1);
+                break;
+            }
+        }
+    }
+
+    qDebug() << "XapkInstaller background thread: Streaming" << apkEntries.size() << "APK," << obbEntries.size()
+             << "OBB, total APK size:" << totalApkSize << "package:" << packageName;
+
+    // 第二步：创建安装会话，设备不支持（Android 5.0 以下）时回退
+    QString output;
+    QStringList createArgs;
+    createArgs << "-s" << adbDeviceAddress << "shell" << "pm" << "install-create" << "-r" << "-S" << QString::number(totalApkSize);
+    if (!runAdb(adbPath, createArgs, output)) {
+        message = QString("创建安装会话失败: %1").arg(output.trimmed());
+        return SR_UNSUPPORTED;
+    }
+    QRegularExpressionMatch sessionMatch = QRegularExpression(R"(\[(\d+)\])").match(output);
+    if (!output.contains("Success") || !sessionMatch.hasMatch()) {
+        message = QString("创建安装会话失败: %1").arg(output.trimmed());
+        return SR_UNSUPPORTED;
+    }
+    QString sessionId = sessionMatch.captured(1);
+
+    auto abandonSession = [&]() {
+        QString abandonOutput;
+        runAdb(adbPath, QStringList() << "-s" << adbDeviceAddress << "shell" << "pm" << "install-abandon" << sessionId,
+               abandonOutput);
+    };
+
+    // 第三步：按 zip 中的顺序把每个 APK 直接写入安装会话
+    a = openZip(xapkFile);
+    if (!a) {
+        abandonSession();
+        message = "无法打开 XAPK 文件";
+        return SR_UNSUPPORTED;
+    }
+
+    int written = 0;
+    QRegularExpression unsafeChars("[^A-Za-z0-9._-]");
+    while ((r = archive_read_next_header(a, &entry)) == ARCHIVE_OK) {
+        QString path = QString::fromUtf8(archive_entry_pathname(entry));
+        if (archive_entry_filetype(entry) != AE_IFREG || !path.toLower().endsWith(".apk") || path.contains('/')) {
+            continue;
+        }
+        qint64 size = archive_entry_size(entry);
+        // 会话内的 split 名字必须唯一，加序号并去掉 shell 敏感字符
+        QString splitName = QString("%1_%2").arg(written).arg(QString(path).replace(unsafeChars, "_"));
+
+        QMetaObject::invokeMethod(this, "progress",
+                                Qt::QueuedConnection,
+                                Q_ARG(QString, QString("正在写入 %1 (%2/%3)").arg(path).arg(written + 1).arg(apkEntries.size())));
+
+        QStringList writeArgs;
+        writeArgs << "-s" << adbDeviceAddress << "exec-in" << "pm" << "install-write" << "-S" << QString::number(size)
+                  << sessionId << splitName << "-";
+        if (!streamEntryToAdb(a, size, adbPath, writeArgs, output) || !output.contains("Success")) {
+            qWarning() << "XapkInstaller background thread: install-write failed:" << path << output;
+            archive_read_free(a);
+            abandonSession();
+            // 一个条目都没写成功时多半是 adb/设备不支持 exec-in，回退到解压安装
+            message = QString("写入 %1 失败: %2").arg(path, output.trimmed());
+            return written == 0 ? SR_UNSUPPORTED : SR_FAILED;
+        }
+        written++;
+    }
+    archive_read_free(a);
+
+    if (r != ARCHIVE_EOF || written != apkEntries.size()) {
+        abandonSession();
+        message = "读取 XAPK 数据失败";
+        return SR_FAILED;
+    }
+
+    QMetaObject::invokeMethod(this, "progress",
+                            Qt::QueuedConnection,
+                            Q_ARG(QString, QString("正在提交安装 %1 个 APK 文件...").arg(written)));
+
+    QStringList commitArgs;
+    commitArgs << "-s" << adbDeviceAddress << "shell" << "pm" << "install-commit" << sessionId;
+    if (!runAdb(adbPath, commitArgs, output, 120000) || !output.contains("Success")) {
+        qWarning() << "XapkInstaller background thread: install-commit failed:" << output;
+        message = QString("安装失败: %1").arg(output.trimmed());
+        return SR_FAILED;
+    }
+    qDebug() << "XapkInstaller background thread: Streaming install committed, session:" << sessionId;
+
+    // 第四步：OBB 直接写到 /sdcard/Android/obb/<package_name>/
+    if (obbEntries.isEmpty()) {
+        message = "XAPK 安装成功";
+        return SR_SUCCESS;
+    }
+    if (packageName.isEmpty()) {
+        qWarning() << "XapkInstaller: Could not determine package name for OBB files";
+        message = "XAPK 安装成功，但无法确定包名，未推送 OBB 文件";
+        return SR_SUCCESS;
+    }
+    // 包名来自压缩包里的清单，不能让它指到 obb 目录之外
+    if (packageName.contains('/') || packageName.contains("..")) {
+        qWarning() << "XapkInstaller: Invalid package name for OBB files:" << packageName;
+        message = "XAPK 安装成功，但包名无效，未推送 OBB 文件";
+        return SR_SUCCESS;
+    }
+
+    a = openZip(xapkFile);
+    if (!a) {
+        message = "XAPK 安装成功，但 OBB 文件推送失败";
+        return SR_SUCCESS;
+    }
+
+    QString obbBasePath = QString("/sdcard/Android/obb/%1").arg(packageName);
+    int obbFailed = 0;
+    while ((r = archive_read_next_header(a, &entry)) == ARCHIVE_OK) {
+        QString path = QString::fromUtf8(archive_entry_pathname(entry));
+        if (archive_entry_filetype(entry) != AE_IFREG || !path.toLower().endsWith(".obb")) {
+            continue;
+        }
+        qint64 size = archive_entry_size_is_set(entry) ? archive_entry_size(entry) : -1;
+        QString deviceObbPath = QString("%1/%2").arg(obbBasePath, QFileInfo(path).fileName());
+
+        QMetaObject::invokeMethod(this, "progress",
+                                Qt::QueuedConnection,
+                                Q_ARG(QString, QString("正在推送 OBB 文件 %1...").arg(QFileInfo(path).fileName())));
+
+        QStringList obbArgs;
+        obbArgs << "-s" << adbDeviceAddress << "exec-in"
+                << QString("mkdir -p %1 && cat > %2").arg(shellQuote(obbBasePath), shellQuote(deviceObbPath));
+        bool ok = streamEntryToAdb(a, size, adbPath, obbArgs, output);
+        if (ok && size >= 0) {
+            // exec-in 不回传远端退出码，用文件大小确认写入完整
+            QString statOutput;
+            ok = runAdb(adbPath, QStringList() << "-s" << adbDeviceAddress << "shell" << "stat" << "-c" << "%s" << shellQuote(deviceObbPath),
+                        statOutput)
+                 && statOutput.trimmed() == QString::number(size);
+        }
+        if (!ok) {
+            qWarning() << "XapkInstaller background thread: Failed to push OBB file:" << path << output;
+            obbFailed++;
+        }
+    }
+    archive_read_free(a);
+
+    if (obbFailed > 0 || r != ARCHIVE_EOF) {
+        message = QString("XAPK 安装成功，但有 %1 个 OBB 文件推送失败").arg(qMax(obbFailed, 1));
+    } else {
+        message = "XAPK 安装成功";
+    }
+    return SR_SUCCESS;
+}
+
+struct archive* XapkInstaller::openZip(const QString& zipPath)
+{
+    struct archive *a = archive_read_new();
+    // seekable 模式先读中央目录，条目大小在读数据前就已知，跳过条目时直接 seek
+    archive_read_support_format_zip_seekable(a);
+
+#ifdef Q_OS_WIN
+    int r = archive_read_open_filename_w(a, reinterpret_cast<const wchar_t*>(zipPath.utf16()), XAPK_STREAM_BLOCK);
+#else
+    int r = archive_read_open_filename(a, QFile::encodeName(zipPath).constData(), XAPK_STREAM_BLOCK);
+#endif
+    if (r != ARCHIVE_OK) {
+        qDebug() << "XapkInstaller: Failed to open ZIP file:" << zipPath << archive_error_string(a);
+        archive_read_free(a);
+        return nullptr;
+    }
+    return a;
+}
+
+bool XapkInstaller::streamEntryToAdb(struct archive* a, qint64 size, const QString& adbPath,
+                                     const QStringList& args, QString& output)
+{
+    output.clear();
+
+    QProcess process;
+    process.setProgram(adbPath);
+    process.setArguments(args);
+    process.setProcessChannelMode(QProcess::MergedChannels);
+    process.start();
+    if (!process.waitForStarted(5000)) {
+        output = process.errorString();
+        return false;
+    }
+
+    QByteArray buffer(XAPK_STREAM_BLOCK, Qt::Uninitialized);
+    qint64 total = 0;
+    bool ok = true;
+    for (;;) {
+        la_ssize_t len = archive_read_data(a, buffer.data(), buffer.size());
+        if (len == 0) {
+            break;
+        }
+        if (len < 0) {
+            output = QString::fromUtf8(archive_error_string(a));
+            ok = false;
+            break;
+        }
+        if (process.write(buffer.constData(), len) != len) {
+            ok = false;
+            break;
+        }
+        total += len;
+        // 控制管道里的积压，内存占用与文件大小无关
+        while (process.bytesToWrite() > XAPK_STREAM_WINDOW) {
+            if (!process.waitForBytesWritten(30000)) {
+                ok = false;
+                break;
+            }
+        }
+        if (!ok) {
+            break;
+        }
+    }
+
+    if (!ok) {
+        process.kill();
+        process.waitForFinished(3000);
+        if (output.isEmpty()) {
+            output = QString::fromUtf8(process.readAll());
+        }
+        return false;
+    }
+
+    process.closeWriteChannel();
+    if (!process.waitForFinished(120000)) {
+        process.kill();
+        output = "timeout";
+        return false;
+    }
+    output = QString::fromUtf8(process.readAll());
+    return process.exitCode() == 0 && (size < 0 || total == size);
+}
+
+bool XapkInstaller::runAdb(const QString& adbPath, const QStringList& args, QString& output, int timeoutMs)
+{
+    QProcess process;
+    process.setProgram(adbPath);
+    process.setArguments(args);
+    process.setProcessChannelMode(QProcess::MergedChannels);
+    process.start();
+    if (!process.waitForFinished(timeoutMs)) {
+        process.kill();
+        output = process.errorString();
+        return false;
+    }
+    output = QString::fromUtf8(process.readAll());
+    return process.exitStatus() == QProcess::NormalExit && process.exitCode() == 0;
+}
+
+QString XapkInstaller::shellQuote(const QString& arg)
+{
+    QString quoted = arg;
+    quoted.replace("'", "'\\''");
+    return QString("'%1'").arg(quoted);
+}
+
 bool XapkInstaller::extractZip(const QString& zipPath, const QString& outputDir)
 {
     struct archive *a;
@@ -361,21 +710,11 @@ bool XapkInstaller::extractZip(const QString& zipPath, const QString& outputDir)
     }
 
 #ifdef Q_OS_WIN
-    // Windows上：读取整个文件到内存，然后使用内存方式打开archive
-    QByteArray fileData = zipFile.readAll();
+    // Windows上：用宽字符路径按块读取，不再把整个文件读进内存
     zipFile.close();
-
-    if (fileData.isEmpty()) {
-        qDebug() << "XapkInstaller: Failed to read ZIP file or file is empty:" << zipPath;
-        archive_read_free(a);
-        archive_write_free(ext);
-        QDir::setCurrent(originalCurrentDir);
-        return false;
-    }
-
-    r = archive_read_open_memory(a, fileData.data(), fileData.size());
+    r = archive_read_open_filename_w(a, reinterpret_cast<const wchar_t*>(zipPath.utf16()), XAPK_STREAM_BLOCK);
     if (r != ARCHIVE_OK) {
-        qDebug() << "XapkInstaller: Failed to open archive from memory:" << archive_error_string(a);
+        qDebug() << "XapkInstaller: Failed to open ZIP file:" << archive_error_string(a);
         archive_read_free(a);
         archive_write_free(ext);
         QDir::setCurrent(originalCurrentDir);
@@ -492,77 +831,14 @@ bool XapkInstaller::extractZip(const QString& zipPath, const QString& outputDir)
 
 QString XapkInstaller::extractPackageNameFromApk(const QString& apkFile)
 {
-    // 获取应用程序目录路径
-    QString appDir = QCoreApplication::applicationDirPath();
-
-    // 辅助函数：尝试使用指定的 aapt 路径提取包名
-    auto tryExtractPackageName = [&apkFile](const QString& aaptPath) -> QString {
-        QFileInfo aaptInfo(aaptPath);
-        // 如果是相对路径（系统 PATH），直接尝试；如果是绝对路径，检查文件是否存在
-        if (aaptPath.contains("/") || aaptPath.contains("\\")) {
-            // 绝对路径，检查文件是否存在
-            if (!aaptInfo.exists() || !aaptInfo.isFile()) {
-                return QString(); // 文件不存在
-            }
-        }
-
-        QProcess aaptProcess;
-        aaptProcess.setProgram(aaptPath);
-        aaptProcess.setArguments(QStringList() << "dump" << "badging" << apkFile);
-        aaptProcess.start();
-
-        if (aaptProcess.waitForFinished(5000) && aaptProcess.exitCode() == 0) {
-            QByteArray output = aaptProcess.readAllStandardOutput();
-            QString outputStr = QString::fromUtf8(output);
-
-            // 解析 aapt 输出，查找 package: name='...'
-            QRegularExpression regex(R"(package:\s*name='([^']+)')");
-            QRegularExpressionMatch match = regex.match(outputStr);
-            if (match.hasMatch()) {
-                QString packageName = match.captured(1);
-                qDebug() << "XapkInstaller: Extracted package name using" << aaptPath << "package:" << packageName;
-                return packageName;
-            }
-        }
-        return QString();
-    };
-
-    // 方法1: 优先尝试应用程序目录下的 aapt
-#ifdef Q_OS_WIN
-    QString localAapt = appDir + "/aapt.exe";
-    QString localAapt2 = appDir + "/aapt2.exe";
-#else
-    QString localAapt = appDir + "/aapt";
-    QString localAapt2 = appDir + "/aapt2";
-#endif
-
-    QString packageName = tryExtractPackageName(localAapt);
-    if (!packageName.isEmpty()) {
-        return packageName;
-    }
-
-    // 方法2: 尝试应用程序目录下的 aapt2
-    packageName = tryExtractPackageName(localAapt2);
-    if (!packageName.isEmpty()) {
-        return packageName;
-    }
-
-    // 方法3: 回退到系统 PATH 中的 aapt
-    packageName = tryExtractPackageName("aapt");
-    if (!packageName.isEmpty()) {
-        return packageName;
-    }
-
-    // 方法4: 回退到系统 PATH 中的 aapt2
-    packageName = tryExtractPackageName("aapt2");
-    if (!packageName.isEmpty()) {
-        return packageName;
+    // 进程内解析 AndroidManifest.xml，不依赖 aapt
+    QString packageName = ApkManifestReader::packageName(apkFile);
+    if (packageName.isEmpty()) {
+        qDebug() << "XapkInstaller: Could not read package name from manifest:" << apkFile;
+    } else {
+        qDebug() << "XapkInstaller: Extracted package name:" << packageName;
     }
-
-    qDebug() << "XapkInstaller: Could not extract package name using aapt/aapt2. "
-             << "Checked application directory:" << appDir
-             << "and system PATH.";
-    return QString();
+    return packageName;
 }
 
 void XapkInstaller::pushObbFiles(const QStringList& obbFiles, const QString& packageName,
@@ -571,6 +847,10 @@ void XapkInstaller::pushObbFiles(const QStringList& obbFiles, const QString& pac
     if (packageName.isEmpty() || obbFiles.isEmpty() || !device) {
         return;
     }
+    if (packageName.contains('/') || packageName.contains("..")) {
+        qWarning() << "XapkInstaller: Invalid package name for OBB files:" << packageName;
+        return;
+    }
 
     qDebug() << "XapkInstaller: Pushing OBB files for package:" << packageName;
 
@@ -7,6 +7,8 @@
 #include <QPointer>
 #include "QtScrcpyCore.h"
 
+struct archive;
+
 /**
  * @brief XAPK安装帮助类
  * 
@@ -45,6 +47,48 @@ signals:
     void finished(bool success, const QString& message);
 
 private:
+    enum StreamResult
+    {
+        SR_SUCCESS,     // 流式安装成功
+        SR_FAILED,      // 已经开始写入设备后失败，不再回退
+        SR_UNSUPPORTED, // 无法流式安装（条目大小未知/设备不支持安装会话），回退到解压安装
+    };
+
+    /**
+     * @brief 不解压直接从 XAPK 流式安装
+     *
+     * 依次把 zip 中的 APK 写入 pm install-create 创建的安装会话（install-write 从 stdin 读取），
+     * 再把 OBB 通过 exec-in 写到设备，内存中最多只保留几个数据块
+     * @param packageName 输出：包名（来自 manifest.json 或 OBB 文件名）
+     * @param message 输出：结果消息
+     */
+    StreamResult streamInstall(const QString& xapkFile, const QString& adbPath,
+                               const QString& adbDeviceAddress, QString& packageName, QString& message);
+
+    /**
+     * @brief 打开 ZIP 文件（seekable 模式，条目大小取自中央目录）
+     * @return 失败返回 nullptr
+     */
+    static struct archive* openZip(const QString& zipPath);
+
+    /**
+     * @brief 把当前条目的数据写入 adb 进程的 stdin
+     * @param size 条目大小，写入字节数不一致视为失败
+     * @param output 输出：进程的标准输出和错误输出
+     */
+    static bool streamEntryToAdb(struct archive* a, qint64 size, const QString& adbPath,
+                                 const QStringList& args, QString& output);
+
+    /**
+     * @brief 执行一条 adb 命令并等待结束
+     */
+    static bool runAdb(const QString& adbPath, const QStringList& args, QString& output, int timeoutMs = 30000);
+
+    /**
+     * @brief 用单引号包起来作为设备 shell 的一个参数，内部的 ' 转成 '\''
+     */
+    static QString shellQuote(const QString& arg);
+
     /**
      * @brief 解压ZIP文件
      * @param zipPath ZIP文件路径
@@ -169,23 +169,31 @@ void LevelProxyModel::rebuildIndexMap()
 
 void LevelProxyModel::onSourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles)
 {
-    Q_UNUSED(bottomRight);
     if (!topLeft.isValid()) return;
 
-    bool wasAccepted = m_sourceToProxyRowMap.contains(topLeft);
-    bool isNowAccepted = filterAcceptsIndex(topLeft);
-
-    if (wasAccepted && !isNowAccepted) {
-        rebuildIndexMap();
-    } else if (!wasAccepted && isNowAccepted) {
-        rebuildIndexMap();
-    } else if (wasAccepted && isNowAccepted) {
-        int row = m_sourceToProxyRowMap.value(topLeft, -1);
-        if (row != -1) {
-            QModelIndex proxyTopLeft = createIndex(row, topLeft.column());
-            QModelIndex proxyBottomRight = createIndex(row, bottomRight.column());
-            emit dataChanged(proxyTopLeft, proxyBottomRight, roles);
+    // TreeModel 在事务里会把相邻行合并成一个区间发出，需要逐行处理
+    const QModelIndex parent = topLeft.parent();
+    const int lastRow = bottomRight.isValid() ? bottomRight.row() : topLeft.row();
+    QList<int> proxyRows;
+    for (int sourceRow = topLeft.row(); sourceRow <= lastRow; ++sourceRow) {
+        QModelIndex sourceIndex = sourceModel()->index(sourceRow, topLeft.column(), parent);
+        bool wasAccepted = m_sourceToProxyRowMap.contains(sourceIndex);
+        bool isNowAccepted = filterAcceptsIndex(sourceIndex);
+        if (wasAccepted != isNowAccepted) {
+            // 有行进出过滤结果，重建一次即可，不必再逐行通知
+            rebuildIndexMap();
+            proxyRows.clear();
+            break;
         }
+        if (wasAccepted) {
+            proxyRows.append(m_sourceToProxyRowMap.value(sourceIndex));
+        }
+    }
+
+    for (int row : proxyRows) {
+        QModelIndex proxyTopLeft = createIndex(row, topLeft.column());
+        QModelIndex proxyBottomRight = createIndex(row, bottomRight.column());
+        emit dataChanged(proxyTopLeft, proxyBottomRight, roles);
     }
 
     if (roles.isEmpty() || roles.contains(DeviceRoles::SelectedRole)) {
@@ -24,11 +24,13 @@
 #include "helper/windowsizehelper.h"
 #include "helper/AccountModel.h"
 #include "helper/DeviceScanner.h"
+#include "helper/DeviceListSync.h"
 #include "helper/ImagesModel.h"
 #include "helper/FileCopyManager.h"
 #include "proxytester.h"
 
 #include "sdk_wrapper/screenshot_image.h"
+#include "sdk_wrapper/thumbnail_service.h"
 #include "sdk_wrapper/video_render_item.h"
 #include "sdk_wrapper/video_render_item_ex.h"
 // #include "sdk_wrapper/armcloud_engine_wrapper.h"
@@ -157,6 +159,8 @@ int main(int argc, char *argv[])
     treeProxyModel.setSortRole(DeviceRoles::NameRole);
     treeProxyModel.sort(0);
 
+    DeviceListSync deviceListSync(&treeModel);
+
     SelectedListModel selectedListModel;
     selectedListModel.setSourceModel(&treeModel);
     selectedListModel.setProxyModel(&treeProxyModel);
@@ -177,6 +181,7 @@ int main(int argc, char *argv[])
     TranslateHelper::getInstance()->init(&engine);
     engine.rootContext()->setContextProperty("channelName", channel);
     engine.rootContext()->setContextProperty("Network", Network::getInstance());
+    engine.rootContext()->setContextProperty("ThumbnailService", ThumbnailService::getInstance());
     // engine.rootContext()->setContextProperty("ArmcloudEngine", ArmcloudEngineWrapper::getInstance());
     engine.rootContext()->setContextProperty("Utils", Utils::getInstance());
     // engine.rootContext()->setContextProperty("baseModel", &baseModel);
@@ -186,6 +191,7 @@ int main(int argc, char *argv[])
     // engine.rootContext()->setContextProperty("groupControl", GroupControlWrapper::getInstance());
     engine.rootContext()->setContextProperty("ReportHelper", ReportHelper::getInstance());
     engine.rootContext()->setContextProperty("treeModel", &treeModel);
+    engine.rootContext()->setContextProperty("deviceListSync", &deviceListSync);
     engine.rootContext()->setContextProperty("treeProxyModel", &treeProxyModel);
     engine.rootContext()->setContextProperty("selectedListModel", &selectedListModel);
     // engine.rootContext()->setContextProperty("authTreeModel", &authTreeModel);
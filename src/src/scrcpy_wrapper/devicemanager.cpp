@@ -1,8 +1,13 @@
 #include "devicemanager.h"
 #include "scrcpy_observer.h"
 #include "grid_observer.h"
+#include "thumbnail_observer.h"
 #include "../helper/XapkInstaller.h"
+#include "../helper/ApkBatchInstaller.h"
 #include "../../QtScrcpyCore/src/adb/adbprocessimpl.h"
+#include "adbprocess.h"
+#include "macroreplayer.h"
+#include "bulkpusher.h"
 #include <QCoreApplication>
 #include <QDebug>
 #include <QRandomGenerator>
@@ -12,6 +17,7 @@
 #include <QProcess>
 #include <QTimer>
 #include <QFileInfo>
+#include <QFile>
 #ifdef Q_OS_WIN
 #include <windows.h>
 #endif
@@ -22,6 +28,7 @@ DeviceManager::DeviceManager(QObject *parent)
 {
     connect(&m_deviceManage, &qsc::IDeviceManage::deviceConnected, this, &DeviceManager::onDeviceConnected);
     connect(&m_deviceManage, &qsc::IDeviceManage::deviceDisconnected, this, &DeviceManager::onDeviceDisconnected);
+    connect(&m_deviceManage, &qsc::IDeviceManage::deviceReleased, this, &DeviceManager::deviceReleased);
 }
 
 DeviceManager::~DeviceManager()
@@ -139,11 +146,56 @@ void DeviceManager::disconnectDevice(const QString &serial)
     m_deviceManage.disconnectDevice(serial);
 }
 
+void DeviceManager::disconnectAllDevices()
+{
+    qInfo() << "Disconnecting all devices";
+    m_deviceManage.disconnectAllDevice();
+}
+
 bool DeviceManager::hasDevice(const QString &serial) const
 {
     return !const_cast<qsc::IDeviceManage&>(m_deviceManage).getDevice(serial).isNull();
 }
 
+void DeviceManager::setConnectLimits(int globalLimit, int perHostLimit)
+{
+    m_deviceManage.setConnectLimits(globalLimit, perHostLimit);
+}
+
+QVariantMap DeviceManager::connectStats() const
+{
+    QVariantMap result;
+    auto stats = const_cast<qsc::IDeviceManage&>(m_deviceManage).getConnectStats();
+    for (auto it = stats.constBegin(); it != stats.constEnd(); ++it) {
+        QVariantMap stage;
+        stage["count"] = it->count;
+        stage["avgMs"] = it->count ? it->totalMs / it->count : 0;
+        stage["maxMs"] = it->maxMs;
+        result[it.key()] = stage;
+    }
+    return result;
+}
+
+QVariantMap DeviceManager::pushCacheStats() const
+{
+    QVariantMap result;
+    auto stats = const_cast<qsc::IDeviceManage&>(m_deviceManage).getPushCacheStats();
+    for (auto it = stats.constBegin(); it != stats.constEnd(); ++it) {
+        QVariantMap host;
+        host["hits"] = it->hits;
+        host["misses"] = it->misses;
+        result[it.key()] = host;
+    }
+    return result;
+}
+
+// adb 连接重试间隔：指数退避加抖动，避免批量设备同时重试
+static int adbRetryDelayMs(int retryCount)
+{
+    int delay = qMin(500 << qMax(0, qMin(retryCount, 4)), 4000);
+    return delay / 2 + static_cast<int>(QRandomGenerator::global()->bounded(delay / 2 + 1));
+}
+
 static inline QPointer<qsc::IDevice> getDev(qsc::IDeviceManage &mgr, const QString &serial) {
     auto dev = mgr.getDevice(serial);
     if (dev.isNull()) {
@@ -215,8 +267,14 @@ void DeviceManager::textInput(const QString &serial, const QString &text)
 {
     auto dev = getDev(m_deviceManage, serial);
     if (!dev) return;
-    QString t = text;
-    dev->postTextInput(t);
+    // 分块发送，长文本不会被截断，进度和完成通过 textInputProgress/textInputFinished 转发给 QML
+    dev->postTextStream(text);
+}
+
+void DeviceManager::cancelTextInput(const QString &serial)
+{
+    auto dev = getDev(m_deviceManage, serial);
+    if (dev) dev->cancelTextStream();
 }
 
 void DeviceManager::pushFile(const QString &serial, const QString &file, const QString &devicePath)
@@ -448,6 +506,12 @@ void DeviceManager::onDeviceConnected(bool success, const QString &serial, const
 {
     if (success) {
         qInfo() << "Device connected:" << deviceName << size;
+        auto dev = getDev(m_deviceManage, serial);
+        if (dev && !m_thumbnailObservers.contains(serial)) {
+            QSharedPointer<ThumbnailObserver> observer(new ThumbnailObserver(serial));
+            dev->registerDeviceObserver(observer.data());
+            m_thumbnailObservers.insert(serial, observer);
+        }
         emit deviceConnected(serial, deviceName, size);
     } else {
         qWarning() << "Device connect failed:" << serial;
@@ -458,6 +522,13 @@ void DeviceManager::onDeviceConnected(bool success, const QString &serial, const
 void DeviceManager::onDeviceDisconnected(const QString &serial)
 {
     qInfo() << "Device disconnected:" << serial;
+    QSharedPointer<ThumbnailObserver> observer = m_thumbnailObservers.take(serial);
+    if (observer) {
+        auto dev = getDev(m_deviceManage, serial);
+        if (dev) {
+            dev->deRegisterDeviceObserver(observer.data());
+        }
+    }
     emit deviceDisconnected(serial);
 }
 
@@ -534,6 +605,149 @@ void DeviceManager::screenshot(const QString &serial)
     if (!dev.isNull()) dev->screenshot();
 }
 
+bool DeviceManager::startMacroRecord(const QString &serial)
+{
+    auto dev = getDev(m_deviceManage, serial);
+    if (!dev) return false;
+    dev->startControlRecord();
+    qInfo() << "Macro record started:" << serial;
+    return true;
+}
+
+bool DeviceManager::stopMacroRecord(const QString &serial, const QString &filePath)
+{
+    auto dev = getDev(m_deviceManage, serial);
+    if (!dev) return false;
+    QByteArray timeline = dev->stopControlRecord();
+    if (timeline.isEmpty()) {
+        qWarning() << "Macro record is empty:" << serial;
+        return false;
+    }
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Failed to save macro:" << filePath << file.errorString();
+        return false;
+    }
+    file.write(timeline);
+    file.close();
+    qInfo() << "Macro record saved:" << filePath << "bytes:" << timeline.size();
+    return true;
+}
+
+bool DeviceManager::replayMacro(const QString &filePath, const QStringList &serials)
+{
+    if (m_macroReplayer && m_macroReplayer->isRunning()) {
+        qWarning() << "Macro replay already running";
+        return false;
+    }
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Failed to open macro:" << filePath << file.errorString();
+        return false;
+    }
+    QByteArray timeline = file.readAll();
+    file.close();
+
+    if (!m_macroReplayer) {
+        m_macroReplayer = new qsc::MacroReplayer(this);
+        connect(m_macroReplayer, &qsc::MacroReplayer::replayProgress, this, [this](quint32 done, quint32 total) {
+            emit macroReplayProgress(static_cast<int>(done), static_cast<int>(total));
+        });
+        connect(m_macroReplayer, &qsc::MacroReplayer::replayFinished, this, [this](bool complete) {
+            qsc::MacroReplayer::ReplayStats stats = m_macroReplayer->stats();
+            QVariantMap map;
+            map["events"] = stats.events;
+            map["sends"] = stats.sends;
+            map["skippedDevices"] = stats.skippedDevices;
+            map["rebases"] = stats.rebases;
+            map["meanLatenessUs"] = stats.meanLatenessUs;
+            map["maxLatenessUs"] = stats.maxLatenessUs;
+            map["durationUs"] = stats.durationUs;
+            map["plannedDurationUs"] = stats.plannedDurationUs;
+            emit macroReplayFinished(complete, map);
+        });
+    }
+
+    if (!m_macroReplayer->load(timeline)) {
+        qWarning() << "Invalid macro file:" << filePath;
+        return false;
+    }
+    qInfo() << "Macro replay:" << filePath << "events:" << m_macroReplayer->eventCount() << "devices:" << serials.size();
+    return m_macroReplayer->start(serials);
+}
+
+void DeviceManager::stopMacroReplay()
+{
+    if (m_macroReplayer) {
+        m_macroReplayer->stop();
+    }
+}
+
+bool DeviceManager::isMacroReplaying() const
+{
+    return m_macroReplayer && m_macroReplayer->isRunning();
+}
+
+bool DeviceManager::pushFileToDevices(const QStringList &serials, const QString &file, const QString &devicePath)
+{
+    if (m_bulkPusher && m_bulkPusher->isRunning()) {
+        qWarning() << "Bulk push already running";
+        return false;
+    }
+    if (!m_bulkPusher) {
+        m_bulkPusher = new qsc::BulkPusher(this);
+        connect(m_bulkPusher, &qsc::BulkPusher::pushProgress, this, &DeviceManager::bulkPushProgress);
+        connect(m_bulkPusher, &qsc::BulkPusher::deviceFinished, this, &DeviceManager::bulkPushDeviceFinished);
+        connect(m_bulkPusher, &qsc::BulkPusher::pushFinished, this, &DeviceManager::bulkPushFinished);
+    }
+
+    QString remote = devicePath.isEmpty() ? QString("/sdcard/Download") : devicePath;
+    qInfo() << "Bulk push:" << file << "to" << remote << "devices:" << serials.size();
+    return m_bulkPusher->start(QFileInfo(file).absoluteFilePath(), remote, serials);
+}
+
+void DeviceManager::cancelBulkPush()
+{
+    if (m_bulkPusher) {
+        m_bulkPusher->cancel();
+    }
+}
+
+bool DeviceManager::isBulkPushing() const
+{
+    return m_bulkPusher && m_bulkPusher->isRunning();
+}
+
+bool DeviceManager::installApkToDevices(const QStringList &serials, const QString &apkFile, bool force)
+{
+    if (m_batchInstaller && m_batchInstaller->isRunning()) {
+        qWarning() << "Batch install already running";
+        return false;
+    }
+    if (!m_batchInstaller) {
+        m_batchInstaller = new ApkBatchInstaller(this);
+        connect(m_batchInstaller, &ApkBatchInstaller::progress, this, &DeviceManager::batchInstallProgress);
+        connect(m_batchInstaller, &ApkBatchInstaller::deviceFinished, this, &DeviceManager::batchInstallDeviceFinished);
+        connect(m_batchInstaller, &ApkBatchInstaller::finished, this, &DeviceManager::batchInstallFinished);
+    }
+    m_batchInstaller->setForceInstall(force);
+    return m_batchInstaller->start(apkFile, serials);
+}
+
+void DeviceManager::cancelBatchInstall()
+{
+    if (m_batchInstaller) {
+        m_batchInstaller->cancel();
+    }
+}
+
+bool DeviceManager::isBatchInstalling() const
+{
+    return m_batchInstaller && m_batchInstaller->isRunning();
+}
+
 bool DeviceManager::registerObserver(const QString &serial)
 {
     auto dev = m_deviceManage.getDevice(serial);
@@ -554,6 +768,12 @@ bool DeviceManager::registerObserver(const QString &serial)
     connect(ob.data(), &ScrcpyObserver::grabCursorChanged, this, [this, serial](bool grab) {
         emitGrabCursorChanged(serial, grab);
     });
+    connect(ob.data(), &ScrcpyObserver::textInputProgress, this, [this, serial](qint64 sentBytes, qint64 totalBytes, qint64 bytesPerSecond) {
+        emit textInputProgress(serial, sentBytes, totalBytes, bytesPerSecond);
+    });
+    connect(ob.data(), &ScrcpyObserver::textInputFinished, this, [this, serial](bool complete) {
+        emit textInputFinished(serial, complete);
+    });
     
     return true;
 }
@@ -651,36 +871,29 @@ void DeviceManager::connectAdbWithRetry(const QString &serial, const QString &ad
     m_adbConnectStates[serial] = ACS_CONNECTING;
     m_adbConnectRetryCount[serial] = retryCount;
     
-    QString adbPath = AdbProcessImpl::getAdbPath();
-    if (adbPath.isEmpty()) {
-        qWarning() << "DeviceManager::connectAdbWithRetry - ADB path is empty";
-        m_adbConnectStates.remove(serial);
-        m_adbConnectRetryCount.remove(serial);
-        return;
-    }
-    
-    // 直接使用QProcess执行adb connect命令（参考XAPK安装器的方式）
-    QProcess* connectProcess = new QProcess(this);
-    connectProcess->setProgram(adbPath);
-    connectProcess->setArguments(QStringList() << "connect" << adbDeviceAddress);
+    // 使用 qsc::AdbProcess，adb server 可用时直接走 host:connect，不再创建 adb 进程
+    qsc::AdbProcess* connectProcess = new qsc::AdbProcess(this);
     
-    qDebug() << "DeviceManager::connectAdbWithRetry - Executing:" << adbPath << "connect" << adbDeviceAddress;
+    qDebug() << "DeviceManager::connectAdbWithRetry - Executing: adb connect" << adbDeviceAddress;
     
-    connect(connectProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-            this, [this, connectProcess, serial, adbDeviceAddress, apkFile, retryCount](int exitCode, QProcess::ExitStatus exitStatus) {
+    connect(connectProcess, &qsc::AdbProcess::adbProcessResult,
+            this, [this, connectProcess, serial, adbDeviceAddress, apkFile, retryCount](qsc::AdbProcess::ADB_EXEC_RESULT processResult) {
+        if (qsc::AdbProcess::AER_SUCCESS_START == processResult) {
+            return;
+        }
         
-        QString errorOutput = connectProcess->readAllStandardError();
-        QString stdOutput = connectProcess->readAllStandardOutput();
+        QString errorOutput = connectProcess->getErrorOut();
+        QString stdOutput = connectProcess->getStdOut();
         
         bool shouldContinue = false;
         
-        if (exitStatus == QProcess::NormalExit && exitCode == 0) {
+        if (qsc::AdbProcess::AER_SUCCESS_EXEC == processResult) {
             // 退出码为0，连接成功
-            qDebug() << "DeviceManager::connectAdbWithRetry - ADB connected successfully (exit code 0) for serial:" << serial
+            qDebug() << "DeviceManager::connectAdbWithRetry - ADB connected successfully for serial:" << serial
                      << "output:" << stdOutput;
             shouldContinue = true;
-        } else if (exitStatus == QProcess::NormalExit) {
-            // 退出码非0，但可能是"already connected"的情况，检查输出
+        } else if (qsc::AdbProcess::AER_ERROR_EXEC == processResult) {
+            // 执行失败，但可能是"already connected"的情况，检查输出
             QString allOutput = (stdOutput + " " + errorOutput).toLower();
             
             // 检查输出中是否包含成功连接的信息
@@ -693,18 +906,14 @@ void DeviceManager::connectAdbWithRetry(const QString &serial, const QString &ad
             } else {
                 qWarning() << "DeviceManager::connectAdbWithRetry - ADB connect failed for serial:" << serial 
                            << "adbDeviceAddress:" << adbDeviceAddress
-                           << "exitCode:" << exitCode
                            << "error:" << errorOutput
                            << "output:" << stdOutput;
             }
         } else {
-            // 进程崩溃或其他错误
-            qWarning() << "DeviceManager::connectAdbWithRetry - ADB connect process crashed or failed for serial:" << serial
+            // 进程启动失败或找不到 adb
+            qWarning() << "DeviceManager::connectAdbWithRetry - ADB connect failed to start for serial:" << serial
                        << "adbDeviceAddress:" << adbDeviceAddress
-                       << "exitCode:" << exitCode
-                       << "exitStatus:" << exitStatus
-                       << "error:" << errorOutput
-                       << "output:" << stdOutput;
+                       << "result:" << processResult;
         }
         
         connectProcess->deleteLater();
@@ -717,7 +926,7 @@ void DeviceManager::connectAdbWithRetry(const QString &serial, const QString &ad
             if (retryCount < MAX_RETRY_COUNT) {
                 qDebug() << "DeviceManager::connectAdbWithRetry - Retrying ADB connection, retryCount:" << (retryCount + 1);
                 // 等待一小段时间后重试（参考server.cpp的重试机制）
-                QTimer::singleShot(1000, this, [this, serial, adbDeviceAddress, apkFile, retryCount]() {
+                QTimer::singleShot(adbRetryDelayMs(retryCount), this, [this, serial, adbDeviceAddress, apkFile, retryCount]() {
                     connectAdbWithRetry(serial, adbDeviceAddress, apkFile, retryCount + 1);
                 });
             } else {
@@ -729,22 +938,7 @@ void DeviceManager::connectAdbWithRetry(const QString &serial, const QString &ad
         }
     });
     
-    // 启动连接进程
-    connectProcess->start();
-    if (!connectProcess->waitForStarted(3000)) {
-        qWarning() << "DeviceManager::connectAdbWithRetry - Failed to start ADB connect process";
-        connectProcess->deleteLater();
-        
-        // 启动失败也重试
-        if (retryCount < MAX_RETRY_COUNT) {
-            QTimer::singleShot(1000, this, [this, serial, adbDeviceAddress, apkFile, retryCount]() {
-                connectAdbWithRetry(serial, adbDeviceAddress, apkFile, retryCount + 1);
-            });
-        } else {
-            m_adbConnectStates.remove(serial);
-            m_adbConnectRetryCount.remove(serial);
-        }
-    }
+    connectProcess->connectDevice(adbDeviceAddress);
 }
 
 // 验证ADB连接是否真的可用（使用adb devices命令）
@@ -755,36 +949,19 @@ void DeviceManager::verifyAdbConnection(const QString &serial, const QString &ad
     
     m_adbConnectStates[serial] = ACS_VERIFYING;
     
-    QString adbPath = AdbProcessImpl::getAdbPath();
-    if (adbPath.isEmpty()) {
-        qWarning() << "DeviceManager::verifyAdbConnection - ADB path is empty";
-        m_adbConnectStates.remove(serial);
-        m_adbConnectRetryCount.remove(serial);
-        return;
-    }
-    
-    // 使用QProcess执行adb devices命令来验证设备是否真的连接
-    QProcess* verifyProcess = new QProcess(this);
-    verifyProcess->setProgram(adbPath);
-    verifyProcess->setArguments(QStringList() << "devices");
+    // 使用 qsc::AdbProcess 执行 devices（host:devices），用于验证设备是否真的连接
+    qsc::AdbProcess* verifyProcess = new qsc::AdbProcess(this);
     
-    connect(verifyProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-            this, [this, verifyProcess, serial, adbDeviceAddress, apkFile](int exitCode, QProcess::ExitStatus exitStatus) {
+    connect(verifyProcess, &qsc::AdbProcess::adbProcessResult,
+            this, [this, verifyProcess, serial, adbDeviceAddress, apkFile](qsc::AdbProcess::ADB_EXEC_RESULT processResult) {
+        if (qsc::AdbProcess::AER_SUCCESS_START == processResult) {
+            return;
+        }
         
         bool deviceFound = false;
-        if (exitStatus == QProcess::NormalExit && exitCode == 0) {
-            QString output = verifyProcess->readAllStandardOutput();
-            // 检查输出中是否包含设备地址
-            if (output.contains(adbDeviceAddress)) {
-                // 进一步检查设备状态是否为"device"（已授权）
-                QStringList lines = output.split('\n');
-                for (const QString& line : lines) {
-                    if (line.contains(adbDeviceAddress) && line.contains("device")) {
-                        deviceFound = true;
-                        break;
-                    }
-                }
-            }
+        if (qsc::AdbProcess::AER_SUCCESS_EXEC == processResult) {
+            // getDevicesSerialFromStdOut 只返回状态为 device（已授权）的设备
+            deviceFound = verifyProcess->getDevicesSerialFromStdOut().contains(adbDeviceAddress);
         }
         
         verifyProcess->deleteLater();
@@ -806,13 +983,7 @@ void DeviceManager::verifyAdbConnection(const QString &serial, const QString &ad
         }
     });
     
-    verifyProcess->start();
-    if (!verifyProcess->waitForStarted(3000)) {
-        qWarning() << "DeviceManager::verifyAdbConnection - Failed to start verify process";
-        verifyProcess->deleteLater();
-        m_adbConnectStates.remove(serial);
-        m_adbConnectRetryCount.remove(serial);
-    }
+    verifyProcess->execute("", QStringList() << "devices");
 }
 
 // 在ADB连接成功后开始安装APK
@@ -928,7 +1099,7 @@ void DeviceManager::connectXapkAdbWithRetry(const QString &serial, const QString
             // 连接失败，检查是否需要重试
             if (retryCount < MAX_RETRY_COUNT) {
                 qDebug() << "DeviceManager::connectXapkAdbWithRetry - Retrying ADB connection, retryCount:" << (retryCount + 1);
-                QTimer::singleShot(1000, this, [this, serial, adbDeviceAddress, xapkFile, dev, retryCount]() {
+                QTimer::singleShot(adbRetryDelayMs(retryCount), this, [this, serial, adbDeviceAddress, xapkFile, dev, retryCount]() {
                     connectXapkAdbWithRetry(serial, adbDeviceAddress, xapkFile, dev, retryCount + 1);
                 });
             } else {
@@ -943,7 +1114,7 @@ void DeviceManager::connectXapkAdbWithRetry(const QString &serial, const QString
         connectProcess->deleteLater();
         
         if (retryCount < MAX_RETRY_COUNT) {
-            QTimer::singleShot(1000, this, [this, serial, adbDeviceAddress, xapkFile, dev, retryCount]() {
+            QTimer::singleShot(adbRetryDelayMs(retryCount), this, [this, serial, adbDeviceAddress, xapkFile, dev, retryCount]() {
                 connectXapkAdbWithRetry(serial, adbDeviceAddress, xapkFile, dev, retryCount + 1);
             });
         }
@@ -1027,7 +1198,7 @@ void DeviceManager::connectAdbForPushFileWithRetry(const QString &serial, const
             if (retryCount < MAX_RETRY_COUNT) {
                 qDebug() << "DeviceManager::connectAdbForPushFileWithRetry - Retrying ADB connection, retryCount:" << (retryCount + 1);
                 // 等待一小段时间后重试
-                QTimer::singleShot(1000, this, [this, serial, adbDeviceAddress, filePath, devicePath, retryCount]() {
+                QTimer::singleShot(adbRetryDelayMs(retryCount), this, [this, serial, adbDeviceAddress, filePath, devicePath, retryCount]() {
                     connectAdbForPushFileWithRetry(serial, adbDeviceAddress, filePath, devicePath, retryCount + 1);
                 });
             } else {
@@ -1047,7 +1218,7 @@ void DeviceManager::connectAdbForPushFileWithRetry(const QString &serial, const
         
         // 启动失败也重试
         if (retryCount < MAX_RETRY_COUNT) {
-            QTimer::singleShot(1000, this, [this, serial, adbDeviceAddress, filePath, devicePath, retryCount]() {
+            QTimer::singleShot(adbRetryDelayMs(retryCount), this, [this, serial, adbDeviceAddress, filePath, devicePath, retryCount]() {
                 connectAdbForPushFileWithRetry(serial, adbDeviceAddress, filePath, devicePath, retryCount + 1);
             });
         } else {
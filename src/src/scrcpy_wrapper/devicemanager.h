@@ -9,10 +9,18 @@
 #include <QMouseEvent>
 #include <QWheelEvent>
 #include <QKeyEvent>
+#include <QVariantMap>
 #include "QtScrcpyCore.h"
 
+namespace qsc {
+class MacroReplayer;
+class BulkPusher;
+}
+
 class ScrcpyObserver;
+class ThumbnailObserver;
 class XapkInstaller;
+class ApkBatchInstaller;
 
 class DeviceManager : public QObject
 {
@@ -24,7 +32,13 @@ public:
     Q_INVOKABLE void connectDevice(const QString &serial);
     Q_INVOKABLE void connectDeviceDirectTcp(const QString &serial, const QString &host, quint16 videoPort, quint16 audioPort, quint16 controlPort);
     Q_INVOKABLE void disconnectDevice(const QString &serial);
+    // 立即返回，每台设备清理完成后发出 deviceReleased
+    Q_INVOKABLE void disconnectAllDevices();
     Q_INVOKABLE bool hasDevice(const QString &serial) const;
+    // 批量连接：adb 阶段的全局/单主机并发上限，以及各阶段耗时统计
+    Q_INVOKABLE void setConnectLimits(int globalLimit, int perHostLimit);
+    Q_INVOKABLE QVariantMap connectStats() const;
+    Q_INVOKABLE QVariantMap pushCacheStats() const;
 
     // user data & observer bridging
     Q_INVOKABLE bool setUserData(const QString &serial, QObject *userData);
@@ -39,6 +53,7 @@ public:
     Q_INVOKABLE void volumeUp(const QString &serial);
     Q_INVOKABLE void volumeDown(const QString &serial);
     Q_INVOKABLE void textInput(const QString &serial, const QString &text);
+    Q_INVOKABLE void cancelTextInput(const QString &serial);
     Q_INVOKABLE void pushFile(const QString &serial, const QString &file, const QString &devicePath = QString());
     Q_INVOKABLE void pushFile(const QString &serial, const QString &file, const QString &devicePath, const QString &adbDeviceAddress);
     Q_INVOKABLE void installApk(const QString &serial, const QString &apkFile);
@@ -63,6 +78,23 @@ public:
     // others
     Q_INVOKABLE void screenshot(const QString &serial);
 
+    // 控制流宏：在单台设备上录制，保存为文件后回放到多台设备
+    Q_INVOKABLE bool startMacroRecord(const QString &serial);
+    Q_INVOKABLE bool stopMacroRecord(const QString &serial, const QString &filePath);
+    Q_INVOKABLE bool replayMacro(const QString &filePath, const QStringList &serials);
+    Q_INVOKABLE void stopMacroReplay();
+    Q_INVOKABLE bool isMacroReplaying() const;
+
+    // 批量推送：源文件只读一次，并行推送到多台设备
+    Q_INVOKABLE bool pushFileToDevices(const QStringList &serials, const QString &file, const QString &devicePath = QString());
+    Q_INVOKABLE void cancelBulkPush();
+    Q_INVOKABLE bool isBulkPushing() const;
+
+    // 批量安装：已安装相同或更高 versionCode 的设备会被跳过，force 为 true 时全部安装
+    Q_INVOKABLE bool installApkToDevices(const QStringList &serials, const QString &apkFile, bool force = false);
+    Q_INVOKABLE void cancelBatchInstall();
+    Q_INVOKABLE bool isBatchInstalling() const;
+
     // observer control
     Q_INVOKABLE bool registerObserver(const QString &serial);
     Q_INVOKABLE void deRegisterObserver(const QString &serial);
@@ -76,11 +108,22 @@ public:
 signals:
     void deviceConnected(const QString &serial, const QString &deviceName, const QSize &size);
     void deviceDisconnected(const QString &serial);
+    void deviceReleased(const QString &serial);
     void deviceConnectFailed(const QString &serial);
     void newFrame(const QString &serial, const QImage &frame);
     void screenInfo(const QString &serial, int width, int height);
     void fpsUpdated(const QString &serial, int fps);
     void grabCursorChanged(const QString &serial, bool grab);
+    void textInputProgress(const QString &serial, qint64 sentBytes, qint64 totalBytes, qint64 bytesPerSecond);
+    void textInputFinished(const QString &serial, bool complete);
+    void macroReplayProgress(int done, int total);
+    void macroReplayFinished(bool complete, const QVariantMap &stats);
+    void bulkPushProgress(qint64 sentBytes, qint64 totalBytes, qint64 bytesPerSecond);
+    void bulkPushDeviceFinished(const QString &serial, bool success, const QString &error);
+    void bulkPushFinished(int succeeded, int failed);
+    void batchInstallProgress(int done, int total);
+    void batchInstallDeviceFinished(const QString &serial, const QString &status, const QString &message);
+    void batchInstallFinished(int installed, int skipped, int failed);
 
 private slots:
     void onDeviceConnected(bool success, const QString& serial, const QString& deviceName, const QSize& size);
@@ -93,7 +136,12 @@ private slots:
 private:
     qsc::IDeviceManage& m_deviceManage;
     QHash<QString, QSharedPointer<ScrcpyObserver>> m_observers;
+    // 每个视频会话一个，给网格提供缩略图
+    QHash<QString, QSharedPointer<ThumbnailObserver>> m_thumbnailObservers;
     QHash<QString, XapkInstaller*> m_xapkInstallers;  // 每个设备的XAPK安装器
+    QPointer<qsc::MacroReplayer> m_macroReplayer;
+    QPointer<qsc::BulkPusher> m_bulkPusher;
+    QPointer<ApkBatchInstaller> m_batchInstaller;
     
     // ADB连接状态管理（参考server.cpp的状态机实现）
     enum AdbConnectState {
@@ -352,6 +352,36 @@ void GroupController::postTextInput(QString &text)
     }
 }
 
+void GroupController::postTextStream(const QString &text)
+{
+    for (const auto& serial : m_devices) {
+        if (true == isHost(serial)) {
+            continue;
+        }
+        auto device = qsc::IDeviceManage::getInstance().getDevice(serial);
+        if (!device) {
+            continue;
+        }
+
+        device->postTextStream(text);
+    }
+}
+
+void GroupController::cancelTextStream()
+{
+    for (const auto& serial : m_devices) {
+        if (true == isHost(serial)) {
+            continue;
+        }
+        auto device = qsc::IDeviceManage::getInstance().getDevice(serial);
+        if (!device) {
+            continue;
+        }
+
+        device->cancelTextStream();
+    }
+}
+
 void GroupController::requestDeviceClipboard()
 {
     for (const auto& serial : m_devices) {
@@ -39,6 +39,8 @@ private:
     void collapsePanel() override;
     void postBackOrScreenOn(bool down) override;
     void postTextInput(QString &text) override;
+    void postTextStream(const QString &text) override;
+    void cancelTextStream() override;
     void requestDeviceClipboard() override;
     void setDeviceClipboard(bool pause = true) override;
     void clipboardPaste() override;
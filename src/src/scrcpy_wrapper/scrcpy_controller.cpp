@@ -1,5 +1,6 @@
 #include "scrcpy_controller.h"
 #include "../sdk_wrapper/video_frame.h"
+#include "../helper/ApkManifestReader.h"
 #include <QDebug>
 #include <QMouseEvent>
 #include <QWheelEvent>
@@ -559,77 +560,14 @@ void ScrcpyController::pushObbFiles(const QStringList& obbFiles, const QString&
 
 QString ScrcpyController::extractPackageNameFromApk(const QString& apkFile)
 {
-    // 获取应用程序目录路径
-    QString appDir = QCoreApplication::applicationDirPath();
-    
-    // 辅助函数：尝试使用指定的 aapt 路径提取包名
-    auto tryExtractPackageName = [&apkFile](const QString& aaptPath) -> QString {
-        QFileInfo aaptInfo(aaptPath);
-        // 如果是相对路径（系统 PATH），直接尝试；如果是绝对路径，检查文件是否存在
-        if (aaptPath.contains("/") || aaptPath.contains("\\")) {
-            // 绝对路径，检查文件是否存在
-            if (!aaptInfo.exists() || !aaptInfo.isFile()) {
-                return QString(); // 文件不存在
-            }
-        }
-        
-        QProcess aaptProcess;
-        aaptProcess.setProgram(aaptPath);
-        aaptProcess.setArguments(QStringList() << "dump" << "badging" << apkFile);
-        aaptProcess.start();
-        
-        if (aaptProcess.waitForFinished(5000) && aaptProcess.exitCode() == 0) {
-            QByteArray output = aaptProcess.readAllStandardOutput();
-            QString outputStr = QString::fromUtf8(output);
-            
-            // 解析 aapt 输出，查找 package: name='...'
-            QRegularExpression regex(R"(package:\s*name='([^']+)')");
-            QRegularExpressionMatch match = regex.match(outputStr);
-            if (match.hasMatch()) {
-                QString packageName = match.captured(1);
-                qDebug() << "Extracted package name using" << aaptPath << "package:" << packageName;
-                return packageName;
-            }
-        }
-        return QString();
-    };
-    
-    // 方法1: 优先尝试应用程序目录下的 aapt
-#ifdef Q_OS_WIN
-    QString localAapt = appDir + "/aapt.exe";
-    QString localAapt2 = appDir + "/aapt2.exe";
-#else
-    QString localAapt = appDir + "/aapt";
-    QString localAapt2 = appDir + "/aapt2";
-#endif
-    
-    QString packageName = tryExtractPackageName(localAapt);
-    if (!packageName.isEmpty()) {
-        return packageName;
-    }
-    
-    // 方法2: 尝试应用程序目录下的 aapt2
-    packageName = tryExtractPackageName(localAapt2);
-    if (!packageName.isEmpty()) {
-        return packageName;
-    }
-    
-    // 方法3: 回退到系统 PATH 中的 aapt
-    packageName = tryExtractPackageName("aapt");
-    if (!packageName.isEmpty()) {
-        return packageName;
-    }
-    
-    // 方法4: 回退到系统 PATH 中的 aapt2
-    packageName = tryExtractPackageName("aapt2");
-    if (!packageName.isEmpty()) {
-        return packageName;
+    // 进程内解析 AndroidManifest.xml，不依赖 aapt
+    QString packageName = ApkManifestReader::packageName(apkFile);
+    if (packageName.isEmpty()) {
+        qDebug() << "Could not read package name from manifest:" << apkFile;
+    } else {
+        qDebug() << "Extracted package name:" << packageName;
     }
-    
-    qDebug() << "Could not extract package name using aapt/aapt2. "
-             << "Checked application directory:" << appDir
-             << "and system PATH.";
-    return QString();
+    return packageName;
 }
 
 QString ScrcpyController::getRecentlyInstalledPackageName(const QString& serial)
@@ -652,7 +590,7 @@ QString ScrcpyController::getRecentlyInstalledPackageName(const QString& serial)
     // 主要依赖 extractPackageNameFromApk 方法在安装前获取包名
     
     qDebug() << "getRecentlyInstalledPackageName: This method is not fully implemented. "
-             << "Please use aapt/aapt2 to extract package name before installation.";
+             << "Package name is read from AndroidManifest.xml before installation.";
     return QString();
 }
 
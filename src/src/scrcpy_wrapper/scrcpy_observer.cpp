@@ -98,6 +98,17 @@ void ScrcpyObserver::grabCursor(bool grab)
                               Q_ARG(bool, grab));
 }
 
+void ScrcpyObserver::textStreamProgress(qint64 sentBytes, qint64 totalBytes, qint64 bytesPerSecond)
+{
+    // 文本流回调来自 Controller，本身就在主线程
+    emit textInputProgress(sentBytes, totalBytes, bytesPerSecond);
+}
+
+void ScrcpyObserver::textStreamFinished(bool complete)
+{
+    emit textInputFinished(complete);
+}
+
 void ScrcpyObserver::doEmitScreenInfo(int width, int height)
 {
     emit screenInfo(width, height);
@@ -19,6 +19,8 @@ public:
                  int linesizeY, int linesizeU, int linesizeV) override;
     void updateFPS(quint32 fps) override;
     void grabCursor(bool grab) override;
+    void textStreamProgress(qint64 sentBytes, qint64 totalBytes, qint64 bytesPerSecond) override;
+    void textStreamFinished(bool complete) override;
 
     QString serial() const { return m_serial; }
 
@@ -27,6 +29,8 @@ signals:
     void screenInfo(int width, int height);
     void fpsUpdated(int fps);
     void grabCursorChanged(bool grab);
+    void textInputProgress(qint64 sentBytes, qint64 totalBytes, qint64 bytesPerSecond);
+    void textInputFinished(bool complete);
 
 private slots:
     // 用于线程安全的信号发射
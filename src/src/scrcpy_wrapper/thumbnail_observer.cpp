@@ -0,0 +1,48 @@
+#include "thumbnail_observer.h"
+#include "../sdk_wrapper/thumbnail_service.h"
+#include <QImage>
+#include <libyuv.h>
+
+ThumbnailObserver::ThumbnailObserver(const QString &serial)
+    : m_serial(serial)
+{
+}
+
+void ThumbnailObserver::onFrame(int width, int height, uint8_t* dataY, uint8_t* dataU, uint8_t* dataV,
+                                int linesizeY, int linesizeU, int linesizeV)
+{
+    int side = 0;
+    if (width <= 0 || height <= 0 || !ThumbnailService::getInstance()->wantsLiveFrame(m_serial, side)) {
+        return;
+    }
+
+    // 按长边等比缩小，I420 要求偶数宽高
+    int longSide = qMax(width, height);
+    int dstWidth = width;
+    int dstHeight = height;
+    if (side < longSide) {
+        dstWidth = qMax(2, (width * side / longSide) & ~1);
+        dstHeight = qMax(2, (height * side / longSide) & ~1);
+    }
+
+    QImage image(dstWidth, dstHeight, QImage::Format_ARGB32);
+    if (dstWidth == width && dstHeight == height) {
+        libyuv::I420ToARGB(dataY, linesizeY, dataU, linesizeU, dataV, linesizeV,
+                           image.bits(), image.bytesPerLine(), width, height);
+    } else {
+        int chromaWidth = dstWidth / 2;
+        int chromaHeight = dstHeight / 2;
+        int sizeY = dstWidth * dstHeight;
+        int sizeUV = chromaWidth * chromaHeight;
+        m_scaled.resize(sizeY + sizeUV * 2);
+        uint8_t *scaledY = reinterpret_cast<uint8_t *>(m_scaled.data());
+        uint8_t *scaledU = scaledY + sizeY;
+        uint8_t *scaledV = scaledU + sizeUV;
+        libyuv::I420Scale(dataY, linesizeY, dataU, linesizeU, dataV, linesizeV, width, height,
+                          scaledY, dstWidth, scaledU, chromaWidth, scaledV, chromaWidth,
+                          dstWidth, dstHeight, libyuv::kFilterBox);
+        libyuv::I420ToARGB(scaledY, dstWidth, scaledU, chromaWidth, scaledV, chromaWidth,
+                           image.bits(), image.bytesPerLine(), dstWidth, dstHeight);
+    }
+    ThumbnailService::getInstance()->setLiveFrame(m_serial, image, side);
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <QString>
+#include "QtScrcpyCore.h"
+
+/**
+ * @brief 从视频会话的解码帧生成网格缩略图
+ *
+ * 只有 ThumbnailService 需要时才处理：先在 YUV 上缩到格子大小，再转 ARGB，
+ * 整帧不做颜色转换
+ */
+class ThumbnailObserver : public qsc::DeviceObserver
+{
+public:
+    explicit ThumbnailObserver(const QString &serial);
+    ~ThumbnailObserver() override = default;
+
+    void onFrame(int width, int height, uint8_t* dataY, uint8_t* dataU, uint8_t* dataV,
+                 int linesizeY, int linesizeU, int linesizeV) override;
+
+    QString serial() const { return m_serial; }
+
+private:
+    QString m_serial;
+    QByteArray m_scaled;  // 缩小后的 I420，复用避免每次分配
+};
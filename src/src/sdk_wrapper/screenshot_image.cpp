@@ -1,25 +1,24 @@
 #include "screenshot_image.h"
+#include "thumbnail_service.h"
 #include "video_frame.h"
 #include <QPainter>
-#include <QtNetwork/QNetworkRequest>
-#include <QBuffer>
+#include <QQuickWindow>
+#include <QtMath>
 
-#include "libyuv.h"
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
 ScreenshotRenderItem::ScreenshotRenderItem(QQuickItem* parent)
     : QQuickPaintedItem(parent)
-    , m_networkManager(new QNetworkAccessManager(this)) // 初始化网络管理器
 {
     setRenderTarget(QQuickPaintedItem::FramebufferObject); // 可选：提高性能
     setAntialiasing(false);
-
-    // 连接网络管理器的 finished 信号到我们的槽函数
-    connect(m_networkManager, &QNetworkAccessManager::finished, this, &ScreenshotRenderItem::onImageDownloaded);
 }
 
-ScreenshotRenderItem::~ScreenshotRenderItem() = default;
+ScreenshotRenderItem::~ScreenshotRenderItem()
+{
+    ThumbnailService::getInstance()->unsubscribe(this);
+}
 
 void ScreenshotRenderItem::onFrame(std::shared_ptr<armcloud::VideoFrame>& frame) {
     if (!frame) return;
@@ -104,81 +103,80 @@ void ScreenshotRenderItem::setRotation(qreal rotation){
 }
 
 void ScreenshotRenderItem::setImageUrl(const QUrl& url) {
-    if (m_imageUrl != url){
-        m_imageUrl = url;
-        emit imageUrlChanged(); // 属性改变时发出信号
-    }
-    
+    if (m_imageUrl == url)
+        return;
+
+    m_imageUrl = url;
+    emit imageUrlChanged(); // 属性改变时发出信号
+    // 下载、刷新和解码都交给 ThumbnailService，同一地址只请求一次
     if (m_imageUrl.isValid()) {
-        // 添加请求标识，避免串图
-        QString requestId = QString::number(QDateTime::currentMSecsSinceEpoch()) + "_" + QString::number(reinterpret_cast<quintptr>(this));
-        // qDebug() << "ScreenshotRenderItem::setImageUrl - Request ID:" << requestId << "URL:" << url.toString();
-        
-        QByteArray data;
-        postImageRequest(m_imageUrl, data, requestId);
-    }else{
-        // 无效不做任何处理
+        ThumbnailService::getInstance()->subscribe(this, m_imageUrl);
+    } else {
+        ThumbnailService::getInstance()->unsubscribe(this);
     }
 }
 
-void ScreenshotRenderItem::postImageRequest(const QUrl& url, const QByteArray& postData, const QString& requestId) {
-    if (!url.isValid()) {
-        qWarning() << "postImageRequest: Invalid URL provided.";
+void ScreenshotRenderItem::setSerial(const QString& serial) {
+    if (m_serial == serial)
         return;
-    }
 
-    QNetworkRequest request(url);
-    // 添加请求标识头，避免缓存和串图
-    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
-    request.setRawHeader("X-Request-ID", requestId.toUtf8());
-    request.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::AlwaysNetwork);
-    
-    // qDebug() << "ScreenshotRenderItem: POST request sent to" << url << "with Request ID:" << requestId;
-    m_networkManager->get(request);
+    // 先按旧序列号取消订阅，再用新的重新登记
+    ThumbnailService::getInstance()->unsubscribe(this);
+    m_serial = serial;
+    emit serialChanged();
+    if (m_imageUrl.isValid()) {
+        ThumbnailService::getInstance()->subscribe(this, m_imageUrl);
+    }
 }
 
-void ScreenshotRenderItem::setHasVideo(bool value)
-{
-    if (m_hasVideo == value)
-        return;
-    m_hasVideo = value;
-    emit hasVideoChanged();
+void ScreenshotRenderItem::setThumbnail(const QImage& image) {
+    {
+        QMutexLocker locker(&m_mutex);
+        m_image = image;
+    }
+    setHasVideo(true);
+    update();
 }
 
-void ScreenshotRenderItem::onImageDownloaded(QNetworkReply* reply) {
-    // 获取请求标识用于调试
-    QString requestId = reply->request().rawHeader("X-Request-ID");
-    
-    if (reply->error() == QNetworkReply::NoError) {
-        // 读取所有可用的数据
-        QByteArray imageData = reply->readAll();
-        
-        if (imageData.isEmpty()) {
-            qWarning() << "ScreenshotRenderItem: Empty image data received for Request ID:" << requestId;
-            reply->deleteLater();
-            return;
-        }
+QSize ScreenshotRenderItem::thumbnailSize() const {
+    qreal dpr = window() ? window()->effectiveDevicePixelRatio() : 1.0;
+    return QSize(qCeil(width() * dpr), qCeil(height() * dpr));
+}
 
-        int channels;
-        int width = 0;
-        int height = 0;
-        unsigned char* rgba = stbi_load_from_memory((const uint8_t*)imageData.data(), imageData.size(), &width, &height, &channels, 4); // force RGBA
-        if (!rgba) {
-            // qWarning() << "ScreenshotRenderItem: Failed to decode image data for Request ID:" << requestId;
-            reply->deleteLater();
-            return;
+bool ScreenshotRenderItem::isOnScreen() const {
+    QQuickWindow* win = window();
+    if (!win || !win->isVisible() || win->visibility() == QWindow::Minimized)
+        return false;
+    if (!isVisible() || width() <= 0 || height() <= 0)
+        return false;
+
+    QRectF bounds(0, 0, win->width(), win->height());
+    for (QQuickItem* item = parentItem(); item; item = item->parentItem()) {
+        if (item->clip()) {
+            bounds &= item->mapRectToScene(item->boundingRect());
         }
+    }
+    return bounds.intersects(mapRectToScene(boundingRect()));
+}
 
-        // qDebug() << "ScreenshotRenderItem: Successfully decoded image" << width << "x" << height << "for Request ID:" << requestId;
-        
-        auto videoFrame = std::make_shared<armcloud::VideoFrame>(width, height, armcloud::PixelFormat::ARGB);
-        libyuv::ABGRToARGB(rgba, width * 4, videoFrame->buffer(0), width * 4, width, height);
-        stbi_image_free(rgba);
+void ScreenshotRenderItem::itemChange(ItemChange change, const ItemChangeData& value) {
+    QQuickPaintedItem::itemChange(change, value);
+    if ((change == ItemVisibleHasChanged && value.boolValue) || change == ItemSceneChange) {
+        ThumbnailService::getInstance()->touch(this);
+    }
+}
 
-        onFrame(videoFrame);
-    } else {
-        qWarning() << "ScreenshotRenderItem: Image download error for Request ID:" << requestId << "Error:" << reply->errorString();
-        setHasVideo(false);
+void ScreenshotRenderItem::geometryChange(const QRectF& newGeometry, const QRectF& oldGeometry) {
+    QQuickPaintedItem::geometryChange(newGeometry, oldGeometry);
+    if (newGeometry.size() != oldGeometry.size()) {
+        ThumbnailService::getInstance()->touch(this);
     }
-    reply->deleteLater(); // 释放 QNetworkReply 资源
+}
+
+void ScreenshotRenderItem::setHasVideo(bool value)
+{
+    if (m_hasVideo == value)
+        return;
+    m_hasVideo = value;
+    emit hasVideoChanged();
 }
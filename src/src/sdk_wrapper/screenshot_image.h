@@ -4,8 +4,6 @@
 #include <QImage>
 #include <QMutex>
 #include <memory>
-#include <QtNetwork/QNetworkAccessManager> // 新增：用于网络请求
-#include <QtNetwork/QNetworkReply>       // 新增：用于网络回复
 #include "video_render_sink.h"
 
 
@@ -17,6 +15,8 @@ class ScreenshotRenderItem : public QQuickPaintedItem {
     // 新增属性：图片 URL
     Q_PROPERTY(QUrl imageUrl READ imageUrl WRITE setImageUrl NOTIFY imageUrlChanged)
     Q_PROPERTY(bool hasVideo READ hasVideo WRITE setHasVideo NOTIFY hasVideoChanged FINAL)
+    // 视频会话的序列号，会话存在时缩略图直接取自视频流
+    Q_PROPERTY(QString serial READ serial WRITE setSerial NOTIFY serialChanged FINAL)
 public:
     explicit ScreenshotRenderItem(QQuickItem* parent = nullptr);
     ~ScreenshotRenderItem() override;
@@ -33,8 +33,20 @@ public:
     void setImageUrl(const QUrl& url);
     bool hasVideo() const { return m_hasVideo; }
     void setHasVideo(bool value);
-private:
-    void postImageRequest(const QUrl &url, const QByteArray &postData, const QString &requestId);
+    QString serial() const { return m_serial; }
+    void setSerial(const QString& serial);
+
+    // 由 ThumbnailService 调用：显示已缩放好的缩略图
+    void setThumbnail(const QImage& image);
+    // 缩略图需要的长宽（物理像素）
+    QSize thumbnailSize() const;
+    // 是否在窗口中真正可见（考虑 GridView 等父项的裁剪）
+    bool isOnScreen() const;
+
+protected:
+    void itemChange(ItemChange change, const ItemChangeData& value) override;
+    void geometryChange(const QRectF& newGeometry, const QRectF& oldGeometry) override;
+
 signals:
     // 旋转属性改变时发出信号
     void rotationChanged();
@@ -42,10 +54,8 @@ signals:
     void imageUrlChanged();
 
     void hasVideoChanged();
-private slots:
-    // 处理图片下载完成的槽函数
-    void onImageDownloaded(QNetworkReply* reply);
 
+    void serialChanged();
 private:
     QImage m_image;
     QMutex m_mutex;
@@ -53,5 +63,5 @@ private:
     qreal m_rotation = 0.0;
     QUrl m_imageUrl; // 存储图片 URL
     bool m_hasVideo = false;
-    QNetworkAccessManager* m_networkManager; // 网络访问管理器
+    QString m_serial;
 };
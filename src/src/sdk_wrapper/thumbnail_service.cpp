@@ -0,0 +1,361 @@
+#include "thumbnail_service.h"
+#include "screenshot_image.h"
+#include <QUrlQuery>
+#include <QThread>
+#include <QtNetwork/QNetworkRequest>
+#include <QDebug>
+
+#include "libyuv.h"
+#include "stb_image.h"
+
+// 检查可见性的节拍，刷新间隔按 refreshInterval 计算
+#define TICK_INTERVAL 250
+// 解码后缩略图的缓存上限（字节）
+#define THUMBNAIL_CACHE_BYTES (64 * 1024 * 1024)
+#define REQUEST_TIMEOUT 5000
+
+ThumbnailService::ThumbnailService(QObject *parent)
+    : QObject{parent}
+    , _manager(new QNetworkAccessManager(this))
+{
+    _refreshInterval = 2000;
+    _maxConnectionsPerHost = 4;
+    _liveThumbnails = true;
+    _liveInterval = 1000;
+    _clock.start();
+    _thumbnails.setMaxCost(THUMBNAIL_CACHE_BYTES);
+    // 解码只占一半核心，避免和视频解码抢 CPU
+    _decodePool.setMaxThreadCount(qBound(1, QThread::idealThreadCount() / 2, 4));
+    _timer.setInterval(TICK_INTERVAL);
+    connect(&_timer, &QTimer::timeout, this, &ThumbnailService::onTick);
+    _timer.start();
+}
+
+QString ThumbnailService::keyOf(const QUrl &url) {
+    // 旧的调用方会带 ?t= 时间戳，去掉后同一设备只对应一个条目
+    QUrl stripped(url);
+    QUrlQuery query(stripped);
+    query.removeAllQueryItems("t");
+    stripped.setQuery(query);
+    return stripped.toString();
+}
+
+void ThumbnailService::subscribe(ScreenshotRenderItem *item, const QUrl &url) {
+    unsubscribe(item);
+    if (!url.isValid()) {
+        return;
+    }
+    QString key = keyOf(url);
+    Entry &entry = _entries[key];
+    if (entry.items.isEmpty() && entry.url.isEmpty()) {
+        entry.url = QUrl(key);
+        entry.host = entry.url.authority();
+    }
+    entry.items.append(item);
+    _itemKeys.insert(item, key);
+    if (!item->serial().isEmpty()) {
+        _serialKeys.insert(item->serial(), key);
+    }
+
+    // 已经解码过的直接显示，不等下一次请求
+    if (QImage *image = _thumbnails.object(key)) {
+        _cacheHits++;
+        item->setThumbnail(*image);
+    }
+    touch(item);
+}
+
+void ThumbnailService::unsubscribe(ScreenshotRenderItem *item) {
+    auto it = _itemKeys.find(item);
+    if (it == _itemKeys.end()) {
+        return;
+    }
+    QString key = it.value();
+    _itemKeys.erase(it);
+    if (_serialKeys.value(item->serial()) == key) {
+        _serialKeys.remove(item->serial());
+    }
+
+    auto entryIt = _entries.find(key);
+    if (entryIt == _entries.end()) {
+        return;
+    }
+    Entry &entry = entryIt.value();
+    for (int i = entry.items.size() - 1; i >= 0; --i) {
+        if (entry.items[i].isNull() || entry.items[i] == item) {
+            entry.items.removeAt(i);
+        }
+    }
+    if (entry.items.isEmpty()) {
+        QPointer<QNetworkReply> reply = entry.reply;
+        _entries.erase(entryIt);
+        // 没人看了就不必再占着 host 的连接
+        if (reply) {
+            reply->abort();
+        }
+    }
+}
+
+void ThumbnailService::touch(ScreenshotRenderItem *item) {
+    QString key = _itemKeys.value(item);
+    auto it = _entries.find(key);
+    if (it == _entries.end() || !item->isOnScreen()) {
+        return;
+    }
+    Entry &entry = it.value();
+    if (entry.decodedSide > 0 && targetSideOf(entry) > entry.decodedSide) {
+        // 格子变大了，缓存的缩略图不够清晰，不能用条件请求
+        entry.etag.clear();
+        entry.lastModified.clear();
+        entry.fetchedAt = -1;
+    }
+    if (isDue(entry)) {
+        // 还没有画面的格子插到队首
+        schedule(key, entry.fetchedAt < 0);
+    }
+}
+
+bool ThumbnailService::isDue(const Entry &entry) const {
+    if (entry.busy || entry.queued) {
+        return false;
+    }
+    return entry.fetchedAt < 0 || _clock.elapsed() - entry.fetchedAt >= _refreshInterval;
+}
+
+bool ThumbnailService::hasVisibleItem(const Entry &entry) {
+    for (const auto &item : entry.items) {
+        if (item && item->isOnScreen()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int ThumbnailService::targetSideOf(const Entry &entry) {
+    int side = 0;
+    for (const auto &item : entry.items) {
+        if (item) {
+            QSize size = item->thumbnailSize();
+            side = qMax(side, qMax(size.width(), size.height()));
+        }
+    }
+    return side;
+}
+
+void ThumbnailService::onTick() {
+    for (auto it = _entries.begin(); it != _entries.end(); ++it) {
+        if (isDue(it.value()) && hasVisibleItem(it.value())) {
+            schedule(it.key(), it.value().fetchedAt < 0);
+        }
+    }
+}
+
+void ThumbnailService::schedule(const QString &key, bool urgent) {
+    Entry &entry = _entries[key];
+    entry.queued = true;
+    QQueue<QString> &queue = _hostQueues[entry.host];
+    if (urgent) {
+        queue.prepend(key);
+    } else {
+        queue.enqueue(key);
+    }
+    pump(entry.host);
+}
+
+void ThumbnailService::pump(const QString &host) {
+    auto queueIt = _hostQueues.find(host);
+    if (queueIt == _hostQueues.end()) {
+        return;
+    }
+    QQueue<QString> &queue = queueIt.value();
+    while (!queue.isEmpty() && _hostActive.value(host) < _maxConnectionsPerHost) {
+        QString key = queue.dequeue();
+        auto it = _entries.find(key);
+        if (it == _entries.end()) {
+            continue;
+        }
+        it.value().queued = false;
+        // 排队期间被滚出屏幕的不再请求，下次可见时重新排队
+        if (!hasVisibleItem(it.value())) {
+            continue;
+        }
+        fetch(key);
+    }
+    if (queue.isEmpty()) {
+        _hostQueues.erase(queueIt);
+    }
+}
+
+void ThumbnailService::fetch(const QString &key) {
+    Entry &entry = _entries[key];
+    QNetworkRequest request(entry.url);
+    request.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::AlwaysNetwork);
+    request.setTransferTimeout(REQUEST_TIMEOUT);
+    // 只有解码结果还在缓存里时才能接受 304
+    if (_thumbnails.contains(key)) {
+        if (!entry.etag.isEmpty()) {
+            request.setRawHeader("If-None-Match", entry.etag);
+        }
+        if (!entry.lastModified.isEmpty()) {
+            request.setRawHeader("If-Modified-Since", entry.lastModified);
+        }
+    }
+
+    QString host = entry.host;
+    QNetworkReply *reply = _manager->get(request);
+    entry.reply = reply;
+    entry.busy = true;
+    _hostActive[host]++;
+    _requests++;
+    connect(reply, &QNetworkReply::finished, this, [this, key, host, reply] {
+        onReplyFinished(key, host, reply);
+    });
+}
+
+void ThumbnailService::onReplyFinished(const QString &key, const QString &host, QNetworkReply *reply) {
+    reply->deleteLater();
+    if (--_hostActive[host] <= 0) {
+        _hostActive.remove(host);
+    }
+
+    auto it = _entries.find(key);
+    if (it != _entries.end()) {
+        Entry &entry = it.value();
+        entry.reply = nullptr;
+        entry.fetchedAt = _clock.elapsed();
+        int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        if (reply->error() == QNetworkReply::NoError && status == 304) {
+            _notModified++;
+            entry.busy = false;
+        } else if (reply->error() == QNetworkReply::NoError) {
+            entry.etag = reply->rawHeader("ETag");
+            entry.lastModified = reply->rawHeader("Last-Modified");
+            QByteArray data = reply->readAll();
+            if (data.isEmpty()) {
+                qWarning() << "ThumbnailService: Empty image data received for" << key;
+                entry.busy = false;
+            } else {
+                decode(key, data, targetSideOf(entry));
+            }
+        } else {
+            if (reply->error() != QNetworkReply::OperationCanceledError) {
+                qWarning() << "ThumbnailService: Image download error for" << key << "Error:" << reply->errorString();
+            }
+            entry.busy = false;
+            for (const auto &item : entry.items) {
+                if (item) {
+                    item->setHasVideo(false);
+                }
+            }
+        }
+    }
+    pump(host);
+}
+
+void ThumbnailService::decode(const QString &key, const QByteArray &data, int side) {
+    _decodePool.start([this, key, data, side] {
+        int channels;
+        int width = 0;
+        int height = 0;
+        unsigned char *rgba = stbi_load_from_memory((const uint8_t *)data.constData(), data.size(),
+                                                    &width, &height, &channels, 4);  // force RGBA
+        QImage thumbnail;
+        if (rgba) {
+            QImage full(width, height, QImage::Format_ARGB32);
+            libyuv::ABGRToARGB(rgba, width * 4, full.bits(), full.bytesPerLine(), width, height);
+            stbi_image_free(rgba);
+
+            // 按格子的长边等比缩小，不放大
+            int longSide = qMax(width, height);
+            if (side > 0 && side < longSide) {
+                int dstWidth = qMax(1, width * side / longSide);
+                int dstHeight = qMax(1, height * side / longSide);
+                thumbnail = QImage(dstWidth, dstHeight, QImage::Format_ARGB32);
+                libyuv::ARGBScale(full.constBits(), full.bytesPerLine(), width, height,
+                                  thumbnail.bits(), thumbnail.bytesPerLine(), dstWidth, dstHeight,
+                                  libyuv::kFilterBox);
+            } else {
+                thumbnail = full;
+            }
+        }
+        QMetaObject::invokeMethod(this, [this, key, thumbnail, side] {
+            onDecoded(key, thumbnail, side);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void ThumbnailService::onDecoded(const QString &key, const QImage &image, int side) {
+    auto it = _entries.find(key);
+    if (it == _entries.end()) {
+        return;
+    }
+    Entry &entry = it.value();
+    entry.busy = false;
+    if (image.isNull()) {
+        qWarning() << "ThumbnailService: Failed to decode image data for" << key;
+        entry.etag.clear();
+        entry.lastModified.clear();
+        return;
+    }
+    _decoded++;
+    entry.decodedSide = side;
+    _thumbnails.insert(key, new QImage(image), qMax<qsizetype>(1, image.sizeInBytes()));
+    deliver(entry, image);
+}
+
+void ThumbnailService::deliver(const Entry &entry, const QImage &image) {
+    for (const auto &item : entry.items) {
+        if (item) {
+            item->setThumbnail(image);
+        }
+    }
+}
+
+bool ThumbnailService::wantsLiveFrame(const QString &serial, int &side) const {
+    if (!_liveThumbnails) {
+        return false;
+    }
+    auto it = _entries.constFind(_serialKeys.value(serial));
+    if (it == _entries.constEnd()) {
+        return false;
+    }
+    const Entry &entry = it.value();
+    if (entry.fetchedAt >= 0 && _clock.elapsed() - entry.fetchedAt < _liveInterval) {
+        return false;
+    }
+    // 格子不在屏幕上时不做任何转换
+    if (!hasVisibleItem(entry)) {
+        return false;
+    }
+    side = targetSideOf(entry);
+    return side > 0;
+}
+
+void ThumbnailService::setLiveFrame(const QString &serial, const QImage &image, int side) {
+    QString key = _serialKeys.value(serial);
+    auto it = _entries.find(key);
+    if (it == _entries.end() || image.isNull()) {
+        return;
+    }
+    Entry &entry = it.value();
+    // 刷新时间顺延，视频流持续出帧时截图接口就不会被调用
+    entry.fetchedAt = _clock.elapsed();
+    entry.decodedSide = side;
+    entry.etag.clear();
+    entry.lastModified.clear();
+    _liveFrames++;
+    _thumbnails.insert(key, new QImage(image), qMax<qsizetype>(1, image.sizeInBytes()));
+    deliver(entry, image);
+}
+
+QVariantMap ThumbnailService::stats() const {
+    QVariantMap result;
+    result.insert("requests", _requests);
+    result.insert("notModified", _notModified);
+    result.insert("decoded", _decoded);
+    result.insert("liveFrames", _liveFrames);
+    result.insert("cacheHits", _cacheHits);
+    result.insert("entries", _entries.size());
+    result.insert("cacheBytes", _thumbnails.totalCost());
+    return result;
+}
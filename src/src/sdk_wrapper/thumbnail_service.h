@@ -0,0 +1,131 @@
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QCache>
+#include <QImage>
+#include <QPointer>
+#include <QQueue>
+#include <QTimer>
+#include <QThreadPool>
+#include <QElapsedTimer>
+#include <QVariantMap>
+#include <QtNetwork/QNetworkAccessManager>
+#include <QtNetwork/QNetworkReply>
+#include "../stdafx.h"
+#include "../singleton.h"
+
+class ScreenshotRenderItem;
+
+/**
+ * @brief 设备网格缩略图调度
+ *
+ * 所有 ScreenshotRenderItem 共用一个网络管理器，按截图地址订阅。只刷新屏幕上可见的
+ * 格子，每个 host 限制并发，带 If-None-Match/If-Modified-Since 条件请求；解码和缩放
+ * 在工作线程完成，直接缩到格子大小，解码结果放在 LRU 里，滚回来时立即显示
+ */
+class ThumbnailService : public QObject {
+    Q_OBJECT
+    // 可见格子的刷新间隔（毫秒）
+    Q_PROPERTY_AUTO(int, refreshInterval)
+    Q_PROPERTY_AUTO(int, maxConnectionsPerHost)
+    // 已有视频会话的设备直接从解码帧生成缩略图，不再轮询截图接口
+    Q_PROPERTY_AUTO(bool, liveThumbnails)
+    // 视频流缩略图的最小间隔（毫秒）
+    Q_PROPERTY_AUTO(int, liveInterval)
+
+private:
+    explicit ThumbnailService(QObject *parent = nullptr);
+
+public:
+    SINGLETON(ThumbnailService)
+
+    /**
+     * @brief 订阅截图，同一地址的多个格子共享一次下载和解码
+     * @param item 显示缩略图的格子
+     * @param url 截图地址，不带时间戳参数
+     */
+    void subscribe(ScreenshotRenderItem *item, const QUrl &url);
+
+    /**
+     * @brief 取消订阅，格子销毁或地址变化时调用
+     */
+    void unsubscribe(ScreenshotRenderItem *item);
+
+    /**
+     * @brief 格子变为可见或尺寸变化时调用，有缓存先显示缓存，过期则优先刷新
+     */
+    void touch(ScreenshotRenderItem *item);
+
+    /**
+     * @brief 视频会话是否需要一帧缩略图，由视频观察者在每帧解码后调用（主线程）
+     * @param serial 会话的设备序列号
+     * @param side 输出：缩略图长边（物理像素）
+     * @return 有可见格子且距上次已超过 liveInterval 时返回 true
+     */
+    bool wantsLiveFrame(const QString &serial, int &side) const;
+
+    /**
+     * @brief 提交从视频流生成的缩略图，同时推迟该格子的 HTTP 刷新
+     */
+    void setLiveFrame(const QString &serial, const QImage &image, int side);
+
+    // 统计：requests/notModified/decoded/liveFrames/cacheHits/entries/cacheBytes
+    Q_INVOKABLE QVariantMap stats() const;
+
+private:
+    struct Entry {
+        QUrl url;
+        QString host;
+        QList<QPointer<ScreenshotRenderItem>> items;
+        QByteArray etag;
+        QByteArray lastModified;
+        QPointer<QNetworkReply> reply;
+        int decodedSide = 0;  // 缓存中缩略图按多大的长边解码
+        qint64 fetchedAt = -1;
+        bool queued = false;
+        bool busy = false;  // 下载或解码中
+    };
+
+    void onTick();
+
+    void schedule(const QString &key, bool urgent);
+
+    void pump(const QString &host);
+
+    void fetch(const QString &key);
+
+    void onReplyFinished(const QString &key, const QString &host, QNetworkReply *reply);
+
+    void decode(const QString &key, const QByteArray &data, int side);
+
+    void onDecoded(const QString &key, const QImage &image, int side);
+
+    void deliver(const Entry &entry, const QImage &image);
+
+    bool isDue(const Entry &entry) const;
+
+    static bool hasVisibleItem(const Entry &entry);
+
+    static int targetSideOf(const Entry &entry);
+
+    static QString keyOf(const QUrl &url);
+
+private:
+    QNetworkAccessManager *_manager;
+    QThreadPool _decodePool;
+    QTimer _timer;
+    QElapsedTimer _clock;
+    QHash<QString, Entry> _entries;
+    QHash<ScreenshotRenderItem *, QString> _itemKeys;
+    QHash<QString, QString> _serialKeys;
+    QHash<QString, QQueue<QString>> _hostQueues;
+    QHash<QString, int> _hostActive;
+    // 解码后的缩略图，成本按字节计算
+    QCache<QString, QImage> _thumbnails;
+    quint64 _requests = 0;
+    quint64 _notModified = 0;
+    quint64 _decoded = 0;
+    quint64 _liveFrames = 0;
+    quint64 _cacheHits = 0;
+};
@@ -4,8 +4,10 @@
 #include <QObject>
 #include <QString>
 #include <QList>
+#include <QStringList>
 #include <QVariant>
 #include <QDateTime>
+#include <QHash>
 
 
 enum DeviceRoles {
@@ -49,38 +51,52 @@ enum DeviceRoles {
 };
 
 // 设备数据结构体
+// 字段按类型排列减少填充；image/aospVersion/state/dns/hostIp 解析时经 StringPool 去重
 struct DeviceData {
-    int groupId;                      // 分组ID
     QString hostId;                   // 主机ID
-    int adb;
     QString data;
     QString dbId;                     // 数据库ID，设备整个生命周期中保持不变
     QString dns;
-    QString dpi;
-    QString fps;
-    QString height;
     QString id;
     QString image;
     QString ip;
-    int memory;
     QString name;
     QString displayName;
     QString shortId;
     QString state;
     QString created;
-    QString width;
     QString aospVersion;
     QString hostIp;
-    bool checked;                     // 是否勾选
-    bool selected;                    // 是否选定
-    bool refresh;                     // 是否需要重连
+    QString macvlanIp;                // Macvlan IP地址
+    size_t recordHash = 0;            // 服务端字段的哈希，0 表示未知或被本地修改过
+    int groupId;                      // 分组ID
+    int adb;
+    int memory;
+    int dpi = 0;
+    int fps = 0;
+    int height = 0;
+    int width = 0;
     int tcpVideoPort;                 // TCP视频流端口
     int tcpAudioPort;                 // TCP音频流端口
     int tcpControlPort;               // TCP控制流端口
-    QString macvlanIp;               // Macvlan IP地址
+    bool checked;                     // 是否勾选
+    bool selected;                    // 是否选定
+    bool refresh;                     // 是否需要重连
 };
 
+// 只覆盖服务端下发、同步时会整体覆盖的字段（不含 id/hostId/hostIp/groupId 和界面状态）
+inline size_t deviceRecordHash(const DeviceData& d) {
+    return qHashMulti(0, d.displayName, d.state, d.image, d.adb, d.data, d.dbId, d.dns,
+                      d.dpi, d.fps, d.height, d.ip, d.memory, d.name, d.shortId, d.width,
+                      d.aospVersion, d.created, d.tcpVideoPort, d.tcpAudioPort, d.tcpControlPort,
+                      d.macvlanIp);
+}
+
 inline bool operator==(const DeviceData& a, const DeviceData& b) {
+    // 两边哈希都有效且不同，肯定不相等，不必逐字段比较
+    if (a.recordHash != 0 && b.recordHash != 0 && a.recordHash != b.recordHash) {
+        return false;
+    }
     return a.groupId == b.groupId &&
            a.hostId == b.hostId &&
            a.adb == b.adb &&
@@ -112,6 +128,15 @@ inline bool operator==(const DeviceData& a, const DeviceData& b) {
 
 Q_DECLARE_METATYPE(DeviceData)
 
+// 一次设备列表同步的结果，可以在工作线程里解析好，再由 TreeModel 在主线程一次应用
+struct DeviceListDelta
+{
+    QString hostIp;
+    QList<DeviceData> changed;        // 新增或有变化的设备
+    QStringList removed;              // 已删除设备的 dbId
+    bool full = false;                // 全量：changed 是完整列表，本地多出来的设备一并删除
+};
+
 struct GroupData
 {
     int groupId;
@@ -13,6 +13,7 @@ TreeItem::~TreeItem()
 
 void TreeItem::appendChild(TreeItem *child)
 {
+    child->m_row = m_children.size();
     m_children.append(child);
 }
 
@@ -20,13 +21,21 @@ bool TreeItem::insertChild(int pos, TreeItem *child)
 {
     if (pos < 0 || pos > m_children.size()) return false;
     m_children.insert(pos, child);
+    for (int i = pos; i < m_children.size(); ++i) {
+        m_children[i]->m_row = i;
+    }
     return true;
 }
 
 TreeItem* TreeItem::takeChild(int row)
 {
     if (row < 0 || row >= m_children.size()) return nullptr;
-    return m_children.takeAt(row);
+    TreeItem *child = m_children.takeAt(row);
+    for (int i = row; i < m_children.size(); ++i) {
+        m_children[i]->m_row = i;
+    }
+    child->m_row = -1;
+    return child;
 }
 
 bool TreeItem::removeChild(int row)
@@ -58,8 +67,12 @@ int TreeItem::columnCount() const
 int TreeItem::row() const
 {
     if (m_parent && !m_parent->m_children.isEmpty()) {
-        int index = m_parent->m_children.indexOf(const_cast<TreeItem*>(this));
-        return index >= 0 ? index : 0;
+        const QList<TreeItem*> &siblings = m_parent->m_children;
+        if (m_row >= 0 && m_row < siblings.size() && siblings.at(m_row) == this) {
+            return m_row;
+        }
+        m_row = siblings.indexOf(const_cast<TreeItem*>(this));
+        return m_row >= 0 ? m_row : 0;
     }
     return 0;
 }
@@ -93,6 +106,25 @@ GroupData& GroupItem::groupData()
     return m_groupData;
 }
 
+int GroupItem::checkedHostCount() const
+{
+    return m_checkedHostCount;
+}
+
+int GroupItem::partialHostCount() const
+{
+    return m_partialHostCount;
+}
+
+void GroupItem::countHostState(int state, int delta)
+{
+    if (state == Qt::Checked) {
+        m_checkedHostCount += delta;
+    } else if (state == Qt::PartiallyChecked) {
+        m_partialHostCount += delta;
+    }
+}
+
 // HostItem implementation
 HostItem::HostItem(const HostData &data, TreeItem *parent) : TreeItem(parent), m_hostData(data) {}
 
@@ -108,6 +140,26 @@ HostData& HostItem::hostData()
     return m_hostData;
 }
 
+int HostItem::checkedCount() const
+{
+    return m_checkedCount;
+}
+
+void HostItem::setCheckedCount(int count)
+{
+    m_checkedCount = count;
+}
+
+int HostItem::checkState() const
+{
+    return m_checkState;
+}
+
+void HostItem::setCheckState(int state)
+{
+    m_checkState = state;
+}
+
 // DeviceItem implementation
 DeviceItem::DeviceItem(const DeviceData &data, TreeItem *parent) : TreeItem(parent), m_deviceData(data) {}
 
@@ -120,3 +172,13 @@ DeviceData& DeviceItem::deviceData()
 {
     return m_deviceData;
 }
+
+int DeviceItem::slot() const
+{
+    return m_slot;
+}
+
+void DeviceItem::setSlot(int slot)
+{
+    m_slot = slot;
+}
@@ -29,6 +29,8 @@ public:
 protected:
     QList<TreeItem*> m_children;
     TreeItem *m_parent;
+    // 在父节点中的行号，增删子节点时由父节点维护，避免 row() 每次线性查找
+    mutable int m_row = -1;
 };
 
 class GroupItem : public TreeItem
@@ -37,8 +39,14 @@ public:
     explicit GroupItem(const GroupData &data, TreeItem *parent = nullptr);
     int type() const override;
     GroupData& groupData();
+    // 子主机勾选三态的计数，由 TreeModel 在主机状态变化时增量维护
+    int checkedHostCount() const;
+    int partialHostCount() const;
+    void countHostState(int state, int delta);
 private:
     GroupData m_groupData;
+    int m_checkedHostCount = 0;
+    int m_partialHostCount = 0;
 };
 
 class HostItem : public TreeItem
@@ -47,8 +55,16 @@ public:
     explicit HostItem(const HostData &data, TreeItem *parent = nullptr);
     int type() const override;
     HostData& hostData();
+    // 已勾选的子设备数
+    int checkedCount() const;
+    void setCheckedCount(int count);
+    // 计入父分组计数的三态（Qt::CheckState），-1 表示尚未计入
+    int checkState() const;
+    void setCheckState(int state);
 private:
     HostData m_hostData;
+    int m_checkedCount = 0;
+    int m_checkState = -1;
 };
 
 class DeviceItem : public TreeItem
@@ -57,9 +73,13 @@ public:
     explicit DeviceItem(const DeviceData &data, TreeItem *parent = nullptr);
     int type() const override;
     DeviceData& deviceData();
+    // 勾选/选中位图中的稠密序号，-1 表示未分配
+    int slot() const;
+    void setSlot(int slot);
 
 private:
     DeviceData m_deviceData;
+    int m_slot = -1;
 };
 
 // 新增：用于根节点的具体类
@@ -1,4 +1,5 @@
 #include "treemodel.h"
+#include "helper/StringPool.h"
 #include <QJsonDocument>
 #include <QJsonArray>
 #include <QJsonObject>
@@ -6,6 +7,11 @@
 #include <QFile>
 #include <QStandardPaths>
 #include <QDateTime>
+#include <algorithm>
+#include <functional>
+
+// 事务中记录“全部角色都可能变化”的标记，提交时发出不带角色的 dataChanged
+#define ALL_ROLES -1
 
 TreeModel::TreeModel(QObject *parent)
     : QAbstractItemModel(parent)
@@ -57,6 +63,11 @@ void TreeModel::initDefaultGroup()
 void TreeModel::saveConfig()
 {
     if (m_configPath.isEmpty()) return;
+    // 事务内只记一笔，提交时写一次
+    if (m_transactionDepth > 0) {
+        m_saveDeferred = true;
+        return;
+    }
     QFile file(m_configPath);
     if (file.open(QIODevice::WriteOnly)) {
         file.write(toJson());
@@ -136,9 +147,18 @@ void TreeModel::rebuildTree()
     }
     
     // 清理所有缓存
-    m_deviceIndexCache.clear();
-    m_checkedDeviceIds.clear();
-    m_selectedDeviceIds.clear();
+    m_groupItems.clear();
+    m_hostItems.clear();
+    m_hostIdsByIp.clear();
+    m_deviceItems.clear();
+    m_deviceItemsByShortId.clear();
+    m_deviceItemsByName.clear();
+    m_pendingChanges.clear();
+    m_checkedBits.clear();
+    m_selectedBits.clear();
+    m_freeDeviceSlots.clear();
+    m_deviceSlotCount = 0;
+    m_checkedDeviceCount = 0;
     // 注意：不要清理 m_checkedGroupIds 和 m_checkedHostIds，它们表示用户对空分组/空主机的勾选意图
     
     // 创建新的根节点
@@ -147,14 +167,18 @@ void TreeModel::rebuildTree()
     for(const auto& groupData : m_groups){
         auto groupItem = new GroupItem(groupData, m_rootItem);
         m_rootItem->appendChild(groupItem);
+        m_groupItems.insert(groupData.groupId, groupItem);
         if(m_hostsByGroup.contains(groupData.groupId)){
             for(auto& hostData : m_hostsByGroup[groupData.groupId]){
                 hostData.hostPadCount = m_devicesByHost.value(hostData.hostId).size();
                 auto hostItem = new HostItem(hostData, groupItem);
                 groupItem->appendChild(hostItem);
+                indexHost(hostItem);
                 if(m_devicesByHost.contains(hostData.hostId)){
                     for(const auto& deviceData : m_devicesByHost.value(hostData.hostId)){
-                        hostItem->appendChild(new DeviceItem(deviceData, hostItem));
+                        auto deviceItem = new DeviceItem(deviceData, hostItem);
+                        hostItem->appendChild(deviceItem);
+                        indexDevice(deviceItem);
                     }
                 }
             }
@@ -180,7 +204,9 @@ bool TreeModel::addGroup(const QString &name)
     int newRow = m_groups.size();
     beginInsertRows(QModelIndex(), newRow, newRow);
     m_groups.append(newGroup);
-    m_rootItem->appendChild(new GroupItem(newGroup, m_rootItem));
+    auto groupItem = new GroupItem(newGroup, m_rootItem);
+    m_rootItem->appendChild(groupItem);
+    m_groupItems.insert(newGroup.groupId, groupItem);
     endInsertRows();
 
     saveConfig();
@@ -232,14 +258,26 @@ bool TreeModel::removeGroup(int groupId)
 
             QList<TreeItem*> itemsToMove;
             while(sourceGroupItem->childCount() > 0){
+                detachHostCheckState(static_cast<HostItem*>(sourceGroupItem->child(0)));
                 itemsToMove.append(sourceGroupItem->takeChild(0));
             }
 
             for (auto* item : itemsToMove) {
                 item->setParentItem(destGroupItem);
                 destGroupItem->appendChild(item);
+                // 节点里的分组ID也要同步，backingHost 依赖它定位后备数据
+                HostItem* hostItem = static_cast<HostItem*>(item);
+                hostItem->hostData().groupId = 1;
+                for (auto& device : m_devicesByHost[hostItem->hostData().hostId]) {
+                    device.groupId = 1;
+                }
+                for (int i = 0; i < hostItem->childCount(); ++i) {
+                    static_cast<DeviceItem*>(hostItem->child(i))->deviceData().groupId = 1;
+                }
+                updateHostCheckState(hostItem);
             }
             endMoveRows();
+            notifyChanged(destParent, {CheckedRole});
         }
     }
 
@@ -255,7 +293,10 @@ bool TreeModel::removeGroup(int groupId)
     if(finalSourceRow != -1){
         beginRemoveRows(QModelIndex(), finalSourceRow, finalSourceRow);
         m_groups.removeAt(finalSourceRow);
-        delete m_rootItem->takeChild(finalSourceRow);
+        m_groupItems.remove(groupId);
+        TreeItem* groupItem = m_rootItem->takeChild(finalSourceRow);
+        m_pendingChanges.remove(groupItem);
+        delete groupItem;
         endRemoveRows();
     }
 
@@ -293,7 +334,7 @@ bool TreeModel::renameGroup(int groupId, const QString& newName)
     if (modelIndex.isValid()) {
         GroupItem* groupItem = static_cast<GroupItem*>(modelIndex.internalPointer());
         groupItem->groupData().groupName = newName;
-        emit dataChanged(modelIndex, modelIndex, {GroupNameRole});
+        notifyChanged(modelIndex, {GroupNameRole});
     } else {
         // Fallback for safety, though it shouldn't be reached.
         rebuildTree();
@@ -330,55 +371,49 @@ bool TreeModel::addHost(const QVariantMap &hostDataMap)
     QString hostId = hostDataMap["id"].toString();
 
     // 如果该主机已存在，则更新主机信息而不是直接返回失败
-    for (auto it = m_hostsByGroup.begin(); it != m_hostsByGroup.end(); ++it) {
-        QList<HostData>& hostListRef = it.value();
-        for (int i = 0; i < hostListRef.size(); ++i) {
-            if (hostListRef[i].hostId == hostId) {
-                HostData& existingHost = hostListRef[i];
-
-                QVector<int> changedRoles;
-
-                // ip 更新
-                const QString newIp = hostDataMap.value("ip").toString();
-                if (!newIp.isEmpty() && existingHost.ip != newIp) {
-                    existingHost.ip = newIp;
-                    changedRoles.append(IpRole);
-                }
+    if (HostItem* existingItem = m_hostItems.value(hostId)) {
+        HostData* existingHostPtr = backingHost(existingItem);
+        if (existingHostPtr) {
+            HostData& existingHost = *existingHostPtr;
 
-                // hostName 更新（默认与 ip 一致）
-                const QString newHostName = hostDataMap.value("hostName").toString().isEmpty() ? newIp : hostDataMap.value("hostName").toString();
-                if (!newHostName.isEmpty() && existingHost.hostName != newHostName) {
-                    existingHost.hostName = newHostName;
-                    changedRoles.append(HostNameRole);
-                }
+            QVector<int> changedRoles;
 
-                // 在线状态 & 更新时间
-                const QString newUpdateTime = QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss");
-                if (existingHost.updateTime != newUpdateTime) {
-                    existingHost.updateTime = newUpdateTime;
-                    changedRoles.append(UpdateTimeRole);
-                }
-                if (existingHost.state != "online") {
-                    existingHost.state = "online";
-                    changedRoles.append(StateRole);
-                }
+            // ip 更新
+            const QString newIp = hostDataMap.value("ip").toString();
+            if (!newIp.isEmpty() && existingHost.ip != newIp) {
+                existingHost.ip = newIp;
+                changedRoles.append(IpRole);
+            }
 
-                // 回写到树节点并通知 UI
-                QModelIndex hostIndex = findIndex(hostId, TypeHost);
-                if (hostIndex.isValid()) {
-                    HostItem* hostItem = static_cast<HostItem*>(hostIndex.internalPointer());
-                    hostItem->hostData() = existingHost;
-                    if (!changedRoles.isEmpty()) {
-                        emit dataChanged(hostIndex, hostIndex, changedRoles);
-                    }
-                } else {
-                    // 找不到节点时退化到重建树
-                    rebuildTree();
-                }
+            // hostName 更新（默认与 ip 一致）
+            const QString newHostName = hostDataMap.value("hostName").toString().isEmpty() ? newIp : hostDataMap.value("hostName").toString();
+            if (!newHostName.isEmpty() && existingHost.hostName != newHostName) {
+                existingHost.hostName = newHostName;
+                changedRoles.append(HostNameRole);
+            }
 
-                saveConfig();
-                return true;
+            // 在线状态 & 更新时间
+            const QString newUpdateTime = QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss");
+            if (existingHost.updateTime != newUpdateTime) {
+                existingHost.updateTime = newUpdateTime;
+                changedRoles.append(UpdateTimeRole);
+            }
+            if (existingHost.state != "online") {
+                existingHost.state = "online";
+                changedRoles.append(StateRole);
             }
+
+            // 回写到树节点并通知 UI，IP 可能变了，重新登记索引
+            unindexHost(existingItem);
+            existingItem->hostData() = existingHost;
+            indexHost(existingItem);
+            if (!changedRoles.isEmpty()) {
+                QModelIndex hostIndex = indexOfItem(existingItem);
+                notifyChanged(hostIndex, changedRoles);
+            }
+
+            saveConfig();
+            return true;
         }
     }
 
@@ -404,20 +439,22 @@ bool TreeModel::addHost(const QVariantMap &hostDataMap)
     hostData.selected = false;
 
     m_hostsByGroup[defaultGroupId].append(hostData);
-    parentItem->appendChild(new HostItem(hostData, parentItem));
+    HostItem* hostItem = new HostItem(hostData, parentItem);
+    parentItem->appendChild(hostItem);
+    indexHost(hostItem);
 
     endInsertRows();
 
     // 如果该分组先前被勾选但还没有主机，继承分组勾选到新主机（主机无设备）
     if (m_checkedGroupIds.contains(defaultGroupId)) {
-        m_checkedHostIds.insert(hostData.hostId);
+        setHostCheckIntent(hostItem, true);
         QModelIndex hostIndex = index(newRow, 0, parentIndex);
-        emit dataChanged(hostIndex, hostIndex, {CheckedRole});
-        emit dataChanged(parentIndex, parentIndex, {CheckedRole});
+        notifyChanged(hostIndex, {CheckedRole});
+        notifyChanged(parentIndex, {CheckedRole});
     }
 
     // 更新分组的设备数量显示
-    emit dataChanged(parentIndex, parentIndex, {GroupPadCountRole});
+    notifyChanged(parentIndex, {GroupPadCountRole});
 
     saveConfig();
     return true;
@@ -425,25 +462,13 @@ bool TreeModel::addHost(const QVariantMap &hostDataMap)
 
 void TreeModel::addDevice(const QString& hostIp, const QVariantMap &deviceDataMap)
 {
-    int groupId = -1;
-    QString hostId = "";
-    bool hostExists = false;
-    for(auto it = m_hostsByGroup.constBegin(); it != m_hostsByGroup.constEnd(); ++it){
-        for(const auto& host : it.value()){
-            if(host.ip == hostIp){
-                hostExists = true;
-                groupId = host.groupId;
-                hostId = host.hostId;
-                break;
-            }
-        }
-        if(hostExists) break;
-    }
-
-    if (!hostExists) {
-        qWarning() << "Attempted to add device to non-existent host" << hostId;
+    HostItem* hostItem = hostItemByIp(hostIp);
+    if (!hostItem) {
+        qWarning() << "Attempted to add device to non-existent host" << hostIp;
         return;
     }
+    int groupId = hostItem->hostData().groupId;
+    QString hostId = hostItem->hostData().hostId;
 
     DeviceData deviceData;
     deviceData.groupId = groupId;
@@ -451,22 +476,22 @@ void TreeModel::addDevice(const QString& hostIp, const QVariantMap &deviceDataMa
     deviceData.adb = deviceDataMap["adb"].toInt();
     deviceData.data = deviceDataMap["data"].toString();
     deviceData.dbId = deviceDataMap["dbId"].toString();
-    deviceData.dns = deviceDataMap["dns"].toString();
-    deviceData.dpi = deviceDataMap["dpi"].toString();
-    deviceData.fps = deviceDataMap["fps"].toString();
-    deviceData.height = deviceDataMap["height"].toString();
+    deviceData.dns = StringPool::intern(deviceDataMap["dns"].toString());
+    deviceData.dpi = deviceDataMap["dpi"].toInt();
+    deviceData.fps = deviceDataMap["fps"].toInt();
+    deviceData.height = deviceDataMap["height"].toInt();
     deviceData.id = deviceDataMap["id"].toString();
-    deviceData.image = deviceDataMap["image"].toString();
+    deviceData.image = StringPool::intern(deviceDataMap["image"].toString());
     deviceData.ip = deviceDataMap["ip"].toString();
     deviceData.memory = deviceDataMap["memory"].toInt();
     deviceData.name = deviceDataMap["name"].toString();
     deviceData.displayName = deviceDataMap["user_name"].toString();
     deviceData.shortId = deviceDataMap["short_id"].toString();
-    deviceData.state = deviceDataMap["state"].toString();
+    deviceData.state = StringPool::intern(deviceDataMap["state"].toString());
     deviceData.created = deviceDataMap["created"].toString();
-    deviceData.width = deviceDataMap["width"].toString();
-    deviceData.aospVersion = deviceDataMap["aosp_version"].toString();
-    deviceData.hostIp = hostIp;
+    deviceData.width = deviceDataMap["width"].toInt();
+    deviceData.aospVersion = StringPool::intern(deviceDataMap["aosp_version"].toString());
+    deviceData.hostIp = StringPool::intern(hostIp);
     deviceData.checked = false;
     deviceData.selected = false;
     deviceData.refresh = false;
@@ -475,105 +500,92 @@ void TreeModel::addDevice(const QString& hostIp, const QVariantMap &deviceDataMa
     qDebug() << "add device" << deviceData.groupId << deviceData.hostId << deviceData.name;
 
     // Prevent adding duplicate devices under the same host, update if exists.
-    if (m_devicesByHost.contains(hostId)) {
-        auto& devices = m_devicesByHost[hostId];
-        for (auto& existingDevice : devices) {
-            if (existingDevice.name == deviceData.name) {
-                qDebug() << "Device with id" << deviceData.id << "already exists under host" << hostId << ". Updating fields.";
-                // Preserve UI-related states
-                bool checked = existingDevice.checked;
-                bool selected = existingDevice.selected;
-
-                if (deviceDataMap.contains("adb")) existingDevice.adb = deviceDataMap["adb"].toInt();
-                if (deviceDataMap.contains("data")) existingDevice.data = deviceDataMap["data"].toString();
-                if (deviceDataMap.contains("dns")) existingDevice.dns = deviceDataMap["dns"].toString();
-                if (deviceDataMap.contains("dpi")) existingDevice.dpi = deviceDataMap["dpi"].toString();
-                if (deviceDataMap.contains("fps")) existingDevice.fps = deviceDataMap["fps"].toString();
-                if (deviceDataMap.contains("height")) existingDevice.height = deviceDataMap["height"].toString();
-                if (deviceDataMap.contains("id")) existingDevice.id = deviceDataMap["id"].toString();
-                if (deviceDataMap.contains("image")) existingDevice.image = deviceDataMap["image"].toString();
-                if (deviceDataMap.contains("ip")) existingDevice.ip = deviceDataMap["ip"].toString();
-                if (deviceDataMap.contains("memory")) existingDevice.memory = deviceDataMap["memory"].toInt();
-                if (deviceDataMap.contains("name")) existingDevice.name = deviceDataMap["name"].toString();
-                if (deviceDataMap.contains("user_name")) existingDevice.displayName = deviceDataMap["user_name"].toString();
-                if (deviceDataMap.contains("displayName")) existingDevice.displayName = deviceDataMap["displayName"].toString();
-                if (deviceDataMap.contains("short_id")) existingDevice.shortId = deviceDataMap["short_id"].toString();
-                if (deviceDataMap.contains("shortId")) existingDevice.shortId = deviceDataMap["shortId"].toString();
-                if (deviceDataMap.contains("state")) existingDevice.state = deviceDataMap["state"].toString();
-                if (deviceDataMap.contains("created")) existingDevice.created = deviceDataMap["created"].toString();
-                if (deviceDataMap.contains("width")) existingDevice.width = deviceDataMap["width"].toString();
-                if (deviceDataMap.contains("aosp_version")) existingDevice.aospVersion = deviceDataMap["aosp_version"].toString();
-                if (deviceDataMap.contains("aospVersion")) existingDevice.aospVersion = deviceDataMap["aospVersion"].toString();
-                if (deviceDataMap.contains("host_ip")) existingDevice.hostIp = deviceDataMap["host_ip"].toString();
-                if (deviceDataMap.contains("hostIp")) existingDevice.hostIp = deviceDataMap["hostIp"].toString();
-                if (deviceDataMap.contains("macvlan_ip")) existingDevice.macvlanIp = deviceDataMap["macvlan_ip"].toString();
-                if (deviceDataMap.contains("macvlanIp")) existingDevice.macvlanIp = deviceDataMap["macvlanIp"].toString();
-
-                existingDevice.checked = checked;
-                existingDevice.selected = selected;
-
-                QModelIndex deviceIndex = findIndex(existingDevice.name, TypeDevice);
-                if (deviceIndex.isValid()) {
-                    static_cast<DeviceItem*>(deviceIndex.internalPointer())->deviceData() = existingDevice;
-                    emit dataChanged(deviceIndex, deviceIndex);
-                } else {
-                    rebuildTree(); // Fallback
-                }
-                saveConfig();
-                return;
-            }
+    DeviceItem* existingItem = nullptr;
+    for (auto it = m_deviceItemsByName.constFind(deviceData.name); it != m_deviceItemsByName.constEnd() && it.key() == deviceData.name; ++it) {
+        if (it.value()->parentItem() == hostItem) {
+            existingItem = it.value();
+            break;
         }
     }
-
-    QModelIndex hostIndex = findIndex(hostId, TypeHost);
-    if (!hostIndex.isValid()) {
-        qWarning() << "Host item not found in tree for hostId:" << hostId << ". Falling back to rebuild.";
-        rebuildTree();
-        saveConfig();
-        return;
-    }
-
-    HostItem* hostItem = static_cast<HostItem*>(hostIndex.internalPointer());
+    if (existingItem) {
+        DeviceData* existingDevicePtr = backingDevice(existingItem);
+        if (existingDevicePtr) {
+            DeviceData& existingDevice = *existingDevicePtr;
+            qDebug() << "Device with id" << deviceData.id << "already exists under host" << hostId << ". Updating fields.";
+            // Preserve UI-related states
+            bool checked = existingDevice.checked;
+            bool selected = existingDevice.selected;
+
+            if (deviceDataMap.contains("adb")) existingDevice.adb = deviceDataMap["adb"].toInt();
+            if (deviceDataMap.contains("data")) existingDevice.data = deviceDataMap["data"].toString();
+            if (deviceDataMap.contains("dns")) existingDevice.dns = deviceDataMap["dns"].toString();
+            if (deviceDataMap.contains("dpi")) existingDevice.dpi = deviceDataMap["dpi"].toInt();
+            if (deviceDataMap.contains("fps")) existingDevice.fps = deviceDataMap["fps"].toInt();
+            if (deviceDataMap.contains("height")) existingDevice.height = deviceDataMap["height"].toInt();
+            if (deviceDataMap.contains("id")) existingDevice.id = deviceDataMap["id"].toString();
+            if (deviceDataMap.contains("image")) existingDevice.image = deviceDataMap["image"].toString();
+            if (deviceDataMap.contains("ip")) existingDevice.ip = deviceDataMap["ip"].toString();
+            if (deviceDataMap.contains("memory")) existingDevice.memory = deviceDataMap["memory"].toInt();
+            if (deviceDataMap.contains("name")) existingDevice.name = deviceDataMap["name"].toString();
+            if (deviceDataMap.contains("user_name")) existingDevice.displayName = deviceDataMap["user_name"].toString();
+            if (deviceDataMap.contains("displayName")) existingDevice.displayName = deviceDataMap["displayName"].toString();
+            if (deviceDataMap.contains("short_id")) existingDevice.shortId = deviceDataMap["short_id"].toString();
+            if (deviceDataMap.contains("shortId")) existingDevice.shortId = deviceDataMap["shortId"].toString();
+            if (deviceDataMap.contains("state")) existingDevice.state = deviceDataMap["state"].toString();
+            if (deviceDataMap.contains("created")) existingDevice.created = deviceDataMap["created"].toString();
+            if (deviceDataMap.contains("width")) existingDevice.width = deviceDataMap["width"].toInt();
+            if (deviceDataMap.contains("aosp_version")) existingDevice.aospVersion = deviceDataMap["aosp_version"].toString();
+            if (deviceDataMap.contains("aospVersion")) existingDevice.aospVersion = deviceDataMap["aospVersion"].toString();
+            if (deviceDataMap.contains("host_ip")) existingDevice.hostIp = deviceDataMap["host_ip"].toString();
+            if (deviceDataMap.contains("hostIp")) existingDevice.hostIp = deviceDataMap["hostIp"].toString();
+            if (deviceDataMap.contains("macvlan_ip")) existingDevice.macvlanIp = deviceDataMap["macvlan_ip"].toString();
+            if (deviceDataMap.contains("macvlanIp")) existingDevice.macvlanIp = deviceDataMap["macvlanIp"].toString();
+
+            existingDevice.checked = checked;
+            existingDevice.selected = selected;
+            existingDevice.recordHash = 0;
+
+            QModelIndex deviceIndex = indexOfItem(existingItem);
+            setDeviceData(existingItem, existingDevice);
+            notifyChanged(deviceIndex, {});
+            saveConfig();
+            return;
+        }
+    }
+
+    QModelIndex hostIndex = indexOfItem(hostItem);
     int newRow = hostItem->childCount();
 
     beginInsertRows(hostIndex, newRow, newRow);
     m_devicesByHost[hostId].append(deviceData);
-    hostItem->appendChild(new DeviceItem(deviceData, hostItem));
+    DeviceItem* deviceItem = new DeviceItem(deviceData, hostItem);
+    hostItem->appendChild(deviceItem);
+    indexDevice(deviceItem);
     endInsertRows();
-    
-    // 更新设备索引缓存
-    QModelIndex newDeviceIndex = index(newRow, 0, hostIndex);
-    m_deviceIndexCache[deviceData.dbId] = QPersistentModelIndex(newDeviceIndex);
 
     // 一旦该主机新增了设备，如果之前主机是“空主机勾选”，清理空主机勾选状态，转为设备级别
     if (m_checkedHostIds.contains(hostId)) {
         // 将主机的勾选意图下放到刚添加的设备
-        const QList<DeviceData>& devices = m_devicesByHost.value(hostId);
-        for (const auto& d : devices) {
-            m_checkedDeviceIds.insert(d.dbId);
+        for (int i = 0; i < hostItem->childCount(); ++i) {
+            setDeviceChecked(static_cast<DeviceItem*>(hostItem->child(i)), true);
         }
-        m_checkedHostIds.remove(hostId);
-        emit dataChanged(hostIndex, hostIndex, {CheckedRole});
+        setHostCheckIntent(hostItem, false);
+        notifyChanged(hostIndex, {CheckedRole});
         QModelIndex groupIndex2 = parent(hostIndex);
-        if (groupIndex2.isValid()) emit dataChanged(groupIndex2, groupIndex2, {CheckedRole});
+        if (groupIndex2.isValid()) notifyChanged(groupIndex2, {CheckedRole});
     }
 
     // Update host's device count
-    for (auto& hostList : m_hostsByGroup) {
-        for (auto& host : hostList) {
-            if (host.hostId == hostId) {
-                host.hostPadCount = m_devicesByHost.value(hostId).size();
-                break;
-            }
-        }
+    if (HostData* host = backingHost(hostItem)) {
+        host->hostPadCount = m_devicesByHost.value(hostId).size();
     }
     hostItem->hostData().hostPadCount = m_devicesByHost.value(hostId).size();
-    emit dataChanged(hostIndex, hostIndex, {HostPadCountRole});
+    notifyChanged(hostIndex, {HostPadCountRole});
 
     // 更新分组的设备数量显示
     QModelIndex groupIndex = parent(hostIndex);
     if (groupIndex.isValid()) {
-        emit dataChanged(groupIndex, groupIndex, {GroupPadCountRole});
+        notifyChanged(groupIndex, {GroupPadCountRole});
     }
 
     saveConfig();
@@ -616,10 +628,12 @@ void TreeModel::moveHost(const QString& hostId, int newGroupId)
     beginMoveRows(sourceParentIndex, sourceRow, sourceRow, destParentIndex, destRow);
 
     // --- Move the item in the tree structure ---
+    detachHostCheckState(hostItem);
     sourceGroupItem->takeChild(sourceRow);
     hostItem->setParentItem(destGroupItem);
     destGroupItem->appendChild(hostItem);
     hostItem->hostData().groupId = newGroupId;
+    updateHostCheckState(hostItem);
 
     // --- Update the backing data store to match ---
     int hostIndexInOldList = -1;
@@ -647,8 +661,8 @@ void TreeModel::moveHost(const QString& hostId, int newGroupId)
 
     endMoveRows();
 
-    emit dataChanged(sourceParentIndex, sourceParentIndex, {GroupPadCountRole});
-    emit dataChanged(destParentIndex, destParentIndex, {GroupPadCountRole});
+    notifyChanged(sourceParentIndex, {GroupPadCountRole, CheckedRole});
+    notifyChanged(destParentIndex, {GroupPadCountRole, CheckedRole});
 
     saveConfig();
 }
@@ -673,17 +687,13 @@ bool TreeModel::removeHost(const QString& hostId)
 
     // 先移除该主机下的所有设备（树 + 后备存储 + 缓存）
     if (m_devicesByHost.contains(hostId)) {
-        QList<DeviceData> devices = m_devicesByHost.value(hostId);
         const int deviceCount = hostItem->childCount();
         if (deviceCount > 0) {
             beginRemoveRows(hostIndex, 0, deviceCount - 1);
-            for (const auto& d : devices) {
-                m_selectedDeviceIds.remove(d.dbId);
-                m_checkedDeviceIds.remove(d.dbId);
-                m_deviceIndexCache.remove(d.dbId);
-            }
             while (hostItem->childCount() > 0) {
-                delete hostItem->takeChild(0);
+                DeviceItem* deviceItem = static_cast<DeviceItem*>(hostItem->takeChild(hostItem->childCount() - 1));
+                releaseDevice(deviceItem);
+                delete deviceItem;
             }
             endRemoveRows();
         }
@@ -703,15 +713,18 @@ bool TreeModel::removeHost(const QString& hostId)
             if (list[i].hostId == hostId) { list.removeAt(i); break; }
         }
     }
+    detachHostCheckState(hostItem);
+    unindexHost(hostItem);
+    m_pendingChanges.remove(hostItem);
     delete groupItem->takeChild(hostRow);
     endRemoveRows();
 
     // 清理主机勾选集
     m_checkedHostIds.remove(hostId);
 
-    // 通知分组（主机数量变化）
+    // 通知分组（主机数量和三态变化）
     if (groupIndex.isValid()) {
-        emit dataChanged(groupIndex, groupIndex, {GroupPadCountRole});
+        notifyChanged(groupIndex, {GroupPadCountRole, CheckedRole});
     }
 
     saveConfig();
@@ -720,115 +733,57 @@ bool TreeModel::removeHost(const QString& hostId)
 
 bool TreeModel::removeDevice(const QString& deviceName)
 {
-    QString hostId;
-    int deviceRowInList = -1;
-    bool found = false;
-
-    // Find device in backing store
-    for (auto it = m_devicesByHost.begin(); it != m_devicesByHost.end(); ++it) {
-        QList<DeviceData>& deviceList = it.value();
-        for (int i = 0; i < deviceList.size(); ++i) {
-            if (deviceList.at(i).name == deviceName) {
-                hostId = it.key();
-                deviceRowInList = i;
-                found = true;
-                break;
-            }
-        }
-        if (found) break;
-    }
-
-    if (!found) {
+    DeviceItem* deviceItem = m_deviceItemsByName.value(deviceName);
+    if (!deviceItem) {
         qWarning() << "Device to remove not found:" << deviceName;
         return false;
     }
 
-    // Find parent HostItem's index
-    QModelIndex hostIndex = findIndex(hostId, TypeHost);
-    if (!hostIndex.isValid()) {
-        qWarning() << "Parent host not found in tree for device:" << deviceName;
-        rebuildTree(); // Fallback
-        saveConfig();
-        return false;
-    }
-
-    HostItem* hostItem = static_cast<HostItem*>(hostIndex.internalPointer());
-    int deviceRowInTree = -1;
-    for (int i = 0; i < hostItem->childCount(); ++i) {
-        DeviceItem* deviceItem = static_cast<DeviceItem*>(hostItem->child(i));
-        if (deviceItem->deviceData().name == deviceName) {
-            deviceRowInTree = i;
-            break;
-        }
-    }
-
-    if (deviceRowInTree == -1) {
-        qWarning() << "Device item not found in tree for device:" << deviceName;
-        rebuildTree(); // Fallback
-        saveConfig();
-        return false;
-    }
+    HostItem* hostItem = static_cast<HostItem*>(deviceItem->parentItem());
+    const QString hostId = hostItem->hostData().hostId;
+    QModelIndex hostIndex = indexOfItem(hostItem);
+    const int deviceRow = deviceItem->row();
 
     // Remove the item using begin/end
-    beginRemoveRows(hostIndex, deviceRowInTree, deviceRowInTree);
-    QString deviceDbId = m_devicesByHost[hostId][deviceRowInList].dbId;
-    m_devicesByHost[hostId].removeAt(deviceRowInList);
-    delete hostItem->takeChild(deviceRowInTree);
+    beginRemoveRows(hostIndex, deviceRow, deviceRow);
+    int backingRow = backingDeviceRow(deviceItem);
+    if (backingRow >= 0) {
+        m_devicesByHost[hostId].removeAt(backingRow);
+    }
+    hostItem->takeChild(deviceRow);
+    releaseDevice(deviceItem);
+    delete deviceItem;
     endRemoveRows();
-    
-    // 清理设备索引缓存
-    m_deviceIndexCache.remove(deviceDbId);
 
     // Update host's device count
     int newDeviceCount = m_devicesByHost.value(hostId).size();
     hostItem->hostData().hostPadCount = newDeviceCount;
-    for (auto& hostList : m_hostsByGroup) {
-        bool foundHost = false;
-        for (auto& host : hostList) {
-            if (host.hostId == hostId) {
-                host.hostPadCount = newDeviceCount;
-                foundHost = true;
-                break;
-            }
-        }
-        if(foundHost) break;
+    if (HostData* host = backingHost(hostItem)) {
+        host->hostPadCount = newDeviceCount;
     }
-    emit dataChanged(hostIndex, hostIndex, {HostPadCountRole});
+    notifyChanged(hostIndex, {HostPadCountRole});
 
     // 更新分组的设备数量显示
     QModelIndex groupIndex = parent(hostIndex);
     if (groupIndex.isValid()) {
-        emit dataChanged(groupIndex, groupIndex, {GroupPadCountRole});
+        notifyChanged(groupIndex, {GroupPadCountRole});
     }
 
-    // 清理选中和勾选状态（使用 dbId 更稳妥）
-    m_selectedDeviceIds.remove(deviceDbId);
-    m_checkedDeviceIds.remove(deviceDbId);
+    // 主机三态可能随设备删除变化
+    notifyChanged(hostIndex, {CheckedRole});
+    if (groupIndex.isValid()) {
+        notifyChanged(groupIndex, {CheckedRole});
+    }
 
     saveConfig();
-
     return true;
 }
 
 void TreeModel::modifyDevice(const QString& name, const QVariantMap& newData)
 {
-    DeviceData* devicePtr = nullptr;
-    QString deviceId;
-    bool deviceFound = false;
-
-    for (auto& deviceList : m_devicesByHost) {
-        for (auto& device : deviceList) {
-            if (device.name == name) {
-                devicePtr = &device;
-                deviceId = device.id;
-                deviceFound = true;
-                break;
-            }
-        }
-        if (deviceFound) break;
-    }
-
-    if (!deviceFound) {
+    DeviceItem* deviceItem = m_deviceItemsByName.value(name);
+    DeviceData* devicePtr = backingDevice(deviceItem);
+    if (!devicePtr) {
         qWarning() << "modifyDevice: Device with name" << name << "not found.";
         return;
     }
@@ -843,19 +798,19 @@ void TreeModel::modifyDevice(const QString& name, const QVariantMap& newData)
         if (key == "displayName" && devicePtr->displayName != value.toString()) { devicePtr->displayName = value.toString(); changedRoles.append(DisplayNameRole); }
         else if (key == "name" && devicePtr->name != value.toString()) { devicePtr->name = value.toString(); changedRoles.append(NameRole); }
         else if (key == "image" && devicePtr->image != value.toString()) { devicePtr->image = value.toString(); changedRoles.append(ImageRole); }
-        else if (key == "dpi" && devicePtr->dpi != value.toString()) { devicePtr->dpi = value.toString(); changedRoles.append(DpiRole); }
-        else if (key == "fps" && devicePtr->fps != value.toString()) { devicePtr->fps = value.toString(); changedRoles.append(FpsRole); }
+        else if (key == "dpi" && devicePtr->dpi != value.toInt()) { devicePtr->dpi = value.toInt(); changedRoles.append(DpiRole); }
+        else if (key == "fps" && devicePtr->fps != value.toInt()) { devicePtr->fps = value.toInt(); changedRoles.append(FpsRole); }
         else if (key == "state" && devicePtr->state != value.toString()) { devicePtr->state = value.toString(); changedRoles.append(StateRole); }
         else if (key == "refresh" && devicePtr->refresh != value.toBool()) { devicePtr->refresh = value.toBool(); changedRoles.append(RefreshRole); }
         else if (key == "adb" && devicePtr->adb != value.toInt()) { devicePtr->adb = value.toInt(); changedRoles.append(AdbRole); }
         else if (key == "data" && devicePtr->data != value.toString()) { devicePtr->data = value.toString(); changedRoles.append(DataRole); }
         else if (key == "dbId" && devicePtr->dbId != value.toString()) { devicePtr->dbId = value.toString(); changedRoles.append(DbIdRole); }
         else if (key == "dns" && devicePtr->dns != value.toString()) { devicePtr->dns = value.toString(); changedRoles.append(DnsRole); }
-        else if (key == "height" && devicePtr->height != value.toString()) { devicePtr->height = value.toString(); changedRoles.append(HeightRole); }
+        else if (key == "height" && devicePtr->height != value.toInt()) { devicePtr->height = value.toInt(); changedRoles.append(HeightRole); }
         else if (key == "ip" && devicePtr->ip != value.toString()) { devicePtr->ip = value.toString(); changedRoles.append(IpRole); }
         else if (key == "memory" && devicePtr->memory != value.toInt()) { devicePtr->memory = value.toInt(); changedRoles.append(MemoryRole); }
         else if (key == "shortId" && devicePtr->shortId != value.toString()) { devicePtr->shortId = value.toString(); changedRoles.append(ShortIdRole); }
-        else if (key == "width" && devicePtr->width != value.toString()) { devicePtr->width = value.toString(); changedRoles.append(WidthRole); }
+        else if (key == "width" && devicePtr->width != value.toInt()) { devicePtr->width = value.toInt(); changedRoles.append(WidthRole); }
         else if (key == "aospVersion" && devicePtr->aospVersion != value.toString()) { devicePtr->aospVersion = value.toString(); changedRoles.append(AospVersionRole); }
         else if (key == "hostIp" && devicePtr->hostIp != value.toString()) { devicePtr->hostIp = value.toString(); changedRoles.append(HostIpRole); }
         else if (key == "macvlanIp" && devicePtr->macvlanIp != value.toString()) { devicePtr->macvlanIp = value.toString(); changedRoles.append(MacvlanIpRole); }
@@ -863,35 +818,19 @@ void TreeModel::modifyDevice(const QString& name, const QVariantMap& newData)
     }
 
     if (!changedRoles.isEmpty()) {
-        QModelIndex deviceIndex = findIndex(name, TypeDevice);
-        if (deviceIndex.isValid()) {
-            DeviceItem* deviceItem = static_cast<DeviceItem*>(deviceIndex.internalPointer());
-            if (deviceItem) {
-                deviceItem->deviceData() = *devicePtr;
-                emit dataChanged(deviceIndex, deviceIndex, changedRoles);
-            }
-        }
+        devicePtr->recordHash = 0;
+        QModelIndex deviceIndex = indexOfItem(deviceItem);
+        setDeviceData(deviceItem, *devicePtr);
+        notifyChanged(deviceIndex, changedRoles);
         saveConfig();
     }
 }
 
 void TreeModel::modifyDeviceEx(const QString &shortId, const QVariantMap &newData)
 {
-    DeviceData* devicePtr = nullptr;
-    bool deviceFound = false;
-
-    for (auto& deviceList : m_devicesByHost) {
-        for (auto& device : deviceList) {
-            if (device.shortId == shortId) {
-                devicePtr = &device;
-                deviceFound = true;
-                break;
-            }
-        }
-        if (deviceFound) break;
-    }
-
-    if (!deviceFound) {
+    DeviceItem* deviceItem = m_deviceItemsByShortId.value(shortId);
+    DeviceData* devicePtr = backingDevice(deviceItem);
+    if (!devicePtr) {
         qWarning() << "modifyDeviceEx: Device with shortId" << shortId << "not found.";
         return;
     }
@@ -906,19 +845,19 @@ void TreeModel::modifyDeviceEx(const QString &shortId, const QVariantMap &newDat
         if (key == "displayName" && devicePtr->displayName != value.toString()) { devicePtr->displayName = value.toString(); changedRoles.append(DisplayNameRole); }
         else if (key == "name" && devicePtr->name != value.toString()) { devicePtr->name = value.toString(); changedRoles.append(NameRole); }
         else if (key == "image" && devicePtr->image != value.toString()) { devicePtr->image = value.toString(); changedRoles.append(ImageRole); }
-        else if (key == "dpi" && devicePtr->dpi != value.toString()) { devicePtr->dpi = value.toString(); changedRoles.append(DpiRole); }
-        else if (key == "fps" && devicePtr->fps != value.toString()) { devicePtr->fps = value.toString(); changedRoles.append(FpsRole); }
+        else if (key == "dpi" && devicePtr->dpi != value.toInt()) { devicePtr->dpi = value.toInt(); changedRoles.append(DpiRole); }
+        else if (key == "fps" && devicePtr->fps != value.toInt()) { devicePtr->fps = value.toInt(); changedRoles.append(FpsRole); }
         else if (key == "state" && devicePtr->state != value.toString()) { devicePtr->state = value.toString(); changedRoles.append(StateRole); }
         else if (key == "refresh" && devicePtr->refresh != value.toBool()) { devicePtr->refresh = value.toBool(); changedRoles.append(RefreshRole); }
         else if (key == "adb" && devicePtr->adb != value.toInt()) { devicePtr->adb = value.toInt(); changedRoles.append(AdbRole); }
         else if (key == "data" && devicePtr->data != value.toString()) { devicePtr->data = value.toString(); changedRoles.append(DataRole); }
         else if (key == "dbId" && devicePtr->dbId != value.toString()) { devicePtr->dbId = value.toString(); changedRoles.append(DbIdRole); }
         else if (key == "dns" && devicePtr->dns != value.toString()) { devicePtr->dns = value.toString(); changedRoles.append(DnsRole); }
-        else if (key == "height" && devicePtr->height != value.toString()) { devicePtr->height = value.toString(); changedRoles.append(HeightRole); }
+        else if (key == "height" && devicePtr->height != value.toInt()) { devicePtr->height = value.toInt(); changedRoles.append(HeightRole); }
         else if (key == "ip" && devicePtr->ip != value.toString()) { devicePtr->ip = value.toString(); changedRoles.append(IpRole); }
         else if (key == "memory" && devicePtr->memory != value.toInt()) { devicePtr->memory = value.toInt(); changedRoles.append(MemoryRole); }
         else if (key == "shortId" && devicePtr->shortId != value.toString()) { devicePtr->shortId = value.toString(); changedRoles.append(ShortIdRole); }
-        else if (key == "width" && devicePtr->width != value.toString()) { devicePtr->width = value.toString(); changedRoles.append(WidthRole); }
+        else if (key == "width" && devicePtr->width != value.toInt()) { devicePtr->width = value.toInt(); changedRoles.append(WidthRole); }
         else if (key == "aospVersion" && devicePtr->aospVersion != value.toString()) { devicePtr->aospVersion = value.toString(); changedRoles.append(AospVersionRole); }
         else if (key == "hostIp" && devicePtr->hostIp != value.toString()) { devicePtr->hostIp = value.toString(); changedRoles.append(HostIpRole); }
         else if (key == "macvlanIp" && devicePtr->macvlanIp != value.toString()) { devicePtr->macvlanIp = value.toString(); changedRoles.append(MacvlanIpRole); }
@@ -926,32 +865,10 @@ void TreeModel::modifyDeviceEx(const QString &shortId, const QVariantMap &newDat
     }
 
     if (!changedRoles.isEmpty()) {
-        QModelIndex deviceIndex;
-        bool indexFound = false;
-        for(int i=0; i<m_rootItem->childCount(); ++i){
-            auto groupItem = static_cast<GroupItem*>(m_rootItem->child(i));
-            for(int j=0; j<groupItem->childCount(); ++j){
-                auto hostItem = static_cast<HostItem*>(groupItem->child(j));
-                for(int k=0; k<hostItem->childCount(); ++k){
-                    auto deviceItem = static_cast<DeviceItem*>(hostItem->child(k));
-                    if(deviceItem->deviceData().shortId == shortId){
-                        deviceIndex = index(k, 0, index(j, 0, index(i, 0, QModelIndex())));
-                        indexFound = true;
-                        break;
-                    }
-                }
-                if(indexFound) break;
-            }
-            if(indexFound) break;
-        }
-
-        if (deviceIndex.isValid()) {
-            DeviceItem* deviceItem = static_cast<DeviceItem*>(deviceIndex.internalPointer());
-            if (deviceItem) {
-                deviceItem->deviceData() = *devicePtr;
-                emit dataChanged(deviceIndex, deviceIndex, changedRoles);
-            }
-        }
+        devicePtr->recordHash = 0;
+        QModelIndex deviceIndex = indexOfItem(deviceItem);
+        setDeviceData(deviceItem, *devicePtr);
+        notifyChanged(deviceIndex, changedRoles);
         saveConfig();
     }
 }
@@ -963,33 +880,15 @@ void TreeModel::updateDevice(const QString& dbId, const QVariantMap& device)
         return;
     }
 
-    DeviceData* devicePtr = nullptr;
-    QString hostId;
-    int deviceRow = -1;
-
-    // 在后备容器中查找设备
-    for (auto it = m_devicesByHost.begin(); it != m_devicesByHost.end(); ++it) {
-        QList<DeviceData>& list = it.value();
-        for (int i = 0; i < list.size(); ++i) {
-            if (list[i].dbId == dbId) {
-                devicePtr = &list[i];
-                deviceRow = i;
-                hostId = it.key();
-                break;
-            }
-        }
-        if (devicePtr) break;
-    }
+    // 通过索引查找设备及其后备数据
+    DeviceItem* deviceItem = m_deviceItems.value(dbId);
+    DeviceData* devicePtr = backingDevice(deviceItem);
 
     if (!devicePtr) {
         qWarning() << "updateDevice: Device with dbId" << dbId << "not found.";
         return;
     }
 
-    // 记录旧的勾选/选中状态
-    const bool wasChecked = m_checkedDeviceIds.contains(dbId);
-    const bool wasSelected = m_selectedDeviceIds.contains(dbId);
-
     QVector<int> changedRoles;
     QMapIterator<QString, QVariant> it(device);
     while (it.hasNext()) {
@@ -1000,61 +899,38 @@ void TreeModel::updateDevice(const QString& dbId, const QVariantMap& device)
         if (key == "displayName" && devicePtr->displayName != value.toString()) { devicePtr->displayName = value.toString(); changedRoles.append(DisplayNameRole); }
         else if (key == "name" && devicePtr->name != value.toString()) { devicePtr->name = value.toString(); changedRoles.append(NameRole); }
         else if (key == "image" && devicePtr->image != value.toString()) { devicePtr->image = value.toString(); changedRoles.append(ImageRole); }
-        else if (key == "dpi" && devicePtr->dpi != value.toString()) { devicePtr->dpi = value.toString(); changedRoles.append(DpiRole); }
-        else if (key == "fps" && devicePtr->fps != value.toString()) { devicePtr->fps = value.toString(); changedRoles.append(FpsRole); }
+        else if (key == "dpi" && devicePtr->dpi != value.toInt()) { devicePtr->dpi = value.toInt(); changedRoles.append(DpiRole); }
+        else if (key == "fps" && devicePtr->fps != value.toInt()) { devicePtr->fps = value.toInt(); changedRoles.append(FpsRole); }
         else if (key == "state" && devicePtr->state != value.toString()) { devicePtr->state = value.toString(); changedRoles.append(StateRole); }
         else if (key == "refresh" && devicePtr->refresh != value.toBool()) { devicePtr->refresh = value.toBool(); changedRoles.append(RefreshRole); }
         else if (key == "adb" && devicePtr->adb != value.toInt()) { devicePtr->adb = value.toInt(); changedRoles.append(AdbRole); }
         else if (key == "data" && devicePtr->data != value.toString()) { devicePtr->data = value.toString(); changedRoles.append(DataRole); }
         else if (key == "dbId" && devicePtr->dbId != value.toString()) { devicePtr->dbId = value.toString(); changedRoles.append(DbIdRole); }
         else if (key == "dns" && devicePtr->dns != value.toString()) { devicePtr->dns = value.toString(); changedRoles.append(DnsRole); }
-        else if (key == "height" && devicePtr->height != value.toString()) { devicePtr->height = value.toString(); changedRoles.append(HeightRole); }
+        else if (key == "height" && devicePtr->height != value.toInt()) { devicePtr->height = value.toInt(); changedRoles.append(HeightRole); }
         else if (key == "ip" && devicePtr->ip != value.toString()) { devicePtr->ip = value.toString(); changedRoles.append(IpRole); }
         else if (key == "memory" && devicePtr->memory != value.toInt()) { devicePtr->memory = value.toInt(); changedRoles.append(MemoryRole); }
         else if (key == "shortId" && devicePtr->shortId != value.toString()) { devicePtr->shortId = value.toString(); changedRoles.append(ShortIdRole); }
-        else if (key == "width" && devicePtr->width != value.toString()) { devicePtr->width = value.toString(); changedRoles.append(WidthRole); }
+        else if (key == "width" && devicePtr->width != value.toInt()) { devicePtr->width = value.toInt(); changedRoles.append(WidthRole); }
         else if (key == "aospVersion" && devicePtr->aospVersion != value.toString()) { devicePtr->aospVersion = value.toString(); changedRoles.append(AospVersionRole); }
         else if (key == "hostIp" && devicePtr->hostIp != value.toString()) { devicePtr->hostIp = value.toString(); changedRoles.append(HostIpRole); }
         else if (key == "macvlanIp" && devicePtr->macvlanIp != value.toString()) { devicePtr->macvlanIp = value.toString(); changedRoles.append(MacvlanIpRole); }
         else if (key == "macvlan_ip" && devicePtr->macvlanIp != value.toString()) { devicePtr->macvlanIp = value.toString(); changedRoles.append(MacvlanIpRole); }
     }
 
-    // 恢复勾选/选中状态
-    if (wasChecked) m_checkedDeviceIds.insert(devicePtr->dbId); else m_checkedDeviceIds.remove(devicePtr->dbId);
-    if (wasSelected) m_selectedDeviceIds.insert(devicePtr->dbId); else m_selectedDeviceIds.remove(devicePtr->dbId);
-
     if (!changedRoles.isEmpty()) {
-        QModelIndex deviceIndex = findIndex(dbId, TypeDevice);
-        QModelIndex hostIndex;
-        if (!hostId.isEmpty()) {
-            hostIndex = findIndex(hostId, TypeHost);
-        }
-        
-        if (deviceIndex.isValid()) {
-            DeviceItem* deviceItem = static_cast<DeviceItem*>(deviceIndex.internalPointer());
-            if (deviceItem) {
-                deviceItem->deviceData() = *devicePtr;
-                emit dataChanged(deviceIndex, deviceIndex, changedRoles);
-            }
-            // 如果设备状态改变，需要通知主机节点更新 HostPadCountRole（用于显示过滤后的设备数量）
-            // 同时需要通知分组节点更新 GroupPadCountRole
-            if (changedRoles.contains(StateRole) && hostIndex.isValid()) {
-                emit dataChanged(hostIndex, hostIndex, {HostPadCountRole});
-                QModelIndex groupIndex = parent(hostIndex);
-                if (groupIndex.isValid()) {
-                    emit dataChanged(groupIndex, groupIndex, {GroupPadCountRole});
-                }
-            }
-        } else if (hostIndex.isValid()) {
-            // 索引缺失时，尝试通过父节点发出粗粒度变更
-            emit dataChanged(hostIndex, hostIndex, changedRoles);
-            // 如果设备状态改变，也需要更新 HostPadCountRole 和 GroupPadCountRole
-            if (changedRoles.contains(StateRole)) {
-                emit dataChanged(hostIndex, hostIndex, {HostPadCountRole});
-                QModelIndex groupIndex = parent(hostIndex);
-                if (groupIndex.isValid()) {
-                    emit dataChanged(groupIndex, groupIndex, {GroupPadCountRole});
-                }
+        devicePtr->recordHash = 0;
+        QModelIndex deviceIndex = indexOfItem(deviceItem);
+        QModelIndex hostIndex = parent(deviceIndex);
+        setDeviceData(deviceItem, *devicePtr);
+        notifyChanged(deviceIndex, changedRoles);
+        // 如果设备状态改变，需要通知主机节点更新 HostPadCountRole（用于显示过滤后的设备数量）
+        // 同时需要通知分组节点更新 GroupPadCountRole
+        if (changedRoles.contains(StateRole) && hostIndex.isValid()) {
+            notifyChanged(hostIndex, {HostPadCountRole});
+            QModelIndex groupIndex = parent(hostIndex);
+            if (groupIndex.isValid()) {
+                notifyChanged(groupIndex, {GroupPadCountRole});
             }
         }
         saveConfig();
@@ -1063,26 +939,13 @@ void TreeModel::updateDevice(const QString& dbId, const QVariantMap& device)
 
 void TreeModel::modifyHost(const QString& hostIp, const QVariantMap& newData)
 {
-    HostData* hostPtr = nullptr;
-    QString hostId;
-    bool hostFound = false;
-
-    for (auto& hostList : m_hostsByGroup) {
-        for (auto& host : hostList) {
-            if (host.ip == hostIp) {
-                hostPtr = &host;
-                hostId = host.hostId;
-                hostFound = true;
-                break;
-            }
-        }
-        if (hostFound) break;
-    }
-
-    if (!hostFound) {
+    HostItem* hostItem = hostItemByIp(hostIp);
+    HostData* hostPtr = backingHost(hostItem);
+    if (!hostPtr) {
         qWarning() << "modifyHost: Host with ip" << hostIp << "not found.";
         return;
     }
+    const QString hostId = hostPtr->hostId;
 
     QVector<int> changedRoles;
     bool stateDidChange = false;
@@ -1113,12 +976,16 @@ void TreeModel::modifyHost(const QString& hostIp, const QVariantMap& newData)
     }
 
     if (!changedRoles.isEmpty()) {
-        QModelIndex hostIndex = findIndex(hostId, TypeHost);
+        // 主机上下线会改写所有设备的状态，合并成一次通知
+        beginTransaction();
+        QModelIndex hostIndex = indexOfItem(hostItem);
         if (hostIndex.isValid()) {
-            HostItem* hostItem = static_cast<HostItem*>(hostIndex.internalPointer());
             if (hostItem) {
+                // IP 可能变了，重新登记索引
+                unindexHost(hostItem);
                 hostItem->hostData() = *hostPtr;
-                emit dataChanged(hostIndex, hostIndex, changedRoles);
+                indexHost(hostItem);
+                notifyChanged(hostIndex, changedRoles);
 
                 if (stateDidChange) {
                     QString newDeviceState = (hostPtr->state == "offline") ? "offline" : "running";
@@ -1126,65 +993,49 @@ void TreeModel::modifyHost(const QString& hostIp, const QVariantMap& newData)
                     if (m_devicesByHost.contains(hostId)) {
                         for (auto& device : m_devicesByHost[hostId]) {
                             device.state = newDeviceState;
+                            // 状态是本地推断的，下次同步不能因哈希相同而跳过
+                            device.recordHash = 0;
                         }
                     }
                     
                     for (int i = 0; i < hostItem->childCount(); ++i) {
                         DeviceItem* deviceItem = static_cast<DeviceItem*>(hostItem->child(i));
+                        deviceItem->deviceData().recordHash = 0;
                         if (deviceItem->deviceData().state != newDeviceState) {
                             deviceItem->deviceData().state = newDeviceState;
                             QModelIndex deviceIndex = index(i, 0, hostIndex);
-                            emit dataChanged(deviceIndex, deviceIndex, {StateRole});
+                            notifyChanged(deviceIndex, {StateRole});
                         }
                     }
                     
                     // 主机状态改变时，需要通知分组更新 GroupPadCountRole（用于显示过滤后的设备数量）
                     QModelIndex groupIndex = parent(hostIndex);
                     if (groupIndex.isValid()) {
-                        emit dataChanged(groupIndex, groupIndex, {GroupPadCountRole});
+                        notifyChanged(groupIndex, {GroupPadCountRole});
                     }
                 }
             }
         }
         saveConfig();
+        commitTransaction();
     }
 }
 
 void TreeModel::removeDevicesByHostIp(const QString& hostIp)
 {
-    QString hostId = "";
-    bool hostFound = false;
-    for (const auto& hostList : m_hostsByGroup) {
-        for (const auto& host : hostList) {
-            if (host.ip == hostIp) {
-                hostId = host.hostId;
-                hostFound = true;
-                break;
-            }
-        }
-        if (hostFound) {
-            break;
-        }
-    }
-
-    if (!hostFound) {
+    HostItem* hostItem = hostItemByIp(hostIp);
+    if (!hostItem) {
         qWarning() << "Host with IP not found for removing devices:" << hostIp;
         return;
     }
+    const QString hostId = hostItem->hostData().hostId;
 
     if (!m_devicesByHost.contains(hostId)) {
         qWarning() << "Host" << hostId << "found but has no devices to remove.";
         return;
     }
 
-    // Find the host index in the tree
-    QModelIndex hostIndex = findIndex(hostId, TypeHost);
-    if (!hostIndex.isValid()) {
-        qWarning() << "Host item not found in tree for hostId:" << hostId;
-        return;
-    }
-
-    HostItem* hostItem = static_cast<HostItem*>(hostIndex.internalPointer());
+    QModelIndex hostIndex = indexOfItem(hostItem);
     int deviceCount = hostItem->childCount();
 
     if (deviceCount == 0) {
@@ -1192,52 +1043,35 @@ void TreeModel::removeDevicesByHostIp(const QString& hostIp)
         return;
     }
 
-    // Clean up selection and checked states for the devices being removed
-    const QList<DeviceData>& devicesToRemove = m_devicesByHost.value(hostId);
-    for (const auto& device : devicesToRemove) {
-        m_selectedDeviceIds.remove(device.dbId);
-        m_checkedDeviceIds.remove(device.dbId);
-    }
-
     // Remove all device items from the tree
     beginRemoveRows(hostIndex, 0, deviceCount - 1);
     while (hostItem->childCount() > 0) {
-        delete hostItem->takeChild(0);
+        DeviceItem* deviceItem = static_cast<DeviceItem*>(hostItem->takeChild(hostItem->childCount() - 1));
+        releaseDevice(deviceItem);
+        delete deviceItem;
     }
     endRemoveRows();
 
     // Remove all devices from backing store
-    // 同时清理持久索引缓存中属于该主机的条目
-    if (m_devicesByHost.contains(hostId)) {
-        const QList<DeviceData> toRemove = m_devicesByHost.value(hostId);
-        for (const auto& d : toRemove) {
-            m_deviceIndexCache.remove(d.dbId);
-        }
-        m_devicesByHost.remove(hostId);
-    }
+    m_devicesByHost.remove(hostId);
 
     // 对于成为“空主机”的情况，保持之前的勾选语义：如果所在分组在 m_checkedGroupIds 中，则将该空主机设为勾选
     if (m_checkedGroupIds.contains(hostItem->hostData().groupId)) {
-        m_checkedHostIds.insert(hostId);
-        emit dataChanged(hostIndex, hostIndex, {CheckedRole});
+        setHostCheckIntent(hostItem, true);
+        notifyChanged(hostIndex, {CheckedRole});
     }
 
     // Update host's device count
     hostItem->hostData().hostPadCount = 0;
-    for (auto& hostList : m_hostsByGroup) {
-        for (auto& host : hostList) {
-            if (host.hostId == hostId) {
-                host.hostPadCount = 0;
-                break;
-            }
-        }
+    if (HostData* host = backingHost(hostItem)) {
+        host->hostPadCount = 0;
     }
-    emit dataChanged(hostIndex, hostIndex, {HostPadCountRole});
+    notifyChanged(hostIndex, {HostPadCountRole});
 
     // 更新分组的设备数量显示
     QModelIndex groupIndex = parent(hostIndex);
     if (groupIndex.isValid()) {
-        emit dataChanged(groupIndex, groupIndex, {GroupPadCountRole});
+        notifyChanged(groupIndex, {GroupPadCountRole});
     }
 
     saveConfig();
@@ -1328,20 +1162,20 @@ void TreeModel::parseDevice(const QJsonObject& padObject, DeviceData& device)
     device.displayName = displayName.isEmpty() ? padObject["user_name"].toString() : displayName;
     device.shortId = shortId.isEmpty() ? padObject["short_id"].toString() : shortId;
     device.dbId = dbId.isEmpty() ? padObject["db_id"].toString() : dbId;
-    device.image = padObject["image"].toString();
-    device.state = padObject["state"].toString();
+    device.image = StringPool::intern(padObject["image"].toString());
+    device.state = StringPool::intern(padObject["state"].toString());
     device.adb = padObject["adb"].toInt();
     device.data = padObject["data"].toString();
-    device.dns = padObject["dns"].toString();
-    device.dpi = padObject["dpi"].toString();
-    device.fps = padObject["fps"].toString();
-    device.height = padObject["height"].toString();
+    device.dns = StringPool::intern(padObject["dns"].toString());
+    device.dpi = padObject["dpi"].toVariant().toInt();
+    device.fps = padObject["fps"].toVariant().toInt();
+    device.height = padObject["height"].toVariant().toInt();
     device.ip = padObject["ip"].toString();
     device.memory = padObject["memory"].toInt();
     device.created = padObject["created"].toString();
-    device.width = padObject["width"].toString();
-    device.aospVersion = aospVersion.isEmpty() ? padObject["aosp_version"].toString() : aospVersion;
-    device.hostIp = hostIp.isEmpty() ? padObject["host_ip"].toString() : hostIp;
+    device.width = padObject["width"].toVariant().toInt();
+    device.aospVersion = StringPool::intern(aospVersion.isEmpty() ? padObject["aosp_version"].toString() : aospVersion);
+    device.hostIp = StringPool::intern(hostIp.isEmpty() ? padObject["host_ip"].toString() : hostIp);
     // Macvlan IP字段
     // 接口返回的字段名为 macvlan_ip
     // 配置文件保存的字段名为 macvlanIp
@@ -1382,6 +1216,7 @@ void TreeModel::parseDevice(const QJsonObject& padObject, DeviceData& device)
     device.checked = false;
     device.selected = false;
     device.refresh = false;
+    device.recordHash = deviceRecordHash(device);
 }
 
 QModelIndex TreeModel::index(int row, int column, const QModelIndex &parent) const
@@ -1440,45 +1275,10 @@ QVariant TreeModel::data(const QModelIndex &index, int role) const
                     if (totalHosts == 0) {
                         return m_checkedGroupIds.contains(group.groupId);
                     }
-
-                    int checkedHostCount = 0;
-                    int partialHostCount = 0;
-                    // 检查每个主机的勾选状态
-                    for(int i = 0; i < totalHosts; ++i) {
-                        HostItem* childHostItem = static_cast<HostItem*>(item->child(i));
-                        bool hostChecked = true;
-                        bool hasCheckedDevice = false;
-
-                        const int childDeviceCount = childHostItem->childCount();
-                        if (childDeviceCount == 0) {
-                            // 无设备时，使用主机的勾选状态集
-                            hostChecked = m_checkedHostIds.contains(childHostItem->hostData().hostId);
-                            hasCheckedDevice = hostChecked;
-                        } else {
-                            // 有设备时，检查设备勾选状态
-                            int checkedDeviceCount = 0;
-                            for(int j = 0; j < childDeviceCount; ++j){
-                                DeviceItem* deviceItem = static_cast<DeviceItem*>(childHostItem->child(j));
-                                if(m_checkedDeviceIds.contains(deviceItem->deviceData().dbId)){
-                                    checkedDeviceCount++;
-                                    hasCheckedDevice = true;
-                                }
-                            }
-                            // 完全选中：所有设备都选中
-                            hostChecked = (checkedDeviceCount == childDeviceCount);
-                            // 部分选中：有选中设备但不是全部
-                            if (hasCheckedDevice && !hostChecked) {
-                                partialHostCount++;
-                            }
-                        }
-
-                        if (hostChecked) {
-                            checkedHostCount++;
-                        }
-                    }
-
+                    // 主机三态由计数增量维护，不再逐个遍历主机和设备
+                    const int checkedHostCount = groupItem->checkedHostCount();
                     // 如果有任何主机是部分选中，分组应该是部分选中
-                    if (partialHostCount > 0) {
+                    if (groupItem->partialHostCount() > 0) {
                         return QVariant(); // Indeterminate
                     }
                     // 所有主机都完全选中
@@ -1509,20 +1309,9 @@ QVariant TreeModel::data(const QModelIndex &index, int role) const
                 case StateRole: return host.state;
                 case SelectedRole: return host.selected;
                 case CheckedRole: {
-                    const int deviceCount = item->childCount();
-                    if (deviceCount == 0) {
-                        return m_checkedHostIds.contains(host.hostId);
-                    }
-                    int checkedCount = 0;
-                    for(int i = 0; i < deviceCount; ++i) {
-                        DeviceItem* deviceItem = static_cast<DeviceItem*>(item->child(i));
-                        if(m_checkedDeviceIds.contains(deviceItem->deviceData().dbId)){
-                            checkedCount++;
-                        }
-                    }
-                    if (checkedCount == 0) return false;
-                    if (checkedCount == deviceCount) return true;
-                    return QVariant(); // Indeterminate
+                    const int checkState = hostCheckState(hostItem);
+                    if (checkState == Qt::PartiallyChecked) return QVariant(); // Indeterminate
+                    return checkState == Qt::Checked;
                 }
                 default: return QVariant();
             }
@@ -1553,8 +1342,8 @@ QVariant TreeModel::data(const QModelIndex &index, int role) const
                 case ShortIdRole: return device.shortId;
                 case StateRole: return device.state;
                 case WidthRole: return device.width;
-                case CheckedRole: return m_checkedDeviceIds.contains(device.dbId);
-                case SelectedRole: return m_selectedDeviceIds.contains(device.dbId);
+                case CheckedRole: return isChecked(deviceItem);
+                case SelectedRole: return isSelected(deviceItem);
                 case AospVersionRole: return device.aospVersion;
                 case HostIpRole: return device.hostIp;
                 case TcpVideoPortRole: {
@@ -1641,7 +1430,9 @@ bool TreeModel::setData(const QModelIndex &index, const QVariant &value, int rol
                     success = true;
                     break;
                 case NameRole:
+                    unindexDevice(deviceItem);
                     device.name = value.toString();
+                    indexDevice(deviceItem);
                     success = true;
                     break;
                 case ImageRole:
@@ -1649,11 +1440,11 @@ bool TreeModel::setData(const QModelIndex &index, const QVariant &value, int rol
                     success = true;
                     break;
                 case DpiRole:
-                    device.dpi = value.toString();
+                    device.dpi = value.toInt();
                     success = true;
                     break;
                 case FpsRole:
-                    device.fps = value.toString();
+                    device.fps = value.toInt();
                     success = true;
                     break;
                 case StateRole:
@@ -1673,7 +1464,9 @@ bool TreeModel::setData(const QModelIndex &index, const QVariant &value, int rol
                     success = true;
                     break;
                 case DbIdRole:
+                    unindexDevice(deviceItem);
                     device.dbId = value.toString();
+                    indexDevice(deviceItem);
                     success = true;
                     break;
                 case DnsRole:
@@ -1681,7 +1474,7 @@ bool TreeModel::setData(const QModelIndex &index, const QVariant &value, int rol
                     success = true;
                     break;
                 case HeightRole:
-                    device.height = value.toString();
+                    device.height = value.toInt();
                     success = true;
                     break;
                 case IpRole:
@@ -1693,11 +1486,13 @@ bool TreeModel::setData(const QModelIndex &index, const QVariant &value, int rol
                     success = true;
                     break;
                 case ShortIdRole:
+                    unindexDevice(deviceItem);
                     device.shortId = value.toString();
+                    indexDevice(deviceItem);
                     success = true;
                     break;
                 case WidthRole:
-                    device.width = value.toString();
+                    device.width = value.toInt();
                     success = true;
                     break;
                 case AospVersionRole:
@@ -1715,6 +1510,11 @@ bool TreeModel::setData(const QModelIndex &index, const QVariant &value, int rol
                 default:
                     return false;
             }
+            // 本地改过的记录与服务端不一致，清掉记录哈希，下次同步逐字段比较纠正
+            device.recordHash = 0;
+            if (DeviceData *backing = backingDevice(deviceItem)) {
+                backing->recordHash = 0;
+            }
             break;
         }
         default:
@@ -1722,7 +1522,7 @@ bool TreeModel::setData(const QModelIndex &index, const QVariant &value, int rol
     }
 
     if (success) {
-        emit dataChanged(index, index, {role});
+        notifyChanged(index, {role});
         saveConfig();
     }
 
@@ -1798,38 +1598,23 @@ void TreeModel::selectDevice(const QString& dbId, bool selected)
         return;
     }
     
-    if (selected) {
-        m_selectedDeviceIds.insert(dbId);
-    } else {
-        m_selectedDeviceIds.remove(dbId);
-    }
-    
-    // 通过设备ID找到设备的ModelIndex
-    QModelIndex deviceIndex;
-    for(int i=0; i<m_rootItem->childCount(); ++i){
-        auto groupItem = static_cast<GroupItem*>(m_rootItem->child(i));
-        for(int j=0; j<groupItem->childCount(); ++j){
-            auto hostItem = static_cast<HostItem*>(groupItem->child(j));
-            for(int k=0; k<hostItem->childCount(); ++k){
-                auto deviceItem = static_cast<DeviceItem*>(hostItem->child(k));
-                if(deviceItem->deviceData().dbId == dbId){
-                    deviceIndex = index(k, 0, index(j, 0, index(i, 0, QModelIndex())));
-                    goto found;
-                }
-            }
-        }
+    DeviceItem* deviceItem = m_deviceItems.value(dbId);
+    if (!deviceItem) {
+        return;
     }
-    found:
-    
+    setDeviceSelected(deviceItem, selected);
+
+    QModelIndex deviceIndex = indexOfItem(deviceItem);
+
     if(deviceIndex.isValid()){
-        emit dataChanged(deviceIndex, deviceIndex, {SelectedRole});
+        notifyChanged(deviceIndex, {SelectedRole});
         // Also notify parent group/host if their state depends on child selection
         QModelIndex hostIndex = parent(deviceIndex);
         if(hostIndex.isValid()){
-            emit dataChanged(hostIndex, hostIndex, {SelectedRole});
+            notifyChanged(hostIndex, {SelectedRole});
             QModelIndex groupIndex = parent(hostIndex);
             if(groupIndex.isValid()){
-                 emit dataChanged(groupIndex, groupIndex, {SelectedRole});
+                 notifyChanged(groupIndex, {SelectedRole});
             }
         }
     }
@@ -1852,13 +1637,10 @@ void TreeModel::checkGroup(int groupId, bool checked)
         const int deviceCount = hostItem->childCount();
 
         if (deviceCount == 0) {
-            const QString hostId = hostItem->hostData().hostId;
-            if (checked) m_checkedHostIds.insert(hostId); else m_checkedHostIds.remove(hostId);
+            setHostCheckIntent(hostItem, checked);
         } else {
             for(int k=0; k<deviceCount; ++k){
-                DeviceItem* deviceItem = static_cast<DeviceItem*>(hostItem->child(k));
-                const QString dbId = deviceItem->deviceData().dbId;
-                if (checked) m_checkedDeviceIds.insert(dbId); else m_checkedDeviceIds.remove(dbId);
+                setDeviceChecked(static_cast<DeviceItem*>(hostItem->child(k)), checked);
             }
             // 合并通知该主机下所有设备的变更
             emit dataChanged(index(0, 0, hostIndex), index(deviceCount - 1, 0, hostIndex), {CheckedRole});
@@ -1873,14 +1655,14 @@ void TreeModel::checkGroup(int groupId, bool checked)
     if (hostCount > 0) {
         emit dataChanged(index(0, 0, groupIndex), index(hostCount - 1, 0, groupIndex), {CheckedRole});
     }
-    emit dataChanged(groupIndex, groupIndex, {CheckedRole});
+    notifyChanged(groupIndex, {CheckedRole});
 }
 
 void TreeModel::checkHost(const QString& hostId, bool checked)
 {
     QModelIndex hostIndex = findIndex(hostId, TypeHost);
     if(!hostIndex.isValid()) return;
-    TreeItem* hostItem = static_cast<TreeItem*>(hostIndex.internalPointer());
+    HostItem* hostItem = static_cast<HostItem*>(hostIndex.internalPointer());
     if (!hostItem) return;
     
     qDebug() << "checkHost called for hostId:" << hostId << "checked:" << checked << "device count:" << hostItem->childCount();
@@ -1891,14 +1673,7 @@ void TreeModel::checkHost(const QString& hostId, bool checked)
     for(int i=0; i < deviceCount; ++i){
         TreeItem* childItem = hostItem->child(i);
         if (!(childItem && childItem->type() == TypeDevice)) continue;
-        DeviceItem* deviceItem = static_cast<DeviceItem*>(childItem);
-        const QString dbId = deviceItem->deviceData().dbId;
-
-        if (checked) {
-            m_checkedDeviceIds.insert(dbId);
-        } else {
-            m_checkedDeviceIds.remove(dbId);
-        }
+        setDeviceChecked(static_cast<DeviceItem*>(childItem), checked);
     }
 
     // 一次性通知该主机下设备的勾选变化，避免逐条信号引发的 QML 重绘抖动
@@ -1907,16 +1682,15 @@ void TreeModel::checkHost(const QString& hostId, bool checked)
     }
     // 若主机没有设备，记录主机的勾选状态
     if (deviceCount == 0) {
-        if (checked) m_checkedHostIds.insert(hostId);
-        else m_checkedHostIds.remove(hostId);
+        setHostCheckIntent(hostItem, checked);
     }
     
-    qDebug() << "checkHost finished, total checked devices:" << m_checkedDeviceIds.size();
+    qDebug() << "checkHost finished, total checked devices:" << m_checkedDeviceCount;
     
-    emit dataChanged(hostIndex, hostIndex, {CheckedRole});
+    notifyChanged(hostIndex, {CheckedRole});
     QModelIndex groupIndex = parent(hostIndex);
     if(groupIndex.isValid()){
-        emit dataChanged(groupIndex, groupIndex, {CheckedRole});
+        notifyChanged(groupIndex, {CheckedRole});
     }
 }
 
@@ -1934,44 +1708,26 @@ void TreeModel::checkDevice(const QString& dbId, bool checked, bool updateParent
     
     qDebug() << "checkDevice called for dbId:" << dbId << "checked:" << checked << "updateParents:" << updateParents;
     
-    if (checked) {
-        m_checkedDeviceIds.insert(dbId);
-    } else {
-        m_checkedDeviceIds.remove(dbId);
-    }
-    
-    // 通过设备ID找到设备的ModelIndex - 使用缓存优化
-    QModelIndex deviceIndex;
-    if (m_deviceIndexCache.contains(dbId)) {
-        const QPersistentModelIndex persisted = m_deviceIndexCache.value(dbId);
-        if (persisted.isValid()) {
-            deviceIndex = persisted;
-            qDebug() << "Using cached persistent index for device:" << dbId;
-        } else {
-            m_deviceIndexCache.remove(dbId);
-        }
-    }
-    if (!deviceIndex.isValid()) {
-        deviceIndex = findIndex(dbId, TypeDevice);
-        if (deviceIndex.isValid()) {
-            m_deviceIndexCache[dbId] = QPersistentModelIndex(deviceIndex);
-            qDebug() << "Found and cached persistent index for device:" << dbId;
-        } else {
-            qWarning() << "Could not find index for device:" << dbId;
-        }
+    DeviceItem* deviceItem = m_deviceItems.value(dbId);
+    if (!deviceItem) {
+        qWarning() << "Could not find index for device:" << dbId;
+        return;
     }
-    
+    setDeviceChecked(deviceItem, checked);
+
+    QModelIndex deviceIndex = indexOfItem(deviceItem);
+
     if(deviceIndex.isValid()){
-        emit dataChanged(deviceIndex, deviceIndex, {CheckedRole});
+        notifyChanged(deviceIndex, {CheckedRole});
         if(updateParents){
             QModelIndex hostIndex = parent(deviceIndex);
             if(hostIndex.isValid()){
                 qDebug() << "Emitting dataChanged for host parent";
-                emit dataChanged(hostIndex, hostIndex, {CheckedRole});
+                notifyChanged(hostIndex, {CheckedRole});
                 QModelIndex groupIndex = parent(hostIndex);
                 if(groupIndex.isValid()){
                     qDebug() << "Emitting dataChanged for group parent";
-                    emit dataChanged(groupIndex, groupIndex, {CheckedRole});
+                    notifyChanged(groupIndex, {CheckedRole});
                 }
             }
         }
@@ -1981,264 +1737,733 @@ void TreeModel::checkDevice(const QString& dbId, bool checked, bool updateParent
 
 bool TreeModel::isDeviceSelected(const QString& dbId) const
 {
-    return m_selectedDeviceIds.contains(dbId);
+    DeviceItem* deviceItem = m_deviceItems.value(dbId);
+    return deviceItem && isSelected(deviceItem);
 }
 
 bool TreeModel::isDeviceChecked(const QString& dbId) const
 {
-    return m_checkedDeviceIds.contains(dbId);
+    DeviceItem* deviceItem = m_deviceItems.value(dbId);
+    return deviceItem && isChecked(deviceItem);
 }
 
 QModelIndex TreeModel::findIndex(const QVariant& id, int type) const
 {
-    for(int i=0; i<m_rootItem->childCount(); ++i){
-        auto groupItem = static_cast<GroupItem*>(m_rootItem->child(i));
-        if(type == TypeGroup && groupItem->groupData().groupId == id.toInt()){
-            return index(i, 0, QModelIndex());
+    switch (type) {
+    case TypeGroup:
+        return indexOfItem(m_groupItems.value(id.toInt()));
+    case TypeHost:
+        return indexOfItem(m_hostItems.value(id.toString()));
+    case TypeDevice:
+        return indexOfItem(m_deviceItems.value(id.toString()));
+    default:
+        return QModelIndex();
+    }
+}
+
+QModelIndex TreeModel::indexOfItem(TreeItem *item) const
+{
+    if (!item || item == m_rootItem) {
+        return QModelIndex();
+    }
+    return createIndex(item->row(), 0, item);
+}
+
+HostItem *TreeModel::hostItemByIp(const QString &hostIp) const
+{
+    auto it = m_hostIdsByIp.constFind(hostIp);
+    if (it == m_hostIdsByIp.constEnd()) {
+        return nullptr;
+    }
+    return m_hostItems.value(it.value());
+}
+
+HostData *TreeModel::backingHost(HostItem *hostItem)
+{
+    if (!hostItem) {
+        return nullptr;
+    }
+    // 后备列表与分组下的主机节点顺序一致，先按行号取，对不上再查找
+    const QString &hostId = hostItem->hostData().hostId;
+    auto groupIt = m_hostsByGroup.find(hostItem->hostData().groupId);
+    if (groupIt != m_hostsByGroup.end()) {
+        QList<HostData> &hosts = groupIt.value();
+        int row = hostItem->row();
+        if (row < hosts.size() && hosts[row].hostId == hostId) {
+            return &hosts[row];
+        }
+        for (auto &host : hosts) {
+            if (host.hostId == hostId) {
+                return &host;
+            }
+        }
+    }
+    return nullptr;
+}
+
+int TreeModel::backingDeviceRow(DeviceItem *deviceItem) const
+{
+    if (!deviceItem || !deviceItem->parentItem()) {
+        return -1;
+    }
+    // 后备列表与主机下的设备节点顺序一致，先按行号取，对不上再查找
+    HostItem *hostItem = static_cast<HostItem*>(deviceItem->parentItem());
+    auto devicesIt = m_devicesByHost.constFind(hostItem->hostData().hostId);
+    if (devicesIt == m_devicesByHost.constEnd()) {
+        return -1;
+    }
+    const QList<DeviceData> &devices = devicesIt.value();
+    const QString &dbId = deviceItem->deviceData().dbId;
+    int row = deviceItem->row();
+    if (row < devices.size() && devices[row].dbId == dbId) {
+        return row;
+    }
+    for (int i = 0; i < devices.size(); ++i) {
+        if (devices[i].dbId == dbId) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+DeviceData *TreeModel::backingDevice(DeviceItem *deviceItem)
+{
+    int row = backingDeviceRow(deviceItem);
+    if (row < 0) {
+        return nullptr;
+    }
+    HostItem *hostItem = static_cast<HostItem*>(deviceItem->parentItem());
+    return &m_devicesByHost[hostItem->hostData().hostId][row];
+}
+
+void TreeModel::indexHost(HostItem *hostItem)
+{
+    const HostData &host = hostItem->hostData();
+    m_hostItems.insert(host.hostId, hostItem);
+    if (!host.ip.isEmpty() && !m_hostIdsByIp.contains(host.ip)) {
+        m_hostIdsByIp.insert(host.ip, host.hostId);
+    }
+    // 空主机的勾选意图按 hostId 记录，hostId 变化后要重新计入
+    updateHostCheckState(hostItem);
+}
+
+void TreeModel::unindexHost(HostItem *hostItem)
+{
+    const HostData &host = hostItem->hostData();
+    if (m_hostIdsByIp.value(host.ip) == host.hostId) {
+        m_hostIdsByIp.remove(host.ip);
+    }
+    if (m_hostItems.value(host.hostId) == hostItem) {
+        m_hostItems.remove(host.hostId);
+    }
+}
+
+void TreeModel::indexDevice(DeviceItem *deviceItem)
+{
+    const DeviceData &device = deviceItem->deviceData();
+    if (!device.dbId.isEmpty()) {
+        m_deviceItems.insert(device.dbId, deviceItem);
+    }
+    if (!device.shortId.isEmpty()) {
+        m_deviceItemsByShortId.insert(device.shortId, deviceItem);
+    }
+    if (!device.name.isEmpty()) {
+        m_deviceItemsByName.insert(device.name, deviceItem);
+    }
+    if (deviceItem->slot() < 0) {
+        acquireDeviceSlot(deviceItem);
+        updateHostCheckState(static_cast<HostItem*>(deviceItem->parentItem()));
+    }
+}
+
+void TreeModel::unindexDevice(DeviceItem *deviceItem)
+{
+    const DeviceData &device = deviceItem->deviceData();
+    if (m_deviceItems.value(device.dbId) == deviceItem) {
+        m_deviceItems.remove(device.dbId);
+    }
+    if (m_deviceItemsByShortId.value(device.shortId) == deviceItem) {
+        m_deviceItemsByShortId.remove(device.shortId);
+    }
+    m_deviceItemsByName.remove(device.name, deviceItem);
+}
+
+void TreeModel::setDeviceData(DeviceItem *deviceItem, const DeviceData &data)
+{
+    DeviceData &current = deviceItem->deviceData();
+    if (current.dbId != data.dbId || current.shortId != data.shortId || current.name != data.name) {
+        unindexDevice(deviceItem);
+        current = data;
+        indexDevice(deviceItem);
+    } else {
+        current = data;
+    }
+}
+
+void TreeModel::acquireDeviceSlot(DeviceItem *deviceItem)
+{
+    int slot;
+    if (!m_freeDeviceSlots.isEmpty()) {
+        slot = m_freeDeviceSlots.takeLast();
+    } else {
+        slot = m_deviceSlotCount++;
+        if (slot >= m_checkedBits.size()) {
+            const int size = qMax(64, m_checkedBits.size() * 2);
+            m_checkedBits.resize(size);
+            m_selectedBits.resize(size);
         }
-        for(int j=0; j<groupItem->childCount(); ++j){
-            auto hostItem = static_cast<HostItem*>(groupItem->child(j));
-            if(type == TypeHost && hostItem->hostData().hostId == id.toString()){
-                return index(j, 0, index(i, 0, QModelIndex()));
+    }
+    deviceItem->setSlot(slot);
+}
+
+void TreeModel::releaseDevice(DeviceItem *deviceItem)
+{
+    // 设备节点已从主机摘下但尚未析构，parentItem 仍指向原主机
+    HostItem *hostItem = static_cast<HostItem*>(deviceItem->parentItem());
+    const int slot = deviceItem->slot();
+    if (slot >= 0) {
+        if (m_checkedBits.testBit(slot)) {
+            m_checkedBits.clearBit(slot);
+            --m_checkedDeviceCount;
+            hostItem->setCheckedCount(hostItem->checkedCount() - 1);
+        }
+        m_selectedBits.clearBit(slot);
+        m_freeDeviceSlots.append(slot);
+        deviceItem->setSlot(-1);
+    }
+    unindexDevice(deviceItem);
+    m_pendingChanges.remove(deviceItem);
+    updateHostCheckState(hostItem);
+}
+
+bool TreeModel::isChecked(DeviceItem *deviceItem) const
+{
+    return deviceItem->slot() >= 0 && m_checkedBits.testBit(deviceItem->slot());
+}
+
+bool TreeModel::isSelected(DeviceItem *deviceItem) const
+{
+    return deviceItem->slot() >= 0 && m_selectedBits.testBit(deviceItem->slot());
+}
+
+bool TreeModel::setDeviceChecked(DeviceItem *deviceItem, bool checked)
+{
+    const int slot = deviceItem->slot();
+    if (slot < 0 || m_checkedBits.testBit(slot) == checked) {
+        return false;
+    }
+    m_checkedBits.setBit(slot, checked);
+    m_checkedDeviceCount += checked ? 1 : -1;
+    HostItem *hostItem = static_cast<HostItem*>(deviceItem->parentItem());
+    hostItem->setCheckedCount(hostItem->checkedCount() + (checked ? 1 : -1));
+    updateHostCheckState(hostItem);
+    return true;
+}
+
+void TreeModel::setDeviceSelected(DeviceItem *deviceItem, bool selected)
+{
+    if (deviceItem->slot() >= 0) {
+        m_selectedBits.setBit(deviceItem->slot(), selected);
+    }
+}
+
+void TreeModel::setHostCheckIntent(HostItem *hostItem, bool checked)
+{
+    const QString &hostId = hostItem->hostData().hostId;
+    if (checked) {
+        m_checkedHostIds.insert(hostId);
+    } else {
+        m_checkedHostIds.remove(hostId);
+    }
+    updateHostCheckState(hostItem);
+}
+
+int TreeModel::hostCheckState(HostItem *hostItem) const
+{
+    const int deviceCount = hostItem->childCount();
+    if (deviceCount == 0) {
+        // 无设备时，使用主机的勾选状态集
+        return m_checkedHostIds.contains(hostItem->hostData().hostId) ? Qt::Checked : Qt::Unchecked;
+    }
+    if (hostItem->checkedCount() == 0) return Qt::Unchecked;
+    if (hostItem->checkedCount() == deviceCount) return Qt::Checked;
+    return Qt::PartiallyChecked;
+}
+
+void TreeModel::updateHostCheckState(HostItem *hostItem)
+{
+    const int state = hostCheckState(hostItem);
+    if (state == hostItem->checkState()) {
+        return;
+    }
+    GroupItem *groupItem = static_cast<GroupItem*>(hostItem->parentItem());
+    groupItem->countHostState(hostItem->checkState(), -1);
+    groupItem->countHostState(state, 1);
+    hostItem->setCheckState(state);
+}
+
+void TreeModel::detachHostCheckState(HostItem *hostItem)
+{
+    // 主机离开分组前先从分组计数里扣掉，挂到新分组后再由 updateHostCheckState 计入
+    GroupItem *groupItem = static_cast<GroupItem*>(hostItem->parentItem());
+    groupItem->countHostState(hostItem->checkState(), -1);
+    hostItem->setCheckState(-1);
+}
+
+void TreeModel::checkDevices(const QStringList &dbIds, bool checked)
+{
+    QSet<QString> wanted(dbIds.begin(), dbIds.end());
+    checkDevicesWhere([checked](const DeviceData &) { return checked; }, &wanted);
+}
+
+void TreeModel::checkAllDevices(bool checked)
+{
+    checkDevicesWhere([checked](const DeviceData &) { return checked; });
+}
+
+void TreeModel::checkDevicesWhere(const std::function<bool(const DeviceData&)> &shouldCheck, const QSet<QString> *onlyDbIds)
+{
+    // 所有变化在一个事务里提交，每个主机下的设备合并成连续区间通知一次
+    beginTransaction();
+    auto apply = [&](DeviceItem *deviceItem) {
+        if (setDeviceChecked(deviceItem, shouldCheck(deviceItem->deviceData()))) {
+            notifyChanged(indexOfItem(deviceItem), {CheckedRole});
+            HostItem *hostItem = static_cast<HostItem*>(deviceItem->parentItem());
+            notifyChanged(indexOfItem(hostItem), {CheckedRole});
+            notifyChanged(indexOfItem(hostItem->parentItem()), {CheckedRole});
+        }
+    };
+    if (onlyDbIds) {
+        for (const QString &dbId : *onlyDbIds) {
+            if (DeviceItem *deviceItem = m_deviceItems.value(dbId)) {
+                apply(deviceItem);
             }
-            for(int k=0; k<hostItem->childCount(); ++k){
-                auto deviceItem = static_cast<DeviceItem*>(hostItem->child(k));
-                if(type == TypeDevice && deviceItem->deviceData().dbId == id.toString()){
-                    return index(k, 0, index(j, 0, index(i, 0, QModelIndex())));
+        }
+    } else {
+        for (int i = 0; i < m_rootItem->childCount(); ++i) {
+            TreeItem *groupItem = m_rootItem->child(i);
+            for (int j = 0; j < groupItem->childCount(); ++j) {
+                TreeItem *hostItem = groupItem->child(j);
+                for (int k = 0; k < hostItem->childCount(); ++k) {
+                    apply(static_cast<DeviceItem*>(hostItem->child(k)));
                 }
             }
         }
     }
-    return QModelIndex();
+    commitTransaction();
 }
 
-void TreeModel::updateDeviceList(const QString &hostIp, const QVariantList &newDevicesVariant)
+void TreeModel::beginTransaction()
 {
-    QString hostId;
-    for (const auto& h_list : m_hostsByGroup) {
-        for (const auto& h : h_list) {
-            if (h.ip == hostIp) {
-                hostId = h.hostId;
-                break;
+    ++m_transactionDepth;
+}
+
+void TreeModel::commitTransaction()
+{
+    if (m_transactionDepth <= 0) {
+        qWarning() << "commitTransaction called without beginTransaction";
+        return;
+    }
+    if (--m_transactionDepth > 0) {
+        return;
+    }
+    flushPendingChanges();
+    if (m_saveDeferred) {
+        m_saveDeferred = false;
+        saveConfig();
+    }
+}
+
+void TreeModel::notifyChanged(const QModelIndex &index, const QVector<int> &roles)
+{
+    if (!index.isValid()) {
+        return;
+    }
+    if (m_transactionDepth == 0) {
+        emit dataChanged(index, index, roles);
+        return;
+    }
+    QSet<int> &pending = m_pendingChanges[static_cast<TreeItem*>(index.internalPointer())];
+    if (roles.isEmpty()) {
+        pending.insert(ALL_ROLES);
+    } else {
+        for (int role : roles) {
+            pending.insert(role);
+        }
+    }
+}
+
+void TreeModel::flushPendingChanges()
+{
+    if (m_pendingChanges.isEmpty()) {
+        return;
+    }
+
+    // 按父节点分组，同一父节点下相邻的行合并成一个区间，角色取并集
+    QHash<TreeItem*, QMap<int, QSet<int>>> rowsByParent;
+    for (auto it = m_pendingChanges.constBegin(); it != m_pendingChanges.constEnd(); ++it) {
+        TreeItem *item = it.key();
+        rowsByParent[item->parentItem()][item->row()].unite(it.value());
+    }
+    m_pendingChanges.clear();
+
+    // 先发设备，再发主机、分组，父节点的三态和计数读到的是子节点的最新值
+    auto depthOf = [this](TreeItem *item) {
+        int depth = 0;
+        for (; item && item != m_rootItem; item = item->parentItem()) {
+            ++depth;
+        }
+        return depth;
+    };
+    QList<TreeItem*> parents = rowsByParent.keys();
+    std::sort(parents.begin(), parents.end(), [&](TreeItem *a, TreeItem *b) {
+        return depthOf(a) > depthOf(b);
+    });
+
+    for (TreeItem *parentItem : parents) {
+        QModelIndex parentIndex = indexOfItem(parentItem);
+        const QMap<int, QSet<int>> &rows = rowsByParent.value(parentItem);
+        auto it = rows.constBegin();
+        while (it != rows.constEnd()) {
+            int first = it.key();
+            int last = first;
+            QSet<int> roles = it.value();
+            for (++it; it != rows.constEnd() && it.key() == last + 1; ++it) {
+                last = it.key();
+                roles.unite(it.value());
             }
+            QVector<int> roleList;
+            if (!roles.contains(ALL_ROLES)) {
+                roleList = QVector<int>(roles.begin(), roles.end());
+            }
+            emit dataChanged(index(first, 0, parentIndex), index(last, 0, parentIndex), roleList);
         }
-        if (!hostId.isEmpty()) break;
     }
+}
 
+bool TreeModel::resolveHost(const QString &hostIp, QString &hostId, QModelIndex &hostIndex, const char *caller) const
+{
+    hostId = m_hostIdsByIp.value(hostIp);
     if (hostId.isEmpty()) {
-        qDebug() << "updateDeviceList: Host with IP not found:" << hostIp;
-        return;
+        qDebug() << caller << ": Host with IP not found:" << hostIp;
+        return false;
     }
 
-    QModelIndex hostIndex = findIndex(hostId, TypeHost);
+    hostIndex = findIndex(hostId, TypeHost);
     if (!hostIndex.isValid()) {
-        qWarning() << "updateDeviceList: Host with id" << hostId << "not found in tree structure.";
-        return;
+        qWarning() << caller << ": Host with id" << hostId << "not found in tree structure.";
+        return false;
     }
-    HostItem *hostItem = static_cast<HostItem*>(hostIndex.internalPointer());
+    return true;
+}
 
+bool TreeModel::removeHostDevices(const QModelIndex &hostIndex, const QString &hostId, const QSet<QString> &dbIds)
+{
+    HostItem *hostItem = static_cast<HostItem*>(hostIndex.internalPointer());
     QList<DeviceData>& backingDeviceList = m_devicesByHost[hostId];
-    
-    QMap<QString, QVariantMap> newDevicesByDbId;
-    for (const QVariant& v : newDevicesVariant) {
-        QVariantMap m = v.toMap();
-        QString dbId = m["db_id"].toString();
-        if (!dbId.isEmpty()) {
-            newDevicesByDbId.insert(dbId, m);
+
+    // 通过索引定位行号，从后往前删，前面的行号不受影响
+    QList<int> rows;
+    rows.reserve(dbIds.size());
+    for (const QString &dbId : dbIds) {
+        DeviceItem *deviceItem = m_deviceItems.value(dbId);
+        if (deviceItem && deviceItem->parentItem() == hostItem) {
+            rows.append(deviceItem->row());
         }
     }
-
-    // --- Step 1: Remove devices that no longer exist ---
-    bool anyDeviceRemoved = false;
-    for (int i = backingDeviceList.size() - 1; i >= 0; --i) {
-        const DeviceData& localDevice = backingDeviceList[i];
-        bool existsInNewList = newDevicesByDbId.contains(localDevice.dbId);
-        if (!existsInNewList) {
-            beginRemoveRows(hostIndex, i, i);
-            m_checkedDeviceIds.remove(backingDeviceList[i].dbId);
-            m_selectedDeviceIds.remove(backingDeviceList[i].dbId);
-            delete hostItem->takeChild(i);
-            backingDeviceList.removeAt(i);
-            endRemoveRows();
-            m_deviceIndexCache.remove(localDevice.dbId);
-            anyDeviceRemoved = true;
+    // 没有 dbId 的设备不在索引里，只能逐个比对
+    if (dbIds.contains(QString())) {
+        for (int i = 0; i < hostItem->childCount(); ++i) {
+            if (static_cast<DeviceItem*>(hostItem->child(i))->deviceData().dbId.isEmpty()) {
+                rows.append(i);
+            }
         }
     }
+    std::sort(rows.begin(), rows.end(), std::greater<int>());
 
-    // --- Step 2: Update existing and add new devices ---
-    for (const QVariant& deviceVariant : newDevicesVariant) {
-        QVariantMap newDeviceMap = deviceVariant.toMap();
-        QString dbId = newDeviceMap["db_id"].toString();
-        DeviceData* oldDevicePtr = nullptr;
-        int oldDeviceRow = -1;
-
-        // 通过dbId查找
-        for(int i = 0; i < backingDeviceList.size(); ++i) {
-            if (backingDeviceList[i].dbId == dbId) {
-                oldDevicePtr = &backingDeviceList[i];
-                oldDeviceRow = i;
-                break;
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+
+    // 相邻的行合并成一次 beginRemoveRows，代理模型每段只处理一次
+    int pos = 0;
+    while (pos < rows.size()) {
+        int last = rows[pos];
+        int first = last;
+        while (pos + 1 < rows.size() && rows[pos + 1] == first - 1) {
+            first = rows[++pos];
+        }
+        ++pos;
+
+        beginRemoveRows(hostIndex, first, last);
+        for (int i = last; i >= first; --i) {
+            // 树的行号不一定等于后备列表的下标，摘下节点之前按 dbId 找到后备记录
+            DeviceItem *deviceItem = static_cast<DeviceItem*>(hostItem->child(i));
+            int backingRow = backingDeviceRow(deviceItem);
+            hostItem->takeChild(i);
+            releaseDevice(deviceItem);
+            delete deviceItem;
+            if (backingRow >= 0) {
+                backingDeviceList.removeAt(backingRow);
             }
         }
+        endRemoveRows();
+    }
+    return !rows.isEmpty();
+}
 
-        if (oldDevicePtr) {
-            // --- UPDATE ---
-            DeviceData& oldDevice = *oldDevicePtr;
-            
-            // 保持勾选状态
-            bool wasChecked = m_checkedDeviceIds.contains(oldDevice.dbId);
-            bool wasSelected = m_selectedDeviceIds.contains(oldDevice.dbId);
-            
-            DeviceData newDeviceFromServer;
-            parseDevice(QJsonObject::fromVariantMap(newDeviceMap), newDeviceFromServer);
+bool TreeModel::updateHostDevice(const QString &hostIp, const QModelIndex &hostIndex, const DeviceData &newDeviceFromServer)
+{
+    HostItem *hostItem = static_cast<HostItem*>(hostIndex.internalPointer());
+    const QString dbId = newDeviceFromServer.dbId;
+    DeviceData* oldDevicePtr = nullptr;
+    int oldDeviceRow = -1;
 
-            QVector<int> changedRoles;
+    // 通过dbId索引查找
+    DeviceItem *oldDeviceItem = m_deviceItems.value(dbId);
+    if (oldDeviceItem && oldDeviceItem->parentItem() == hostItem) {
+        oldDevicePtr = backingDevice(oldDeviceItem);
+        oldDeviceRow = oldDeviceItem->row();
+    }
 
-            if (oldDevice.id.isEmpty() && !dbId.isEmpty()) {
-                oldDevice.id = dbId;  // 使用dbId作为id
-                changedRoles.append(IdRole);
-            }
-            // 确保hostIp不为空，如果为空则使用传入的hostIp
-            if (oldDevice.hostIp.isEmpty()) {
-                oldDevice.hostIp = hostIp;
-                changedRoles.append(HostIpRole);
-            }
-            if (oldDevice.displayName != newDeviceFromServer.displayName) { oldDevice.displayName = newDeviceFromServer.displayName; changedRoles.append(DisplayNameRole); }
-            if (oldDevice.state != newDeviceFromServer.state) { oldDevice.state = newDeviceFromServer.state; changedRoles.append(StateRole); }
-            if (oldDevice.image != newDeviceFromServer.image) { oldDevice.image = newDeviceFromServer.image; changedRoles.append(ImageRole); }
-            if (oldDevice.adb != newDeviceFromServer.adb) { oldDevice.adb = newDeviceFromServer.adb; changedRoles.append(AdbRole); }
-            if (oldDevice.data != newDeviceFromServer.data) { oldDevice.data = newDeviceFromServer.data; changedRoles.append(DataRole); }
-            if (oldDevice.dbId != newDeviceFromServer.dbId) {
-                oldDevice.dbId = newDeviceFromServer.dbId;
-                changedRoles.append(DbIdRole);
-            }
-            if (oldDevice.dns != newDeviceFromServer.dns) { oldDevice.dns = newDeviceFromServer.dns; changedRoles.append(DnsRole); }
-            if (oldDevice.dpi != newDeviceFromServer.dpi) { oldDevice.dpi = newDeviceFromServer.dpi; changedRoles.append(DpiRole); }
-            if (oldDevice.fps != newDeviceFromServer.fps) { oldDevice.fps = newDeviceFromServer.fps; changedRoles.append(FpsRole); }
-            if (oldDevice.height != newDeviceFromServer.height) { oldDevice.height = newDeviceFromServer.height; changedRoles.append(HeightRole); }
-            if (oldDevice.ip != newDeviceFromServer.ip) { oldDevice.ip = newDeviceFromServer.ip; changedRoles.append(IpRole); }
-            if (oldDevice.memory != newDeviceFromServer.memory) { oldDevice.memory = newDeviceFromServer.memory; changedRoles.append(MemoryRole); }
-            if (oldDevice.name != newDeviceFromServer.name) { oldDevice.name = newDeviceFromServer.name; changedRoles.append(NameRole); }
-            if (oldDevice.shortId != newDeviceFromServer.shortId) { oldDevice.shortId = newDeviceFromServer.shortId; changedRoles.append(ShortIdRole); }
-            if (oldDevice.width != newDeviceFromServer.width) { oldDevice.width = newDeviceFromServer.width; changedRoles.append(WidthRole); }
-            if (oldDevice.aospVersion != newDeviceFromServer.aospVersion) { oldDevice.aospVersion = newDeviceFromServer.aospVersion; changedRoles.append(AospVersionRole); }
-            // 只有当新数据中的hostIp不为空时才更新，避免清空hostIp
-            if (!newDeviceFromServer.hostIp.isEmpty() && oldDevice.hostIp != newDeviceFromServer.hostIp) { 
-                oldDevice.hostIp = newDeviceFromServer.hostIp; 
-                changedRoles.append(HostIpRole); 
-            }
-            if (oldDevice.created != newDeviceFromServer.created) { oldDevice.created = newDeviceFromServer.created; changedRoles.append(CreatedRole); }
-            if (oldDevice.tcpVideoPort != newDeviceFromServer.tcpVideoPort) { oldDevice.tcpVideoPort = newDeviceFromServer.tcpVideoPort; changedRoles.append(TcpVideoPortRole); }
-            if (oldDevice.tcpAudioPort != newDeviceFromServer.tcpAudioPort) { oldDevice.tcpAudioPort = newDeviceFromServer.tcpAudioPort; changedRoles.append(TcpAudioPortRole); }
-            if (oldDevice.tcpControlPort != newDeviceFromServer.tcpControlPort) { oldDevice.tcpControlPort = newDeviceFromServer.tcpControlPort; changedRoles.append(TcpControlPortRole); }
-            if (oldDevice.macvlanIp != newDeviceFromServer.macvlanIp) { oldDevice.macvlanIp = newDeviceFromServer.macvlanIp; changedRoles.append(MacvlanIpRole); }
+    if (!oldDevicePtr) {
+        return false;
+    }
 
-            if (!changedRoles.isEmpty()) {
-                // 同步更新 backingDeviceList（m_devicesByHost 的引用），这样 toJson() 才能正确序列化
-                backingDeviceList[oldDeviceRow] = oldDevice;
-                
-                QModelIndex deviceIndex = index(oldDeviceRow, 0, hostIndex);
-                static_cast<DeviceItem*>(deviceIndex.internalPointer())->deviceData() = oldDevice;
-                emit dataChanged(deviceIndex, deviceIndex, changedRoles);
-            }
-            
-            // 恢复勾选状态
-            if (wasChecked) {
-                m_checkedDeviceIds.insert(oldDevice.dbId);
-            }
-            if (wasSelected) {
-                m_selectedDeviceIds.insert(oldDevice.dbId);
-            }
-        } else {
-            // --- ADD ---
-            DeviceData deviceToAdd;
-            parseDevice(QJsonObject::fromVariantMap(newDeviceMap), deviceToAdd);
-            deviceToAdd.hostId = hostId;
-            deviceToAdd.groupId = hostItem->hostData().groupId;
-            deviceToAdd.hostIp = hostIp;  // 设置传入的hostIp
-            
-            // 检查设备状态，如果是 creating 状态则默认勾选
-            bool shouldCheck = m_checkedDeviceIds.contains(deviceToAdd.dbId);
-            if (!shouldCheck && deviceToAdd.state == "creating") {
-                shouldCheck = true;
-                m_checkedDeviceIds.insert(deviceToAdd.dbId);
-            }
-            
-            deviceToAdd.checked = shouldCheck;
-            deviceToAdd.selected = m_selectedDeviceIds.contains(deviceToAdd.dbId);
-            deviceToAdd.refresh = false;
-            
-            int newRow = backingDeviceList.size();
-            beginInsertRows(hostIndex, newRow, newRow);
-            backingDeviceList.append(deviceToAdd);
-            hostItem->appendChild(new DeviceItem(deviceToAdd, hostItem));
-            endInsertRows();
-
-            // 新增设备后，主机的三态可能已变化（尤其是空主机被分组/主机级意图勾选后新增设备）
-            emit dataChanged(hostIndex, hostIndex, {CheckedRole});
-            QModelIndex groupIndexAfterAdd = parent(hostIndex);
-            if (groupIndexAfterAdd.isValid()) {
-                emit dataChanged(groupIndexAfterAdd, groupIndexAfterAdd, {CheckedRole});
-            }
+    DeviceData& oldDevice = *oldDevicePtr;
+
+    // 记录哈希相同说明服务端字段都没变，跳过逐字段比较
+    if (oldDevice.recordHash != 0 && oldDevice.recordHash == newDeviceFromServer.recordHash
+        && !oldDevice.id.isEmpty() && !oldDevice.hostIp.isEmpty()
+        && (newDeviceFromServer.hostIp.isEmpty() || newDeviceFromServer.hostIp == oldDevice.hostIp)) {
+        return true;
+    }
+
+    QVector<int> changedRoles;
+
+    if (oldDevice.id.isEmpty() && !dbId.isEmpty()) {
+        oldDevice.id = dbId;  // 使用dbId作为id
+        changedRoles.append(IdRole);
+    }
+    // 确保hostIp不为空，如果为空则使用传入的hostIp
+    if (oldDevice.hostIp.isEmpty()) {
+        oldDevice.hostIp = hostIp;
+        changedRoles.append(HostIpRole);
+    }
+    if (oldDevice.displayName != newDeviceFromServer.displayName) { oldDevice.displayName = newDeviceFromServer.displayName; changedRoles.append(DisplayNameRole); }
+    if (oldDevice.state != newDeviceFromServer.state) { oldDevice.state = newDeviceFromServer.state; changedRoles.append(StateRole); }
+    if (oldDevice.image != newDeviceFromServer.image) { oldDevice.image = newDeviceFromServer.image; changedRoles.append(ImageRole); }
+    if (oldDevice.adb != newDeviceFromServer.adb) { oldDevice.adb = newDeviceFromServer.adb; changedRoles.append(AdbRole); }
+    if (oldDevice.data != newDeviceFromServer.data) { oldDevice.data = newDeviceFromServer.data; changedRoles.append(DataRole); }
+    if (oldDevice.dbId != newDeviceFromServer.dbId) {
+        oldDevice.dbId = newDeviceFromServer.dbId;
+        changedRoles.append(DbIdRole);
+    }
+    if (oldDevice.dns != newDeviceFromServer.dns) { oldDevice.dns = newDeviceFromServer.dns; changedRoles.append(DnsRole); }
+    if (oldDevice.dpi != newDeviceFromServer.dpi) { oldDevice.dpi = newDeviceFromServer.dpi; changedRoles.append(DpiRole); }
+    if (oldDevice.fps != newDeviceFromServer.fps) { oldDevice.fps = newDeviceFromServer.fps; changedRoles.append(FpsRole); }
+    if (oldDevice.height != newDeviceFromServer.height) { oldDevice.height = newDeviceFromServer.height; changedRoles.append(HeightRole); }
+    if (oldDevice.ip != newDeviceFromServer.ip) { oldDevice.ip = newDeviceFromServer.ip; changedRoles.append(IpRole); }
+    if (oldDevice.memory != newDeviceFromServer.memory) { oldDevice.memory = newDeviceFromServer.memory; changedRoles.append(MemoryRole); }
+    if (oldDevice.name != newDeviceFromServer.name) { oldDevice.name = newDeviceFromServer.name; changedRoles.append(NameRole); }
+    if (oldDevice.shortId != newDeviceFromServer.shortId) { oldDevice.shortId = newDeviceFromServer.shortId; changedRoles.append(ShortIdRole); }
+    if (oldDevice.width != newDeviceFromServer.width) { oldDevice.width = newDeviceFromServer.width; changedRoles.append(WidthRole); }
+    if (oldDevice.aospVersion != newDeviceFromServer.aospVersion) { oldDevice.aospVersion = newDeviceFromServer.aospVersion; changedRoles.append(AospVersionRole); }
+    // 只有当新数据中的hostIp不为空时才更新，避免清空hostIp
+    if (!newDeviceFromServer.hostIp.isEmpty() && oldDevice.hostIp != newDeviceFromServer.hostIp) {
+        oldDevice.hostIp = newDeviceFromServer.hostIp;
+        changedRoles.append(HostIpRole);
+    }
+    if (oldDevice.created != newDeviceFromServer.created) { oldDevice.created = newDeviceFromServer.created; changedRoles.append(CreatedRole); }
+    if (oldDevice.tcpVideoPort != newDeviceFromServer.tcpVideoPort) { oldDevice.tcpVideoPort = newDeviceFromServer.tcpVideoPort; changedRoles.append(TcpVideoPortRole); }
+    if (oldDevice.tcpAudioPort != newDeviceFromServer.tcpAudioPort) { oldDevice.tcpAudioPort = newDeviceFromServer.tcpAudioPort; changedRoles.append(TcpAudioPortRole); }
+    if (oldDevice.tcpControlPort != newDeviceFromServer.tcpControlPort) { oldDevice.tcpControlPort = newDeviceFromServer.tcpControlPort; changedRoles.append(TcpControlPortRole); }
+    if (oldDevice.macvlanIp != newDeviceFromServer.macvlanIp) { oldDevice.macvlanIp = newDeviceFromServer.macvlanIp; changedRoles.append(MacvlanIpRole); }
+
+    // 逐字段合并后服务端字段与新记录一致，沿用它的哈希
+    oldDevice.recordHash = newDeviceFromServer.recordHash;
+
+    if (!changedRoles.isEmpty()) {
+        QModelIndex deviceIndex = index(oldDeviceRow, 0, hostIndex);
+        setDeviceData(oldDeviceItem, oldDevice);
+        notifyChanged(deviceIndex, changedRoles);
+    }
+    return true;
+}
+
+void TreeModel::appendHostDevices(const QString &hostIp, const QModelIndex &hostIndex, const QString &hostId, const QList<DeviceData> &devices)
+{
+    if (devices.isEmpty()) {
+        return;
+    }
+    HostItem *hostItem = static_cast<HostItem*>(hostIndex.internalPointer());
+    QList<DeviceData>& backingDeviceList = m_devicesByHost[hostId];
+
+    // 新设备一次插入到末尾，只发一次 rowsInserted
+    int firstRow = backingDeviceList.size();
+    beginInsertRows(hostIndex, firstRow, firstRow + devices.size() - 1);
+    for (const DeviceData &newDeviceFromServer : devices) {
+        DeviceData deviceToAdd = newDeviceFromServer;
+        deviceToAdd.hostId = hostId;
+        deviceToAdd.groupId = hostItem->hostData().groupId;
+        deviceToAdd.hostIp = hostIp;  // 设置传入的hostIp
+
+        // 检查设备状态，如果是 creating 状态则默认勾选
+        const bool shouldCheck = deviceToAdd.state == "creating";
+
+        deviceToAdd.checked = shouldCheck;
+        deviceToAdd.selected = false;
+        deviceToAdd.refresh = false;
+
+        backingDeviceList.append(deviceToAdd);
+        DeviceItem *deviceItem = new DeviceItem(deviceToAdd, hostItem);
+        hostItem->appendChild(deviceItem);
+        indexDevice(deviceItem);
+        if (shouldCheck) {
+            setDeviceChecked(deviceItem, true);
         }
     }
+    endInsertRows();
+
+    // 新增设备后，主机的三态可能已变化（尤其是空主机被分组/主机级意图勾选后新增设备）
+    notifyChanged(hostIndex, {CheckedRole});
+    QModelIndex groupIndexAfterAdd = parent(hostIndex);
+    if (groupIndexAfterAdd.isValid()) {
+        notifyChanged(groupIndexAfterAdd, {CheckedRole});
+    }
+}
+
+void TreeModel::finishHostDevices(const QModelIndex &hostIndex, const QString &hostId, bool anyDeviceRemoved)
+{
+    HostItem *hostItem = static_cast<HostItem*>(hostIndex.internalPointer());
+    QList<DeviceData>& backingDeviceList = m_devicesByHost[hostId];
 
     if (hostItem->hostData().hostPadCount != backingDeviceList.size()) {
         hostItem->hostData().hostPadCount = backingDeviceList.size();
-        emit dataChanged(hostIndex, hostIndex, {HostPadCountRole});
-        
+        notifyChanged(hostIndex, {HostPadCountRole});
+
         // 更新分组的设备数量显示
         QModelIndex groupIndex = parent(hostIndex);
         if (groupIndex.isValid()) {
-            emit dataChanged(groupIndex, groupIndex, {GroupPadCountRole});
+            notifyChanged(groupIndex, {GroupPadCountRole});
         }
     }
 
     // 删除设备后也需要刷新主机与分组的三态，以便在未展开时正确更新复选框
     if (anyDeviceRemoved) {
-        emit dataChanged(hostIndex, hostIndex, {CheckedRole});
+        notifyChanged(hostIndex, {CheckedRole});
         QModelIndex groupIndexAfterRemove = parent(hostIndex);
         if (groupIndexAfterRemove.isValid()) {
-            emit dataChanged(groupIndexAfterRemove, groupIndexAfterRemove, {CheckedRole});
+            notifyChanged(groupIndexAfterRemove, {CheckedRole});
         }
     }
 
     // 当主机从空->有设备：若之前主机为“空主机勾选”，则将所有设备置为勾选并清理该主机标记
     if (hostItem->childCount() > 0 && m_checkedHostIds.contains(hostId)) {
-        for (const auto& d : backingDeviceList) {
-            if (!d.dbId.isEmpty()) m_checkedDeviceIds.insert(d.dbId);
+        for (int i = 0; i < hostItem->childCount(); ++i) {
+            setDeviceChecked(static_cast<DeviceItem*>(hostItem->child(i)), true);
         }
-        m_checkedHostIds.remove(hostId);
-        emit dataChanged(hostIndex, hostIndex, {CheckedRole});
+        setHostCheckIntent(hostItem, false);
+        notifyChanged(hostIndex, {CheckedRole});
         QModelIndex groupIndex = parent(hostIndex);
-        if (groupIndex.isValid()) emit dataChanged(groupIndex, groupIndex, {CheckedRole});
+        if (groupIndex.isValid()) notifyChanged(groupIndex, {CheckedRole});
     }
 
     // 当主机变为无设备：若父分组曾被勾选，则将该空主机设置为勾选
     if (hostItem->childCount() == 0 && m_checkedGroupIds.contains(hostItem->hostData().groupId)) {
-        m_checkedHostIds.insert(hostId);
-        emit dataChanged(hostIndex, hostIndex, {CheckedRole});
+        setHostCheckIntent(hostItem, true);
+        notifyChanged(hostIndex, {CheckedRole});
         QModelIndex groupIndex = parent(hostIndex);
-        if (groupIndex.isValid()) emit dataChanged(groupIndex, groupIndex, {CheckedRole});
+        if (groupIndex.isValid()) notifyChanged(groupIndex, {CheckedRole});
     }
 
     saveConfig();
 }
 
+void TreeModel::updateDeviceList(const QString &hostIp, const QVariantList &newDevicesVariant)
+{
+    DeviceListDelta delta;
+    delta.hostIp = hostIp;
+    delta.full = true;
+    delta.changed.reserve(newDevicesVariant.size());
+    for (const QVariant& deviceVariant : newDevicesVariant) {
+        DeviceData newDeviceFromServer;
+        parseDevice(QJsonObject::fromVariantMap(deviceVariant.toMap()), newDeviceFromServer);
+        delta.changed.append(newDeviceFromServer);
+    }
+    applyDeviceDelta(delta);
+}
 
-int TreeModel::getRunningDeviceCount(const QString& hostIp) const
+void TreeModel::applyDeviceDelta(const QString &hostIp, const QVariantList &changedDevices, const QStringList &removedDbIds)
 {
+    DeviceListDelta delta;
+    delta.hostIp = hostIp;
+    delta.removed = removedDbIds;
+    delta.changed.reserve(changedDevices.size());
+    for (const QVariant& deviceVariant : changedDevices) {
+        DeviceData newDeviceFromServer;
+        parseDevice(QJsonObject::fromVariantMap(deviceVariant.toMap()), newDeviceFromServer);
+        delta.changed.append(newDeviceFromServer);
+    }
+    applyDeviceDelta(delta);
+}
+
+void TreeModel::applyDeviceDelta(const DeviceListDelta &delta)
+{
+    if (!delta.full && delta.changed.isEmpty() && delta.removed.isEmpty()) {
+        return;
+    }
     QString hostId;
-    for (const auto& h_list : m_hostsByGroup) {
-        for (const auto& h : h_list) {
-            if (h.ip == hostIp) {
-                hostId = h.hostId;
-                break;
+    QModelIndex hostIndex;
+    if (!resolveHost(delta.hostIp, hostId, hostIndex, "applyDeviceDelta")) {
+        return;
+    }
+    beginTransaction();
+
+    // --- Step 1: Remove devices that no longer exist ---
+    QSet<QString> removedDbIds(delta.removed.begin(), delta.removed.end());
+    if (delta.full) {
+        QSet<QString> newDbIds;
+        newDbIds.reserve(delta.changed.size());
+        for (const DeviceData& device : delta.changed) {
+            if (!device.dbId.isEmpty()) {
+                newDbIds.insert(device.dbId);
+            }
+        }
+        for (const DeviceData& localDevice : m_devicesByHost.value(hostId)) {
+            if (!newDbIds.contains(localDevice.dbId)) {
+                removedDbIds.insert(localDevice.dbId);
             }
         }
-        if (!hostId.isEmpty()) break;
     }
+    bool anyDeviceRemoved = removeHostDevices(hostIndex, hostId, removedDbIds);
+
+    // --- Step 2: Update existing and add new devices ---
+    QList<DeviceData> addedDevices;
+    QHash<QString, int> addedRows;
+    for (const DeviceData& newDeviceFromServer : delta.changed) {
+        if (updateHostDevice(delta.hostIp, hostIndex, newDeviceFromServer)) {
+            continue;
+        }
+        // 同一批里重复出现的新设备以最后一条为准
+        auto rowIt = addedRows.constFind(newDeviceFromServer.dbId);
+        if (rowIt != addedRows.constEnd()) {
+            addedDevices[rowIt.value()] = newDeviceFromServer;
+            continue;
+        }
+        if (!newDeviceFromServer.dbId.isEmpty()) {
+            addedRows.insert(newDeviceFromServer.dbId, addedDevices.size());
+        }
+        addedDevices.append(newDeviceFromServer);
+    }
+    appendHostDevices(delta.hostIp, hostIndex, hostId, addedDevices);
+
+    finishHostDevices(hostIndex, hostId, anyDeviceRemoved);
+    commitTransaction();
+}
 
+
+int TreeModel::getRunningDeviceCount(const QString& hostIp) const
+{
+    QString hostId = m_hostIdsByIp.value(hostIp);
     if (hostId.isEmpty()) {
         return 0;
     }
@@ -2258,34 +2483,19 @@ int TreeModel::getRunningDeviceCount(const QString& hostIp) const
 void TreeModel::updateDeviceListV3(const QString &hostIp, const QVariantList &partialDevices)
 {
     QString hostId;
-    for (const auto& h_list : m_hostsByGroup) {
-        for (const auto& h : h_list) {
-            if (h.ip == hostIp) { hostId = h.hostId; break; }
-        }
-        if (!hostId.isEmpty()) break;
-    }
-
-    if (hostId.isEmpty()) {
-        qWarning() << "updateDeviceListV3: Host with IP not found:" << hostIp;
-        return;
-    }
-
-    QModelIndex hostIndex = findIndex(hostId, TypeHost);
-    if (!hostIndex.isValid()) {
-        qWarning() << "updateDeviceListV3: Host with id" << hostId << "not found in tree structure.";
+    QModelIndex hostIndex;
+    if (!resolveHost(hostIp, hostId, hostIndex, "updateDeviceListV3")) {
         return;
     }
+    beginTransaction();
     HostItem *hostItem = static_cast<HostItem*>(hostIndex.internalPointer());
 
     QList<DeviceData>& devices = m_devicesByHost[hostId];
 
     auto findDeviceRow = [&](const QVariantMap &m) -> int {
-        const QString dbId = m.value("db_id").toString();
-        for (int i = 0; i < devices.size(); ++i) {
-            const DeviceData &d = devices.at(i);
-            if (!dbId.isEmpty() && d.dbId == dbId) return i;
-        }
-        return -1;
+        DeviceItem *deviceItem = m_deviceItems.value(m.value("db_id").toString());
+        if (!deviceItem || deviceItem->parentItem() != hostItem) return -1;
+        return backingDeviceRow(deviceItem);
     };
 
     bool anyChanged = false;
@@ -2325,8 +2535,8 @@ void TreeModel::updateDeviceListV3(const QString &hostIp, const QVariantList &pa
         if (m.contains("user_name")) updateIf("user_name", m.value("user_name"), dev.displayName, DisplayNameRole);
         if (m.contains("name")) updateIf("name", m.value("name"), dev.name, NameRole);
         if (m.contains("image")) updateIf("image", m.value("image"), dev.image, ImageRole);
-        if (m.contains("dpi")) updateIf("dpi", m.value("dpi"), dev.dpi, DpiRole);
-        if (m.contains("fps")) updateIf("fps", m.value("fps"), dev.fps, FpsRole);
+        if (m.contains("dpi")) updateIfInt("dpi", m.value("dpi"), dev.dpi, DpiRole);
+        if (m.contains("fps")) updateIfInt("fps", m.value("fps"), dev.fps, FpsRole);
         if (m.contains("state")) updateIf("state", m.value("state"), dev.state, StateRole);
         if (m.contains("refresh")) updateIfBool("refresh", m.value("refresh"), dev.refresh, RefreshRole);
         if (m.contains("adb")) updateIfInt("adb", m.value("adb"), dev.adb, AdbRole);
@@ -2337,12 +2547,12 @@ void TreeModel::updateDeviceListV3(const QString &hostIp, const QVariantList &pa
         if (m.contains("tcp_audio_port")) updateIfInt("tcp_audio_port", m.value("tcp_audio_port"), dev.tcpAudioPort, TcpAudioPortRole);
         if (m.contains("tcp_control_port")) updateIfInt("tcp_control_port", m.value("tcp_control_port"), dev.tcpControlPort, TcpControlPortRole);
         if (m.contains("dns")) updateIf("dns", m.value("dns"), dev.dns, DnsRole);
-        if (m.contains("height")) updateIf("height", m.value("height"), dev.height, HeightRole);
+        if (m.contains("height")) updateIfInt("height", m.value("height"), dev.height, HeightRole);
         if (m.contains("ip")) updateIf("ip", m.value("ip"), dev.ip, IpRole);
         if (m.contains("memory")) updateIfInt("memory", m.value("memory"), dev.memory, MemoryRole);
         // if (m.contains("shortId")) updateIf("shortId", m.value("shortId"), dev.shortId, ShortIdRole);
         if (m.contains("short_id")) updateIf("short_id", m.value("short_id"), dev.shortId, ShortIdRole);
-        if (m.contains("width")) updateIf("width", m.value("width"), dev.width, WidthRole);
+        if (m.contains("width")) updateIfInt("width", m.value("width"), dev.width, WidthRole);
         // if (m.contains("aospVersion")) updateIf("aospVersion", m.value("aospVersion"), dev.aospVersion, AospVersionRole);
         if (m.contains("aosp_version")) updateIf("aosp_version", m.value("aosp_version"), dev.aospVersion, AospVersionRole);
         // if (m.contains("hostIp")) updateIf("hostIp", m.value("hostIp"), dev.hostIp, HostIpRole);
@@ -2353,18 +2563,19 @@ void TreeModel::updateDeviceListV3(const QString &hostIp, const QVariantList &pa
         if (m.contains("id")) updateIf("id", m.value("id"), dev.id, IdRole);
 
         if (!changedRoles.isEmpty()) {
+            dev.recordHash = 0;
             QModelIndex deviceIndex = index(row, 0, hostIndex);
-            static_cast<DeviceItem*>(deviceIndex.internalPointer())->deviceData() = dev;
-            emit dataChanged(deviceIndex, deviceIndex, changedRoles);
+            setDeviceData(static_cast<DeviceItem*>(deviceIndex.internalPointer()), dev);
+            notifyChanged(deviceIndex, changedRoles);
             anyChanged = true;
             
             // 如果设备状态改变，需要通知主机节点更新 HostPadCountRole（用于显示过滤后的设备数量）
             // 同时需要通知分组节点更新 GroupPadCountRole
             if (changedRoles.contains(StateRole)) {
-                emit dataChanged(hostIndex, hostIndex, {HostPadCountRole});
+                notifyChanged(hostIndex, {HostPadCountRole});
                 QModelIndex groupIndex = parent(hostIndex);
                 if (groupIndex.isValid()) {
-                    emit dataChanged(groupIndex, groupIndex, {GroupPadCountRole});
+                    notifyChanged(groupIndex, {GroupPadCountRole});
                 }
             }
         }
@@ -2373,6 +2584,7 @@ void TreeModel::updateDeviceListV3(const QString &hostIp, const QVariantList &pa
     if (anyChanged) {
         saveConfig();
     }
+    commitTransaction();
 }
 
 
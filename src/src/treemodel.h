@@ -3,13 +3,18 @@
 
 #include <QAbstractItemModel>
 #include <QSet>
+#include <QBitArray>
+#include <QHash>
+#include <QMultiHash>
 #include <QPersistentModelIndex>
+#include <functional>
 #include "treeitem.h"
 
 // Forward declarations from structs.h
 struct GroupData;
 struct HostData;
 struct DeviceData;
+struct DeviceListDelta;
 
 class TreeModel : public QAbstractItemModel
 {
@@ -55,6 +60,14 @@ public:
     Q_INVOKABLE void modifyHost(const QString& hostIp, const QVariantMap& newData);
     Q_INVOKABLE void updateDeviceList(const QString &hostIp, const QVariantList &devices);
     Q_INVOKABLE void updateDeviceListV3(const QString &hostIp, const QVariantList &devices);
+    // 增量更新：只处理有变化的设备和已删除的 dbId，未列出的设备保持不变
+    Q_INVOKABLE void applyDeviceDelta(const QString &hostIp, const QVariantList &changedDevices, const QStringList &removedDbIds);
+    // 应用已解析好的差异，供后台解析的同步路径使用，主线程调用
+    void applyDeviceDelta(const DeviceListDelta &delta);
+    // 事务：期间的 dataChanged 先记下，最外层提交时按父节点合并成连续区间、角色取并集后一次发出，
+    // 配置也只在提交时保存一次。可以嵌套，必须成对调用
+    Q_INVOKABLE void beginTransaction();
+    Q_INVOKABLE void commitTransaction();
     Q_INVOKABLE QVariantList hostList() const;
     Q_INVOKABLE int getRunningDeviceCount(const QString& hostIp) const;
 
@@ -63,8 +76,15 @@ public:
     Q_INVOKABLE void checkGroup(int groupId, bool checked);
     Q_INVOKABLE void checkHost(const QString& hostId, bool checked);
     Q_INVOKABLE void checkDevice(const QString& dbId, bool checked);
+    // 批量勾选/取消勾选，所有变化合并成一次通知
+    Q_INVOKABLE void checkDevices(const QStringList& dbIds, bool checked);
+    Q_INVOKABLE void checkAllDevices(bool checked);
+    // 按条件设置每个设备的勾选状态；onlyDbIds 不为空时只处理其中的设备
+    void checkDevicesWhere(const std::function<bool(const DeviceData&)>& shouldCheck, const QSet<QString>* onlyDbIds = nullptr);
     bool isDeviceSelected(const QString& dbId) const;
     bool isDeviceChecked(const QString& dbId) const;
+    // 不访问模型状态，可以在工作线程中调用
+    static void parseDevice(const QJsonObject& padObject, DeviceData& device);
     ItemType typeGroup() const { return TypeGroup; }
     ItemType typeHost() const { return TypeHost; }
     ItemType typeDevice() const { return TypeDevice; }
@@ -79,16 +99,45 @@ private:
     void loadConfig();
     int generateNewGroupId();
     void parseData(const QByteArray& data, QList<GroupData>& groups, QMap<int, QList<HostData>>& hostsByGroup, QMap<QString, QList<DeviceData>>& devicesByHost);
-    void parseDevice(const QJsonObject& padObject, DeviceData& device);
     void parseGroup(const QJsonObject& groupObject, GroupData& group);
     void parseHost(const QJsonObject& hostObject, HostData& host);
     void checkDevice(const QString& dbId, bool checked, bool updateParents);
     QModelIndex findIndex(const QVariant& id, int type) const;
+    QModelIndex indexOfItem(TreeItem *item) const;
+    HostItem *hostItemByIp(const QString &hostIp) const;
+    HostData *backingHost(HostItem *hostItem);
+    int backingDeviceRow(DeviceItem *deviceItem) const;
+    DeviceData *backingDevice(DeviceItem *deviceItem);
+    void indexHost(HostItem *hostItem);
+    void unindexHost(HostItem *hostItem);
+    void indexDevice(DeviceItem *deviceItem);
+    void unindexDevice(DeviceItem *deviceItem);
+    void setDeviceData(DeviceItem *deviceItem, const DeviceData &data);
+    void acquireDeviceSlot(DeviceItem *deviceItem);
+    void releaseDevice(DeviceItem *deviceItem);
+    bool isChecked(DeviceItem *deviceItem) const;
+    bool isSelected(DeviceItem *deviceItem) const;
+    bool setDeviceChecked(DeviceItem *deviceItem, bool checked);
+    void setDeviceSelected(DeviceItem *deviceItem, bool selected);
+    void setHostCheckIntent(HostItem *hostItem, bool checked);
+    int hostCheckState(HostItem *hostItem) const;
+    void updateHostCheckState(HostItem *hostItem);
+    void detachHostCheckState(HostItem *hostItem);
+    bool resolveHost(const QString &hostIp, QString &hostId, QModelIndex &hostIndex, const char *caller) const;
+    bool removeHostDevices(const QModelIndex &hostIndex, const QString &hostId, const QSet<QString> &dbIds);
+    bool updateHostDevice(const QString &hostIp, const QModelIndex &hostIndex, const DeviceData &device);
+    void appendHostDevices(const QString &hostIp, const QModelIndex &hostIndex, const QString &hostId, const QList<DeviceData> &devices);
+    void notifyChanged(const QModelIndex &index, const QVector<int> &roles);
+    void flushPendingChanges();
+    void finishHostDevices(const QModelIndex &hostIndex, const QString &hostId, bool anyDeviceRemoved);
 
     TreeItem *m_rootItem;
-    QSet<QString> m_selectedDeviceIds;  // 存储选中的设备dbId（因为id在创建过程中为空）
-    QSet<QString> m_checkedDeviceIds;   // 存储勾选的设备dbId（因为id在创建过程中为空）
-    mutable QMap<QString, QPersistentModelIndex> m_deviceIndexCache;  // 设备ID到持久索引的缓存
+    // 设备的勾选/选中状态，按 DeviceItem::slot() 存在位图里，序号随设备删除回收复用
+    QBitArray m_checkedBits;
+    QBitArray m_selectedBits;
+    QVector<int> m_freeDeviceSlots;
+    int m_deviceSlotCount = 0;
+    int m_checkedDeviceCount = 0;
     QSet<int> m_checkedGroupIds;        // 存储分组的勾选状态（在无主机时生效）
     QSet<QString> m_checkedHostIds;     // 存储主机的勾选状态（在无设备时生效）
 
@@ -96,6 +145,18 @@ private:
     QList<GroupData> m_groups;
     QMap<int, QList<HostData>> m_hostsByGroup;
     QMap<QString, QList<DeviceData>> m_devicesByHost;
+
+    // 查找索引，树节点增删、移动和关键字段变化时同步维护
+    QHash<int, GroupItem*> m_groupItems;                  // groupId -> 分组节点
+    QHash<QString, HostItem*> m_hostItems;                // hostId -> 主机节点
+    QHash<QString, QString> m_hostIdsByIp;                // 主机IP -> hostId
+    QHash<QString, DeviceItem*> m_deviceItems;            // dbId -> 设备节点
+    QHash<QString, DeviceItem*> m_deviceItemsByShortId;   // shortId -> 设备节点
+    QMultiHash<QString, DeviceItem*> m_deviceItemsByName; // 设备名 -> 设备节点（不同主机下可能重名）
+
+    int m_transactionDepth = 0;
+    bool m_saveDeferred = false;
+    QHash<TreeItem*, QSet<int>> m_pendingChanges;         // 事务中待通知的节点及角色
 };
 
 #endif // TREEMODEL_H
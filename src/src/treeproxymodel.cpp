@@ -261,48 +261,23 @@ void TreeProxyModel::setShowAllDevices(bool show) {
 
 // 自动勾选匹配搜索条件的设备，取消勾选不匹配的设备
 void TreeProxyModel::autoCheckMatchingDevices() {
-    if (!sourceModel()) return;
-    
-    // 遍历所有设备，根据匹配情况设置勾选状态
-    for (int i = 0; i < sourceModel()->rowCount(QModelIndex()); ++i) { // Groups
-        QModelIndex groupIndex = sourceModel()->index(i, 0, QModelIndex());
-        for (int j = 0; j < sourceModel()->rowCount(groupIndex); ++j) { // Hosts
-            QModelIndex hostIndex = sourceModel()->index(j, 0, groupIndex);
-            for (int k = 0; k < sourceModel()->rowCount(hostIndex); ++k) { // Devices
-                QModelIndex deviceIndex = sourceModel()->index(k, 0, hostIndex);
-                if (sourceModel()->data(deviceIndex, DeviceRoles::ItemTypeRole) == TreeModel::TypeDevice) {
-                    // 检查设备是否匹配搜索条件
-                    QString displayName = sourceModel()->data(deviceIndex, DeviceRoles::DisplayNameRole).toString();
-                    QString hostIp = sourceModel()->data(deviceIndex, DeviceRoles::HostIpRole).toString();
-                    bool matches = displayName.contains(m_searchFilter, Qt::CaseInsensitive) || 
-                                  hostIp.contains(m_searchFilter, Qt::CaseInsensitive);
-                    
-                    // 根据匹配情况设置勾选状态
-                    sourceModel()->setData(deviceIndex, matches, DeviceRoles::CheckedRole);
-                }
-            }
-        }
-    }
+    TreeModel *treeModel = qobject_cast<TreeModel*>(sourceModel());
+    if (!treeModel) return;
+
+    // 由源模型一次批量设置，变化合并通知，不再逐个 setData
+    const QString filter = m_searchFilter;
+    treeModel->checkDevicesWhere([&filter](const DeviceData &device) {
+        return device.displayName.contains(filter, Qt::CaseInsensitive) ||
+               device.hostIp.contains(filter, Qt::CaseInsensitive);
+    });
 }
 
 // 取消所有设备的勾选状态
 void TreeProxyModel::clearAllDeviceChecks() {
-    if (!sourceModel()) return;
-    
-    // 遍历所有设备，取消勾选状态
-    for (int i = 0; i < sourceModel()->rowCount(QModelIndex()); ++i) { // Groups
-        QModelIndex groupIndex = sourceModel()->index(i, 0, QModelIndex());
-        for (int j = 0; j < sourceModel()->rowCount(groupIndex); ++j) { // Hosts
-            QModelIndex hostIndex = sourceModel()->index(j, 0, groupIndex);
-            for (int k = 0; k < sourceModel()->rowCount(hostIndex); ++k) { // Devices
-                QModelIndex deviceIndex = sourceModel()->index(k, 0, hostIndex);
-                if (sourceModel()->data(deviceIndex, DeviceRoles::ItemTypeRole) == TreeModel::TypeDevice) {
-                    // 取消勾选所有设备
-                    sourceModel()->setData(deviceIndex, false, DeviceRoles::CheckedRole);
-                }
-            }
-        }
-    }
+    TreeModel *treeModel = qobject_cast<TreeModel*>(sourceModel());
+    if (!treeModel) return;
+
+    treeModel->checkAllDevices(false);
 }
 
 // 计算过滤后的设备数量（通过代理索引）